@@ -35,6 +35,13 @@ void Myconfig::load_config() {
     l2_sizes_str.push_back(sz);
   }
 
+  if (yamlconfig["L2"]["policy"]) {
+    policy = yamlconfig["L2"]["policy"].as<string>();
+  }
+  if (yamlconfig["L2"]["writeback"]) {
+    track_writeback = yamlconfig["L2"]["writeback"].as<bool>();
+  }
+
   output_path = yamlconfig["output"].as<string>();
 }
 
@@ -43,10 +50,7 @@ void Myconfig::_prepare() {
     int pos = l1_trace_path.at(i).rfind('/');
     if (pos == std::string::npos) pos = -1;
     l1_names.push_back(l1_trace_path.at(i).substr(pos + 1));
-
-    l1_miss_output_path.push_back(output_path + "/l1_trace_" + l1_names.back());
   }
-  l2_trace_path = output_path + "/l2.trace";
   l2_mrc_output_path = output_path + "/l2.mrc";
   mkdir(output_path.c_str(), 0777);
 }
@@ -11,69 +11,70 @@
 
 using namespace std;
 
-double Simulator::gen_miss_trace(string algo, uint64_t cache_size,
-                                 string trace_path, string miss_output_path) {
-  uint64_t n_req = 0, n_hit = 0;
-  std::ofstream miss_ofs(miss_output_path);
+void Simulator::simulate_hierarchy(string &algo, vector<string> &l1_trace_path,
+                                   vector<uint64_t> &l1_sizes,
+                                   vector<uint64_t> &l2_sizes, string &policy,
+                                   bool track_writeback,
+                                   string &mrc_output_path) {
+  int n_l1 = l1_trace_path.size();
+  vector<reader_t *> readers(n_l1);
+  vector<cache_t *> l1_caches(n_l1);
 
-  reader_init_param_t reader_init_params = {
-      .time_field = 1, .obj_id_field = 2, .obj_size_field = 3};
-  // see the cacheSimulator example for using csv trace
-  reader_init_params.binary_fmt_str = "III";
-  reader_t *reader =
-      open_trace(trace_path.c_str(), BIN_TRACE, &reader_init_params);
-  common_cache_params_t cc_params = {.cache_size = cache_size};
-  cache_t *cache = create_cache(algo.c_str(), cc_params, nullptr);
-
-  request_t *req = new_request();
-
-  bool hit;
-  read_one_req(reader, req);
-  while (req->valid) {
-    n_req += 1;
-    hit = cache->get(cache, req);
-    if (!hit)
-      miss_ofs << req->clock_time << "," << (uint64_t)req->obj_id << ","
-               << req->obj_size << std::endl;
-    else
-      n_hit += 1;
-    read_one_req(reader, req);
+  for (int i = 0; i < n_l1; i++) {
+    reader_init_param_t reader_init_params = {
+        .time_field = 1, .obj_id_field = 2, .obj_size_field = 3};
+    // see the cacheSimulator example for using csv trace
+    reader_init_params.binary_fmt_str = (char *)"III";
+    readers[i] = open_trace(l1_trace_path.at(i).c_str(), BIN_TRACE,
+                            &reader_init_params);
+    common_cache_params_t cc_params = default_common_cache_params();
+    cc_params.cache_size = l1_sizes.at(i);
+    l1_caches[i] = create_cache(algo.c_str(), cc_params, nullptr);
   }
 
-  miss_ofs.close();
-  std::cout << trace_path << ", object miss ratio "
-            << 1.0 - (double)n_hit / n_req << std::endl;
-
-  return 1.0 - (double)n_hit / n_req;
-}
-
-void Simulator::output_mrc(string &algo, vector<uint64_t> cache_sizes,
-                           string &trace_path, string &mrc_output_path) {
-  char alg[] = "LRU";
-  reader_init_param_t reader_init_params = {
-      .time_field = 1, .obj_id_field = 2, .obj_size_field = 3};
-  reader_init_params.binary_fmt_str = "III";
-  reader_t *reader =
-      open_trace(trace_path.c_str(), BIN_TRACE, &reader_init_params);
+  common_cache_params_t cc_params = default_common_cache_params();
+  cc_params.cache_size = l2_sizes[0];
+  cache_t *l2_cache = create_cache(algo.c_str(), cc_params, nullptr);
 
-  common_cache_params_t ccparams = {.cache_size = cache_sizes[0]};
-  cache_t *cache = create_cache(algo.c_str(), ccparams, nullptr);
+  cache_hierarchy_params_t params = default_cache_hierarchy_params();
+  params.policy = HIERARCHY_INVALID;
+  for (int i = 0; i < HIERARCHY_INVALID; i++) {
+    if (policy == hierarchy_policy_str[i]) params.policy = (hierarchy_policy_e)i;
+  }
+  if (params.policy == HIERARCHY_INVALID) {
+    std::cerr << "unknown hierarchy policy " << policy << std::endl;
+    abort();
+  }
+  params.track_writeback = track_writeback;
 
-  uint64_t cache_size_array[cache_sizes.size()];
-  std::copy(cache_sizes.begin(), cache_sizes.end(), cache_size_array);
+  vector<cache_stat_t> l1_stat(n_l1);
+  cache_hierarchy_stat_t *mrc = simulate_cache_hierarchy(
+      readers.data(), l1_caches.data(), n_l1, l2_cache, l2_sizes.size(),
+      l2_sizes.data(), &params, l1_stat.data());
 
-  auto mrc = simulate_at_multi_sizes(reader, cache, cache_sizes.size(),
-                                     cache_size_array, nullptr, 0, 0,
-                                     std::thread::hardware_concurrency());
+  for (int i = 0; i < n_l1; i++) {
+    std::cout << l1_trace_path.at(i) << ", object miss ratio "
+              << (double)l1_stat[i].n_miss / l1_stat[i].n_req << std::endl;
+  }
 
   std::ofstream mrc_ofs(mrc_output_path);
-  mrc_ofs << "# L2, " << mrc[0].n_req << " req, " << mrc[0].n_req_byte
+  mrc_ofs << "# L2 (" << hierarchy_policy_str[params.policy] << "), "
+          << mrc[0].stat.n_req << " req, " << mrc[0].stat.n_req_byte
           << " byte" << std::endl;
-  mrc_ofs << "# cache size, miss_cnt, miss_byte" << std::endl;
-  for (int i = 0; i < cache_sizes.size(); i++) {
-    mrc_ofs << mrc[i].cache_size << "," << mrc[i].n_miss << ","
-            << mrc[i].n_miss_byte << std::endl;
+  mrc_ofs << "# cache size, miss_cnt, miss_byte, writeback_cnt, "
+             "back_invalidation_cnt"
+          << std::endl;
+  for (size_t i = 0; i < l2_sizes.size(); i++) {
+    mrc_ofs << mrc[i].stat.cache_size << "," << mrc[i].stat.n_miss << ","
+            << mrc[i].stat.n_miss_byte << "," << mrc[i].n_writeback << ","
+            << mrc[i].n_back_invalidation << std::endl;
   }
-
   mrc_ofs.close();
+
+  free(mrc);
+  l2_cache->cache_free(l2_cache);
+  for (int i = 0; i < n_l1; i++) {
+    l1_caches[i]->cache_free(l1_caches[i]);
+    close_reader(readers[i]);
+  }
 }
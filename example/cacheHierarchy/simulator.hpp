@@ -17,12 +17,13 @@ using namespace std;
 
 class Simulator {
  public:
-  /* return obj miss ratio */
-  static double gen_miss_trace(string algo, uint64_t cache_size,
-                               string trace_path, string miss_output_path);
-
-  static void output_mrc(string &algo, std::vector<uint64_t> cache_sizes,
-                         string &trace_path, string &mrc_output_path);
+  /* simulate the L1 caches and all L2 sizes in one pass, the L1 misses are
+   * streamed to the L2 caches in memory, and write the L2 miss ratio curve */
+  static void simulate_hierarchy(string &algo, vector<string> &l1_trace_path,
+                                 vector<uint64_t> &l1_sizes,
+                                 vector<uint64_t> &l2_sizes, string &policy,
+                                 bool track_writeback,
+                                 string &mrc_output_path);
 };
 
 #endif  // libCacheSim_CACHESIMULATOR_H
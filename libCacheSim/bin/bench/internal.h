@@ -0,0 +1,83 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "../../include/libCacheSim/reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* a request of a synthetic workload, kept compact so that the whole trace
+ * fits in memory and generating requests does not show up in the results */
+typedef struct {
+  obj_id_t obj_id;
+  uint32_t obj_size;
+  uint32_t clock_time;
+  int64_t next_access_vtime;
+} bench_req_t;
+
+typedef struct {
+  const char *name;
+  /* the Zipf skewness of the popular objects */
+  double alpha;
+  /* the fraction of requests that are sequential scans of new objects */
+  double scan_ratio;
+  /* whether object sizes follow a lognormal distribution, otherwise 4 KiB */
+  bool var_size;
+} workload_spec_t;
+
+typedef struct {
+  const workload_spec_t *spec;
+  bench_req_t *reqs;
+  int64_t n_req;
+  int64_t n_obj;
+  /* the total size of all objects in the workload */
+  int64_t working_set_byte;
+} workload_t;
+
+typedef struct {
+  int64_t n_alloc;
+  int64_t alloc_byte;
+  int64_t rss_byte;
+} mem_stat_t;
+
+/* one line of the JSON report */
+typedef struct {
+  const char *suite;
+  const char *name;
+  const char *workload;
+  int64_t cache_size;
+  int64_t n_op;
+  double miss_ratio;
+  double elapsed_sec;
+  mem_stat_t mem_before;
+  mem_stat_t mem_after;
+} bench_result_t;
+
+/* workload.c */
+extern const workload_spec_t workload_specs[];
+extern const int n_workload_specs;
+
+workload_t *generate_workload(const workload_spec_t *spec, int64_t n_req,
+                              int64_t n_obj, uint64_t seed);
+
+void free_workload(workload_t *workload);
+
+/* write the workload to a trace file in the given format,
+ * format is one of csv, bin, oracleGeneral, lcs and zstd */
+bool write_workload_trace(const workload_t *workload, const char *format,
+                          const char *path);
+
+/* measure.c */
+double bench_now_sec(void);
+
+mem_stat_t get_mem_stat(void);
+
+int64_t get_peak_rss_byte(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,453 @@
+//
+// a benchmark for the eviction algorithms, the hash tables and the trace
+// readers, it generates synthetic workloads in memory, runs each component
+// on them and reports the throughput, the latency per operation, the memory
+// usage and the number of allocations in JSON
+//
+// usage: bench [-s all|algo|hashtable|reader] [-n n_req] [-m n_obj]
+//              [-a lru,fifo,...] [-r cache_size_ratio] [-o bench.json]
+//
+// bench/main.c
+// libCacheSim
+//
+
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../dataStructure/hashtable/chainedHashTable.h"
+#include "../../dataStructure/hashtable/chainedHashTableV2.h"
+#include "../../dataStructure/hashtable/concurrentHashTable.h"
+#include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/reader.h"
+#include "../../utils/include/mymath.h"
+#include "../cachesim/cache_init.h"
+#include "internal.h"
+
+#define BENCH_SEED 42
+#define MAX_N_ALGO 64
+
+static const char *default_algos[] = {
+    "lru",        "fifo",        "arc",          "lhd",        "random",
+    "lfu",        "gdsf",        "lfuda",        "twoq",       "slru",
+    "hyperbolic", "lecar",       "cacheus",      "size",       "lfucpp",
+    "wtinyLFU",   "clock",       "lirs",         "fifomerge",  "sfifo",
+    "s3fifo",     "qdlp",        "sieve",        "lru-prob",   "s3lru",
+    "belady",     "beladySize",  "fifo-belady",  "lru-belady", "sieve-belady",
+#ifdef ENABLE_GLCACHE
+    "GLCache",
+#endif
+#ifdef ENABLE_LRB
+    "lrb",
+#endif
+};
+
+struct bench_args {
+  bool run_algo;
+  bool run_hashtable;
+  bool run_reader;
+  int64_t n_req;
+  int64_t n_obj;
+  double cache_size_ratio;
+  const char *algos[MAX_N_ALGO];
+  int n_algo;
+  char *algo_str;
+  const char *ofilepath;
+};
+
+static void print_usage(const char *prog) {
+  printf(
+      "usage: %s [options]\n"
+      "  -s suite       all, algo, hashtable or reader, default all\n"
+      "  -n n_req       the number of requests per workload, default 2000000\n"
+      "  -m n_obj       the number of popular objects, default 100000\n"
+      "  -a algos       comma separated eviction algorithms, default all\n"
+      "  -r ratio       cache size as a fraction of the working set size, "
+      "default 0.1\n"
+      "  -o path        the output JSON file, default bench.json\n",
+      prog);
+}
+
+static void parse_args(int argc, char **argv, struct bench_args *args) {
+  memset(args, 0, sizeof(struct bench_args));
+  args->run_algo = args->run_hashtable = args->run_reader = true;
+  args->n_req = 2000000;
+  args->n_obj = 100000;
+  args->cache_size_ratio = 0.1;
+  args->ofilepath = "bench.json";
+
+  int opt;
+  while ((opt = getopt(argc, argv, "s:n:m:a:r:o:h")) != -1) {
+    switch (opt) {
+      case 's':
+        args->run_algo = strcmp(optarg, "all") == 0 ||
+                         strcmp(optarg, "algo") == 0;
+        args->run_hashtable = strcmp(optarg, "all") == 0 ||
+                              strcmp(optarg, "hashtable") == 0;
+        args->run_reader = strcmp(optarg, "all") == 0 ||
+                           strcmp(optarg, "reader") == 0;
+        if (!args->run_algo && !args->run_hashtable && !args->run_reader) {
+          ERROR("unknown suite %s\n", optarg);
+        }
+        break;
+      case 'n':
+        args->n_req = strtoll(optarg, NULL, 10);
+        break;
+      case 'm':
+        args->n_obj = strtoll(optarg, NULL, 10);
+        break;
+      case 'a':
+        args->algo_str = strdup(optarg);
+        break;
+      case 'r':
+        args->cache_size_ratio = strtod(optarg, NULL);
+        break;
+      case 'o':
+        args->ofilepath = optarg;
+        break;
+      case 'h':
+        print_usage(argv[0]);
+        exit(0);
+      default:
+        print_usage(argv[0]);
+        exit(1);
+    }
+  }
+
+  if (args->n_req <= 0 || args->n_obj <= 0) {
+    ERROR("n_req and n_obj must be positive\n");
+  }
+  if (args->cache_size_ratio <= 0 || args->cache_size_ratio > 1) {
+    ERROR("cache size ratio must be in (0, 1]\n");
+  }
+
+  if (args->algo_str != NULL) {
+    char *saveptr = NULL;
+    char *algo = strtok_r(args->algo_str, ",", &saveptr);
+    while (algo != NULL) {
+      if (args->n_algo >= MAX_N_ALGO) {
+        ERROR("too many algorithms, at most %d\n", MAX_N_ALGO);
+      }
+      args->algos[args->n_algo++] = algo;
+      algo = strtok_r(NULL, ",", &saveptr);
+    }
+  } else {
+    args->n_algo = sizeof(default_algos) / sizeof(default_algos[0]);
+    for (int i = 0; i < args->n_algo; i++) {
+      args->algos[i] = default_algos[i];
+    }
+  }
+}
+
+static void set_req(request_t *req, const bench_req_t *bench_req) {
+  req->clock_time = bench_req->clock_time;
+  req->obj_id = bench_req->obj_id;
+  req->obj_size = bench_req->obj_size;
+  req->next_access_vtime = bench_req->next_access_vtime;
+  req->valid = true;
+}
+
+static void report_result(FILE *ofile, const bench_result_t *result,
+                          bool first) {
+  double ns_per_op = result->elapsed_sec * 1e9 / (double)result->n_op;
+  double mqps = (double)result->n_op / result->elapsed_sec / 1e6;
+  int64_t n_alloc = result->mem_after.n_alloc - result->mem_before.n_alloc;
+  int64_t alloc_byte =
+      result->mem_after.alloc_byte - result->mem_before.alloc_byte;
+  int64_t rss_growth =
+      result->mem_after.rss_byte - result->mem_before.rss_byte;
+
+  printf("%-9s %-14s %-13s %8.2f MQPS %8.1f ns/op miss ratio %.4f\n",
+         result->suite, result->name, result->workload, mqps, ns_per_op,
+         result->miss_ratio);
+
+  fprintf(ofile,
+          "%s\n    {\"suite\": \"%s\", \"name\": \"%s\", \"workload\": \"%s\", "
+          "\"cache_size\": %ld, \"n_op\": %ld, \"miss_ratio\": %.6f, "
+          "\"throughput_mqps\": %.4f, \"ns_per_op\": %.2f, "
+          "\"rss_growth_byte\": %ld, \"peak_rss_byte\": %ld, "
+          "\"n_alloc\": %ld, \"alloc_byte\": %ld}",
+          first ? "" : ",", result->suite, result->name, result->workload,
+          (long)result->cache_size, (long)result->n_op, result->miss_ratio,
+          mqps, ns_per_op, (long)rss_growth, (long)get_peak_rss_byte(),
+          (long)n_alloc, (long)alloc_byte);
+  fflush(ofile);
+}
+
+/* replay the workload on one eviction algorithm */
+static bench_result_t bench_algo(const workload_t *workload, const char *algo,
+                                 int64_t cache_size) {
+  bench_result_t result = {.suite = "algo",
+                           .name = algo,
+                           .workload = workload->spec->name,
+                           .cache_size = cache_size,
+                           .n_op = workload->n_req};
+
+  set_rand_seed(BENCH_SEED);
+  request_t *req = new_request();
+  result.mem_before = get_mem_stat();
+  /* the oracle algorithms check the trace name */
+  cache_t *cache =
+      create_cache("synthetic.oracleGeneral", algo, cache_size, NULL, false);
+
+  int64_t n_miss = 0;
+  double start = bench_now_sec();
+  for (int64_t i = 0; i < workload->n_req; i++) {
+    set_req(req, &workload->reqs[i]);
+    if (!cache->get(cache, req)) n_miss += 1;
+  }
+  result.elapsed_sec = bench_now_sec() - start;
+  result.mem_after = get_mem_stat();
+  result.miss_ratio = (double)n_miss / (double)workload->n_req;
+
+  cache->cache_free(cache);
+  free_request(req);
+
+  return result;
+}
+
+/* find the object and insert it on a miss, as a cache does on every request,
+ * the growing variant starts from a small table and pays for the expansion */
+static bench_result_t bench_chained_hashtable(const workload_t *workload,
+                                              const char *name, bool v2,
+                                              uint16_t hashpower) {
+  bench_result_t result = {.suite = "hashtable",
+                           .name = name,
+                           .workload = workload->spec->name,
+                           .n_op = workload->n_req};
+
+  request_t *req = new_request();
+  result.mem_before = get_mem_stat();
+  hashtable_t *hashtable = v2 ? create_chained_hashtable_v2(hashpower)
+                              : create_chained_hashtable(hashpower);
+
+  int64_t n_insert = 0;
+  double start = bench_now_sec();
+  for (int64_t i = 0; i < workload->n_req; i++) {
+    set_req(req, &workload->reqs[i]);
+    cache_obj_t *obj =
+        v2 ? chained_hashtable_find_v2(hashtable, req)
+           : chained_hashtable_find(hashtable, req->obj_id);
+    if (obj == NULL) {
+      if (v2) {
+        chained_hashtable_insert_v2(hashtable, req);
+      } else {
+        chained_hashtable_insert(hashtable, req);
+      }
+      n_insert += 1;
+    }
+  }
+  result.elapsed_sec = bench_now_sec() - start;
+  result.mem_after = get_mem_stat();
+  result.miss_ratio = (double)n_insert / (double)workload->n_req;
+
+  if (v2) {
+    free_chained_hashtable_v2(hashtable);
+  } else {
+    free_chained_hashtable(hashtable);
+  }
+  free_request(req);
+
+  return result;
+}
+
+static bench_result_t bench_concurrent_hashtable(const workload_t *workload,
+                                                 uint16_t hashpower) {
+  bench_result_t result = {.suite = "hashtable",
+                           .name = "concurrent",
+                           .workload = workload->spec->name,
+                           .n_op = workload->n_req};
+
+  result.mem_before = get_mem_stat();
+  concurrent_hashtable_t *hashtable =
+      create_concurrent_hashtable(hashpower, 10);
+
+  int64_t n_insert = 0;
+  double start = bench_now_sec();
+  for (int64_t i = 0; i < workload->n_req; i++) {
+    const bench_req_t *bench_req = &workload->reqs[i];
+    uint64_t hv = concurrent_hashtable_hv(bench_req->obj_id);
+    concurrent_hashtable_lock(hashtable, hv);
+    concurrent_obj_t *obj =
+        concurrent_hashtable_find_locked(hashtable, hv, bench_req->obj_id);
+    if (obj == NULL) {
+      obj = my_malloc(concurrent_obj_t);
+      memset(obj, 0, sizeof(concurrent_obj_t));
+      obj->obj_id = bench_req->obj_id;
+      obj->obj_size = bench_req->obj_size;
+      concurrent_hashtable_insert_locked(hashtable, hv, obj);
+      n_insert += 1;
+    }
+    concurrent_hashtable_unlock(hashtable, hv);
+  }
+  result.elapsed_sec = bench_now_sec() - start;
+  result.mem_after = get_mem_stat();
+  result.miss_ratio = (double)n_insert / (double)workload->n_req;
+
+  free_concurrent_hashtable(hashtable);
+
+  return result;
+}
+
+/* the hashpower that fits all objects of the workload without expansion */
+static uint16_t presized_hashpower(const workload_t *workload) {
+  uint16_t hashpower = 10;
+  while ((1LL << hashpower) < workload->n_obj) hashpower++;
+  return hashpower;
+}
+
+/* write the workload in the given format and read it back */
+static bool bench_reader(const workload_t *workload, const char *dir,
+                         const char *format, bench_result_t *result) {
+  char path[1024];
+  trace_type_e trace_type;
+  reader_init_param_t init_params = default_reader_init_params();
+
+  if (strcmp(format, "csv") == 0) {
+    snprintf(path, sizeof(path), "%s/%s.csv", dir, workload->spec->name);
+    trace_type = CSV_TRACE;
+    init_params.time_field = 1;
+    init_params.obj_id_field = 2;
+    init_params.obj_size_field = 3;
+    init_params.has_header = false;
+    init_params.has_header_set = true;
+    init_params.delimiter = ',';
+    init_params.obj_id_is_num = true;
+  } else if (strcmp(format, "bin") == 0) {
+    snprintf(path, sizeof(path), "%s/%s.bin", dir, workload->spec->name);
+    trace_type = BIN_TRACE;
+    init_params.binary_fmt_str = "<IQI";
+    init_params.time_field = 1;
+    init_params.obj_id_field = 2;
+    init_params.obj_size_field = 3;
+  } else if (strcmp(format, "oracleGeneral") == 0) {
+    snprintf(path, sizeof(path), "%s/%s.oracleGeneral.bin", dir,
+             workload->spec->name);
+    trace_type = ORACLE_GENERAL_TRACE;
+  } else if (strcmp(format, "lcs") == 0) {
+    snprintf(path, sizeof(path), "%s/%s.lcs", dir, workload->spec->name);
+    trace_type = LCS_TRACE;
+  } else {
+    /* zstd */
+    snprintf(path, sizeof(path), "%s/%s.oracleGeneral.bin.zst", dir,
+             workload->spec->name);
+    trace_type = ORACLE_GENERAL_TRACE;
+  }
+
+  if (!write_workload_trace(workload, format, path)) {
+    WARN("cannot write %s trace %s\n", format, path);
+    unlink(path);
+    return false;
+  }
+
+  memset(result, 0, sizeof(bench_result_t));
+  result->suite = "reader";
+  result->name = format;
+  result->workload = workload->spec->name;
+
+  request_t *req = new_request();
+  result->mem_before = get_mem_stat();
+  double start = bench_now_sec();
+  reader_t *reader = setup_reader(path, trace_type, &init_params);
+  int64_t n_req = 0;
+  while (read_one_req(reader, req) == 0) {
+    n_req += 1;
+  }
+  result->elapsed_sec = bench_now_sec() - start;
+  result->mem_after = get_mem_stat();
+  result->n_op = n_req;
+
+  close_reader(reader);
+  free_request(req);
+  unlink(path);
+
+  if (n_req != workload->n_req) {
+    WARN("%s reader read %ld requests, expect %ld\n", format, (long)n_req,
+         (long)workload->n_req);
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv) {
+  struct bench_args args;
+  parse_args(argc, argv, &args);
+
+  FILE *ofile = fopen(args.ofilepath, "w");
+  if (ofile == NULL) {
+    ERROR("cannot open %s\n", args.ofilepath);
+  }
+  fprintf(ofile,
+          "{\"n_req\": %ld, \"n_obj\": %ld, \"cache_size_ratio\": %.4f, ",
+          (long)args.n_req, (long)args.n_obj, args.cache_size_ratio);
+  fprintf(ofile, "\"results\": [");
+
+  bool first = true;
+  bench_result_t result;
+  for (int w = 0; w < n_workload_specs; w++) {
+    workload_t *workload = generate_workload(&workload_specs[w], args.n_req,
+                                             args.n_obj, BENCH_SEED + w);
+    INFO("workload %s: %ld requests, %ld objects, working set %ld bytes\n",
+         workload->spec->name, (long)workload->n_req, (long)workload->n_obj,
+         (long)workload->working_set_byte);
+
+    if (args.run_algo) {
+      int64_t cache_size =
+          (int64_t)(workload->working_set_byte * args.cache_size_ratio);
+      for (int i = 0; i < args.n_algo; i++) {
+        result = bench_algo(workload, args.algos[i], cache_size);
+        report_result(ofile, &result, first);
+        first = false;
+      }
+    }
+
+    if (args.run_hashtable) {
+      uint16_t hashpower = presized_hashpower(workload);
+      result = bench_chained_hashtable(workload, "chainedV1-grow", false, 12);
+      report_result(ofile, &result, first);
+      first = false;
+      result = bench_chained_hashtable(workload, "chainedV1-presized", false,
+                                       hashpower);
+      report_result(ofile, &result, first);
+      result = bench_chained_hashtable(workload, "chainedV2-grow", true, 12);
+      report_result(ofile, &result, first);
+      result = bench_chained_hashtable(workload, "chainedV2-presized", true,
+                                       hashpower);
+      report_result(ofile, &result, first);
+      result = bench_concurrent_hashtable(workload, hashpower);
+      report_result(ofile, &result, first);
+    }
+
+    if (args.run_reader) {
+      char dir[] = "/tmp/libCacheSim_bench_XXXXXX";
+      if (mkdtemp(dir) == NULL) {
+        ERROR("cannot create a temporary directory\n");
+      }
+      const char *formats[] = {"csv", "bin", "oracleGeneral", "lcs",
+#ifdef SUPPORT_ZSTD_TRACE
+                               "zstd"
+#endif
+      };
+      for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        if (bench_reader(workload, dir, formats[i], &result)) {
+          report_result(ofile, &result, first);
+          first = false;
+        }
+      }
+      rmdir(dir);
+    }
+
+    free_workload(workload);
+  }
+
+  fprintf(ofile, "\n]}\n");
+  fclose(ofile);
+  INFO("results are written to %s\n", args.ofilepath);
+
+  free(args.algo_str);
+  return 0;
+}
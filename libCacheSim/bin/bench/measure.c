@@ -0,0 +1,104 @@
+//
+// time and memory measurement for the benchmark
+//
+// RSS is read from /proc/self/statm and the peak RSS from getrusage,
+// the number of allocations is counted by wrapping the malloc family with
+// the linker (-Wl,--wrap=malloc), which is only enabled on Linux,
+// on other platforms the allocation counters stay zero
+//
+// bench/measure.c
+// libCacheSim
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "internal.h"
+
+#ifdef BENCH_WRAP_MALLOC
+static int64_t n_alloc = 0;
+static int64_t alloc_byte = 0;
+
+static inline void count_alloc(size_t size) {
+  __atomic_add_fetch(&n_alloc, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&alloc_byte, (int64_t)size, __ATOMIC_RELAXED);
+}
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+int __real_posix_memalign(void **memptr, size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  count_alloc(size);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+  count_alloc(nmemb * size);
+  return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  count_alloc(size);
+  return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size) {
+  count_alloc(size);
+  return __real_aligned_alloc(alignment, size);
+}
+
+int __wrap_posix_memalign(void **memptr, size_t alignment, size_t size) {
+  count_alloc(size);
+  return __real_posix_memalign(memptr, alignment, size);
+}
+#endif
+
+double bench_now_sec(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static int64_t get_rss_byte(void) {
+#ifdef __linux__
+  FILE *ifile = fopen("/proc/self/statm", "r");
+  if (ifile == NULL) return 0;
+
+  long n_page_total = 0, n_page_resident = 0;
+  int n = fscanf(ifile, "%ld %ld", &n_page_total, &n_page_resident);
+  fclose(ifile);
+  if (n != 2) return 0;
+
+  return (int64_t)n_page_resident * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+mem_stat_t get_mem_stat(void) {
+  mem_stat_t stat = {.n_alloc = 0, .alloc_byte = 0, .rss_byte = 0};
+#ifdef BENCH_WRAP_MALLOC
+  stat.n_alloc = __atomic_load_n(&n_alloc, __ATOMIC_RELAXED);
+  stat.alloc_byte = __atomic_load_n(&alloc_byte, __ATOMIC_RELAXED);
+#endif
+  stat.rss_byte = get_rss_byte();
+  return stat;
+}
+
+int64_t get_peak_rss_byte(void) {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+  /* bytes on macOS */
+  return (int64_t)usage.ru_maxrss;
+#else
+  /* KiB on Linux */
+  return (int64_t)usage.ru_maxrss * 1024;
+#endif
+}
@@ -0,0 +1,199 @@
+//
+// synthetic workloads for the benchmark, generated with the SYNTHETIC trace
+// reader and kept in memory with a fixed seed so that every run measures the
+// same requests
+//
+// the popular objects follow a Zipf distribution, a workload can mix in
+// sequential scans of objects that are requested once, and object sizes are
+// either fixed or lognormal
+//
+// bench/workload.c
+// libCacheSim
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/libCacheSim/const.h"
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
+#include "../../include/libCacheSim/request.h"
+#include "../../traceReader/generalReader/lcs.h"
+#include "internal.h"
+
+#ifdef SUPPORT_ZSTD_TRACE
+#include <zstd.h>
+#endif
+
+#define FIXED_OBJ_SIZE 4096
+#define SCAN_LEN 1000
+/* the number of requests per second in the generated clock time */
+#define REQ_PER_SEC 1000
+
+const workload_spec_t workload_specs[] = {
+    {.name = "zipf", .alpha = 1.0, .scan_ratio = 0, .var_size = false},
+    {.name = "zipf-scan", .alpha = 0.8, .scan_ratio = 0.2, .var_size = false},
+    {.name = "zipf-varsize", .alpha = 1.0, .scan_ratio = 0, .var_size = true},
+};
+const int n_workload_specs =
+    sizeof(workload_specs) / sizeof(workload_specs[0]);
+
+workload_t *generate_workload(const workload_spec_t *spec, int64_t n_req,
+                              int64_t n_obj, uint64_t seed) {
+  workload_t *workload = malloc(sizeof(workload_t));
+  ASSERT_NOT_NULL(workload, "cannot allocate workload\n");
+  workload->spec = spec;
+  workload->n_req = n_req;
+  workload->reqs = malloc(sizeof(bench_req_t) * n_req);
+  ASSERT_NOT_NULL(workload->reqs, "cannot allocate %ld requests\n",
+                  (long)n_req);
+
+  /* lognormal sizes have a median of 4 KiB and are capped to
+   * [64 B, 4 MiB], see synthetic.c */
+  char synthetic_spec[256];
+  snprintf(synthetic_spec, sizeof(synthetic_spec),
+           "n-req=%ld,n-obj=%ld,alpha=%lf,scan-ratio=%lf,scan-len=%d,"
+           "size-dist=%s,obj-size=%d,req-rate=%d,seed=%lu",
+           (long)n_req, (long)n_obj, spec->alpha, spec->scan_ratio, SCAN_LEN,
+           spec->var_size ? "lognormal" : "fixed", FIXED_OBJ_SIZE,
+           REQ_PER_SEC, (unsigned long)seed);
+  reader_t *reader = open_trace(synthetic_spec, SYNTHETIC_TRACE, NULL);
+
+  request_t *req = new_request();
+  obj_id_t max_obj_id = 0;
+  for (int64_t i = 0; i < n_req; i++) {
+    if (read_one_req(reader, req) != 0) {
+      ERROR("synthetic reader ends after %ld requests\n", (long)i);
+    }
+    workload->reqs[i].obj_id = req->obj_id;
+    workload->reqs[i].obj_size = (uint32_t)req->obj_size;
+    workload->reqs[i].clock_time = (uint32_t)req->clock_time;
+    max_obj_id = MAX(max_obj_id, req->obj_id);
+  }
+  free_request(req);
+  close_reader(reader);
+
+  /* fill in the next access vtime so that the oracle algorithms can run,
+   * and compute the working set size, obj ids start from 1 */
+  int64_t *next_access = malloc(sizeof(int64_t) * (max_obj_id + 1));
+  ASSERT_NOT_NULL(next_access, "cannot allocate next access array\n");
+  for (obj_id_t i = 0; i <= max_obj_id; i++) next_access[i] = -1;
+
+  workload->n_obj = 0;
+  workload->working_set_byte = 0;
+  for (int64_t i = n_req - 1; i >= 0; i--) {
+    obj_id_t obj_id = workload->reqs[i].obj_id;
+    if (next_access[obj_id] == -1) {
+      workload->n_obj += 1;
+      workload->working_set_byte += workload->reqs[i].obj_size;
+      workload->reqs[i].next_access_vtime = INT64_MAX;
+    } else {
+      workload->reqs[i].next_access_vtime = next_access[obj_id];
+    }
+    next_access[obj_id] = i;
+  }
+
+  free(next_access);
+
+  return workload;
+}
+
+void free_workload(workload_t *workload) {
+  free(workload->reqs);
+  free(workload);
+}
+
+/* oracleGeneral: uint32 time, uint64 id, uint32 size, int64 next vtime */
+typedef struct __attribute__((packed)) {
+  uint32_t clock_time;
+  uint64_t obj_id;
+  uint32_t obj_size;
+  int64_t next_access_vtime;
+} og_req_t;
+
+static og_req_t *to_og_reqs(const workload_t *workload) {
+  og_req_t *og_reqs = malloc(sizeof(og_req_t) * workload->n_req);
+  ASSERT_NOT_NULL(og_reqs, "cannot allocate trace buffer\n");
+  for (int64_t i = 0; i < workload->n_req; i++) {
+    const bench_req_t *req = &workload->reqs[i];
+    og_reqs[i].clock_time = req->clock_time;
+    og_reqs[i].obj_id = req->obj_id;
+    og_reqs[i].obj_size = req->obj_size;
+    og_reqs[i].next_access_vtime =
+        req->next_access_vtime == INT64_MAX ? -1 : req->next_access_vtime;
+  }
+  return og_reqs;
+}
+
+static bool write_all(FILE *ofile, const void *buf, size_t size) {
+  return fwrite(buf, 1, size, ofile) == size;
+}
+
+bool write_workload_trace(const workload_t *workload, const char *format,
+                          const char *path) {
+  FILE *ofile = fopen(path, "wb");
+  if (ofile == NULL) {
+    WARN("cannot open %s\n", path);
+    return false;
+  }
+
+  bool ok = true;
+  if (strcmp(format, "csv") == 0) {
+    for (int64_t i = 0; i < workload->n_req && ok; i++) {
+      const bench_req_t *req = &workload->reqs[i];
+      ok = fprintf(ofile, "%u,%lu,%u\n", req->clock_time,
+                   (unsigned long)req->obj_id, req->obj_size) > 0;
+    }
+  } else if (strcmp(format, "bin") == 0) {
+    /* read with the format string <IQI */
+    for (int64_t i = 0; i < workload->n_req && ok; i++) {
+      const bench_req_t *req = &workload->reqs[i];
+      uint64_t obj_id = req->obj_id;
+      ok = write_all(ofile, &req->clock_time, sizeof(uint32_t)) &&
+           write_all(ofile, &obj_id, sizeof(uint64_t)) &&
+           write_all(ofile, &req->obj_size, sizeof(uint32_t));
+    }
+  } else if (strcmp(format, "oracleGeneral") == 0 ||
+             strcmp(format, "lcs") == 0) {
+    if (strcmp(format, "lcs") == 0) {
+      lcs_trace_header_t header;
+      memset(&header, 0, sizeof(header));
+      header.start_magic = LCS_TRACE_START_MAGIC;
+      header.end_magic = LCS_TRACE_END_MAGIC;
+      header.n_req = workload->n_req;
+      header.n_obj = workload->n_obj;
+      header.time_field = 1;
+      header.obj_id_field = 2;
+      header.obj_size_field = 3;
+      header.next_access_vtime_field = 4;
+      header.item_size = sizeof(og_req_t);
+      header.n_fields = 4;
+      memcpy(header.format, "<IQIq", 5);
+      ok = write_all(ofile, &header, sizeof(header));
+    }
+    og_req_t *og_reqs = to_og_reqs(workload);
+    ok = ok && write_all(ofile, og_reqs, sizeof(og_req_t) * workload->n_req);
+    free(og_reqs);
+  } else if (strcmp(format, "zstd") == 0) {
+#ifdef SUPPORT_ZSTD_TRACE
+    /* a zstd compressed oracleGeneral trace */
+    og_req_t *og_reqs = to_og_reqs(workload);
+    size_t src_size = sizeof(og_req_t) * workload->n_req;
+    size_t dst_cap = ZSTD_compressBound(src_size);
+    void *dst = malloc(dst_cap);
+    ASSERT_NOT_NULL(dst, "cannot allocate compression buffer\n");
+    size_t dst_size = ZSTD_compress(dst, dst_cap, og_reqs, src_size, 3);
+    ok = !ZSTD_isError(dst_size) && write_all(ofile, dst, dst_size);
+    free(dst);
+    free(og_reqs);
+#else
+    ok = false;
+#endif
+  } else {
+    WARN("unknown trace format %s\n", format);
+    ok = false;
+  }
+
+  fclose(ofile);
+  return ok;
+}
@@ -138,6 +138,8 @@ static inline cache_t *create_cache(const char *trace_path,
     cache = QDLP_init(cc_params, eviction_params);
   } else if (strcasecmp(eviction_algo, "sieve") == 0) {
     cache = Sieve_init(cc_params, eviction_params);
+  } else if (strcasecmp(eviction_algo, "partition") == 0) {
+    cache = Partition_init(cc_params, eviction_params);
 #ifdef ENABLE_GLCACHE
   } else if (strcasecmp(eviction_algo, "GLCache") == 0 ||
              strcasecmp(eviction_algo, "gl-cache") == 0) {
@@ -168,6 +170,10 @@ static inline cache_t *create_cache(const char *trace_path,
     abort();
   }
 
+  /* the caches here are not used inside other algorithms, so the objects
+   * only need the metadata of their own algorithm */
+  cache_use_compact_obj(cache);
+
   return cache;
 }
 
@@ -47,6 +47,8 @@ enum argp_option_short {
 
   OPTION_PREFETCH_ALGO = 'p',
   OPTION_PREFETCH_PARAMS = 0x109,
+  OPTION_NUM_SHARD = 0x10a,
+  OPTION_SIM_OUTPUT = 0x10b,
 };
 
 /*
@@ -88,8 +90,16 @@ static struct argp_option options[] = {
     {"report-interval", OPTION_REPORT_INTERVAL, "3600", 0,
      "how often to report stat when running one cache", 10},
     {"warmup-sec", OPTION_WARMUP_SEC, "0", 0, "warm up time in seconds", 10},
-    {"use-ttl", OPTION_USE_TTL, "false", 0, "specify to use ttl from the trace",
+    {"num-shard", OPTION_NUM_SHARD, "0", 0,
+     "split the trace into shards simulated in parallel when running one "
+     "cache, the result is approximate",
      10},
+    {"sim-output", OPTION_SIM_OUTPUT, "path", 0,
+     "write the per-request hit bitmap and the admission and eviction events "
+     "to path.hit and path.event when running one cache",
+     10},
+    {"use-ttl", OPTION_USE_TTL, "false", 0,
+     "remove objects when their ttl expires", 10},
     {"consider-obj-metadata", OPTION_CONSIDER_OBJ_METADATA, "false", 0,
      "Whether consider per object metadata size in the simulated cache", 10},
     {"verbose", OPTION_VERBOSE, "1", 0, "Produce verbose output", 10},
@@ -164,6 +174,12 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_WARMUP_SEC:
       arguments->warmup_sec = atoi(arg);
       break;
+    case OPTION_NUM_SHARD:
+      arguments->n_shard = atoi(arg);
+      break;
+    case OPTION_SIM_OUTPUT:
+      arguments->sim_output_path = arg;
+      break;
     case ARGP_KEY_ARG:
       if (state->arg_num >= N_ARGS) {
         printf("found too many arguments, current %s\n", arg);
@@ -197,7 +213,12 @@ static char doc[] =
     "example: ./cachesim /trace/path csv LRU 100MB\n\n"
     "trace can be zstd compressed\n"
     "cache_size is in byte, but also support KB/MB/GB\n"
-    "supported trace_type: txt/csv/twr/vscsi/oracleGeneralBin\n"
+    "supported trace_type: txt/csv/twr/vscsi/oracleGeneralBin/synthetic/multi\n"
+    "a synthetic trace uses the workload spec as trace_path, "
+    "e.g., n-req=1000000,n-obj=100000,alpha=0.8\n"
+    "a multi trace uses comma-separated paths or glob patterns as trace_path, "
+    "see multi-type/multi-merge/multi-tag/multi-readahead in "
+    "--trace-type-params\n"
     "supported eviction_algo: LRU/LFU/FIFO/ARC/LeCaR/Cacheus\n";
 
 /**
@@ -226,6 +247,8 @@ static void init_arg(struct arguments *args) {
   memset(args->ofilepath, 0, OFILEPATH_LEN);
   args->n_req = -1;
   args->sample_ratio = 1.0;
+  args->n_shard = 0;
+  args->sim_output_path = NULL;
 
   for (int i = 0; i < N_MAX_ALGO; i++) {
     args->eviction_algo[i] = NULL;
@@ -300,6 +323,11 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
   reader_init_params.sampler = NULL;
 
   parse_reader_params(args->trace_type_params, &reader_init_params);
+  if (args->trace_type == MULTI_TRACE &&
+      reader_init_params.multi_trace_type == UNKNOWN_TRACE) {
+    /* the traces have the same type, which is detected from the path */
+    reader_init_params.multi_trace_type = detect_trace_type(args->trace_path);
+  }
 
   if (args->sample_ratio > 0 && args->sample_ratio < 1 - 1e-6) {
     sampler_t *sampler = create_spatial_sampler(args->sample_ratio);
@@ -345,6 +373,10 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
         args->caches[idx]->prefetcher = create_prefetcher(
             args->prefetch_algo, args->prefetch_params, args->cache_sizes[j]);
       }
+
+      if (args->use_ttl) {
+        cache_enable_ttl_wheel(args->caches[idx]);
+      }
     }
   }
 
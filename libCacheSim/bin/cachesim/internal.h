@@ -40,6 +40,9 @@ struct arguments {
   double sample_ratio;
   int n_thread;
   int64_t n_req; /* number of requests to process */
+  int n_shard;   /* number of shards in sharded simulation, 0 to disable */
+  /* the path prefix of the per-request output, NULL to disable */
+  char *sim_output_path;
 
   bool verbose;
   int report_interval;
@@ -57,7 +60,7 @@ void parse_cmd(int argc, char *argv[], struct arguments *args);
 void free_arg(struct arguments *args);
 
 void simulate(reader_t *reader, cache_t *cache, int report_interval,
-              int warmup_sec, char *ofilepath);
+              int warmup_sec, char *ofilepath, const char *sim_output_path);
 
 void print_parsed_args(struct arguments *args);
 
@@ -20,9 +20,32 @@ int main(int argc, char **argv) {
     ERROR("no cache size found\n");
   }
 
+  if (args.n_cache_size * args.n_eviction_algo == 1 && args.n_shard > 1) {
+    sharded_sim_params_t params = default_sharded_sim_params();
+    params.n_shard = args.n_shard;
+    params.num_of_threads = args.n_thread;
+    sharded_sim_result_t *res =
+        simulate_sharded(args.reader, args.caches[0], &params);
+    if (res != NULL) {
+      printf(
+          "%s %s cache size %ld, %lld req, %d shards, miss ratio %.4lf, byte "
+          "miss ratio %.4lf, sampled miss ratio %.4lf (serial %.4lf)\n",
+          args.trace_path, res->stat.cache_name, (long)res->stat.cache_size,
+          (long long)res->stat.n_req, res->n_shard,
+          (double)res->stat.n_miss / (double)res->stat.n_req,
+          (double)res->stat.n_miss_byte / (double)res->stat.n_req_byte,
+          res->sampled_sharded_miss_ratio, res->sampled_exact_miss_ratio);
+      free_sharded_sim_result(res);
+    }
+
+    args.caches[0]->cache_free(args.caches[0]);
+    free_arg(&args);
+    return 0;
+  }
+
   if (args.n_cache_size * args.n_eviction_algo == 1) {
     simulate(args.reader, args.caches[0], args.report_interval, args.warmup_sec,
-             args.ofilepath);
+             args.ofilepath, args.sim_output_path);
 
     free_arg(&args);
     return 0;
@@ -69,6 +92,16 @@ int main(int argc, char **argv) {
              (double)result[i].n_miss_byte / (double)result[i].n_req_byte);
     printf("%s", output_str);
     fprintf(output_file, "%s", output_str);
+#ifdef ENABLE_PERF_STAT
+    print_perf_stat(stdout, result[i].cache_name, &result[i].perf_stat);
+#endif
+#ifdef SUPPORT_TTL
+    if (args.use_ttl) {
+      printf("%s %32s expired %lld objects, %lld bytes\n", output_filename,
+             result[i].cache_name, (long long)result[i].expired_obj_cnt,
+             (long long)result[i].expired_bytes);
+    }
+#endif
   }
   fclose(output_file);
 
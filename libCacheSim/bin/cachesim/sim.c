@@ -1,7 +1,9 @@
 
 
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/evictionAlgo/Partition.h"
 #include "../../include/libCacheSim/reader.h"
+#include "../../include/libCacheSim/simOutput.h"
 #include "../../utils/include/mymath.h"
 #include "../../utils/include/mystr.h"
 #include "../../utils/include/mysys.h"
@@ -11,7 +13,7 @@ extern "C" {
 #endif
 
 void simulate(reader_t *reader, cache_t *cache, int report_interval,
-              int warmup_sec, char *ofilepath) {
+              int warmup_sec, char *ofilepath, const char *sim_output_path) {
   /* random seed */
   srand(time(NULL));
   set_rand_seed(rand());
@@ -21,6 +23,17 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval,
   uint64_t last_req_cnt = 0, last_miss_cnt = 0;
   uint64_t req_byte = 0, miss_byte = 0;
 
+  /* the output includes the warmup requests so that it is indexed by the
+   * request number in the trace */
+  sim_output_t *sim_output = NULL;
+  if (sim_output_path != NULL) {
+    sim_output = open_sim_output(sim_output_path, cache);
+    if (sim_output == NULL) {
+      ERROR("cannot create simulation output %s\n", sim_output_path);
+      exit(1);
+    }
+  }
+
   read_one_req(reader, req);
   uint64_t start_ts = (uint64_t)req->clock_time;
   uint64_t last_report_ts = warmup_sec;
@@ -29,18 +42,22 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval,
   while (req->valid) {
     req->clock_time -= start_ts;
     if (req->clock_time <= warmup_sec) {
-      cache->get(cache, req);
+      bool hit = cache->get(cache, req);
+      if (sim_output != NULL) sim_output_record(sim_output, hit);
       read_one_req(reader, req);
       continue;
     } else {
       if (start_time < 0) {
         start_time = gettime();
+        if (is_partition_cache(cache)) Partition_reset_stat(cache);
       }
     }
 
     req_cnt++;
     req_byte += req->obj_size;
-    if (cache->get(cache, req) == false) {
+    bool hit = cache->get(cache, req);
+    if (sim_output != NULL) sim_output_record(sim_output, hit);
+    if (hit == false) {
       miss_cnt++;
       miss_byte += req->obj_size;
     }
@@ -64,6 +81,10 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval,
 
   double runtime = gettime() - start_time;
 
+  if (sim_output != NULL && !close_sim_output(sim_output)) {
+    WARN("failed to write simulation output %s\n", sim_output_path);
+  }
+
   char output_str[1024];
   char size_str[8];
   convert_size_to_str(cache->cache_size, size_str);
@@ -79,6 +100,20 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval,
 #pragma GCC diagnostic pop
   printf("%s", output_str);
 
+  if (is_partition_cache(cache)) {
+    for (int i = 0; i < Partition_get_n_partition(cache); i++) {
+      cache_stat_t stat;
+      Partition_get_stat(cache, i, &stat);
+      convert_size_to_str(stat.cache_size, size_str);
+      printf("%s %s cache size %8s, %16lu req, miss ratio %.4lf, byte miss "
+             "ratio %.4lf\n",
+             reader->trace_path, stat.cache_name, size_str,
+             (unsigned long)stat.n_req,
+             (double)stat.n_miss / (double)stat.n_req,
+             (double)stat.n_miss_byte / (double)stat.n_req_byte);
+    }
+  }
+
   FILE *output_file = fopen(ofilepath, "a");
   if (output_file == NULL) {
     ERROR("cannot open file %s %s\n", ofilepath, strerror(errno));
@@ -87,6 +122,12 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval,
   fprintf(output_file, "%s\n", output_str);
   fclose(output_file);
 
+#ifdef ENABLE_PERF_STAT
+  perf_stat_t perf_stat;
+  cache_get_perf_stat(cache, &perf_stat);
+  print_perf_stat(stdout, cache->cache_name, &perf_stat);
+#endif
+
 #if defined(TRACK_EVICTION_V_AGE)
   while (cache->get_occupied_byte(cache) > 0) {
     cache->evict(cache, req);
@@ -61,6 +61,10 @@ trace_type_e trace_type_str_to_enum(const char *trace_type_str,
     return ORACLE_SYS_TWRNS_TRACE;
   } else if (strcasecmp(trace_type_str, "valpinTrace") == 0) {
     return VALPIN_TRACE;
+  } else if (strcasecmp(trace_type_str, "synthetic") == 0) {
+    return SYNTHETIC_TRACE;
+  } else if (strcasecmp(trace_type_str, "multi") == 0) {
+    return MULTI_TRACE;
   } else {
     ERROR("unsupported trace type: %s\n", trace_type_str);
   }
@@ -90,6 +94,7 @@ void parse_reader_params(const char *reader_params_str,
                          reader_init_param_t *params) {
   params->delimiter = '\0';
   params->obj_id_is_num = false;
+  params->multi_trace_type = UNKNOWN_TRACE;
 
   if (reader_params_str == NULL) return;
   char *params_str = strdup(reader_params_str);
@@ -142,6 +147,25 @@ void parse_reader_params(const char *reader_params_str,
                strcasecmp(key, "has-header") == 0) {
       params->has_header = is_true(value);
       params->has_header_set = true;
+    } else if (strcasecmp(key, "index") == 0 ||
+               strcasecmp(key, "use-index") == 0) {
+      params->use_index = is_true(value);
+    } else if (strcasecmp(key, "multi-type") == 0) {
+      params->multi_trace_type = trace_type_str_to_enum(value, NULL);
+    } else if (strcasecmp(key, "multi-merge") == 0) {
+      params->multi_trace_merge = is_true(value);
+    } else if (strcasecmp(key, "multi-readahead") == 0) {
+      params->multi_trace_readahead = is_true(value);
+    } else if (strcasecmp(key, "multi-tag") == 0) {
+      if (strcasecmp(value, "none") == 0) {
+        params->multi_trace_tag = MULTI_TRACE_TAG_NONE;
+      } else if (strcasecmp(value, "tenant") == 0) {
+        params->multi_trace_tag = MULTI_TRACE_TAG_TENANT;
+      } else if (strcasecmp(value, "ns") == 0) {
+        params->multi_trace_tag = MULTI_TRACE_TAG_NS;
+      } else {
+        ERROR("unsupported multi-tag %s, expect none/tenant/ns\n", value);
+      }
     } else if (strcasecmp(key, "format") == 0) {
       params->binary_fmt_str = strdup(value);
     } else if (strcasecmp(key, "delimiter") == 0) {
@@ -309,6 +333,10 @@ reader_t *create_reader(const char *trace_type_str, const char *trace_path,
   reader_init_params.sampler = NULL;
 
   parse_reader_params(trace_type_params, &reader_init_params);
+  if (trace_type == MULTI_TRACE &&
+      reader_init_params.multi_trace_type == UNKNOWN_TRACE) {
+    reader_init_params.multi_trace_type = detect_trace_type(trace_path);
+  }
 
   if (sample_ratio > 0 && sample_ratio < 1 - 1e-6) {
     sampler_t *sampler = create_spatial_sampler(sample_ratio);
@@ -0,0 +1,226 @@
+//
+// measure the throughput of a concurrent cache shared by multiple threads
+//
+// the trace is loaded into memory and partitioned by object id, so that each
+// thread replays the requests of its own objects in trace order, all threads
+// share one cache, and the cache is re-created for each number of threads
+//
+// usage: concurrentSim trace_path trace_type algo cache_size n_threads
+//                      [cache_params] [trace_type_params]
+// example: concurrentSim ../data/cloudPhysicsIO.oracleGeneral.bin
+//                        oracleGeneral s3fifo 1gb 1,2,4,8
+//
+// concurrentSim/main.c
+// libCacheSim
+//
+
+#include <assert.h>
+#include <pthread.h>
+#include <strings.h>
+
+#include "../../dataStructure/hash/hash.h"
+#include "../../include/libCacheSim/concurrentCache.h"
+#include "../../include/libCacheSim/reader.h"
+#include "../../utils/include/mysys.h"
+#include "../cli_reader_utils.h"
+
+#define MAX_N_THREAD_CONFIG 64
+
+typedef struct {
+  obj_id_t obj_id;
+  int64_t obj_size;
+} bench_req_t;
+
+typedef struct {
+  bench_req_t *reqs;
+  int64_t n_req;
+  int64_t capacity;
+} bench_partition_t;
+
+typedef struct {
+  concurrent_cache_t *cache;
+  bench_partition_t *partitions;
+  int n_partition;
+  int thread_id;
+  int n_thread;
+
+  int64_t n_req;
+  int64_t n_miss;
+  int64_t n_req_byte;
+  int64_t n_miss_byte;
+} bench_thread_params_t;
+
+static uint64_t conv_size_str_to_byte(const char *size_str) {
+  char *end;
+  uint64_t size = strtoull(size_str, &end, 10);
+  if (strcasecmp(end, "kb") == 0 || strcasecmp(end, "k") == 0) {
+    size *= KiB;
+  } else if (strcasecmp(end, "mb") == 0 || strcasecmp(end, "m") == 0) {
+    size *= MiB;
+  } else if (strcasecmp(end, "gb") == 0 || strcasecmp(end, "g") == 0) {
+    size *= GiB;
+  } else if (strcasecmp(end, "tb") == 0 || strcasecmp(end, "t") == 0) {
+    size *= TiB;
+  } else if (end[0] != '\0') {
+    ERROR("cannot parse cache size %s\n", size_str);
+  }
+  return size;
+}
+
+/**
+ * @brief load the trace into n_partition in-memory partitions,
+ * an object always goes to the same partition
+ */
+static bench_partition_t *load_partitions(reader_t *reader, int n_partition,
+                                          int64_t *n_total_req) {
+  bench_partition_t *partitions =
+      (bench_partition_t *)calloc(n_partition, sizeof(bench_partition_t));
+  request_t *req = new_request();
+  *n_total_req = 0;
+
+  while (read_one_req(reader, req) == 0) {
+    int p = (int)(get_hash_value_int_64(&req->obj_id) % n_partition);
+    bench_partition_t *partition = &partitions[p];
+    if (partition->n_req == partition->capacity) {
+      partition->capacity =
+          partition->capacity == 0 ? 1024 * 1024 : partition->capacity * 2;
+      partition->reqs = (bench_req_t *)realloc(
+          partition->reqs, sizeof(bench_req_t) * partition->capacity);
+      ASSERT_NOT_NULL(partition->reqs, "cannot allocate %ld requests\n",
+                      (long)partition->capacity);
+    }
+    partition->reqs[partition->n_req].obj_id = req->obj_id;
+    partition->reqs[partition->n_req].obj_size = req->obj_size;
+    partition->n_req += 1;
+    *n_total_req += 1;
+  }
+
+  free_request(req);
+  return partitions;
+}
+
+static void *bench_thread(void *arg) {
+  bench_thread_params_t *params = (bench_thread_params_t *)arg;
+  concurrent_cache_t *cache = params->cache;
+  request_t *req = new_request();
+
+  /* thread i replays partition i, i + n_thread, ... */
+  for (int p = params->thread_id; p < params->n_partition;
+       p += params->n_thread) {
+    bench_partition_t *partition = &params->partitions[p];
+    for (int64_t i = 0; i < partition->n_req; i++) {
+      req->obj_id = partition->reqs[i].obj_id;
+      req->obj_size = partition->reqs[i].obj_size;
+      params->n_req += 1;
+      params->n_req_byte += req->obj_size;
+      if (!cache->get(cache, req)) {
+        params->n_miss += 1;
+        params->n_miss_byte += req->obj_size;
+      }
+    }
+  }
+
+  free_request(req);
+  return NULL;
+}
+
+static int parse_n_threads(char *n_thread_str, int *n_threads) {
+  int n = 0;
+  char *token = strtok(n_thread_str, ",");
+  while (token != NULL && n < MAX_N_THREAD_CONFIG) {
+    n_threads[n++] = (int)strtol(token, NULL, 10);
+    if (n_threads[n - 1] <= 0) {
+      ERROR("number of threads must be positive, got %s\n", token);
+    }
+    token = strtok(NULL, ",");
+  }
+  return n;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 6) {
+    printf(
+        "usage: %s trace_path trace_type algo cache_size n_threads "
+        "[cache_params] [trace_type_params]\n"
+        "algo: fifo, clock, s3fifo\n"
+        "n_threads: comma separated, e.g., 1,2,4,8\n",
+        argv[0]);
+    return 1;
+  }
+
+  const char *cache_params = argc > 6 ? argv[6] : NULL;
+  const char *trace_type_params = argc > 7 ? argv[7] : NULL;
+  int n_threads[MAX_N_THREAD_CONFIG];
+  int n_config = parse_n_threads(argv[5], n_threads);
+  int max_n_thread = 1;
+  for (int i = 0; i < n_config; i++) {
+    max_n_thread = MAX(max_n_thread, n_threads[i]);
+  }
+
+  reader_t *reader =
+      create_reader(argv[2], argv[1], trace_type_params, -1, false, 1);
+  int64_t n_total_req = 0;
+  /* use max_n_thread partitions so that all runs replay the same
+   * per-object request sequences */
+  bench_partition_t *partitions =
+      load_partitions(reader, max_n_thread, &n_total_req);
+  close_reader(reader);
+  INFO("loaded %ld requests into %d partitions\n", (long)n_total_req,
+       max_n_thread);
+
+  common_cache_params_t cc_params = default_common_cache_params();
+  cc_params.cache_size = conv_size_str_to_byte(argv[4]);
+  cc_params.hashpower = HASH_POWER_DEFAULT;
+
+  printf("%32s %8s %16s %12s %12s %16s\n", "cache name", "threads", "n_req",
+         "miss ratio", "byte miss", "throughput MQPS");
+  for (int c = 0; c < n_config; c++) {
+    int n_thread = n_threads[c];
+    concurrent_cache_t *cache =
+        create_concurrent_cache(argv[3], cc_params, cache_params);
+    if (cache == NULL) {
+      ERROR("cannot create concurrent cache %s\n", argv[3]);
+    }
+
+    bench_thread_params_t *params = (bench_thread_params_t *)calloc(
+        n_thread, sizeof(bench_thread_params_t));
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * n_thread);
+
+    double start_time = gettime();
+    for (int i = 0; i < n_thread; i++) {
+      params[i].cache = cache;
+      params[i].partitions = partitions;
+      params[i].n_partition = max_n_thread;
+      params[i].thread_id = i;
+      params[i].n_thread = n_thread;
+      pthread_create(&threads[i], NULL, bench_thread, &params[i]);
+    }
+
+    int64_t n_req = 0, n_miss = 0, n_req_byte = 0, n_miss_byte = 0;
+    for (int i = 0; i < n_thread; i++) {
+      pthread_join(threads[i], NULL);
+      n_req += params[i].n_req;
+      n_miss += params[i].n_miss;
+      n_req_byte += params[i].n_req_byte;
+      n_miss_byte += params[i].n_miss_byte;
+    }
+    double elapsed = gettime() - start_time;
+    assert(n_req == n_total_req);
+
+    printf("%32s %8d %16ld %12.4lf %12.4lf %16.2lf\n", cache->cache_name,
+           n_thread, (long)n_req, (double)n_miss / (double)n_req,
+           (double)n_miss_byte / (double)n_req_byte,
+           (double)n_req / elapsed / 1e6);
+
+    free(threads);
+    free(params);
+    cache->cache_free(cache);
+  }
+
+  for (int i = 0; i < max_n_thread; i++) {
+    free(partitions[i].reqs);
+  }
+  free(partitions);
+
+  return 0;
+}
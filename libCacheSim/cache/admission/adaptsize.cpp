@@ -1,55 +1,348 @@
 //
+// AdaptSize admission
+// AdaptSize: Orchestrating the Hot Object Memory Cache in a Content Delivery
+// Network, NSDI'17
+//
+// an object of size s is admitted with probability exp(-s / c),
+// c is tuned every reconf-interval requests: the request rate and size of
+// the objects seen in the window are merged into long-term statistics with
+// an exponentially weighted moving average, then the c that maximizes the
+// object hit ratio predicted by a Markov-chain model of the cache is found
+// with a coarse grid search followed by a golden-section search over log2(c)
+//
+// tuning runs inline on the request that ends the window so that the
+// results are deterministic
+//
 // Created by Juncheng on 5/30/21.
 //
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
 #include "../../include/libCacheSim/admissionAlgo.h"
 #include "../../utils/include/mymath.h"
 
+static const char *DEFAULT_PARAMS =
+    "reconf-interval=500000,max-n-obj=1000000,model-n-obj=100000,"
+    "ewma-decay=0.3,init-c=32768";
+
+typedef struct {
+  double req_cnt;
+  int64_t obj_size;
+} adaptsize_obj_stat_t;
+
+typedef std::unordered_map<obj_id_t, adaptsize_obj_stat_t> adaptsize_stat_map_t;
+
 typedef struct adaptsize_admissioner {
-  int64_t adaptsize_threshold;
+  /* the number of requests between two reconfigurations */
+  int64_t reconf_interval;
+  /* the max number of objects tracked in each statistics table,
+   * objects not in a full table are not tracked */
+  int64_t max_n_obj;
+  /* the weight of the old statistics in the moving average */
+  double ewma_decay;
+
+  /* the max number of objects used in the model, if more objects are
+   * tracked, the model uses a uniform sample of them and a scaled cache */
+  int64_t model_n_obj;
+
+  /* the admission parameter, in bytes */
+  double c;
+  int64_t cache_size;
+  double model_cache_size;
+  int64_t n_req_in_window;
+  int64_t n_reconf;
+
+  adaptsize_stat_map_t interval_stat;
+  adaptsize_stat_map_t long_term_stat;
+
+  /* the statistics copied into arrays for the model */
+  std::vector<double> req_cnt;
+  std::vector<double> obj_size;
+  /* most objects share a few request counts, so the terms that depend on
+   * the request count are computed once per distinct count,
+   * rates are the distinct counts and rate_idx maps an object to its count */
+  std::vector<double> rates;
+  std::vector<int32_t> rate_idx;
+  std::vector<double> log_rate_term;
 } adaptsize_admission_params_t;
 
-bool adaptsize_admit(admissioner_t *admissioner, const request_t *req) {
+/* the bisection on ln(T) stops when the bracket is narrower than this */
+#define ADAPTSIZE_T_SOLVE_TOL 1e-4
+#define ADAPTSIZE_GRID_STEP 2
+#define ADAPTSIZE_GSS_N_ITER 14
+#define ADAPTSIZE_MIN_REQ_CNT 0.1
+
+/**
+ * @brief compute ln(exp(rate * T) - 1) of each distinct rate, an object is in
+ * the cache with probability tmp / (1 + tmp) with tmp = exp(-size / c) *
+ * (exp(rate * T) - 1), which is computed in log space because tmp overflows
+ * or underflows easily
+ */
+static void adaptsize_update_log_rate_term(adaptsize_admission_params_t *pa,
+                                           double T) {
+  for (size_t r = 0; r < pa->rates.size(); r++) {
+    double rate_T = pa->rates[r] * T;
+    pa->log_rate_term[r] = rate_T > 30 ? rate_T : log(expm1(rate_T));
+  }
+}
+
+/* the probability that object i is in the cache, log_rate_term must have
+ * been computed for the current T */
+static inline double adaptsize_in_cache_prob(
+    const adaptsize_admission_params_t *pa, size_t i, double inv_c) {
+  return 1 / (1 + exp(pa->obj_size[i] * inv_c -
+                      pa->log_rate_term[pa->rate_idx[i]]));
+}
+
+/* the expected bytes in the cache given the characteristic time T */
+static double adaptsize_expected_bytes(adaptsize_admission_params_t *pa,
+                                       double T, double inv_c) {
+  adaptsize_update_log_rate_term(pa, T);
+  double n_byte = 0;
+  for (size_t i = 0; i < pa->req_cnt.size(); i++) {
+    n_byte += pa->obj_size[i] * adaptsize_in_cache_prob(pa, i, inv_c);
+  }
+  return n_byte;
+}
+
+/**
+ * @brief the object hit ratio of the cache when objects are admitted with
+ * probability exp(-size / 2^log2c), it first finds the characteristic time
+ * T so that the expected bytes in the cache equal the cache size, using
+ * bisection on ln(T) because the expected bytes increase with T, then sums
+ * the hit probability of each object weighted by its request rate
+ */
+static double adaptsize_model_hit_ratio(adaptsize_admission_params_t *pa,
+                                        double log2c) {
+  const std::vector<double> &req_cnt = pa->req_cnt;
+  const std::vector<double> &obj_size = pa->obj_size;
+  const size_t n_obj = req_cnt.size();
+  const double inv_c = pow(2, -log2c);
+  const double cache_size = pa->model_cache_size;
+
+  double total_byte = 0, sum_val = 0;
+  for (size_t i = 0; i < n_obj; i++) {
+    total_byte += obj_size[i];
+    sum_val += req_cnt[i] * obj_size[i];
+  }
+  if (sum_val <= 0) return 0;
+
+  /* the rates are measured per window and forgotten after about
+   * 1 / (1 - ewma_decay) windows, so the model does not let objects wait
+   * longer than that to be admitted, otherwise the model always prefers
+   * a tiny c that admits only the most popular objects eventually */
+  const double max_T = 1 / (1 - pa->ewma_decay);
+  double the_T = max_T;
+  if (total_byte > cache_size &&
+      adaptsize_expected_bytes(pa, max_T, inv_c) > cache_size) {
+    /* the expected bytes is at most T * sum_val, so T >= exp(lo) */
+    double lo = std::min(log(cache_size / sum_val), log(max_T));
+    double hi = log(max_T);
+    while (hi - lo > ADAPTSIZE_T_SOLVE_TOL) {
+      double mid = (lo + hi) / 2;
+      if (adaptsize_expected_bytes(pa, exp(mid), inv_c) < cache_size) {
+        lo = mid;
+      } else {
+        hi = mid;
+      }
+    }
+    the_T = exp(lo);
+  }
+
+  adaptsize_update_log_rate_term(pa, the_T);
+  double n_hit = 0, n_req = 0;
+  for (size_t i = 0; i < n_obj; i++) {
+    n_hit += req_cnt[i] * adaptsize_in_cache_prob(pa, i, inv_c);
+    n_req += req_cnt[i];
+  }
+
+  return n_req > 0 ? n_hit / n_req : 0;
+}
+
+/**
+ * @brief merge the window statistics into the long-term statistics and
+ * find the c that maximizes the modeled hit ratio
+ */
+static void adaptsize_reconfigure(adaptsize_admission_params_t *pa) {
+  for (auto it = pa->long_term_stat.begin(); it != pa->long_term_stat.end();) {
+    it->second.req_cnt *= pa->ewma_decay;
+    if (it->second.req_cnt < ADAPTSIZE_MIN_REQ_CNT) {
+      it = pa->long_term_stat.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (const auto &it : pa->interval_stat) {
+    auto lt = pa->long_term_stat.find(it.first);
+    if (lt != pa->long_term_stat.end()) {
+      lt->second.req_cnt += (1 - pa->ewma_decay) * it.second.req_cnt;
+      lt->second.obj_size = it.second.obj_size;
+    } else if ((int64_t)pa->long_term_stat.size() < pa->max_n_obj) {
+      adaptsize_obj_stat_t stat = it.second;
+      stat.req_cnt *= (1 - pa->ewma_decay);
+      pa->long_term_stat[it.first] = stat;
+    }
+  }
+  pa->interval_stat.clear();
+
+  /* the model uses every k-th object and a cache k times smaller */
+  int64_t k = ((int64_t)pa->long_term_stat.size() + pa->model_n_obj - 1) /
+              pa->model_n_obj;
+  if (k < 1) k = 1;
+  pa->model_cache_size = (double)pa->cache_size / (double)k;
+  pa->req_cnt.clear();
+  pa->obj_size.clear();
+  int64_t idx = 0;
+  double min_obj_size = (double)pa->cache_size;
+  for (const auto &it : pa->long_term_stat) {
+    if (idx++ % k != 0) continue;
+    pa->req_cnt.push_back(it.second.req_cnt);
+    pa->obj_size.push_back((double)it.second.obj_size);
+    min_obj_size = std::min(min_obj_size, (double)it.second.obj_size);
+  }
+  pa->n_reconf += 1;
+
+  pa->rates = pa->req_cnt;
+  std::sort(pa->rates.begin(), pa->rates.end());
+  pa->rates.erase(std::unique(pa->rates.begin(), pa->rates.end()),
+                  pa->rates.end());
+  pa->log_rate_term.resize(pa->rates.size());
+  pa->rate_idx.resize(pa->req_cnt.size());
+  for (size_t i = 0; i < pa->req_cnt.size(); i++) {
+    pa->rate_idx[i] = (int32_t)(std::lower_bound(pa->rates.begin(),
+                                                 pa->rates.end(),
+                                                 pa->req_cnt[i]) -
+                                pa->rates.begin());
+  }
+
+  if (pa->req_cnt.empty() || pa->cache_size <= 0) return;
+
+  /* coarse grid search over log2(c), a c much smaller than the smallest
+   * object admits almost nothing */
+  const double max_log2c = log2((double)pa->cache_size);
+  const double grid_step = ADAPTSIZE_GRID_STEP;
+  double min_log2c = std::max(0.0, log2(std::max(min_obj_size, 1.0)) - 4);
+  double best_log2c = min_log2c, best_hit_ratio = -1;
+  for (double x = min_log2c; x <= max_log2c; x += grid_step) {
+    double hit_ratio = adaptsize_model_hit_ratio(pa, x);
+    if (hit_ratio > best_hit_ratio) {
+      best_hit_ratio = hit_ratio;
+      best_log2c = x;
+    }
+  }
+
+  /* golden-section search around the best grid point */
+  const double gr = (sqrt(5) - 1) / 2;
+  double lo = std::max(min_log2c, best_log2c - grid_step);
+  double hi = best_log2c + grid_step;
+  double x1 = hi - gr * (hi - lo), x2 = lo + gr * (hi - lo);
+  double f1 = adaptsize_model_hit_ratio(pa, x1);
+  double f2 = adaptsize_model_hit_ratio(pa, x2);
+  for (int i = 0; i < ADAPTSIZE_GSS_N_ITER; i++) {
+    if (f1 > f2) {
+      hi = x2;
+      x2 = x1;
+      f2 = f1;
+      x1 = hi - gr * (hi - lo);
+      f1 = adaptsize_model_hit_ratio(pa, x1);
+    } else {
+      lo = x1;
+      x1 = x2;
+      f1 = f2;
+      x2 = lo + gr * (hi - lo);
+      f2 = adaptsize_model_hit_ratio(pa, x2);
+    }
+  }
+
+  double log2c = f1 > f2 ? x1 : x2;
+  if (std::max(f1, f2) < best_hit_ratio) log2c = best_log2c;
+  pa->c = pow(2, log2c);
+
+  DEBUG("adaptsize reconfiguration %ld: %zu objects, c %.0lf, modeled hit "
+        "ratio %.4lf\n",
+        (long)pa->n_reconf, pa->req_cnt.size(), pa->c,
+        std::max(best_hit_ratio, std::max(f1, f2)));
+}
+
+/**
+ * @brief record the request in the window statistics and reconfigure at the
+ * end of the window, called on every request
+ */
+void adaptsize_update(admissioner_t *admissioner, const request_t *req,
+                      const uint64_t cache_size) {
   adaptsize_admission_params_t *pa =
       (adaptsize_admission_params_t *)admissioner->params;
-  if (req->obj_size < pa->adaptsize_threshold) {
-    return true;
+  pa->cache_size = (int64_t)cache_size;
+
+  auto it = pa->interval_stat.find(req->obj_id);
+  if (it != pa->interval_stat.end()) {
+    it->second.req_cnt += 1;
+    it->second.obj_size = req->obj_size;
+  } else if ((int64_t)pa->interval_stat.size() < pa->max_n_obj) {
+    pa->interval_stat[req->obj_id] = {1.0, req->obj_size};
   }
 
-  return false;
+  if (++pa->n_req_in_window >= pa->reconf_interval) {
+    adaptsize_reconfigure(pa);
+    pa->n_req_in_window = 0;
+  }
+}
+
+bool adaptsize_admit(admissioner_t *admissioner, const request_t *req) {
+  adaptsize_admission_params_t *pa =
+      (adaptsize_admission_params_t *)admissioner->params;
+  double admit_prob = exp(-(double)req->obj_size / pa->c);
+  double r = (double)(next_rand() % 10000000) / 10000000.0;
+
+  return r < admit_prob;
 }
 
 static void adaptsize_admissioner_parse_params(
     const char *init_params, adaptsize_admission_params_t *pa) {
-  if (init_params == NULL) {
-    pa->adaptsize_threshold = INT64_MAX;
-    INFO("use default adaptsize admission: %ld", (long) pa->adaptsize_threshold);
-  } else {
-    char *params_str = strdup(init_params);
-    char *old_params_str = params_str;
-    char *end;
-
-    while (params_str != NULL && params_str[0] != '\0') {
-      /* different parameters are separated by comma,
-       * key and value are separated by = */
-      char *key = strsep((char **)&params_str, "=");
-      char *value = strsep((char **)&params_str, ",");
-
-      // skip the white space
-      while (params_str != NULL && *params_str == ' ') {
-        params_str++;
-      }
+  if (init_params == NULL) return;
 
-      if (strcasecmp(key, "adaptsize") == 0) {
-        pa->adaptsize_threshold = strtoll(value, &end, 0);
-        if (strlen(end) > 2) {
-          ERROR("param parsing error, find string \"%s\" after number\n", end);
-        }
-      } else {
-        ERROR("adaptsize admission does not have parameter %s\n", key);
-      }
+  char *params_str = strdup(init_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "reconf-interval") == 0) {
+      pa->reconf_interval = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "max-n-obj") == 0) {
+      pa->max_n_obj = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "model-n-obj") == 0) {
+      pa->model_n_obj = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "ewma-decay") == 0) {
+      pa->ewma_decay = strtod(value, &end);
+    } else if (strcasecmp(key, "init-c") == 0) {
+      pa->c = strtod(value, &end);
+    } else {
+      ERROR("adaptsize admission does not have parameter %s\n", key);
+    }
+    if (strlen(end) > 2) {
+      ERROR("param parsing error, find string \"%s\" after number\n", end);
     }
-    free(old_params_str);
+  }
+  free(old_params_str);
+
+  if (pa->reconf_interval <= 0 || pa->max_n_obj <= 0 || pa->model_n_obj <= 0 ||
+      pa->c <= 0 ||
+      pa->ewma_decay < 0 || pa->ewma_decay >= 1) {
+    ERROR("adaptsize admission invalid parameters \"%s\"\n", init_params);
   }
 }
 
@@ -61,7 +354,7 @@ void free_adaptsize_admissioner(admissioner_t *admissioner) {
   adaptsize_admission_params_t *pa =
       static_cast<adaptsize_admission_params_t *>(admissioner->params);
 
-  free(pa);
+  delete pa;
   if (admissioner->init_params) {
     free(admissioner->init_params);
   }
@@ -69,19 +362,18 @@ void free_adaptsize_admissioner(admissioner_t *admissioner) {
 }
 
 admissioner_t *create_adaptsize_admissioner(const char *init_params) {
-  adaptsize_admission_params_t *pa = (adaptsize_admission_params_t *)malloc(
-      sizeof(adaptsize_admission_params_t));
-  memset(pa, 0, sizeof(adaptsize_admission_params_t));
+  adaptsize_admission_params_t *pa = new adaptsize_admission_params_t();
+  adaptsize_admissioner_parse_params(DEFAULT_PARAMS, pa);
   adaptsize_admissioner_parse_params(init_params, pa);
 
   admissioner_t *admissioner = (admissioner_t *)malloc(sizeof(admissioner_t));
   memset(admissioner, 0, sizeof(admissioner_t));
   admissioner->params = pa;
   admissioner->admit = adaptsize_admit;
+  admissioner->update = adaptsize_update;
   admissioner->free = free_adaptsize_admissioner;
   admissioner->clone = clone_adaptsize_admissioner;
   if (init_params != NULL) admissioner->init_params = strdup(init_params);
 
-  ERROR("adaptsize is not implemented\n");
   return admissioner;
 }
@@ -0,0 +1,130 @@
+//
+// TinyLFU admission: admit an object if its recent access frequency,
+// estimated with a frequency sketch of all requests, reaches min-freq
+//
+// compared to the bloomfilter admission, the memory is bounded and the
+// frequency is aged, so one-hit wonders of the past are not admitted forever
+//
+// params:
+//   n-entry: the expected number of objects in the cache, the sketch uses
+//            about 8 bytes per entry
+//   min-freq: the frequency (including the current request) to admit,
+//             in [1, 15]
+//   sample-size: the number of requests between two halvings of the sketch,
+//                0 uses 10 * n-entry
+//
+// tinylfu.c
+// libCacheSim
+//
+
+#include "../../dataStructure/freqSketch.h"
+#include "../../include/libCacheSim/admissionAlgo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tinylfu_admissioner {
+  freq_sketch_t *sketch;
+  int64_t n_entry;
+  int64_t sample_size;
+  int min_freq;
+} tinylfu_admission_params_t;
+
+static void tinylfu_update(admissioner_t *admissioner, const request_t *req,
+                           const uint64_t cache_size) {
+  tinylfu_admission_params_t *pa =
+      (tinylfu_admission_params_t *)admissioner->params;
+  freq_sketch_add(pa->sketch, req->obj_id);
+}
+
+bool tinylfu_admit(admissioner_t *admissioner, const request_t *req) {
+  tinylfu_admission_params_t *pa =
+      (tinylfu_admission_params_t *)admissioner->params;
+  return freq_sketch_estimate(pa->sketch, req->obj_id) >= pa->min_freq;
+}
+
+static void tinylfu_admissioner_parse_params(const char *init_params,
+                                             tinylfu_admission_params_t *pa) {
+  pa->n_entry = 1 << 20;
+  pa->sample_size = 0;
+  pa->min_freq = 2;
+  if (init_params == NULL) {
+    return;
+  }
+
+  char *params_str = strdup(init_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "n-entry") == 0) {
+      pa->n_entry = strtoll(value, &end, 0);
+      if (pa->n_entry <= 0) {
+        ERROR("tinylfu admission n-entry must be positive\n");
+      }
+    } else if (strcasecmp(key, "min-freq") == 0) {
+      pa->min_freq = (int)strtol(value, &end, 0);
+      if (pa->min_freq < 1 || pa->min_freq > FREQ_SKETCH_MAX_COUNT) {
+        ERROR("tinylfu admission min-freq must be in [1, %d]\n",
+              FREQ_SKETCH_MAX_COUNT);
+      }
+    } else if (strcasecmp(key, "sample-size") == 0) {
+      pa->sample_size = strtoll(value, &end, 0);
+    } else {
+      ERROR("tinylfu admission does not have parameter %s\n", key);
+    }
+    if (strlen(end) > 2) {
+      ERROR("param parsing error, find string \"%s\" after number\n", end);
+    }
+  }
+  free(old_params_str);
+}
+
+admissioner_t *clone_tinylfu_admissioner(admissioner_t *admissioner) {
+  return create_tinylfu_admissioner(admissioner->init_params);
+}
+
+void free_tinylfu_admissioner(admissioner_t *admissioner) {
+  tinylfu_admission_params_t *pa = admissioner->params;
+
+  free_freq_sketch(pa->sketch);
+  free(pa);
+  if (admissioner->init_params) {
+    free(admissioner->init_params);
+  }
+  free(admissioner);
+}
+
+admissioner_t *create_tinylfu_admissioner(const char *init_params) {
+  tinylfu_admission_params_t *pa = (tinylfu_admission_params_t *)malloc(
+      sizeof(tinylfu_admission_params_t));
+  memset(pa, 0, sizeof(tinylfu_admission_params_t));
+  tinylfu_admissioner_parse_params(init_params, pa);
+  pa->sketch = create_freq_sketch(pa->n_entry, pa->sample_size);
+
+  admissioner_t *admissioner = (admissioner_t *)malloc(sizeof(admissioner_t));
+  memset(admissioner, 0, sizeof(admissioner_t));
+  admissioner->params = pa;
+  admissioner->admit = tinylfu_admit;
+  admissioner->update = tinylfu_update;
+  admissioner->free = free_tinylfu_admissioner;
+  admissioner->clone = clone_tinylfu_admissioner;
+  if (init_params != NULL) admissioner->init_params = strdup(init_params);
+
+  return admissioner;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,10 +2,43 @@
 // Created by Juncheng Yang on 6/20/20.
 //
 
+#include "../dataStructure/hash/hash.h"
 #include "../dataStructure/hashtable/hashtable.h"
+#include "../dataStructure/ttlWheel.h"
 #include "../include/libCacheSim/cache.h"
+#include "../include/libCacheSim/miniSim.h"
 #include "../include/libCacheSim/prefetchAlgo.h"
 
+/* the objects removed while a cache with an event hook evicts */
+typedef struct {
+  obj_id_t obj_id;
+  int64_t obj_size;
+} removed_obj_t;
+
+/* a slot of the open-addressing set of the removed obj ids, the slot is
+ * empty if its gen is not the gen of the current eviction */
+typedef struct {
+  obj_id_t obj_id;
+  uint32_t gen;
+} removed_slot_t;
+
+typedef struct cache_evict_log {
+  /* the removed objects without duplicates */
+  removed_obj_t *removed;
+  int n_removed;
+  int n_removed_alloc;
+  /* the set of obj ids in removed, the number of slots is a power of two
+   * and at least twice n_removed */
+  removed_slot_t *slots;
+  int n_slot;
+  uint32_t gen;
+  request_t *req_local;
+} cache_evict_log_t;
+
+/* the log of the cache that is evicting on this thread, NULL if the cache
+ * does not have an event hook, sub-caches record their removals to it */
+static __thread cache_evict_log_t *curr_evict_log = NULL;
+
 /** this file contains both base function, which should be called by all
  *eviction algorithms, and the queue related functions, which should be called
  *by algorithm that uses only one queue and needs to update the queue such as
@@ -37,6 +70,8 @@ cache_t *cache_struct_init(const char *const cache_name,
   cache->future_stack_dist = NULL;
   cache->future_stack_dist_array_size = 0;
   cache->default_ttl = params.default_ttl;
+  cache->algo_obj_md_size = -1;
+  cache->support_remove = true;
   cache->n_req = 0;
   cache->to_evict_candidate = NULL;
   cache->to_evict_candidate_gen_vtime = -1;
@@ -58,12 +93,102 @@ cache_t *cache_struct_init(const char *const cache_name,
   if (params.hashpower > 0 && params.hashpower < 40)
     hash_power = params.hashpower;
   cache->hashtable = create_hashtable(hash_power);
+#ifdef ENABLE_PERF_STAT
+  cache->perf_stat = (perf_stat_t *)calloc(1, sizeof(perf_stat_t));
+#endif
   hashtable_add_ptr_to_monitoring(cache->hashtable, &cache->q_head);
   hashtable_add_ptr_to_monitoring(cache->hashtable, &cache->q_tail);
 
   return cache;
 }
 
+static cache_evict_log_t *_get_evict_log(cache_t *cache) {
+  if (cache->evict_log == NULL) {
+    cache->evict_log = my_malloc(cache_evict_log_t);
+    memset(cache->evict_log, 0, sizeof(cache_evict_log_t));
+    cache->evict_log->req_local = new_request();
+  }
+  cache->evict_log->n_removed = 0;
+  /* empty the set without touching the slots */
+  cache->evict_log->gen += 1;
+  if (cache->evict_log->gen == 0) {
+    memset(cache->evict_log->slots, 0,
+           sizeof(removed_slot_t) * cache->evict_log->n_slot);
+    cache->evict_log->gen = 1;
+  }
+  return cache->evict_log;
+}
+
+/**
+ * @brief add obj_id to the set of the removed obj ids
+ *
+ * @return false if obj_id is already in the set
+ */
+static bool _removed_set_add(cache_evict_log_t *log, obj_id_t obj_id) {
+  uint64_t mask = (uint64_t)log->n_slot - 1;
+  uint64_t i = get_hash_value_int_64(&obj_id) & mask;
+  while (log->slots[i].gen == log->gen) {
+    if (log->slots[i].obj_id == obj_id) return false;
+    i = (i + 1) & mask;
+  }
+  log->slots[i].obj_id = obj_id;
+  log->slots[i].gen = log->gen;
+  return true;
+}
+
+static void _grow_removed_set(cache_evict_log_t *log) {
+  free(log->slots);
+  log->n_slot = MAX(log->n_slot * 2, 16);
+  log->slots = calloc(log->n_slot, sizeof(removed_slot_t));
+  ASSERT_NOT_NULL(log->slots, "cannot grow the removed obj set\n");
+  log->gen = 1;
+  for (int i = 0; i < log->n_removed; i++) {
+    _removed_set_add(log, log->removed[i].obj_id);
+  }
+}
+
+/* objects removed more than once during the eviction are recorded once */
+static void _record_removed_obj(cache_evict_log_t *log,
+                                const cache_obj_t *obj) {
+  if ((int64_t)(log->n_removed + 1) * 2 > log->n_slot) {
+    _grow_removed_set(log);
+  }
+  if (!_removed_set_add(log, obj->obj_id)) return;
+
+  if (log->n_removed == log->n_removed_alloc) {
+    log->n_removed_alloc = MAX(log->n_removed_alloc * 2, 8);
+    log->removed = realloc(log->removed,
+                           sizeof(removed_obj_t) * log->n_removed_alloc);
+    ASSERT_NOT_NULL(log->removed, "cannot grow the removed obj array\n");
+  }
+  log->removed[log->n_removed].obj_id = obj->obj_id;
+  log->removed[log->n_removed].obj_size = obj->obj_size;
+  log->n_removed += 1;
+}
+
+/**
+ * @brief report the objects removed during the eviction as victims,
+ * an object may be removed and inserted again (e.g., moved between the
+ * queues of S3FIFO or reinserted by the prefetcher), so only the objects
+ * that are not in the cache after the eviction are victims
+ */
+static void _report_evictions(cache_t *cache, const request_t *req,
+                              cache_evict_log_t *log) {
+  cache_obj_t victim;
+  memset(&victim, 0, sizeof(victim));
+
+  for (int i = 0; i < log->n_removed; i++) {
+    log->req_local->obj_id = log->removed[i].obj_id;
+    log->req_local->obj_size = log->removed[i].obj_size;
+    if (cache->find(cache, log->req_local, false) != NULL) continue;
+
+    victim.obj_id = log->removed[i].obj_id;
+    victim.obj_size = log->removed[i].obj_size;
+    cache->event_hook(cache, CACHE_EVENT_EVICT, req, &victim,
+                      cache->event_hook_data);
+  }
+}
+
 /**
  * @brief this function is called by all eviction algorithms to free the cache
  *
@@ -71,8 +196,21 @@ cache_t *cache_struct_init(const char *const cache_name,
  */
 void cache_struct_free(cache_t *cache) {
   free_hashtable(cache->hashtable);
+#ifdef ENABLE_PERF_STAT
+  free(cache->perf_stat);
+#endif
+#ifdef SUPPORT_TTL
+  if (cache->ttl_wheel != NULL) free_ttl_wheel(cache->ttl_wheel);
+#endif
   if (cache->admissioner != NULL) cache->admissioner->free(cache->admissioner);
   if (cache->prefetcher != NULL) cache->prefetcher->free(cache->prefetcher);
+  if (cache->mini_sim != NULL) free_mini_sim(cache->mini_sim);
+  if (cache->evict_log != NULL) {
+    free(cache->evict_log->removed);
+    free(cache->evict_log->slots);
+    free_request(cache->evict_log->req_local);
+    my_free(sizeof(cache_evict_log_t), cache->evict_log);
+  }
   my_free(sizeof(cache_t), cache);
 }
 
@@ -97,6 +235,12 @@ cache_t *clone_cache(const cache_t *old_cache) {
   }
   cache->future_stack_dist = old_cache->future_stack_dist;
   cache->future_stack_dist_array_size = old_cache->future_stack_dist_array_size;
+  if (old_cache->hashtable->obj_struct_size != sizeof(cache_obj_t)) {
+    cache_use_compact_obj(cache);
+  }
+#ifdef SUPPORT_TTL
+  if (old_cache->ttl_wheel != NULL) cache_enable_ttl_wheel(cache);
+#endif
 
   return cache;
 }
@@ -127,9 +271,78 @@ cache_t *create_cache_with_new_size(const cache_t *old_cache,
   }
   cache->future_stack_dist = old_cache->future_stack_dist;
   cache->future_stack_dist_array_size = old_cache->future_stack_dist_array_size;
+  if (old_cache->hashtable->obj_struct_size != sizeof(cache_obj_t)) {
+    cache_use_compact_obj(cache);
+  }
+#ifdef SUPPORT_TTL
+  if (old_cache->ttl_wheel != NULL) cache_enable_ttl_wheel(cache);
+#endif
   return cache;
 }
 
+void cache_use_compact_obj(cache_t *cache) {
+  if (cache->algo_obj_md_size < 0) {
+    DEBUG("%s does not declare its object metadata size\n",
+          cache->cache_name);
+    return;
+  }
+  DEBUG_ASSERT(cache->hashtable->n_obj == 0);
+  cache->hashtable->obj_struct_size =
+      cache_obj_struct_size(cache->algo_obj_md_size);
+}
+
+#ifdef ENABLE_PERF_STAT
+void cache_get_perf_stat(const cache_t *cache, perf_stat_t *perf_stat) {
+  *perf_stat = *cache->perf_stat;
+  perf_stat->chain_len = cache->hashtable->chain_len;
+  perf_stat->n_hashtable_expand = cache->hashtable->n_expand;
+}
+#endif
+
+void cache_enable_ttl_wheel(cache_t *cache) {
+#ifdef SUPPORT_TTL
+  if (!cache->support_remove) {
+    WARN("%s does not support remove, the ttl wheel is not enabled\n",
+         cache->cache_name);
+    return;
+  }
+  if (cache->ttl_wheel == NULL) cache->ttl_wheel = create_ttl_wheel(0);
+#else
+  WARN_ONCE("TTL is not supported, compile with SUPPORT_TTL=on\n");
+#endif
+}
+
+#ifdef SUPPORT_TTL
+/**
+ * @brief called by the ttl wheel when the expiration time of an object has
+ * passed, the object may have been evicted or re-inserted with a new
+ * expiration time since it was added to the wheel
+ */
+static void _cache_expire_obj(const ttl_wheel_entry_t *entry,
+                              void *user_data) {
+  cache_t *cache = (cache_t *)user_data;
+  int64_t curr_time = cache->ttl_wheel->curr_time;
+  /* clock_time is 0 so that find does not skip the expired object */
+  request_t req;
+  memset(&req, 0, sizeof(request_t));
+  req.obj_id = entry->obj_id;
+
+  cache_obj_t *obj = cache->find(cache, &req, false);
+  if (obj == NULL || obj->exp_time == 0) {
+    return;
+  }
+
+  if (obj->exp_time < curr_time) {
+    cache->n_expired_obj += 1;
+    cache->n_expired_byte += obj->obj_size;
+    cache->remove(cache, obj->obj_id);
+  } else if ((int64_t)obj->exp_time + 1 != entry->fire_time) {
+    /* the expiration time has changed, e.g., the object was re-inserted */
+    ttl_wheel_add(cache->ttl_wheel, obj->obj_id, (int64_t)obj->exp_time + 1);
+  }
+}
+#endif
+
 /**
  * @brief whether the request can be inserted into cache
  *
@@ -187,10 +400,12 @@ cache_obj_t *cache_find_base(cache_t *cache, const request_t *req,
 #ifdef SUPPORT_TTL
     if (cache_obj->exp_time != 0 && cache_obj->exp_time < req->clock_time) {
       if (update_cache) {
+        cache->n_expired_obj += 1;
+        cache->n_expired_byte += cache_obj->obj_size;
         cache->remove(cache, cache_obj->obj_id);
       }
 
-      cache_obj = NULL;
+      return NULL;
     }
 #endif
 
@@ -225,29 +440,84 @@ cache_obj_t *cache_find_base(cache_t *cache, const request_t *req,
 bool cache_get_base(cache_t *cache, const request_t *req) {
   cache->n_req += 1;
 
+#ifdef SUPPORT_TTL
+  if (cache->ttl_wheel != NULL) {
+    ttl_wheel_advance(cache->ttl_wheel, req->clock_time, _cache_expire_obj,
+                      cache);
+  }
+#endif
+
   VERBOSE("******* %s req %ld, obj %ld, obj_size %ld, cache size %ld/%ld\n",
           cache->cache_name, cache->n_req, req->obj_id, req->obj_size,
           cache->get_occupied_byte(cache), cache->cache_size);
 
+  if (cache->mini_sim != NULL) {
+    mini_sim_feed(cache->mini_sim, req);
+  }
+
+  PERF_STAT_START(find_start);
   cache_obj_t *obj = cache->find(cache, req, true);
   bool hit = (obj != NULL);
+  PERF_STAT_END(cache->perf_stat, PERF_OP_FIND, find_start);
+
+  if (cache->admissioner != NULL && cache->admissioner->update != NULL) {
+    cache->admissioner->update(cache->admissioner, req, cache->cache_size);
+  }
+
+  bool can_insert = false;
+  if (!hit) {
+    PERF_STAT_START(admit_start);
+    can_insert = cache->can_insert(cache, req);
+    PERF_STAT_END(cache->perf_stat, PERF_OP_ADMIT, admit_start);
+  }
 
   if (hit) {
     VVERBOSE("req %ld, obj %ld --- cache hit\n", cache->n_req, req->obj_id);
-  } else if (!cache->can_insert(cache, req)) {
+  } else if (!can_insert) {
     VVERBOSE("req %ld, obj %ld --- cache miss cannot insert\n", cache->n_req,
              req->obj_id);
+    if (cache->event_hook != NULL) {
+      cache->event_hook(cache, CACHE_EVENT_BYPASS, req, NULL,
+                        cache->event_hook_data);
+    }
   } else {
+    /* the removals of a nested cache (e.g., a ghost cache updated during the
+     * eviction) are not evictions of the outer cache */
+    cache_evict_log_t *outer_log = curr_evict_log;
+    curr_evict_log =
+        cache->event_hook != NULL ? _get_evict_log(cache) : NULL;
     while (cache->get_occupied_byte(cache) + req->obj_size +
                cache->obj_md_size >
            cache->cache_size) {
+      PERF_STAT_START(evict_start);
       cache->evict(cache, req);
+      PERF_STAT_END(cache->perf_stat, PERF_OP_EVICT, evict_start);
+    }
+    if (curr_evict_log != NULL) {
+      _report_evictions(cache, req, curr_evict_log);
+    }
+    curr_evict_log = outer_log;
+    PERF_STAT_START(insert_start);
+    obj = cache->insert(cache, req);
+    PERF_STAT_END(cache->perf_stat, PERF_OP_INSERT, insert_start);
+    if (cache->event_hook != NULL) {
+      /* some algorithms decide not to insert in insert */
+      cache->event_hook(cache,
+                        obj != NULL ? CACHE_EVENT_ADMIT : CACHE_EVENT_BYPASS,
+                        req, obj, cache->event_hook_data);
     }
-    cache->insert(cache, req);
+#ifdef SUPPORT_TTL
+    /* an object expires when the clock passes exp_time */
+    if (cache->ttl_wheel != NULL && obj != NULL && obj->exp_time != 0) {
+      ttl_wheel_add(cache->ttl_wheel, obj->obj_id, (int64_t)obj->exp_time + 1);
+    }
+#endif
   }
 
   if (cache->prefetcher && cache->prefetcher->prefetch) {
+    PERF_STAT_START(prefetch_start);
     cache->prefetcher->prefetch(cache, req);
+    PERF_STAT_END(cache->perf_stat, PERF_OP_PREFETCH, prefetch_start);
   }
 
   return hit;
@@ -326,6 +596,9 @@ void cache_evict_base(cache_t *cache, cache_obj_t *obj,
  */
 void cache_remove_obj_base(cache_t *cache, cache_obj_t *obj,
                            bool remove_from_hashtable) {
+  if (curr_evict_log != NULL) {
+    _record_removed_obj(curr_evict_log, obj);
+  }
   DEBUG_ASSERT(cache->occupied_byte >= obj->obj_size + cache->obj_md_size);
   cache->occupied_byte -= (obj->obj_size + cache->obj_md_size);
   cache->n_obj -= 1;
@@ -0,0 +1,294 @@
+//
+// save a warmed cache to a file and load it back, see checkpoint.h
+//
+// the file has a header (magic, version, cache size, parameters and reader
+// position) followed by the state of the cache written by
+// cache_checkpoint_state, which is the common fields of the cache and the
+// algorithm-specific state written by cache->checkpoint
+//
+// cacheCheckpoint.c
+// libCacheSim
+//
+
+#include <errno.h>
+#include <limits.h>
+
+#include "../dataStructure/hashtable/hashtable.h"
+#include "../dataStructure/ttlWheel.h"
+#include "../include/libCacheSim/cache.h"
+#include "../include/libCacheSim/checkpoint.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHECKPOINT_MAGIC 0x54504b4353434cULL /* "LCSCKPT" */
+#define CHECKPOINT_VERSION 1
+
+typedef struct {
+  uint64_t magic;
+  int32_t version;
+  /* the layout of cache_obj_t before the per-algorithm metadata */
+  int32_t obj_header_size;
+  int32_t misc_size;
+  int32_t obj_struct_size;
+  int64_t cache_size;
+  int64_t default_ttl;
+  char init_params[CACHE_INIT_PARAMS_LEN];
+  /* the number of requests read by the reader, -1 if no reader */
+  int64_t n_read_req;
+} checkpoint_header_t;
+
+typedef struct {
+  uint64_t obj_id;
+  int64_t obj_size;
+  int64_t exp_time;
+  int64_t create_time;
+  misc_metadata_t misc;
+} __attribute__((packed)) checkpoint_obj_t;
+
+bool cache_checkpoint_state(const cache_t *cache, FILE *ofile) {
+  if (cache->checkpoint == NULL) {
+    WARN("%s does not support checkpoint\n", cache->cache_name);
+    return false;
+  }
+
+  bool ok = checkpoint_write(ofile, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+  ok = ok && checkpoint_write(ofile, &cache->n_req, sizeof(int64_t));
+  ok = ok && checkpoint_write(ofile, &cache->n_obj, sizeof(int64_t));
+  ok = ok && checkpoint_write(ofile, &cache->occupied_byte, sizeof(int64_t));
+
+  return ok && cache->checkpoint(cache, ofile);
+}
+
+bool cache_restore_state(cache_t *cache, FILE *ifile) {
+  if (cache->restore == NULL) {
+    WARN("%s does not support restore\n", cache->cache_name);
+    return false;
+  }
+
+  char cache_name[CACHE_NAME_ARRAY_LEN];
+  int64_t n_req, n_obj, occupied_byte;
+  if (!checkpoint_read(ifile, cache_name, CACHE_NAME_ARRAY_LEN) ||
+      !checkpoint_read(ifile, &n_req, sizeof(int64_t)) ||
+      !checkpoint_read(ifile, &n_obj, sizeof(int64_t)) ||
+      !checkpoint_read(ifile, &occupied_byte, sizeof(int64_t))) {
+    return false;
+  }
+
+  if (strncmp(cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN) != 0) {
+    WARN("checkpoint is from %.*s, cannot restore %s\n", CACHE_NAME_ARRAY_LEN,
+         cache_name, cache->cache_name);
+    return false;
+  }
+
+  if (!cache->restore(cache, ifile)) {
+    return false;
+  }
+
+  cache->n_req = n_req;
+  cache->n_obj = n_obj;
+  cache->occupied_byte = occupied_byte;
+
+  return true;
+}
+
+bool checkpoint_queue(const cache_t *cache, const cache_obj_t *q_head,
+                      FILE *ofile) {
+  int32_t md_size =
+      (int32_t)(cache->hashtable->obj_struct_size - CACHE_OBJ_HEADER_SIZE);
+  int64_t n_obj = 0;
+  for (const cache_obj_t *obj = q_head; obj != NULL; obj = obj->queue.next) {
+    n_obj++;
+  }
+
+  if (!checkpoint_write(ofile, &md_size, sizeof(int32_t)) ||
+      !checkpoint_write(ofile, &n_obj, sizeof(int64_t))) {
+    return false;
+  }
+
+  checkpoint_obj_t rec;
+  memset(&rec, 0, sizeof(rec));
+  for (const cache_obj_t *obj = q_head; obj != NULL; obj = obj->queue.next) {
+    rec.obj_id = obj->obj_id;
+    rec.obj_size = obj->obj_size;
+#ifdef SUPPORT_TTL
+    rec.exp_time = obj->exp_time;
+#endif
+#if defined(TRACK_EVICTION_V_AGE) || defined(TRACK_DEMOTION) || \
+    defined(TRACK_CREATE_TIME)
+    rec.create_time = obj->create_time;
+#endif
+    rec.misc = obj->misc;
+
+    if (!checkpoint_write(ofile, &rec, sizeof(rec))) return false;
+    if (md_size > 0 &&
+        !checkpoint_write(ofile, (const char *)obj + CACHE_OBJ_HEADER_SIZE,
+                          md_size)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool restore_queue(cache_t *cache, cache_obj_t **q_head, cache_obj_t **q_tail,
+                   FILE *ifile) {
+  int32_t md_size;
+  int64_t n_obj;
+  if (!checkpoint_read(ifile, &md_size, sizeof(int32_t)) ||
+      !checkpoint_read(ifile, &n_obj, sizeof(int64_t))) {
+    return false;
+  }
+
+  if (md_size !=
+      (int32_t)(cache->hashtable->obj_struct_size - CACHE_OBJ_HEADER_SIZE)) {
+    WARN("%s: checkpoint object metadata size %d, expect %d\n",
+         cache->cache_name, md_size,
+         (int)(cache->hashtable->obj_struct_size - CACHE_OBJ_HEADER_SIZE));
+    return false;
+  }
+
+  request_t req;
+  memset(&req, 0, sizeof(request_t));
+  checkpoint_obj_t rec;
+  for (int64_t i = 0; i < n_obj; i++) {
+    if (!checkpoint_read(ifile, &rec, sizeof(rec))) return false;
+
+    req.obj_id = rec.obj_id;
+    req.obj_size = rec.obj_size;
+    cache_obj_t *obj = hashtable_insert(cache->hashtable, &req);
+    if (md_size > 0 &&
+        !checkpoint_read(ifile, (char *)obj + CACHE_OBJ_HEADER_SIZE,
+                         md_size)) {
+      return false;
+    }
+#ifdef SUPPORT_TTL
+    obj->exp_time = (uint32_t)rec.exp_time;
+    if (cache->ttl_wheel != NULL && obj->exp_time != 0) {
+      ttl_wheel_add(cache->ttl_wheel, obj->obj_id, (int64_t)obj->exp_time + 1);
+    }
+#endif
+#if defined(TRACK_EVICTION_V_AGE) || defined(TRACK_DEMOTION) || \
+    defined(TRACK_CREATE_TIME)
+    obj->create_time = rec.create_time;
+#endif
+    obj->misc = rec.misc;
+
+    append_obj_to_tail(q_head, q_tail, obj);
+  }
+
+  return true;
+}
+
+bool cache_checkpoint(const cache_t *cache, const reader_t *reader,
+                      const char *path) {
+  if (cache->checkpoint == NULL) {
+    WARN("%s does not support checkpoint\n", cache->cache_name);
+    return false;
+  }
+
+  /* write to a temporary file so that an existing checkpoint is not
+   * replaced by a partial one */
+  char tmp_path[PATH_MAX];
+  snprintf(tmp_path, PATH_MAX, "%s.tmp", path);
+  FILE *ofile = fopen(tmp_path, "wb");
+  if (ofile == NULL) {
+    WARN("cannot open %s: %s\n", tmp_path, strerror(errno));
+    return false;
+  }
+
+  checkpoint_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = CHECKPOINT_MAGIC;
+  header.version = CHECKPOINT_VERSION;
+  header.obj_header_size = (int32_t)CACHE_OBJ_HEADER_SIZE;
+  header.misc_size = (int32_t)sizeof(misc_metadata_t);
+  header.obj_struct_size = (int32_t)cache->hashtable->obj_struct_size;
+  header.cache_size = cache->cache_size;
+  header.default_ttl = cache->default_ttl;
+  memcpy(header.init_params, cache->init_params, CACHE_INIT_PARAMS_LEN);
+  header.n_read_req = reader == NULL ? -1 : (int64_t)reader->n_read_req;
+
+  bool ok = checkpoint_write(ofile, &header, sizeof(header)) &&
+            cache_checkpoint_state(cache, ofile);
+  ok = (fclose(ofile) == 0) && ok;
+
+  if (!ok || rename(tmp_path, path) != 0) {
+    WARN("failed to write checkpoint %s\n", path);
+    remove(tmp_path);
+    return false;
+  }
+
+  INFO("%s checkpointed %ld objects to %s\n", cache->cache_name,
+       (long)cache->get_n_obj(cache), path);
+  return true;
+}
+
+bool cache_restore(cache_t *cache, const char *path, reader_t *reader) {
+  if (cache->restore == NULL) {
+    WARN("%s does not support restore\n", cache->cache_name);
+    return false;
+  }
+  if (cache->hashtable->n_obj != 0) {
+    WARN("restore requires an empty cache, %s has %ld objects\n",
+         cache->cache_name, (long)cache->hashtable->n_obj);
+    return false;
+  }
+
+  FILE *ifile = fopen(path, "rb");
+  if (ifile == NULL) {
+    WARN("cannot open %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  checkpoint_header_t header;
+  if (!checkpoint_read(ifile, &header, sizeof(header)) ||
+      header.magic != CHECKPOINT_MAGIC ||
+      header.version != CHECKPOINT_VERSION) {
+    WARN("%s is not a checkpoint of this version\n", path);
+    fclose(ifile);
+    return false;
+  }
+
+  if (header.obj_header_size != (int32_t)CACHE_OBJ_HEADER_SIZE ||
+      header.misc_size != (int32_t)sizeof(misc_metadata_t) ||
+      header.obj_struct_size != (int32_t)cache->hashtable->obj_struct_size) {
+    WARN("%s is written by a build with a different object layout\n", path);
+    fclose(ifile);
+    return false;
+  }
+
+  if (header.cache_size != cache->cache_size ||
+      header.default_ttl != cache->default_ttl ||
+      strncmp(header.init_params, cache->init_params,
+              CACHE_INIT_PARAMS_LEN) != 0) {
+    WARN("%s is from a cache of size %ld and params \"%.*s\"\n", path,
+         (long)header.cache_size, CACHE_INIT_PARAMS_LEN, header.init_params);
+    fclose(ifile);
+    return false;
+  }
+
+  bool ok = cache_restore_state(cache, ifile);
+  fclose(ifile);
+  if (!ok) {
+    WARN("failed to restore %s from %s\n", cache->cache_name, path);
+    return false;
+  }
+
+  if (reader != NULL && header.n_read_req >= 0) {
+    if (reader_seek_to_req(reader, header.n_read_req) != 0) {
+      WARN("cannot seek %s to request %ld\n", reader->trace_path,
+           (long)header.n_read_req);
+      return false;
+    }
+  }
+
+  INFO("%s restored %ld objects from %s\n", cache->cache_name,
+       (long)cache->get_n_obj(cache), path);
+  return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
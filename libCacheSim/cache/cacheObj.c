@@ -48,6 +48,22 @@ cache_obj_t *create_cache_obj_from_request(const request_t *req) {
   return cache_obj;
 }
 
+/**
+ * create a cache_obj of obj_struct_size bytes from request
+ * @param req
+ * @param obj_struct_size
+ * @return
+ */
+cache_obj_t *create_sized_cache_obj_from_request(const request_t *req,
+                                                 size_t obj_struct_size) {
+  DEBUG_ASSERT(obj_struct_size >= CACHE_OBJ_HEADER_SIZE &&
+               obj_struct_size <= sizeof(cache_obj_t));
+  cache_obj_t *cache_obj = (cache_obj_t *)my_malloc_bytes(obj_struct_size);
+  memset(cache_obj, 0, obj_struct_size);
+  if (req != NULL) copy_request_to_cache_obj(cache_obj, req);
+  return cache_obj;
+}
+
 /** remove the object from the built-in doubly linked list
  *
  * @param head
@@ -0,0 +1,570 @@
+//
+//  FIFO, Clock and S3FIFO caches that can be shared by multiple threads,
+//  see include/libCacheSim/concurrentCache.h for the design
+//
+//  objects are never freed while another thread may read them:
+//  a thread only reads an object while holding its bucket lock,
+//  and the evicting thread removes the object from the hash table
+//  (under the bucket lock) before freeing it
+//
+//  S3FIFO keeps ghost entries in the hash table (marked as ghost) and their
+//  ids in a FIFO that is only accessed under the eviction lock, a ghost hit
+//  turns the ghost entry back into an object in the main queue, the stale id
+//  in the ghost FIFO is skipped when it is dropped
+//
+//  concurrentCache.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/concurrentCache.h"
+
+#include <string.h>
+#include <strings.h>
+
+#include "../dataStructure/hashtable/concurrentHashTable.h"
+#include "../dataStructure/mpscRing.h"
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the rings have room for this many objects beyond max_n_obj, because each
+ * thread can reserve one object before it evicts */
+#define CONCURRENT_RING_HEADROOM 4096
+/* the default bound on the number of objects, the rings and the ghost table
+ * are sized by it, a byte-sized cache holding many small objects evicts on
+ * this bound before the cache is full, use the max-obj parameter to raise it */
+#define CONCURRENT_MAX_N_OBJ_DEFAULT (1LL << 24)
+#define CONCURRENT_LOCK_POWER_DEFAULT 14
+
+typedef enum {
+  /* FIFO, Clock, and the main queue of S3FIFO */
+  CONCURRENT_QUEUE_FIFO = 0,
+  CONCURRENT_QUEUE_SMALL = 1,
+  CONCURRENT_QUEUE_GHOST = 2,
+} concurrent_queue_e;
+
+typedef struct {
+  obj_id_t obj_id;
+  int64_t obj_size;
+} concurrent_ghost_entry_t;
+
+typedef struct {
+  /* FIFO, Clock and the main queue of S3FIFO */
+  mpsc_ring_t *fifo;
+
+  /* S3FIFO only */
+  mpsc_ring_t *small;
+  int64_t small_occupied_byte;
+  int64_t small_size;
+
+  /* the ghost FIFO is only accessed by the thread holding the eviction lock */
+  concurrent_ghost_entry_t *ghost;
+  uint64_t ghost_head;
+  uint64_t ghost_tail;
+  uint64_t ghost_mask;
+  int64_t ghost_occupied_byte;
+  int64_t ghost_size;
+
+  uint8_t max_freq;
+  int n_bit_counter;
+  int move_to_main_threshold;
+  double fifo_size_ratio;
+  double ghost_size_ratio;
+  int lock_power;
+
+  /* evict one object, return false if there is nothing to evict */
+  bool (*evict)(concurrent_cache_t *cache);
+} concurrent_params_t;
+
+static const char *FIFO_DEFAULT_PARAMS = "";
+static const char *Clock_DEFAULT_PARAMS = "n-bit-counter=1";
+static const char *S3FIFO_DEFAULT_PARAMS =
+    "fifo-size-ratio=0.10,ghost-size-ratio=0.90,move-to-main-threshold=2";
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+static concurrent_cache_t *concurrent_cache_struct_init(
+    const char *cache_name, const common_cache_params_t ccache_params,
+    const char *default_params, const char *cache_specific_params);
+static void concurrent_cache_free(concurrent_cache_t *cache);
+static bool concurrent_cache_get(concurrent_cache_t *cache,
+                                 const request_t *req);
+static void concurrent_cache_parse_params(concurrent_cache_t *cache,
+                                          const char *cache_specific_params);
+
+static bool concurrent_FIFO_evict(concurrent_cache_t *cache);
+static bool concurrent_Clock_evict(concurrent_cache_t *cache);
+static bool concurrent_S3FIFO_evict(concurrent_cache_t *cache);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+concurrent_cache_t *concurrent_FIFO_init(
+    const common_cache_params_t ccache_params,
+    const char *cache_specific_params) {
+  concurrent_cache_t *cache = concurrent_cache_struct_init(
+      "concurrent-FIFO", ccache_params, FIFO_DEFAULT_PARAMS,
+      cache_specific_params);
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  /* FIFO does not need the access bits, so a hit does not write */
+  params->max_freq = 0;
+  params->evict = concurrent_FIFO_evict;
+
+  return cache;
+}
+
+concurrent_cache_t *concurrent_Clock_init(
+    const common_cache_params_t ccache_params,
+    const char *cache_specific_params) {
+  concurrent_cache_t *cache = concurrent_cache_struct_init(
+      "concurrent-Clock", ccache_params, Clock_DEFAULT_PARAMS,
+      cache_specific_params);
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  params->max_freq = (uint8_t)((1 << params->n_bit_counter) - 1);
+  params->evict = concurrent_Clock_evict;
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "concurrent-Clock-%d",
+           params->n_bit_counter);
+
+  return cache;
+}
+
+concurrent_cache_t *concurrent_S3FIFO_init(
+    const common_cache_params_t ccache_params,
+    const char *cache_specific_params) {
+  concurrent_cache_t *cache = concurrent_cache_struct_init(
+      "concurrent-S3FIFO", ccache_params, S3FIFO_DEFAULT_PARAMS,
+      cache_specific_params);
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  /* 2-bit counter as in S3FIFO */
+  params->max_freq = 3;
+  params->evict = concurrent_S3FIFO_evict;
+
+  params->small_size = (int64_t)(cache->cache_size * params->fifo_size_ratio);
+  params->ghost_size = (int64_t)(cache->cache_size * params->ghost_size_ratio);
+  params->small =
+      create_mpsc_ring(cache->max_n_obj + CONCURRENT_RING_HEADROOM);
+
+  uint64_t ghost_capacity = next_power_of_2_v2(cache->max_n_obj);
+  params->ghost_mask = ghost_capacity - 1;
+  params->ghost = (concurrent_ghost_entry_t *)calloc(
+      ghost_capacity, sizeof(concurrent_ghost_entry_t));
+  ASSERT_NOT_NULL(params->ghost, "cannot allocate %lu ghost entries\n",
+                  (unsigned long)ghost_capacity);
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN,
+           "concurrent-S3FIFO-%.4lf-%d", params->fifo_size_ratio,
+           params->move_to_main_threshold);
+
+  return cache;
+}
+
+concurrent_cache_t *create_concurrent_cache(
+    const char *cache_alg_name, const common_cache_params_t ccache_params,
+    const char *cache_specific_params) {
+  if (strcasecmp(cache_alg_name, "fifo") == 0) {
+    return concurrent_FIFO_init(ccache_params, cache_specific_params);
+  } else if (strcasecmp(cache_alg_name, "clock") == 0) {
+    return concurrent_Clock_init(ccache_params, cache_specific_params);
+  } else if (strcasecmp(cache_alg_name, "s3fifo") == 0) {
+    return concurrent_S3FIFO_init(ccache_params, cache_specific_params);
+  }
+
+  WARN("%s does not have a concurrent implementation\n", cache_alg_name);
+  return NULL;
+}
+
+/**
+ * @brief initialize the fields shared by all concurrent caches
+ */
+static concurrent_cache_t *concurrent_cache_struct_init(
+    const char *cache_name, const common_cache_params_t ccache_params,
+    const char *default_params, const char *cache_specific_params) {
+  concurrent_cache_t *cache = (concurrent_cache_t *)aligned_alloc(
+      64, sizeof(concurrent_cache_t));
+  ASSERT_NOT_NULL(cache, "cannot allocate concurrent cache\n");
+  memset(cache, 0, sizeof(concurrent_cache_t));
+  strncpy(cache->cache_name, cache_name, CACHE_NAME_ARRAY_LEN - 1);
+  if (cache_specific_params != NULL) {
+    strncpy(cache->init_params, cache_specific_params,
+            CACHE_INIT_PARAMS_LEN - 1);
+  }
+
+  cache->get = concurrent_cache_get;
+  cache->cache_free = concurrent_cache_free;
+  cache->cache_size = (int64_t)ccache_params.cache_size;
+  /* -1 until set by the max-obj parameter */
+  cache->max_n_obj = -1;
+  pthread_mutex_init(&cache->evict_lock, NULL);
+
+  cache->eviction_params = my_malloc(concurrent_params_t);
+  memset(cache->eviction_params, 0, sizeof(concurrent_params_t));
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  params->lock_power = CONCURRENT_LOCK_POWER_DEFAULT;
+
+  concurrent_cache_parse_params(cache, default_params);
+  if (cache_specific_params != NULL) {
+    concurrent_cache_parse_params(cache, cache_specific_params);
+  }
+  if (cache->max_n_obj == -1) {
+    cache->max_n_obj = MIN(cache->cache_size, CONCURRENT_MAX_N_OBJ_DEFAULT);
+    if (cache->cache_size > CONCURRENT_MAX_N_OBJ_DEFAULT) {
+      WARN("%s holds at most %lld objects, use max-obj to change it\n",
+           cache->cache_name, (long long)CONCURRENT_MAX_N_OBJ_DEFAULT);
+    }
+  } else if (cache->max_n_obj <= 0) {
+    ERROR("max-obj must be positive, got %ld\n", (long)cache->max_n_obj);
+  }
+
+  /* the hash table does not grow, hashpower should be large enough to hold
+   * the objects in the cache */
+  int hashpower = HASH_POWER_DEFAULT;
+  if (ccache_params.hashpower > 0 && ccache_params.hashpower < 40)
+    hashpower = ccache_params.hashpower;
+  cache->hashtable = create_concurrent_hashtable(hashpower, params->lock_power);
+  params->fifo = create_mpsc_ring(cache->max_n_obj + CONCURRENT_RING_HEADROOM);
+
+  return cache;
+}
+
+static void concurrent_cache_free(concurrent_cache_t *cache) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  free_mpsc_ring(params->fifo);
+  if (params->small != NULL) free_mpsc_ring(params->small);
+  if (params->ghost != NULL) free(params->ghost);
+  /* all objects, including the ghost entries, are in the hash table */
+  free_concurrent_hashtable(cache->hashtable);
+  pthread_mutex_destroy(&cache->evict_lock);
+  my_free(sizeof(concurrent_params_t), params);
+  free(cache);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  internal functions                           ****
+// ****                                                               ****
+// ***********************************************************************
+static inline bool concurrent_cache_need_eviction(concurrent_cache_t *cache) {
+  return __atomic_load_n(&cache->occupied_byte, __ATOMIC_RELAXED) >
+             cache->cache_size ||
+         __atomic_load_n(&cache->n_obj, __ATOMIC_RELAXED) > cache->max_n_obj;
+}
+
+/**
+ * @brief evict until the cache fits, only one thread evicts at a time
+ */
+static void concurrent_cache_evict_if_needed(concurrent_cache_t *cache) {
+  if (!concurrent_cache_need_eviction(cache)) return;
+
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  pthread_mutex_lock(&cache->evict_lock);
+  /* another thread may have evicted while we were waiting for the lock */
+  while (concurrent_cache_need_eviction(cache)) {
+    /* the objects reserved by other threads are not in the queues yet,
+     * those threads will evict after they push */
+    if (!params->evict(cache)) break;
+  }
+  pthread_mutex_unlock(&cache->evict_lock);
+}
+
+static inline void concurrent_cache_sub_obj(concurrent_cache_t *cache,
+                                            const int64_t obj_size) {
+  __atomic_sub_fetch(&cache->occupied_byte, obj_size, __ATOMIC_RELAXED);
+  __atomic_sub_fetch(&cache->n_obj, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&cache->n_evict, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief remove an object popped from a queue from the hash table and free
+ * it, called with the eviction lock held
+ */
+static void concurrent_cache_evict_obj(concurrent_cache_t *cache,
+                                       concurrent_obj_t *obj) {
+  uint64_t hv = concurrent_hashtable_hv(obj->obj_id);
+  concurrent_hashtable_lock(cache->hashtable, hv);
+  bool deleted = concurrent_hashtable_delete_locked(cache->hashtable, hv, obj);
+  concurrent_hashtable_unlock(cache->hashtable, hv);
+  DEBUG_ASSERT(deleted);
+  (void)deleted;
+
+  concurrent_cache_sub_obj(cache, obj->obj_size);
+  my_free(sizeof(concurrent_obj_t), obj);
+}
+
+/**
+ * @brief the user facing get, can be called by any thread
+ *
+ * ```
+ * if obj in cache:
+ *    set the access bits if they are not saturated
+ *    return true
+ * else:
+ *    insert the object into the hash table
+ *    evict until the cache has space
+ *    push the object into its queue
+ *    return false
+ * ```
+ *
+ * @return true if cache hit, false if cache miss
+ */
+static bool concurrent_cache_get(concurrent_cache_t *cache,
+                                 const request_t *req) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  concurrent_hashtable_t *hashtable = cache->hashtable;
+  uint64_t hv = concurrent_hashtable_hv(req->obj_id);
+
+  concurrent_hashtable_lock(hashtable, hv);
+  concurrent_obj_t *obj =
+      concurrent_hashtable_find_locked(hashtable, hv, req->obj_id);
+  if (obj != NULL && __atomic_load_n(&obj->queue_id, __ATOMIC_RELAXED) !=
+                         CONCURRENT_QUEUE_GHOST) {
+    uint8_t freq = __atomic_load_n(&obj->freq, __ATOMIC_RELAXED);
+    if (freq < params->max_freq) {
+      __atomic_store_n(&obj->freq, freq + 1, __ATOMIC_RELAXED);
+    }
+    concurrent_hashtable_unlock(hashtable, hv);
+    return true;
+  }
+
+  /* S3FIFO inserts into the small queue unless the object is in the ghost */
+  bool use_small = params->small != NULL && obj == NULL;
+  int64_t max_obj_size =
+      params->small != NULL ? params->small_size : cache->cache_size;
+  if ((int64_t)req->obj_size > max_obj_size) {
+    concurrent_hashtable_unlock(hashtable, hv);
+    return false;
+  }
+
+  if (obj == NULL) {
+    obj = my_malloc(concurrent_obj_t);
+    obj->obj_id = req->obj_id;
+    concurrent_hashtable_insert_locked(hashtable, hv, obj);
+  }
+  obj->obj_size = req->obj_size;
+  obj->freq = 0;
+  obj->queue_id = use_small ? CONCURRENT_QUEUE_SMALL : CONCURRENT_QUEUE_FIFO;
+  concurrent_hashtable_unlock(hashtable, hv);
+
+  /* reserve space, then evict before the object enters its queue,
+   * so that it is not chosen to make space for itself */
+  __atomic_add_fetch(&cache->occupied_byte, (int64_t)req->obj_size,
+                     __ATOMIC_RELAXED);
+  __atomic_add_fetch(&cache->n_obj, 1, __ATOMIC_RELAXED);
+  if (use_small) {
+    __atomic_add_fetch(&params->small_occupied_byte, (int64_t)req->obj_size,
+                       __ATOMIC_RELAXED);
+  }
+  concurrent_cache_evict_if_needed(cache);
+
+  mpsc_ring_push(use_small ? params->small : params->fifo, obj);
+  /* other threads cannot evict objects that are not in the queues yet,
+   * so check again in case they gave up */
+  concurrent_cache_evict_if_needed(cache);
+
+  return false;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                    eviction functions                         ****
+// ****                                                               ****
+// ***********************************************************************
+static bool concurrent_FIFO_evict(concurrent_cache_t *cache) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  concurrent_obj_t *obj = (concurrent_obj_t *)mpsc_ring_pop(params->fifo);
+  if (obj == NULL) return false;
+
+  concurrent_cache_evict_obj(cache, obj);
+  return true;
+}
+
+/**
+ * @brief evict from the FIFO ring, objects with access bits are reinserted
+ * with the bits decremented, used by Clock and the main queue of S3FIFO
+ */
+static bool concurrent_Clock_evict(concurrent_cache_t *cache) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  concurrent_obj_t *obj;
+  while ((obj = (concurrent_obj_t *)mpsc_ring_pop(params->fifo)) != NULL) {
+    uint8_t freq = __atomic_load_n(&obj->freq, __ATOMIC_RELAXED);
+    if (freq >= 1) {
+      __atomic_store_n(&obj->freq, freq - 1, __ATOMIC_RELAXED);
+      mpsc_ring_push(params->fifo, obj);
+      continue;
+    }
+
+    concurrent_cache_evict_obj(cache, obj);
+    return true;
+  }
+
+  return false;
+}
+
+static void concurrent_S3FIFO_evict_ghost(concurrent_cache_t *cache) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  DEBUG_ASSERT(params->ghost_head < params->ghost_tail);
+  concurrent_ghost_entry_t *entry =
+      &params->ghost[params->ghost_head++ & params->ghost_mask];
+  params->ghost_occupied_byte -= entry->obj_size;
+
+  /* the entry may have been turned back into an object by a ghost hit */
+  uint64_t hv = concurrent_hashtable_hv(entry->obj_id);
+  concurrent_hashtable_lock(cache->hashtable, hv);
+  concurrent_obj_t *obj =
+      concurrent_hashtable_find_locked(cache->hashtable, hv, entry->obj_id);
+  if (obj != NULL && __atomic_load_n(&obj->queue_id, __ATOMIC_RELAXED) ==
+                         CONCURRENT_QUEUE_GHOST) {
+    concurrent_hashtable_delete_locked(cache->hashtable, hv, obj);
+  } else {
+    obj = NULL;
+  }
+  concurrent_hashtable_unlock(cache->hashtable, hv);
+
+  if (obj != NULL) my_free(sizeof(concurrent_obj_t), obj);
+}
+
+/**
+ * @brief evict an object from the small queue and keep its id in the ghost
+ */
+static void concurrent_S3FIFO_evict_to_ghost(concurrent_cache_t *cache,
+                                             concurrent_obj_t *obj) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  if (obj->obj_size > params->ghost_size) {
+    concurrent_cache_evict_obj(cache, obj);
+    return;
+  }
+
+  obj_id_t obj_id = obj->obj_id;
+  int64_t obj_size = obj->obj_size;
+  uint64_t hv = concurrent_hashtable_hv(obj_id);
+  concurrent_hashtable_lock(cache->hashtable, hv);
+  __atomic_store_n(&obj->queue_id, CONCURRENT_QUEUE_GHOST, __ATOMIC_RELAXED);
+  concurrent_hashtable_unlock(cache->hashtable, hv);
+  /* obj may be reused by a ghost hit from now on */
+  concurrent_cache_sub_obj(cache, obj_size);
+
+  while (params->ghost_tail - params->ghost_head > params->ghost_mask ||
+         params->ghost_occupied_byte + obj_size > params->ghost_size) {
+    concurrent_S3FIFO_evict_ghost(cache);
+  }
+  concurrent_ghost_entry_t *entry =
+      &params->ghost[params->ghost_tail++ & params->ghost_mask];
+  entry->obj_id = obj_id;
+  entry->obj_size = obj_size;
+  params->ghost_occupied_byte += obj_size;
+}
+
+static bool concurrent_S3FIFO_evict_small(concurrent_cache_t *cache) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  concurrent_obj_t *obj;
+  while ((obj = (concurrent_obj_t *)mpsc_ring_pop(params->small)) != NULL) {
+    __atomic_sub_fetch(&params->small_occupied_byte, (int64_t)obj->obj_size,
+                       __ATOMIC_RELAXED);
+    if (__atomic_load_n(&obj->freq, __ATOMIC_RELAXED) >=
+        params->move_to_main_threshold) {
+      __atomic_store_n(&obj->queue_id, CONCURRENT_QUEUE_FIFO,
+                       __ATOMIC_RELAXED);
+      __atomic_store_n(&obj->freq, 0, __ATOMIC_RELAXED);
+      mpsc_ring_push(params->fifo, obj);
+      continue;
+    }
+
+    concurrent_S3FIFO_evict_to_ghost(cache, obj);
+    return true;
+  }
+
+  return false;
+}
+
+static bool concurrent_S3FIFO_evict(concurrent_cache_t *cache) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  int64_t small_byte =
+      __atomic_load_n(&params->small_occupied_byte, __ATOMIC_RELAXED);
+  int64_t main_byte =
+      __atomic_load_n(&cache->occupied_byte, __ATOMIC_RELAXED) - small_byte;
+
+  if (main_byte > cache->cache_size - params->small_size || small_byte == 0) {
+    return concurrent_Clock_evict(cache) ||
+           concurrent_S3FIFO_evict_small(cache);
+  }
+  return concurrent_S3FIFO_evict_small(cache) ||
+         concurrent_Clock_evict(cache);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                parameter set up functions                     ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *concurrent_cache_current_params(concurrent_cache_t *cache) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  static __thread char params_str[256];
+  snprintf(params_str, 256,
+           "max-obj=%ld,lock-power=%d,n-bit-counter=%d,fifo-size-ratio=%.4lf,"
+           "ghost-size-ratio=%.4lf,move-to-main-threshold=%d",
+           (long)cache->max_n_obj, params->lock_power, params->n_bit_counter,
+           params->fifo_size_ratio, params->ghost_size_ratio,
+           params->move_to_main_threshold);
+  return params_str;
+}
+
+static void concurrent_cache_parse_params(concurrent_cache_t *cache,
+                                          const char *cache_specific_params) {
+  concurrent_params_t *params = (concurrent_params_t *)cache->eviction_params;
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "max-obj") == 0) {
+      cache->max_n_obj = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "lock-power") == 0) {
+      params->lock_power = (int)strtol(value, &end, 0);
+    } else if (strcasecmp(key, "n-bit-counter") == 0) {
+      params->n_bit_counter = (int)strtol(value, &end, 0);
+      if (params->n_bit_counter < 1 || params->n_bit_counter > 8) {
+        ERROR("n-bit-counter must be in [1, 8], got %d\n",
+              params->n_bit_counter);
+      }
+    } else if (strcasecmp(key, "fifo-size-ratio") == 0) {
+      params->fifo_size_ratio = strtod(value, NULL);
+    } else if (strcasecmp(key, "ghost-size-ratio") == 0) {
+      params->ghost_size_ratio = strtod(value, NULL);
+    } else if (strcasecmp(key, "move-to-main-threshold") == 0) {
+      params->move_to_main_threshold = atoi(value);
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: %s\n",
+             concurrent_cache_current_params(cache));
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s, example paramters %s\n",
+            cache->cache_name, key, concurrent_cache_current_params(cache));
+      exit(1);
+    }
+  }
+
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
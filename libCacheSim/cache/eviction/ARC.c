@@ -18,6 +18,7 @@
 #include <string.h>
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/checkpoint.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -67,6 +68,8 @@ static cache_obj_t *ARC_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *ARC_to_evict(cache_t *cache, const request_t *req);
 static void ARC_evict(cache_t *cache, const request_t *req);
 static bool ARC_remove(cache_t *cache, const obj_id_t obj_id);
+static bool ARC_checkpoint(const cache_t *cache, FILE *ofile);
+static bool ARC_restore(cache_t *cache, FILE *ifile);
 
 /* internal functions */
 /* this is the case IV in the paper */
@@ -111,6 +114,8 @@ cache_t *ARC_init(const common_cache_params_t ccache_params,
   cache->can_insert = cache_can_insert_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->get_n_obj = cache_get_n_obj_default;
+  cache->checkpoint = ARC_checkpoint;
+  cache->restore = ARC_restore;
 
   if (ccache_params.consider_obj_metadata) {
     // two pointer + ghost metadata
@@ -223,7 +228,7 @@ static cache_obj_t *ARC_find(cache_t *cache, const request_t *req,
   cache_obj_t *obj = cache_find_base(cache, req, update_cache);
 
   if (!update_cache) {
-    return obj->ARC.ghost ? NULL : obj;
+    return (obj == NULL || obj->ARC.ghost) ? NULL : obj;
   }
 
   if (obj == NULL) {
@@ -803,6 +808,52 @@ static bool ARC_get_debug(cache_t *cache, const request_t *req) {
   return false;
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                  checkpoint and restore                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief write p, the list sizes and the four lists, the ghost entries are
+ * in the hash table, but not counted in the number of objects and bytes
+ */
+static bool ARC_checkpoint(const cache_t *cache, FILE *ofile) {
+  const ARC_params_t *params = (const ARC_params_t *)(cache->eviction_params);
+
+  return checkpoint_write(ofile, &params->p, sizeof(double)) &&
+         checkpoint_write(ofile, &params->L1_data_size, sizeof(int64_t)) &&
+         checkpoint_write(ofile, &params->L2_data_size, sizeof(int64_t)) &&
+         checkpoint_write(ofile, &params->L1_ghost_size, sizeof(int64_t)) &&
+         checkpoint_write(ofile, &params->L2_ghost_size, sizeof(int64_t)) &&
+         checkpoint_write(ofile, &params->vtime_last_req_in_ghost,
+                          sizeof(int64_t)) &&
+         checkpoint_queue(cache, params->L1_data_head, ofile) &&
+         checkpoint_queue(cache, params->L1_ghost_head, ofile) &&
+         checkpoint_queue(cache, params->L2_data_head, ofile) &&
+         checkpoint_queue(cache, params->L2_ghost_head, ofile);
+}
+
+static bool ARC_restore(cache_t *cache, FILE *ifile) {
+  ARC_params_t *params = (ARC_params_t *)(cache->eviction_params);
+
+  return checkpoint_read(ifile, &params->p, sizeof(double)) &&
+         checkpoint_read(ifile, &params->L1_data_size, sizeof(int64_t)) &&
+         checkpoint_read(ifile, &params->L2_data_size, sizeof(int64_t)) &&
+         checkpoint_read(ifile, &params->L1_ghost_size, sizeof(int64_t)) &&
+         checkpoint_read(ifile, &params->L2_ghost_size, sizeof(int64_t)) &&
+         checkpoint_read(ifile, &params->vtime_last_req_in_ghost,
+                         sizeof(int64_t)) &&
+         restore_queue(cache, &params->L1_data_head, &params->L1_data_tail,
+                       ifile) &&
+         restore_queue(cache, &params->L1_ghost_head, &params->L1_ghost_tail,
+                       ifile) &&
+         restore_queue(cache, &params->L2_data_head, &params->L2_data_tail,
+                       ifile) &&
+         restore_queue(cache, &params->L2_ghost_head, &params->L2_ghost_tail,
+                       ifile);
+}
+
 #ifdef __cplusplus
 }
 #endif
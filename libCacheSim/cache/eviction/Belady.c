@@ -10,7 +10,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
-#include "../../dataStructure/pqueue.h"
+#include "../../dataStructure/indexedHeap.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -18,8 +18,9 @@ extern "C" {
 #endif
 
 typedef struct Belady_params {
-  /* a priority queue recording the next access time */
-  pqueue_t *pq;
+  /* a heap ordered by the negative next access time, so the top is
+   * the object accessed furthest in the future */
+  indexed_heap_t *heap;
 } Belady_params_t;
 
 // #define EVICT_IMMEDIATELY_IF_NO_FUTURE_ACCESS 1
@@ -69,7 +70,8 @@ cache_t *Belady_init(const common_cache_params_t ccache_params,
   Belady_params_t *params = my_malloc(Belady_params_t);
   cache->eviction_params = params;
 
-  params->pq = pqueue_init((unsigned long)8e6);
+  params->heap =
+      create_indexed_heap(1024, offsetof(cache_obj_t, Belady.heap_pos));
   return cache;
 }
 
@@ -80,12 +82,8 @@ cache_t *Belady_init(const common_cache_params_t ccache_params,
  */
 static void Belady_free(cache_t *cache) {
   Belady_params_t *params = cache->eviction_params;
-  pq_node_t *node = pqueue_pop(params->pq);
-  while (node) {
-    my_free(sizeof(pq_node_t), node);
-    node = pqueue_pop(params->pq);
-  }
-  pqueue_free(params->pq);
+  free_indexed_heap(params->heap);
+  my_free(sizeof(Belady_params_t), params);
 
   cache_struct_free(cache);
 }
@@ -114,7 +112,7 @@ static bool Belady_get(cache_t *cache, const request_t *req) {
   DEBUG_ASSERT(req->next_access_vtime != -2);
   Belady_params_t *params = cache->eviction_params;
 
-  DEBUG_ASSERT(cache->n_obj == params->pq->size - 1);
+  DEBUG_ASSERT(cache->n_obj == params->heap->n_entry);
   bool ret = cache_get_base(cache, req);
 
   return ret;
@@ -148,12 +146,8 @@ static cache_obj_t *Belady_find(cache_t *cache, const request_t *req,
   }
 
   cached_obj->Belady.next_access_vtime = req->next_access_vtime;
-  pqueue_pri_t pri = {.pri = req->next_access_vtime};
-  pqueue_change_priority(params->pq, pri,
-                         (pq_node_t *)(cached_obj->Belady.pq_node));
-  DEBUG_ASSERT(
-      ((pq_node_t *)hashtable_find(cache->hashtable, req)->Belady.pq_node)
-          ->pri.pri == req->next_access_vtime);
+  indexed_heap_update(params->heap, cached_obj,
+                      -(double)req->next_access_vtime, cache->n_req);
 
 #if defined(EVICT_IMMEDIATELY_IF_NO_FUTURE_ACCESS)
   if (req->next_access_vtime == INT64_MAX) {
@@ -183,16 +177,9 @@ static cache_obj_t *Belady_insert(cache_t *cache, const request_t *req) {
 
   cache_obj_t *cached_obj = cache_insert_base(cache, req);
 
-  pq_node_t *node = my_malloc(pq_node_t);
-  node->obj_id = req->obj_id;
-  node->pri.pri = req->next_access_vtime;
-  pqueue_insert(params->pq, (void *)node);
-  cached_obj->Belady.pq_node = node;
   cached_obj->Belady.next_access_vtime = req->next_access_vtime;
-
-  DEBUG_ASSERT(
-      ((pq_node_t *)hashtable_find(cache->hashtable, req)->Belady.pq_node)
-          ->pri.pri == req->next_access_vtime);
+  indexed_heap_push(params->heap, cached_obj, -(double)req->next_access_vtime,
+                    cache->n_req);
 
 #if defined(EVICT_IMMEDIATELY_IF_NO_FUTURE_ACCESS)
   if (req->next_access_vtime == INT64_MAX) {
@@ -216,8 +203,8 @@ static cache_obj_t *Belady_insert(cache_t *cache, const request_t *req) {
 static cache_obj_t *Belady_to_evict(cache_t *cache, __attribute__((unused))
                                                     const request_t *req) {
   Belady_params_t *params = cache->eviction_params;
-  pq_node_t *node = (pq_node_t *)pqueue_peek(params->pq);
-  return hashtable_find_obj_id(cache->hashtable, node->obj_id);
+  const heap_entry_t *entry = indexed_heap_peek(params->heap);
+  return entry == NULL ? NULL : entry->obj;
 }
 
 /**
@@ -231,14 +218,8 @@ static cache_obj_t *Belady_to_evict(cache_t *cache, __attribute__((unused))
 static void Belady_evict(cache_t *cache,
                          __attribute__((unused)) const request_t *req) {
   Belady_params_t *params = cache->eviction_params;
-  pq_node_t *node = (pq_node_t *)pqueue_pop(params->pq);
-
-  cache_obj_t *obj_to_evict =
-      hashtable_find_obj_id(cache->hashtable, node->obj_id);
-  DEBUG_ASSERT(node == obj_to_evict->Belady.pq_node);
-
-  obj_to_evict->Belady.pq_node = NULL;
-  my_free(sizeof(pq_node_t), node);
+  heap_entry_t entry = indexed_heap_pop(params->heap);
+  cache_obj_t *obj_to_evict = entry.obj;
 
   cache_evict_base(cache, obj_to_evict, true);
 }
@@ -247,13 +228,7 @@ static void Belady_remove_obj(cache_t *cache, cache_obj_t *obj) {
   Belady_params_t *params = cache->eviction_params;
   DEBUG_ASSERT(obj != NULL);
 
-  if (obj->Belady.pq_node != NULL) {
-    /* if it is NULL, it means we have deleted the entry in pq before this */
-    pqueue_remove(params->pq, obj->Belady.pq_node);
-    my_free(sizeof(pq_node_t), obj->Belady.pq_node);
-    obj->Belady.pq_node = NULL;
-  }
-
+  indexed_heap_remove(params->heap, obj);
   cache_remove_obj_base(cache, obj, true);
 }
 
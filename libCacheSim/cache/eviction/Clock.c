@@ -11,6 +11,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/checkpoint.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -38,6 +39,8 @@ static cache_obj_t *Clock_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *Clock_to_evict(cache_t *cache, const request_t *req);
 static void Clock_evict(cache_t *cache, const request_t *req);
 static bool Clock_remove(cache_t *cache, const obj_id_t obj_id);
+static bool Clock_checkpoint(const cache_t *cache, FILE *ofile);
+static bool Clock_restore(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -66,7 +69,10 @@ cache_t *Clock_init(const common_cache_params_t ccache_params,
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = Clock_to_evict;
+  cache->checkpoint = Clock_checkpoint;
+  cache->restore = Clock_restore;
   cache->obj_md_size = 0;
+  cache->algo_obj_md_size = sizeof(Clock_obj_metadata_t);
 
 #ifdef USE_BELADY
   snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "Clock_Belady");
@@ -333,6 +339,30 @@ static void Clock_parse_params(cache_t *cache,
   free(old_params_str);
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                  checkpoint and restore                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief write the queue and the rewrite counters, the frequency of each
+ * object is saved with the object
+ */
+static bool Clock_checkpoint(const cache_t *cache, FILE *ofile) {
+  const Clock_params_t *params = (const Clock_params_t *)cache->eviction_params;
+  return checkpoint_queue(cache, params->q_head, ofile) &&
+         checkpoint_write(ofile, &params->n_obj_rewritten, sizeof(int64_t)) &&
+         checkpoint_write(ofile, &params->n_byte_rewritten, sizeof(int64_t));
+}
+
+static bool Clock_restore(cache_t *cache, FILE *ifile) {
+  Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
+  return restore_queue(cache, &params->q_head, &params->q_tail, ifile) &&
+         checkpoint_read(ifile, &params->n_obj_rewritten, sizeof(int64_t)) &&
+         checkpoint_read(ifile, &params->n_byte_rewritten, sizeof(int64_t));
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,6 +10,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/checkpoint.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -32,6 +33,8 @@ static cache_obj_t *FIFO_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *FIFO_to_evict(cache_t *cache, const request_t *req);
 static void FIFO_evict(cache_t *cache, const request_t *req);
 static bool FIFO_remove(cache_t *cache, const obj_id_t obj_id);
+static bool FIFO_checkpoint(const cache_t *cache, FILE *ofile);
+static bool FIFO_restore(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -60,7 +63,10 @@ cache_t *FIFO_init(const common_cache_params_t ccache_params,
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->get_n_obj = cache_get_n_obj_default;
   cache->can_insert = cache_can_insert_default;
+  cache->checkpoint = FIFO_checkpoint;
+  cache->restore = FIFO_restore;
   cache->obj_md_size = 0;
+  cache->algo_obj_md_size = 0;
 
   cache->eviction_params = malloc(sizeof(FIFO_params_t));
   FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
@@ -214,6 +220,25 @@ static bool FIFO_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                  checkpoint and restore                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief write the queue from the head (most recently inserted) to the tail
+ */
+static bool FIFO_checkpoint(const cache_t *cache, FILE *ofile) {
+  const FIFO_params_t *params = (const FIFO_params_t *)cache->eviction_params;
+  return checkpoint_queue(cache, params->q_head, ofile);
+}
+
+static bool FIFO_restore(cache_t *cache, FILE *ifile) {
+  FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  return restore_queue(cache, &params->q_head, &params->q_tail, ifile);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,7 @@ static void set_default_params(GLCache_params_t *params) {
   params->rank_intvl = 0.02;
   params->merge_consecutive_segs = true;
   params->retrain_intvl = 86400;
+  params->train_inline = false;
   params->train_source_y = TRAIN_Y_FROM_ONLINE;
   params->type = LOGCACHE_LEARNED;
 
@@ -53,7 +54,7 @@ const char *GLCache_default_params(void) {
   return "segment-size=100, n-merge=2, "
          "type=learned, rank-intvl=0.02,"
          "merge-consecutive-segs=true, train-source-y=online,"
-         "retrain-intvl=86400";
+         "retrain-intvl=86400, train-mode=async";
 }
 
 static void GLCache_parse_init_params(const char *cache_specific_params,
@@ -76,6 +77,15 @@ static void GLCache_parse_init_params(const char *cache_specific_params,
       params->merge_consecutive_segs = atoi(value);
     } else if (strcasecmp(key, "retrain-intvl") == 0) {
       params->retrain_intvl = atoi(value);
+    } else if (strcasecmp(key, "train-mode") == 0) {
+      if (strcasecmp(value, "async") == 0) {
+        params->train_inline = false;
+      } else if (strcasecmp(value, "inline") == 0) {
+        params->train_inline = true;
+      } else {
+        ERROR("Unknown train-mode %s, support async/inline\n", value);
+        exit(1);
+      }
     } else if (strcasecmp(key, "train-source-y") == 0) {
       if (strcasecmp(value, "online") == 0) {
         params->train_source_y = TRAIN_Y_FROM_ONLINE;
@@ -188,6 +198,7 @@ cache_t *GLCache_init(const common_cache_params_t ccache_params,
   cache->to_evict = NULL;
   cache->evict = GLCache_evict;
   cache->remove = GLCache_remove;
+  cache->support_remove = false;
 
   INFO(
       "%s, %.0lfMB, segment_size %d, training_interval %d, source %d, "
@@ -206,6 +217,8 @@ cache_t *GLCache_init(const common_cache_params_t ccache_params,
  */
 static void GLCache_free(cache_t *cache) {
   GLCache_params_t *params = cache->eviction_params;
+  free_learner(cache);
+
   bucket_t *bkt = &params->train_bucket;
   segment_t *seg = bkt->first_seg, *next_seg;
 
@@ -245,8 +258,11 @@ static void GLCache_free(cache_t *cache) {
           params->learner.valid_x);
   my_free(sizeof(feature_t) * params->learner.valid_matrix_n_row,
           params->learner.valid_y);
-  my_free(sizeof(pred_t) * params->learner.inf_matrix_n_row,
+  my_free(sizeof(feature_t) * params->learner.inf_matrix_n_row *
+              params->learner.n_feature,
           params->learner.inference_x);
+  my_free(sizeof(pred_t) * params->learner.inf_matrix_n_row,
+          params->learner.pred);
 
   my_free(sizeof(GLCache_params_t), params);
   cache_struct_free(cache);
@@ -280,6 +296,7 @@ static bool GLCache_get(cache_t *cache, const request_t *req) {
       params->type == LOGCACHE_ITEM_ORACLE) {
     /* generate training data by taking a snapshot */
     learner_t *l = &params->learner;
+    collect_trained_model(cache);
     if (l->last_train_rtime > 0 &&
         params->curr_rtime - l->last_train_rtime >= params->retrain_intvl + 1) {
       train(cache);
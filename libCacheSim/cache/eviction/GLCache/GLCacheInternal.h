@@ -3,6 +3,7 @@
 #include <xgboost/c_api.h>
 
 #include "../../../include/libCacheSim/cache.h"
+#include "../../../utils/include/bgTask.h"
 #include "const.h"
 
 typedef float feature_t;
@@ -44,13 +45,28 @@ typedef struct {
   int64_t last_hour_window_ts;
 } seg_feature_t;
 
+/* a model being trained, the data is copied into the DMatrix before training
+ * starts, so the background thread only touches the handles here */
+typedef struct train_job {
+  BoosterHandle booster;
+  DMatrixHandle train_dm;
+  DMatrixHandle valid_dm;
+  unsigned int n_train_samples;
+  unsigned int n_valid_samples;
+  int n_trees;
+} train_job_t;
+
 typedef struct learner {
   int64_t last_train_rtime;
 
+  /* training runs on train_task, the model in train_job replaces booster
+   * when the task is collected */
+  bg_task_t train_task;
+  train_job_t train_job;
+
   BoosterHandle booster;   // model
   DMatrixHandle train_dm;  // training data
   DMatrixHandle valid_dm;  // validation data
-  DMatrixHandle inf_dm;    // inference data
 
   /* learner stat */
   int n_train;
@@ -169,6 +185,8 @@ typedef struct seg_sel {
   int32_t ranked_seg_size;  // the malloc-ed size of ranked_segs
                             // (ranked_segs.capacity())
   int32_t ranked_seg_pos;   // the position of the next segment to be evicted
+  int32_t n_sorted_segs;    // ranked_segs[0, n_sorted_segs) are sorted,
+                            // the rest are sorted on demand
 } seg_sel_t;
 
 /* parameters and state related to cache */
@@ -180,6 +198,8 @@ typedef struct {
   // lowest utility) or we merge non-consecutive segments based on ranking
   bool merge_consecutive_segs;
   int retrain_intvl;
+  /* train on the request path so that results are reproducible */
+  bool train_inline;
   train_source_e train_source_y;
   GLCache_type_e type;
   double rank_intvl;
@@ -279,6 +299,12 @@ void seg_hit_update(GLCache_params_t *params, cache_obj_t *cache_obj);
 /************* learning *****************/
 void train(cache_t *cache);
 
+/* install the model if the background training has finished */
+void collect_trained_model(cache_t *cache);
+
+/* wait for the background training and free the models */
+void free_learner(cache_t *cache);
+
 void inference(cache_t *cache);
 
 /************* data preparation *****************/
@@ -269,16 +269,19 @@ static void prepare_training_data_per_package(cache_t *cache) {
   GLCache_params_t *params = cache->eviction_params;
   learner_t *learner = &params->learner;
 
+  train_job_t *job = &learner->train_job;
+
+  /* the data is copied, the matrices can be reused while the model trains */
   safe_call(XGDMatrixCreateFromMat(learner->train_x, learner->n_train_samples,
-                                   learner->n_feature, -2, &learner->train_dm));
+                                   learner->n_feature, -2, &job->train_dm));
 
   safe_call(XGDMatrixCreateFromMat(learner->valid_x, learner->n_valid_samples,
-                                   learner->n_feature, -2, &learner->valid_dm));
+                                   learner->n_feature, -2, &job->valid_dm));
 
-  safe_call(XGDMatrixSetFloatInfo(learner->train_dm, "label", learner->train_y,
+  safe_call(XGDMatrixSetFloatInfo(job->train_dm, "label", learner->train_y,
                                   learner->n_train_samples));
 
-  safe_call(XGDMatrixSetFloatInfo(learner->valid_dm, "label", learner->valid_y,
+  safe_call(XGDMatrixSetFloatInfo(job->valid_dm, "label", learner->valid_y,
                                   learner->n_valid_samples));
 
 #if OBJECTIVE == LTR
@@ -293,9 +296,9 @@ static void prepare_training_data_per_package(cache_t *cache) {
   // safe_call(XGDMatrixSetUIntInfo(learner->train_dm, "group", group,
   // n_group));
 
-  safe_call(XGDMatrixSetUIntInfo(learner->train_dm, "group",
+  safe_call(XGDMatrixSetUIntInfo(job->train_dm, "group",
                                  &learner->n_train_samples, 1));
-  safe_call(XGDMatrixSetUIntInfo(learner->valid_dm, "group",
+  safe_call(XGDMatrixSetUIntInfo(job->valid_dm, "group",
                                  &learner->n_valid_samples, 1));
 #endif
 }
@@ -455,6 +458,8 @@ void prepare_training_data(cache_t *cache) {
 #endif
   learner->n_train_samples = pos_in_train_data;
   learner->n_valid_samples = pos_in_valid_data;
+  learner->train_job.n_train_samples = pos_in_train_data;
+  learner->train_job.n_valid_samples = pos_in_valid_data;
 
   prepare_training_data_per_package(cache);
 #ifdef TRAIN_KEEP_HALF
@@ -24,7 +24,9 @@ static inline void resize_matrix(GLCache_params_t *params, feature_t **x_p,
   *size_p = new_size;
 }
 
-/* calculate the ranking of all segments for eviction */
+/* fill one row of the inference matrix for each (sampled) segment in place,
+ * the rows are in the same order as ranked_segs, segments that are not
+ * sampled are not evicted until the next ranking */
 /* TODO: can sample some segments to improve throughput */
 static int prepare_inference_data(cache_t *cache) {
   GLCache_params_t *params = cache->eviction_params;
@@ -40,46 +42,64 @@ static int prepare_inference_data(cache_t *cache) {
   }
 
   feature_t *x = learner->inference_x;
+  segment_t **ranked_segs = params->seg_sel.ranked_segs;
 
   int n_segs = 0;
   int inv_sample_ratio = MAX(params->n_in_use_segs / N_INFERENCE_DATA, 1);
   int credit = inv_sample_ratio;
-  // printf("%d %d\n", params->n_in_use_segs, inv_sample_ratio);
 
   for (int bi = 0; bi < MAX_N_BUCKET; bi++) {
     segment_t *curr_seg = params->buckets[bi].first_seg;
     for (int si = 0; si < params->buckets[bi].n_in_use_segs; si++) {
       if (--credit == 0) {
+        credit = inv_sample_ratio;
         prepare_one_row(cache, curr_seg, false, &x[learner->n_feature * n_segs],
                         NULL);
-        curr_seg = curr_seg->next_seg;
-        n_segs++;
-
-        credit = inv_sample_ratio;
+        ranked_segs[n_segs++] = curr_seg;
+      } else {
+        curr_seg->pred_utility = INT32_MAX;
       }
+      curr_seg = curr_seg->next_seg;
     }
   }
   DEBUG_ASSERT(inv_sample_ratio > 1 || params->n_in_use_segs == n_segs);
 
-  if (params->learner.n_inference > 0) {
-    safe_call(XGDMatrixFree(learner->inf_dm));
-  }
-  safe_call(XGDMatrixCreateFromMat(learner->inference_x, n_segs,
-                                   learner->n_feature, -2, &learner->inf_dm));
+  return n_segs;
+}
 
-  safe_call(XGDMatrixSetUIntInfo(learner->inf_dm, "group", &n_segs, 1));
+/* predict directly from the dense inference matrix using the array interface,
+ * so that xgboost does not copy the features into a DMatrix */
+static const float *predict_from_dense(learner_t *learner, int n_segs) {
+  char array_interface[256];
+  snprintf(array_interface, sizeof(array_interface),
+           "{\"data\": [%lu, true], \"shape\": [%d, %d], "
+           "\"typestr\": \"<f4\", \"version\": 3}",
+           (unsigned long)(uintptr_t)learner->inference_x, n_segs,
+           learner->n_feature);
+  static const char *config =
+      "{\"type\": 0, \"training\": false, \"iteration_begin\": 0, "
+      "\"iteration_end\": 0, \"strict_shape\": false, \"missing\": -2}";
+
+  const bst_ulong *out_shape;
+  bst_ulong out_dim;
+  const float *pred;
+  safe_call(XGBoosterPredictFromDense(learner->booster, array_interface,
+                                      config, NULL, &out_shape, &out_dim,
+                                      &pred));
+  DEBUG_ASSERT(out_dim == 1 && out_shape[0] == (bst_ulong)n_segs);
 
-  return n_segs;
+  return pred;
 }
 
 void inference_xgboost(cache_t *cache) {
   GLCache_params_t *params = cache->eviction_params;
   learner_t *learner = &params->learner;
+  segment_t **ranked_segs = params->seg_sel.ranked_segs;
 
   int n_segs = prepare_inference_data(cache);
 
   /* pred result stored in xgboost lib */
-  const float *pred;
+  const float *pred = predict_from_dense(learner, n_segs);
 
 #ifdef DUMP_INFERENCE_DATA
   static __thread char filename[24];
@@ -87,64 +107,37 @@ void inference_xgboost(cache_t *cache) {
   FILE *f = fopen(filename, "a");
 #endif
 
-  bst_ulong out_len = 0;
-  // TODO: use XGBoosterPredictFromDense to avoid copy
-  // https://github.com/dmlc/xgboost/blob/36346f8f563ef79bae94604e60483fb0bf4c2661/demo/c-api/inference/inference.c
-  safe_call(XGBoosterPredict(learner->booster, learner->inf_dm, 0, 0, 0,
-                             &out_len, &pred));
-  DEBUG_ASSERT(out_len == n_segs);
-
-  segment_t **ranked_segs = params->seg_sel.ranked_segs;
-
-  n_segs = 0;
-  int inv_sample_ratio = MAX(params->n_in_use_segs / N_INFERENCE_DATA, 1);
-  int credit = inv_sample_ratio;
-
-  for (int bi = 0; bi < MAX_N_BUCKET; bi++) {
-    segment_t *curr_seg = params->buckets[bi].first_seg;
-    for (int si = 0; si < params->buckets[bi].n_in_use_segs; si++) {
-      if (--credit == 0) {
-        credit = inv_sample_ratio;
+  for (int i = 0; i < n_segs; i++) {
+    segment_t *curr_seg = ranked_segs[i];
 #if OBJECTIVE == REG
-        if (pred[n_segs] > 0)
-          curr_seg->pred_utility = pred[n_segs] * 1e6 / curr_seg->n_byte;
-        else if (pred[n_segs] < 0)
-          curr_seg->pred_utility = pred[n_segs] * curr_seg->n_byte;
+    if (pred[i] > 0)
+      curr_seg->pred_utility = pred[i] * 1e6 / curr_seg->n_byte;
+    else if (pred[i] < 0)
+      curr_seg->pred_utility = pred[i] * curr_seg->n_byte;
 #elif OBJECTIVE == LTR
-        // segments with smaller utility (high relevance) are evicted first
-        if (pred[n_segs] > 0) {
-          curr_seg->pred_utility = 1.0 / pred[n_segs];
-        } else {
-          curr_seg->pred_utility = INT32_MAX;
-        }
+    // segments with smaller utility (high relevance) are evicted first
+    if (pred[i] > 0) {
+      curr_seg->pred_utility = 1.0 / pred[i];
+    } else {
+      curr_seg->pred_utility = INT32_MAX;
+    }
 #endif
 
-        if (params->buckets[curr_seg->bucket_id].n_in_use_segs <
-            params->n_merge + 1) {
-          // if the segment is the last segment of a bucket or the bucket does
-          // not have enough segments
-          curr_seg->pred_utility += INT32_MAX / 2;
-        }
-
-        ranked_segs[n_segs] = curr_seg;
-        n_segs++;
-
-      } else {
-        curr_seg->pred_utility = INT32_MAX;
-      }
+    if (params->buckets[curr_seg->bucket_id].n_in_use_segs <
+        params->n_merge + 1) {
+      // if the segment is the last segment of a bucket or the bucket does
+      // not have enough segments
+      curr_seg->pred_utility += INT32_MAX / 2;
+    }
 
 #ifdef DUMP_INFERENCE_DATA
-      fprintf(f, "%d %f/%lf: ", n_segs, pred[n_segs],
-              cal_seg_utility(cache, curr_seg, true));
-      for (int j = 0; j < learner->n_feature; j++) {
-        fprintf(f, "%f,",
-                learner->inference_x[learner->n_feature * n_segs + j]);
-      }
-      fprintf(f, "\n");
-#endif
-
-      curr_seg = curr_seg->next_seg;
+    fprintf(f, "%d %f/%lf: ", i, pred[i],
+            cal_seg_utility(cache, curr_seg, true));
+    for (int j = 0; j < learner->n_feature; j++) {
+      fprintf(f, "%f,", learner->inference_x[learner->n_feature * i + j]);
     }
+    fprintf(f, "\n");
+#endif
   }
 
   params->seg_sel.n_ranked_segs = n_segs;
@@ -30,6 +30,7 @@ void init_seg_sel(cache_t *cache) {
   params->seg_sel.ranked_segs = NULL;
   params->seg_sel.ranked_seg_size = -1;
   params->seg_sel.ranked_seg_pos = 0;
+  params->seg_sel.n_sorted_segs = 0;
 }
 
 void init_obj_sel(cache_t *cache) {
@@ -64,6 +65,8 @@ void init_learner(cache_t *cache) {
 
   l->n_train = -1;
   l->n_inference = 0;
+  bg_task_init(&l->train_task, params->train_inline);
+  memset(&l->train_job, 0, sizeof(train_job_t));
 
   l->train_matrix_n_row = N_MAX_TRAINING_DATA;
   l->train_x = my_malloc_n(feature_t, l->train_matrix_n_row * l->n_feature);
@@ -5,14 +5,25 @@
 #include "../../../utils/include/mymath.h"
 #include "utils.h"
 
+/* segments are ordered by utility, then create time, then the position in
+ * ranked_segs when they are ranked (rank), so that the order does not depend
+ * on the sort algorithm, segments evicted before they are sorted (NULL) are
+ * placed at the end */
 static inline int cmp_seg(const void *p1, const void *p2) {
   segment_t *seg1 = *(segment_t **)p1;
   segment_t *seg2 = *(segment_t **)p2;
 
+  if (seg1 == NULL || seg2 == NULL) {
+    return (seg1 == NULL) - (seg2 == NULL);
+  }
+
   DEBUG_ASSERT(seg1->magic == MAGIC);
 
   if (seg1->pred_utility == seg2->pred_utility) {
-    return seg1->create_rtime - seg2->create_rtime;
+    if (seg1->create_rtime == seg2->create_rtime) {
+      return seg1->rank - seg2->rank;
+    }
+    return seg1->create_rtime < seg2->create_rtime ? -1 : 1;
   }
   // cannot return seg1->pred_utility - seg2->pred_utility because result may be
   // less than 1
@@ -22,6 +33,81 @@ static inline int cmp_seg(const void *p1, const void *p2) {
     return 1;
 }
 
+static inline void swap_seg(segment_t **segs, int i, int j) {
+  segment_t *tmp = segs[i];
+  segs[i] = segs[j];
+  segs[j] = tmp;
+}
+
+/* move the k segments with the lowest utility to segs[0, k) in any order,
+ * quickselect with median-of-three pivot */
+static void select_lowest_segs(segment_t **segs, int n, int k) {
+  int lo = 0, hi = n - 1;
+  while (lo < hi) {
+    int mid = lo + (hi - lo) / 2;
+    if (cmp_seg(&segs[mid], &segs[lo]) < 0) swap_seg(segs, lo, mid);
+    if (cmp_seg(&segs[hi], &segs[lo]) < 0) swap_seg(segs, lo, hi);
+    if (cmp_seg(&segs[hi], &segs[mid]) < 0) swap_seg(segs, mid, hi);
+    segment_t *pivot = segs[mid];
+
+    int i = lo, j = hi;
+    while (i <= j) {
+      while (cmp_seg(&segs[i], &pivot) < 0) i++;
+      while (cmp_seg(&segs[j], &pivot) > 0) j--;
+      if (i <= j) {
+        swap_seg(segs, i, j);
+        i++;
+        j--;
+      }
+    }
+
+    if (k - 1 <= j) {
+      hi = j;
+    } else if (k - 1 >= i) {
+      lo = i;
+    } else {
+      break;
+    }
+  }
+}
+
+/* the number of segments sorted at a time, eviction uses about
+ * rank_intvl of the ranked segments before the next ranking */
+static inline int32_t n_segs_per_sort(GLCache_params_t *params) {
+  return (int32_t)(params->seg_sel.n_ranked_segs * params->rank_intvl * 2) +
+         params->n_merge + 1;
+}
+
+/* make sure ranked_segs[0, n_needed) are sorted, only the prefix is sorted
+ * and the rest are partitioned with quickselect */
+static void sort_ranked_segs(GLCache_params_t *params, int32_t n_needed) {
+  seg_sel_t *ss = &params->seg_sel;
+  n_needed = MIN(n_needed, ss->n_ranked_segs);
+  if (n_needed <= ss->n_sorted_segs) return;
+
+  segment_t **unsorted = ss->ranked_segs + ss->n_sorted_segs;
+  int n_unsorted = ss->n_ranked_segs - ss->n_sorted_segs;
+  int n_to_sort = n_needed - ss->n_sorted_segs;
+  if (n_to_sort < n_unsorted) {
+    select_lowest_segs(unsorted, n_unsorted, n_to_sort);
+  }
+  qsort(unsorted, n_to_sort, sizeof(segment_t *), cmp_seg);
+
+  for (int i = ss->n_sorted_segs; i < ss->n_ranked_segs; i++) {
+    if (ss->ranked_segs[i] != NULL) ss->ranked_segs[i]->rank = i;
+  }
+  ss->n_sorted_segs = n_needed;
+}
+
+/* the segment at pos in ranked order, sort more segments if needed */
+static inline segment_t *ranked_seg_at(GLCache_params_t *params, int32_t pos) {
+  seg_sel_t *ss = &params->seg_sel;
+  if (pos >= ss->n_sorted_segs && pos < ss->n_ranked_segs) {
+    sort_ranked_segs(params, pos + n_segs_per_sort(params));
+  }
+  return ss->ranked_segs[pos];
+}
+
 // check whether there are min_evictable segments to evict
 // consecutive indicates the merge eviction uses consecutive segments in the
 // chain if not, it usees segments in ranked order and may not be consecutive
@@ -125,8 +211,19 @@ void rank_segs(cache_t *cache) {
     params->seg_sel.n_ranked_segs = params->n_in_use_segs;
   }
 
-  qsort(ranked_segs, params->seg_sel.n_ranked_segs, sizeof(segment_t *),
-        cmp_seg);
+  for (int i = 0; i < params->seg_sel.n_ranked_segs; i++) {
+    ranked_segs[i]->rank = i;
+  }
+
+  params->seg_sel.n_sorted_segs = 0;
+  if (params->merge_consecutive_segs) {
+    // eviction only uses the segments with the lowest utility before the
+    // next ranking, so we select and sort them instead of sorting all
+    sort_ranked_segs(params, n_segs_per_sort(params));
+  } else {
+    // the ranked chain of each bucket needs all segments in order
+    sort_ranked_segs(params, params->seg_sel.n_ranked_segs);
+  }
 #ifdef DUMP_INFERENCE
   {
     static __thread char fname[128];
@@ -168,8 +265,11 @@ void rank_segs(cache_t *cache) {
   }
 
   for (int i = 0; i < params->seg_sel.n_ranked_segs; i++) {
-    ranked_segs[i]->rank = i;
+    ranked_segs[i]->next_ranked_seg = NULL;
+  }
+  if (params->merge_consecutive_segs) return;
 
+  for (int i = 0; i < params->seg_sel.n_ranked_segs; i++) {
     bucket_t *bkt = &(params->buckets[ranked_segs[i]->bucket_id]);
     if (bkt->ranked_seg_head == NULL) {
       bkt->ranked_seg_head = ranked_segs[i];
@@ -178,7 +278,6 @@ void rank_segs(cache_t *cache) {
       bkt->ranked_seg_tail->next_ranked_seg = ranked_segs[i];
       bkt->ranked_seg_tail = ranked_segs[i];
     }
-    ranked_segs[i]->next_ranked_seg = NULL;
   }
 }
 
@@ -363,11 +462,11 @@ bucket_t *select_segs_learned(cache_t *cache, segment_t **segs) {
 
   /* choosing n_merge segments with the lowest utility, may not be consecutive
    */
-  segment_t *seg_to_evict = ranked_segs[*ranked_seg_pos_p];
+  segment_t *seg_to_evict = ranked_seg_at(params, *ranked_seg_pos_p);
   // find the segment with the lowest utility
   while (seg_to_evict == NULL && *ranked_seg_pos_p < ss->ranked_seg_size) {
     *ranked_seg_pos_p = *ranked_seg_pos_p + 1;
-    seg_to_evict = ranked_segs[*ranked_seg_pos_p];
+    seg_to_evict = ranked_seg_at(params, *ranked_seg_pos_p);
   }
   // keep the first seg_to_evict in case we cannot find segments to merge, and
   // we need to evict one segment (without retaining)
@@ -394,7 +493,7 @@ bucket_t *select_segs_learned(cache_t *cache, segment_t **segs) {
       return NULL;
     }
     *ranked_seg_pos_p = *ranked_seg_pos_p + 1;
-    seg_to_evict = ranked_segs[*ranked_seg_pos_p];
+    seg_to_evict = ranked_seg_at(params, *ranked_seg_pos_p);
     ranked_segs[*ranked_seg_pos_p] = NULL;
   }
   *ranked_seg_pos_p = (*ranked_seg_pos_p + 1);
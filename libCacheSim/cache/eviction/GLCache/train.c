@@ -19,54 +19,38 @@ static void debug_print_feature_matrix(const DMatrixHandle handle,
   printf("\n");
 }
 
-static void train_xgboost(cache_t *cache) {
-  GLCache_params_t *params = cache->eviction_params;
-  learner_t *learner = &params->learner;
+/* train a model on the background thread, it only uses the handles in job */
+static void train_xgboost(void *arg) {
+  train_job_t *job = (train_job_t *)arg;
 
-  if (learner->n_train != 0) {
-    safe_call(XGBoosterFree(learner->booster));
-    safe_call(XGDMatrixFree(learner->train_dm));
-    safe_call(XGDMatrixFree(learner->valid_dm));
-  }
-
-  prepare_training_data(cache);
-  // debug_print_feature_matrix(learner->train_dm, 20);
-
-  DMatrixHandle eval_dmats[2] = {learner->train_dm, learner->valid_dm};
+  DMatrixHandle eval_dmats[2] = {job->train_dm, job->valid_dm};
   static const char *eval_names[2] = {"train", "valid"};
   const char *eval_result;
   double train_loss, valid_loss, last_valid_loss = 0;
   int n_stable_iter = 0;
 
-  safe_call(XGBoosterCreate(eval_dmats, 1, &learner->booster));
-  safe_call(XGBoosterSetParam(learner->booster, "booster", "gbtree"));
-  safe_call(XGBoosterSetParam(learner->booster, "verbosity", "1"));
-  safe_call(XGBoosterSetParam(learner->booster, "nthread", "1"));
+  safe_call(XGBoosterCreate(eval_dmats, 1, &job->booster));
+  safe_call(XGBoosterSetParam(job->booster, "booster", "gbtree"));
+  safe_call(XGBoosterSetParam(job->booster, "verbosity", "1"));
+  safe_call(XGBoosterSetParam(job->booster, "nthread", "1"));
 #if OBJECTIVE == REG
-  safe_call(
-      XGBoosterSetParam(learner->booster, "objective", "reg:squarederror"));
+  safe_call(XGBoosterSetParam(job->booster, "objective", "reg:squarederror"));
 #elif OBJECTIVE == LTR
-  safe_call(XGBoosterSetParam(learner->booster, "objective", "rank:pairwise"));
+  safe_call(XGBoosterSetParam(job->booster, "objective", "rank:pairwise"));
 #endif
 
   for (int i = 0; i < N_TRAIN_ITER; ++i) {
     // Update the model performance for each iteration
-    safe_call(XGBoosterUpdateOneIter(learner->booster, i, learner->train_dm));
-    if (learner->n_valid_samples < 10) continue;
-    safe_call(XGBoosterEvalOneIter(learner->booster, i, eval_dmats, eval_names,
-                                   2, &eval_result));
+    safe_call(XGBoosterUpdateOneIter(job->booster, i, job->train_dm));
+    if (job->n_valid_samples < 10) continue;
+    safe_call(XGBoosterEvalOneIter(job->booster, i, eval_dmats, eval_names, 2,
+                                   &eval_result));
 #if OBJECTIVE == REG
     char *train_pos = strstr(eval_result, "train-rmse:") + 11;
     char *valid_pos = strstr(eval_result, "valid-rmse") + 11;
     train_loss = strtof(train_pos, NULL);
     valid_loss = strtof(valid_pos, NULL);
 
-    // DEBUG("%.2lf hour, cache size %.2lf MB, iter %d, train loss %.4lf, valid
-    // loss %.4lf\n",
-    //     (double) params->curr_rtime / 3600.0,
-    //     (double) cache->cache_size / 1024.0 / 1024.0,
-    //     i, train_loss, valid_loss);
-
     if (fabs(last_valid_loss - valid_loss) / valid_loss < 0.01) {
       n_stable_iter += 1;
       if (n_stable_iter > 2) {
@@ -85,8 +69,26 @@ static void train_xgboost(cache_t *cache) {
 #endif
   }
 #ifndef __APPLE__
-  safe_call(XGBoosterBoostedRounds(learner->booster, &learner->n_trees));
+  safe_call(XGBoosterBoostedRounds(job->booster, &job->n_trees));
 #endif
+}
+
+/* replace the model used for inference with the trained one */
+static void install_model(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  learner_t *learner = &params->learner;
+  train_job_t *job = &learner->train_job;
+
+  if (learner->n_train != 0) {
+    safe_call(XGBoosterFree(learner->booster));
+    safe_call(XGDMatrixFree(learner->train_dm));
+    safe_call(XGDMatrixFree(learner->valid_dm));
+  }
+
+  learner->booster = job->booster;
+  learner->train_dm = job->train_dm;
+  learner->valid_dm = job->valid_dm;
+  learner->n_trees = job->n_trees;
 
   DEBUG(
       "%.2lf hour, cache size %.2lf MB, vtime %ld, train/valid %d/%d samples, "
@@ -94,8 +96,8 @@ static void train_xgboost(cache_t *cache) {
       "rank intvl %.4lf\n",
       (double)params->curr_rtime / 3600.0,
       (double)cache->cache_size / 1024.0 / 1024.0, (long)params->curr_vtime,
-      (int)learner->n_train_samples, (int)learner->n_valid_samples,
-      learner->n_trees, params->rank_intvl);
+      (int)job->n_train_samples, (int)job->n_valid_samples, learner->n_trees,
+      params->rank_intvl);
 
 #ifdef DUMP_MODEL
   {
@@ -105,12 +107,48 @@ static void train_xgboost(cache_t *cache) {
     INFO("dump model %s\n", s);
   }
 #endif
+
+  memset(job, 0, sizeof(train_job_t));
+  learner->n_train += 1;
+}
+
+void collect_trained_model(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+
+  if (bg_task_try_collect(&params->learner.train_task)) {
+    install_model(cache);
+  }
 }
 
+void free_learner(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  if (bg_task_wait(&learner->train_task)) {
+    install_model(cache);
+  }
+
+  if (learner->n_train > 0) {
+    safe_call(XGBoosterFree(learner->booster));
+    safe_call(XGDMatrixFree(learner->train_dm));
+    safe_call(XGDMatrixFree(learner->valid_dm));
+  }
+}
+
+/**
+ * @brief snapshot the training data and train a new model, the model is
+ * trained in the background and installed by collect_trained_model,
+ * or before returning if train-mode=inline
+ */
 void train(cache_t *cache) {
   GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  /* the previous model must be installed before training the next one */
+  if (bg_task_wait(&learner->train_task)) {
+    install_model(cache);
+  }
 
-  uint64_t start_time = gettime_usec();
 #ifdef LOAD_MODEL
   {
     static __thread char s[128];
@@ -119,14 +157,15 @@ void train(cache_t *cache) {
     safe_call(XGBoosterLoadModel(learner->booster, s));
     INFO("Load model %s\n", s);
   }
+  learner->n_train += 1;
 #else
-  train_xgboost(cache);
+  prepare_training_data(cache);
+  // debug_print_feature_matrix(learner->train_job.train_dm, 20);
+  bg_task_submit(&learner->train_task, train_xgboost, &learner->train_job);
+  collect_trained_model(cache);
 #endif
 
-  uint64_t end_time = gettime_usec();
-  // INFO("training time %.4lf sec\n", (end_time - start_time) / 1000000.0);
-  params->learner.n_train += 1;
-  params->learner.last_train_rtime = params->curr_rtime;
-  params->learner.n_train_samples = 0;
-  params->learner.n_valid_samples = 0;
+  learner->last_train_rtime = params->curr_rtime;
+  learner->n_train_samples = 0;
+  learner->n_valid_samples = 0;
 }
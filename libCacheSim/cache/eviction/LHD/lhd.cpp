@@ -2,6 +2,7 @@
 
 #include <sstream>
 
+#include "../../../dataStructure/hashtable/hashtable.h"
 #include "../../../utils/include/mymath.h"
 #include "constants.hpp"
 
@@ -11,7 +12,7 @@ LHD::LHD(int _associativity, int _admissions, cache_t* _cache)
     : ASSOCIATIVITY(_associativity),
       ADMISSIONS(_admissions),
       cache(_cache),
-      recentlyAdmitted(ADMISSIONS, INVALID_CANDIDATE) {
+      recentlyAdmitted(ADMISSIONS, INVALID_OBJ_ID) {
   nextReconfiguration = ACCS_PER_RECONFIGURATION;
   explorerBudget = cache->cache_size * EXPLORER_BUDGET_FRACTION;
 
@@ -32,8 +33,8 @@ LHD::LHD(int _associativity, int _admissions, cache_t* _cache)
   }
 }
 
-candidate_t LHD::rank(const request_t* req) {
-  uint64_t victim = -1;
+cache_obj_t* LHD::rank(const request_t* req) {
+  cache_obj_t* victim = NULL;
   rank_t victimRank = std::numeric_limits<rank_t>::max();
 
   // Sample few candidates early in the trace so that we converge
@@ -45,87 +46,78 @@ candidate_t LHD::rank(const request_t* req) {
   uint32_t candidates = (numReconfigurations > 50) ? ASSOCIATIVITY : 8;
 
   for (uint32_t i = 0; i < candidates; i++) {
-    auto idx = next_rand() % tags.size();
-    auto& tag = tags[idx];
-    rank_t rank = getHitDensity(tag);
+    auto idx = next_rand() % objs.size();
+    cache_obj_t* obj = objs[idx];
+    rank_t rank = getHitDensity(obj);
 
     if (rank < victimRank) {
-      victim = idx;
+      victim = obj;
       victimRank = rank;
     }
   }
 
   for (uint32_t i = 0; i < ADMISSIONS; i++) {
-    auto itr = indices.find(recentlyAdmitted[i]);
-    if (itr == indices.end()) {
+    cache_obj_t* obj =
+        hashtable_find_obj_id(cache->hashtable, recentlyAdmitted[i]);
+    if (obj == NULL) {
       continue;
     }
 
-    auto idx = itr->second;
-    auto& tag = tags[idx];
-    assert(tag.id == recentlyAdmitted[i]);
-    rank_t rank = getHitDensity(tag);
+    assert(objs[obj->LHD.sample_idx] == obj);
+    rank_t rank = getHitDensity(obj);
 
     if (rank < victimRank) {
-      victim = idx;
+      victim = obj;
       victimRank = rank;
     }
   }
 
-  assert(victim != (uint64_t)-1);
+  assert(victim != NULL);
 
   ewmaVictimHitDensity =
       EWMA_DECAY * ewmaVictimHitDensity + (1 - EWMA_DECAY) * victimRank;
 
-  return tags[victim].id;
+  return victim;
 }
 
-void LHD::update(candidate_t id, const request_t* req) {
-  auto itr = indices.find(id);
-  bool insert = (itr == indices.end());
-
-  Tag* tag;
+void LHD::update(cache_obj_t* obj, const request_t* req, bool insert) {
   if (insert) {
-    tags.push_back(Tag{});
-    tag = &tags.back();
-    indices[id] = tags.size() - 1;
+    obj->LHD.sample_idx = (int32_t)objs.size();
+    objs.push_back(obj);
 
-    tag->lastLastHitAge = MAX_AGE;
-    tag->lastHitAge = 0;
-    tag->id = id;
+    obj->LHD.last_last_hit_age = MAX_AGE;
+    obj->LHD.last_hit_age = 0;
   } else {
-    tag = &tags[itr->second];
-    assert(tag->id == id);
-    auto age = getAge(*tag);
-    auto& cl = getClass(*tag);
+    assert(objs[obj->LHD.sample_idx] == obj);
+    auto age = getAge(obj);
+    auto& cl = getClass(obj);
     cl.hits[age] += 1;
 
-    if (tag->explorer) {
-      explorerBudget += tag->size;
+    if (obj->LHD.explorer) {
+      explorerBudget += (rank_t)obj->obj_size;
     }
 
-    tag->lastLastHitAge = tag->lastHitAge;
-    tag->lastHitAge = age;
+    obj->LHD.last_last_hit_age = obj->LHD.last_hit_age;
+    obj->LHD.last_hit_age = age;
   }
 
-  tag->timestamp = timestamp;
-  tag->app = DEFAULT_APP_ID % APP_CLASSES;
-  tag->size = req->obj_size;
+  obj->LHD.timestamp = timestamp;
+  obj->LHD.app = DEFAULT_APP_ID % APP_CLASSES;
 
   // with some probability, some candidates will never be evicted
   // ... but limit how many resources we spend on doing this
   bool explore = (next_rand() % EXPLORE_INVERSE_PROBABILITY) == 0;
   if (explore && explorerBudget > 0 && numReconfigurations < 50) {
-    tag->explorer = true;
-    explorerBudget -= tag->size;
+    obj->LHD.explorer = true;
+    explorerBudget -= (rank_t)req->obj_size;
   } else {
-    tag->explorer = false;
+    obj->LHD.explorer = false;
   }
 
   // If this candidate looks like something that should be
   // evicted, track it.
-  if (insert && !explore && getHitDensity(*tag) < ewmaVictimHitDensity) {
-    recentlyAdmitted[recentlyAdmittedHead++ % ADMISSIONS] = id;
+  if (insert && !explore && getHitDensity(obj) < ewmaVictimHitDensity) {
+    recentlyAdmitted[recentlyAdmittedHead++ % ADMISSIONS] = obj->obj_id;
   }
 
   ++timestamp;
@@ -137,30 +129,27 @@ void LHD::update(candidate_t id, const request_t* req) {
   }
 }
 
-void LHD::replaced(candidate_t id) {
-  auto itr = indices.find(id);
-  assert(itr != indices.end());
-  auto index = itr->second;
-
+void LHD::replaced(cache_obj_t* obj) {
   // Record stats before removing item
-  auto& tag = tags[index];
-  assert(tag.id == id);
-  auto age = getAge(tag);
-  auto& cl = getClass(tag);
+  auto age = getAge(obj);
+  auto& cl = getClass(obj);
   cl.evictions[age] += 1;
 
-  if (tag.explorer) {
-    explorerBudget += tag.size;
+  if (obj->LHD.explorer) {
+    explorerBudget += (rank_t)obj->obj_size;
   }
 
-  // Remove tag for replaced item and update index
-  indices.erase(itr);
-  tags[index] = tags.back();
-  tags.pop_back();
+  removed(obj);
+}
 
-  if (index < tags.size()) {
-    indices[tags[index].id] = index;
-  }
+void LHD::removed(cache_obj_t* obj) {
+  // move the last object into the hole to keep objs dense
+  int32_t idx = obj->LHD.sample_idx;
+  assert(objs[idx] == obj);
+  cache_obj_t* last = objs.back();
+  objs[idx] = last;
+  last->LHD.sample_idx = idx;
+  objs.pop_back();
 }
 
 void LHD::reconfigure() {
@@ -243,7 +232,7 @@ void LHD::dumpClassRanks(Class& cl) {
 
   // float objectAvgSize = cl.sizeAccumulator / cl.totalHits; // +
   // cl.totalEvictions);
-  float objectAvgSize = 1. * cache->occupied_byte / sizeMap.size();
+  float objectAvgSize = 1. * cache->occupied_byte / objs.size();
   rank_t left;
 
   left = cl.totalHits + cl.totalEvictions;
@@ -300,7 +289,7 @@ void LHD::adaptAgeCoarsening() {
   ewmaNumObjects *= EWMA_DECAY;
   ewmaNumObjectsMass *= EWMA_DECAY;
 
-  ewmaNumObjects += sizeMap.size();
+  ewmaNumObjects += objs.size();
   ewmaNumObjectsMass += 1.;
 
   rank_t numObjects = ewmaNumObjects / ewmaNumObjectsMass;
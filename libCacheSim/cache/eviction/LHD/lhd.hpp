@@ -17,17 +17,8 @@ class LHD {
   typedef uint64_t age_t;
   typedef float rank_t;
 
-  // info we track about each object
-  struct Tag {
-    age_t timestamp;
-    age_t lastHitAge;
-    age_t lastLastHitAge;
-    uint32_t app;
-
-    candidate_t id;
-    rank_t size;  // stored redundantly with cache
-    bool explorer;
-  };
+  // the info we track about each object is stored in obj->LHD
+  // (LHD_obj_metadata_t), the size is obj->obj_size
 
   // info we track about each class of objects
   struct Class {
@@ -42,22 +33,24 @@ class LHD {
   LHD(int _associativity, int _admissions, cache_t *cache);
   ~LHD() {}
 
-  // called whenever and object is referenced
-  void update(candidate_t id, const request_t *req);
+  // called whenever and object is referenced, obj->obj_size is the size
+  // before this request
+  void update(cache_obj_t *obj, const request_t *req, bool insert);
 
   // called when an object is evicted
-  void replaced(candidate_t id);
+  void replaced(cache_obj_t *obj);
+
+  // called when an object is removed by the user
+  void removed(cache_obj_t *obj);
 
   // called to find a victim upon a cache miss
-  candidate_t rank(const request_t *req);
+  cache_obj_t *rank(const request_t *req);
 
   void dumpStats(LHDCache::Cache *cache) {}
 
-  std::unordered_map<candidate_t, uint32_t> sizeMap;
-  // object metadata; indices maps object id -> metadata
-  std::vector<Tag> tags;
+  // the cached objects, sampled for eviction, obj->LHD.sample_idx is the index
+  std::vector<cache_obj_t *> objs;
   std::vector<Class> classes;
-  std::unordered_map<candidate_t, uint64_t> indices;
 
  private:
   // CONSTANTS ///////////////////////////
@@ -94,6 +87,8 @@ class LHD {
   static constexpr timestamp_t ACCS_PER_RECONFIGURATION = (1 << 20);
   static constexpr rank_t EWMA_DECAY = 0.9;
 
+  static constexpr obj_id_t INVALID_OBJ_ID = UINT64_MAX;
+
   // verbose debugging output?
   static constexpr bool DUMP_RANKS = false;
 
@@ -122,7 +117,7 @@ class LHD {
   //  misc::Rand rand;
 
   // see ADMISSIONS above
-  std::vector<candidate_t> recentlyAdmitted;
+  std::vector<obj_id_t> recentlyAdmitted;
   int recentlyAdmittedHead = 0;
   rank_t ewmaVictimHitDensity = 0;
 
@@ -143,37 +138,37 @@ class LHD {
     return log;
   }
 
-  inline uint32_t getClassId(const Tag &tag) const {
-    uint32_t hitAgeId = hitAgeClass(tag.lastHitAge + tag.lastLastHitAge);
-    // uint32_t hitAgeId = hitAgeClass(tag.lastHitAge);
-    return tag.app * HIT_AGE_CLASSES + hitAgeId;
+  inline uint32_t getClassId(const cache_obj_t *obj) const {
+    uint32_t hitAgeId = hitAgeClass((age_t)obj->LHD.last_hit_age +
+                                    (age_t)obj->LHD.last_last_hit_age);
+    // uint32_t hitAgeId = hitAgeClass(obj->LHD.last_hit_age);
+    return obj->LHD.app * HIT_AGE_CLASSES + hitAgeId;
   }
 
-  inline uint32_t getClassIdBySize(const Tag &tag) const {
-    uint32_t hitSizeId = 0;
-    uint64_t size = (uint64_t)tag.size;
-    return tag.app * HIT_AGE_CLASSES + ((uint64_t)log(size)) % HIT_AGE_CLASSES;
+  inline uint32_t getClassIdBySize(const cache_obj_t *obj) const {
+    uint64_t size = (uint64_t)obj->obj_size;
+    return obj->LHD.app * HIT_AGE_CLASSES +
+           ((uint64_t)log(size)) % HIT_AGE_CLASSES;
   }
 
-  inline uint32_t getClassIdBySizeAndAge(const Tag &tag) const {
-    if (tag.lastHitAge == 0) return getClassIdBySize(tag);
+  inline uint32_t getClassIdBySizeAndAge(const cache_obj_t *obj) const {
+    if (obj->LHD.last_hit_age == 0) return getClassIdBySize(obj);
 
-    uint32_t hitSizeId = 0;
-    uint64_t size = (uint64_t)tag.size;
-    return tag.app * HIT_AGE_CLASSES +
-           ((uint64_t)log(size) + (uint64_t)log(tag.lastHitAge)) %
+    uint64_t size = (uint64_t)obj->obj_size;
+    return obj->LHD.app * HIT_AGE_CLASSES +
+           ((uint64_t)log(size) + (uint64_t)log(obj->LHD.last_hit_age)) %
                HIT_AGE_CLASSES;
   }
 
-  inline Class &getClass(const Tag &tag) {
-    // return classes[getClassIdBySizeAndAge(tag)];
-    // return classes[getClassIdBySize(tag)];
-    return classes[getClassId(tag)];
+  inline Class &getClass(const cache_obj_t *obj) {
+    // return classes[getClassIdBySizeAndAge(obj)];
+    // return classes[getClassIdBySize(obj)];
+    return classes[getClassId(obj)];
   }
 
-  inline age_t getAge(Tag tag) {
+  inline age_t getAge(const cache_obj_t *obj) {
     timestamp_t age =
-        (timestamp - (timestamp_t)tag.timestamp) >> ageCoarseningShift;
+        (timestamp - (timestamp_t)obj->LHD.timestamp) >> ageCoarseningShift;
 
     if (age >= MAX_AGE) {
       ++overflows;
@@ -183,18 +178,18 @@ class LHD {
     }
   }
 
-  inline rank_t getHitDensity(const Tag &tag) {
-    auto age = getAge(tag);
+  inline rank_t getHitDensity(const cache_obj_t *obj) {
+    auto age = getAge(obj);
     if (age == MAX_AGE - 1) {
       return std::numeric_limits<rank_t>::lowest();
     }
-    auto &cl = getClass(tag);
+    auto &cl = getClass(obj);
 #ifdef BYTE_MISS_RATIO
     rank_t density = cl.hitDensities[age];
 #else
-    rank_t density = cl.hitDensities[age] / tag.size;
+    rank_t density = cl.hitDensities[age] / (rank_t)obj->obj_size;
 #endif
-    if (tag.explorer) {
+    if (obj->LHD.explorer) {
       density += 1.;
     }
     return density;
@@ -19,13 +19,12 @@ extern "C" {
 typedef struct {
   void *LRB_cache;
   char *objective;
+  bool train_inline;
   SimpleRequest lrb_req;
-
-  pair<uint64_t, uint32_t> to_evict_pair;
-  cache_obj_t obj_tmp;
 } LRB_params_t;
 
-static const char *DEFAULT_PARAMS = "objective=byte-miss-ratio";
+static const char *DEFAULT_PARAMS =
+    "objective=byte-miss-ratio, train-mode=async";
 
 // ***********************************************************************
 // ****                                                               ****
@@ -42,8 +41,6 @@ static cache_obj_t *LRB_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *LRB_to_evict(cache_t *cache, const request_t *req);
 static void LRB_evict(cache_t *cache, const request_t *req);
 static bool LRB_remove(cache_t *cache, const obj_id_t obj_id);
-static int64_t LRB_get_occupied_byte(const cache_t *cache);
-static int64_t LRB_get_n_obj(const cache_t *cache);
 
 static void LRB_parse_params(cache_t *cache, const char *cache_specific_params);
 
@@ -80,10 +77,9 @@ cache_t *LRB_init(const common_cache_params_t ccache_params,
   cache->to_evict = LRB_to_evict;
   cache->remove = LRB_remove;
   cache->can_insert = cache_can_insert_default;
-  cache->get_occupied_byte = LRB_get_occupied_byte;
-  cache->get_n_obj = LRB_get_n_obj;
-  cache->to_evict_candidate =
-      static_cast<cache_obj_t *>(malloc(sizeof(cache_obj_t)));
+  cache->get_occupied_byte = cache_get_occupied_byte_default;
+  cache->get_n_obj = cache_get_n_obj_default;
+  cache->algo_obj_md_size = sizeof(LRB_obj_metadata_t);
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 180;
@@ -95,10 +91,9 @@ cache_t *LRB_init(const common_cache_params_t ccache_params,
   memset(params, 0, sizeof(LRB_params_t));
   cache->eviction_params = params;
 
+  LRB_parse_params(cache, DEFAULT_PARAMS);
   if (cache_specific_params != NULL) {
     LRB_parse_params(cache, cache_specific_params);
-  } else {
-    LRB_parse_params(cache, DEFAULT_PARAMS);
   }
 
   auto *lrb = new lrb::LRBCache();
@@ -109,6 +104,7 @@ cache_t *LRB_init(const common_cache_params_t ccache_params,
   std::map<string, string> params_map;
 
   params_map["objective"] = params->objective;
+  params_map["train_mode"] = params->train_inline ? "inline" : "async";
 
   if (strcmp(params->objective, "object-miss-ratio") == 0) {
     snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "%s", "LRB-OMR");
@@ -132,7 +128,6 @@ static void LRB_free(cache_t *cache) {
   auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
   auto *LRB = static_cast<lrb::LRBCache *>(params->LRB_cache);
   delete LRB;
-  free(cache->to_evict_candidate);
   my_free(sizeof(LRB_params_t), params);
   cache_struct_free(cache);
 }
@@ -181,19 +176,15 @@ static cache_obj_t *LRB_find(cache_t *cache, const request_t *req,
   auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
   auto *lrb = static_cast<lrb::LRBCache *>(params->LRB_cache);
 
+  cache_obj_t *obj = cache_find_base(cache, req, update_cache);
   if (!update_cache) {
-    bool is_hit = lrb->exist(static_cast<int64_t>(req->obj_id));
-    return is_hit ? reinterpret_cast<cache_obj_t *>(0x1) : NULL;
+    return obj;
   }
 
   params->lrb_req.reinit(cache->n_req, req->obj_id, req->obj_size, nullptr);
-  bool is_hit = lrb->lookup(params->lrb_req);
+  lrb->lookup(params->lrb_req, obj);
 
-  if (is_hit) {
-    return reinterpret_cast<cache_obj_t *>(0x1);
-  } else {
-    return NULL;
-  }
+  return obj;
 }
 
 /**
@@ -210,11 +201,12 @@ static cache_obj_t *LRB_find(cache_t *cache, const request_t *req,
 static cache_obj_t *LRB_insert(cache_t *cache, const request_t *req) {
   auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
   auto *lrb = static_cast<lrb::LRBCache *>(params->LRB_cache);
-  params->lrb_req.reinit(cache->n_req, req->obj_id, req->obj_size, nullptr);
 
-  lrb->admit(params->lrb_req);
+  cache_obj_t *obj = cache_insert_base(cache, req);
+  params->lrb_req.reinit(cache->n_req, req->obj_id, req->obj_size, nullptr);
+  lrb->admit(params->lrb_req, obj);
 
-  return reinterpret_cast<cache_obj_t *>(0x1);
+  return obj;
 }
 
 /**
@@ -232,15 +224,8 @@ static cache_obj_t *LRB_to_evict(cache_t *cache, const request_t *req) {
   auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
   auto *lrb = static_cast<lrb::LRBCache *>(params->LRB_cache);
 
-  params->to_evict_pair = lrb->rank();
-  auto &meta = lrb->in_cache_metas[params->to_evict_pair.second];
-
-  params->obj_tmp.obj_id = params->to_evict_pair.first;
-  params->obj_tmp.obj_size = meta._size;
-
-  cache->to_evict_candidate = &params->obj_tmp;
+  cache->to_evict_candidate = lrb->rank();
   cache->to_evict_candidate_gen_vtime = cache->n_req;
-
   return cache->to_evict_candidate;
 }
 
@@ -257,12 +242,16 @@ static void LRB_evict(cache_t *cache, const request_t *req) {
   auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
   auto *lrb = static_cast<lrb::LRBCache *>(params->LRB_cache);
 
+  cache_obj_t *victim;
   if (cache->to_evict_candidate_gen_vtime == cache->n_req) {
-    lrb->evict_with_candidate(params->to_evict_pair);
+    victim = cache->to_evict_candidate;
     cache->to_evict_candidate_gen_vtime = -1;
   } else {
-    lrb->evict();
+    victim = lrb->rank();
   }
+
+  lrb->evict(victim);
+  cache_evict_base(cache, victim, true);
 }
 
 /**
@@ -279,25 +268,18 @@ static void LRB_evict(cache_t *cache, const request_t *req) {
  * cache
  */
 static bool LRB_remove(cache_t *cache, const obj_id_t obj_id) {
-  auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
-  auto *LRB = static_cast<lrb::LRBCache *>(params->LRB_cache);
-
-  ERROR("do not support remove");
-  return true;
-}
-
-static int64_t LRB_get_n_obj(const cache_t *cache) {
   auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
   auto *lrb = static_cast<lrb::LRBCache *>(params->LRB_cache);
 
-  return lrb->in_cache_metas.size();
-}
+  cache_obj_t *obj = hashtable_find_obj_id(cache->hashtable, obj_id);
+  if (obj == NULL) {
+    return false;
+  }
 
-static int64_t LRB_get_occupied_byte(const cache_t *cache) {
-  auto *params = static_cast<LRB_params_t *>(cache->eviction_params);
-  auto *lrb = static_cast<lrb::LRBCache *>(params->LRB_cache);
+  lrb->remove(obj);
+  cache_remove_obj_base(cache, obj, true);
 
-  return lrb->_currentSize;
+  return true;
 }
 
 // ***********************************************************************
@@ -307,7 +289,9 @@ static int64_t LRB_get_occupied_byte(const cache_t *cache) {
 // ***********************************************************************
 static const char *LRB_current_params(cache_t *cache, LRB_params_t *params) {
   static __thread char params_str[128];
-  int n = snprintf(params_str, 128, "objective=%s", params->objective);
+  int n = snprintf(params_str, 128, "objective=%s, train-mode=%s",
+                   params->objective,
+                   params->train_inline ? "inline" : "async");
 
   snprintf(cache->cache_name + n, 128 - n, "\n");
 
@@ -332,10 +316,19 @@ static void LRB_parse_params(cache_t *cache,
     }
 
     if (strcasecmp(key, "objective") == 0) {
+      free(params->objective);
       params->objective = strdup(value);
       if (params->objective == NULL) {
         ERROR("out of memory %s\n", strerror(errno));
       }
+    } else if (strcasecmp(key, "train-mode") == 0) {
+      if (strcasecmp(value, "inline") == 0) {
+        params->train_inline = true;
+      } else if (strcasecmp(value, "async") == 0) {
+        params->train_inline = false;
+      } else {
+        ERROR("LRB does not support train-mode %s\n", value);
+      }
     } else if (strcasecmp(key, "print") == 0) {
       printf("current parameters: %s\n", LRB_current_params(cache, params));
       exit(0);
@@ -31,14 +31,8 @@ namespace webcachesim {
 
         virtual ~Cache() = default;
 
-        // main cache management functions (to be defined by a policy)
-        virtual bool lookup(const SimpleRequest &req) = 0;
-        // check whether an object in a cache. Not update metadata
-        virtual bool exist(const int64_t &key) {
-            throw runtime_error("Error: exist() function not implemented");
-        }
-
-        virtual void admit(const SimpleRequest &req) = 0;
+        // the objects are managed by libCacheSim's cache_t, a policy defines
+        // its own lookup and admit that take the cache_obj_t
 
         // configure cache parameters
         virtual void setSize(const uint64_t &cs) {
@@ -12,70 +12,101 @@ using namespace std;
 using namespace lrb;
 
 void LRBCache::train() {
-    ++n_retrain;
     auto timeBegin = chrono::system_clock::now();
-    if (booster) LGBM_BoosterFree(booster);
+    TrainingData *data = pending_training_data;
+    const char *params = pending_training_params.c_str();
     // create training dataset
     DatasetHandle trainData;
     LGBM_DatasetCreateFromCSR(
-            static_cast<void *>(training_data->indptr.data()),
+            static_cast<void *>(data->indptr.data()),
             C_API_DTYPE_INT32,
-            training_data->indices.data(),
-            static_cast<void *>(training_data->data.data()),
+            data->indices.data(),
+            static_cast<void *>(data->data.data()),
             C_API_DTYPE_FLOAT64,
-            training_data->indptr.size(),
-            training_data->data.size(),
+            data->indptr.size(),
+            data->data.size(),
             n_feature,  //remove future t
-            map_to_string(training_params).c_str(),
+            params,
             nullptr,
             &trainData);
 
     LGBM_DatasetSetField(trainData,
                          "label",
-                         static_cast<void *>(training_data->labels.data()),
-                         training_data->labels.size(),
+                         static_cast<void *>(data->labels.data()),
+                         data->labels.size(),
                          C_API_DTYPE_FLOAT32);
 
     // init booster
-    LGBM_BoosterCreate(trainData, map_to_string(training_params).c_str(), &booster);
+    LGBM_BoosterCreate(trainData, params, &pending_booster);
     // train
-    for (int i = 0; i < stoi(training_params["num_iterations"]); i++) {
+    for (int i = 0; i < pending_num_iterations; i++) {
         int isFinished;
-        LGBM_BoosterUpdateOneIter(booster, &isFinished);
+        LGBM_BoosterUpdateOneIter(pending_booster, &isFinished);
         if (isFinished) {
             break;
         }
     }
 
     int64_t len;
-    vector<double> result(training_data->indptr.size() - 1);
-    LGBM_BoosterPredictForCSR(booster,
-                              static_cast<void *>(training_data->indptr.data()),
+    vector<double> result(data->indptr.size() - 1);
+    LGBM_BoosterPredictForCSR(pending_booster,
+                              static_cast<void *>(data->indptr.data()),
                               C_API_DTYPE_INT32,
-                              training_data->indices.data(),
-                              static_cast<void *>(training_data->data.data()),
+                              data->indices.data(),
+                              static_cast<void *>(data->data.data()),
                               C_API_DTYPE_FLOAT64,
-                              training_data->indptr.size(),
-                              training_data->data.size(),
+                              data->indptr.size(),
+                              data->data.size(),
                               n_feature,  //remove future t
                               C_API_PREDICT_NORMAL,
                               0,
-                              atoi(training_params["num_iterations"].c_str()),
-                              map_to_string(training_params).c_str(),
+                              pending_num_iterations,
+                              params,
                               &len,
                               result.data());
 
 
     double se = 0;
     for (int i = 0; i < result.size(); ++i) {
-        auto diff = result[i] - training_data->labels[i];
+        auto diff = result[i] - data->labels[i];
         se += diff * diff;
     }
-    training_loss = training_loss * 0.99 + se / batch_size * 0.01;
+    pending_se = se;
 
     LGBM_DatasetFree(trainData);
-    training_time = 0.95 * training_time +
-                    0.05 * chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now() - timeBegin).count();
+    pending_training_time =
+            chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now() - timeBegin).count();
+}
+
+static void train_job(void *arg) {
+    static_cast<LRBCache *>(arg)->train();
+}
+
+void LRBCache::start_training() {
+    //the previous batch must be installed before its data is reused
+    if (bg_task_wait(&train_task)) {
+        install_model();
+    }
+
+    swap(training_data, pending_training_data);
+    training_data->clear();
+    pending_training_params = map_to_string(training_params);
+    pending_num_iterations = stoi(training_params["num_iterations"]);
+
+    bg_task_submit(&train_task, train_job, this);
+    if (bg_task_try_collect(&train_task)) {
+        install_model();
+    }
+}
+
+void LRBCache::install_model() {
+    ++n_retrain;
+    if (booster) LGBM_BoosterFree(booster);
+    booster = pending_booster;
+    pending_booster = nullptr;
+
+    training_loss = training_loss * 0.99 + pending_se / batch_size * 0.01;
+    training_time = 0.95 * training_time + 0.05 * pending_training_time;
 }
 
 void LRBCache::sample() {
@@ -120,22 +151,32 @@ void LRBCache::update_stat_periodic() {
     segment_positive_example_ratio.emplace_back(positive_example_ratio);
 
     n_retrain = 0;
-    assert(in_cache_metas.size() + out_cache_metas.size() == key_map.size());
+    assert(out_cache_metas.size() == out_cache_key_map.size());
 }
 
 
-bool LRBCache::lookup(const SimpleRequest &req) {
-    bool ret;
+bool LRBCache::lookup(const SimpleRequest &req, cache_obj_t *obj) {
     ++current_seq;
 
+    if (bg_task_try_collect(&train_task)) {
+        install_model();
+    }
+
     forget();
 
     //first update the metadata: insert/update, which can trigger pending data.mature
-    auto it = key_map.find(req.id);
-    if (it != key_map.end()) {
-        auto list_idx = it->second.list_idx;
-        auto list_pos = it->second.list_pos;
-        Meta &meta = list_idx ? out_cache_metas[list_pos] : in_cache_metas[list_pos];
+    Meta *p_meta = nullptr;
+    if (obj != nullptr) {
+        p_meta = &in_cache_metas[obj->LRB.meta_idx];
+    } else {
+        auto it = out_cache_key_map.find(req.id);
+        if (it != out_cache_key_map.end()) {
+            p_meta = &out_cache_metas[it->second];
+        }
+    }
+    bool list_idx = (obj == nullptr);
+    if (p_meta != nullptr) {
+        Meta &meta = *p_meta;
         //update past timestamps
         assert(meta._key == req.id);
         uint64_t last_timestamp = meta._past_timestamp;
@@ -155,8 +196,7 @@ bool LRBCache::lookup(const SimpleRequest &req) {
             }
             //batch_size ~>= batch_size
             if (training_data->labels.size() >= batch_size) {
-                train();
-                training_data->clear();
+                start_training();
             }
             meta._sample_times.clear();
             meta._sample_times.shrink_to_fit();
@@ -170,13 +210,8 @@ bool LRBCache::lookup(const SimpleRequest &req) {
             assert(negative_candidate_queue->find(current_seq % memory_window) !=
                    negative_candidate_queue->end());
         } else {
-            auto *p = dynamic_cast<InCacheMeta *>(&meta);
-            p->p_last_request = in_cache_lru_queue.re_request(p->p_last_request);
+            move_obj_to_head(&lru_head, &lru_tail, obj);
         }
-        //update negative_candidate_queue
-        ret = !list_idx;
-    } else {
-        ret = false;
     }
 
     //sampling happens late to prevent immediate re-request
@@ -184,7 +219,7 @@ bool LRBCache::lookup(const SimpleRequest &req) {
         sample();
     }
 
-    return ret;
+    return obj != nullptr;
 }
 
 
@@ -197,9 +232,9 @@ void LRBCache::forget() {
     auto it = negative_candidate_queue->find(current_seq % memory_window);
     if (it != negative_candidate_queue->end()) {
         auto forget_key = it->second;
-        auto pos = key_map.find(forget_key)->second.list_pos;
-        // Forget only happens at list 1
-        assert(key_map.find(forget_key)->second.list_idx);
+        // Forget only happens at out-of-cache objects
+        assert(out_cache_key_map.find(forget_key) != out_cache_key_map.end());
+        uint32_t pos = out_cache_key_map.find(forget_key)->second;
         auto &meta = out_cache_metas[pos];
 
         //timeout mature
@@ -214,8 +249,7 @@ void LRBCache::forget() {
             }
             //batch_size ~>= batch_size
             if (training_data->labels.size() >= batch_size) {
-                train();
-                training_data->clear();
+                start_training();
             }
             meta._sample_times.clear();
             meta._sample_times.shrink_to_fit();
@@ -226,58 +260,51 @@ void LRBCache::forget() {
     }
 }
 
-void LRBCache::admit(const SimpleRequest &req) {
+void LRBCache::admit(const SimpleRequest &req, cache_obj_t *obj) {
     const uint64_t &size = req.size;
-    if (size > _cacheSize) {
-        LOG("L", _cacheSize, req.id, size);
-        return;
-    }
 
-    auto it = key_map.find(req.id);
-    if (it == key_map.end()) {
+    obj->LRB.meta_idx = in_cache_metas.size();
+    prepend_obj_to_head(&lru_head, &lru_tail, obj);
+
+    auto it = out_cache_key_map.find(req.id);
+    if (it == out_cache_key_map.end()) {
         //fresh insert
-        key_map.insert({req.id, {0, (uint32_t) in_cache_metas.size()}});
-        auto lru_it = in_cache_lru_queue.request(req.id);
-        in_cache_metas.emplace_back(req.id, req.size, current_seq, req.extra_features, lru_it);
+        in_cache_metas.emplace_back(req.id, req.size, current_seq, req.extra_features, obj);
         _currentSize += size;
     } else {
-        //bring list 1 to list 0
-        //first move meta data, then modify hash table
-        uint32_t tail0_pos = in_cache_metas.size();
-        auto &meta = out_cache_metas[it->second.list_pos];
+        //bring out-of-cache meta to in-cache meta
+        uint32_t pos = it->second;
+        auto &meta = out_cache_metas[pos];
         meta._size = size;
         auto forget_timestamp = meta._past_timestamp % memory_window;
         negative_candidate_queue->erase(forget_timestamp);
-        auto it_lru = in_cache_lru_queue.request(req.id);
-        in_cache_metas.emplace_back(out_cache_metas[it->second.list_pos], it_lru);
-        uint32_t tail1_pos = out_cache_metas.size() - 1;
-        if (it->second.list_pos != tail1_pos) {
+        in_cache_metas.emplace_back(meta, obj);
+        uint32_t tail_pos = out_cache_metas.size() - 1;
+        if (pos != tail_pos) {
             //swap tail
-            out_cache_metas[it->second.list_pos] = out_cache_metas[tail1_pos];
-            key_map.find(out_cache_metas[tail1_pos]._key)->second.list_pos = it->second.list_pos;
+            out_cache_metas[pos] = out_cache_metas[tail_pos];
+            out_cache_key_map.find(out_cache_metas[tail_pos]._key)->second = pos;
         }
         out_cache_metas.pop_back();
-        it->second = {0, tail0_pos};
+        out_cache_key_map.erase(req.id);
         _currentSize += size;
     }
 }
 
 
-pair<uint64_t, uint32_t> LRBCache::rank() {
+cache_obj_t *LRBCache::rank() {
 
     {
         //if not trained yet, or in_cache_lru past memory window, use LRU
-        auto &candidate_key = in_cache_lru_queue.dq.back();
-        auto it = key_map.find(candidate_key);
-        assert(it != key_map.end());
-        auto pos = it->second.list_pos;
-        auto &meta = in_cache_metas[pos];
+        cache_obj_t *lru_obj = lru_tail;
+        assert(lru_obj != nullptr);
+        auto &meta = in_cache_metas[lru_obj->LRB.meta_idx];
         if ((!booster) || (memory_window <= current_seq - meta._past_timestamp)) {
             //this use LRU force eviction, consider sampled a beyond boundary object
             if (booster) {
                 ++obj_distribution[1];
             }
-            return {meta._key, pos};
+            return lru_obj;
         }
     }
 
@@ -289,7 +316,6 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
     uint32_t sizes[sample_rate];
 
     unordered_set<uint64_t> key_set;
-    uint64_t keys[sample_rate];
     uint32_t poses[sample_rate];
     //next_past_timestamp, next_size = next_indptr - 1
 
@@ -308,7 +334,6 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
             key_set.insert(meta._key);
         }
 
-        keys[idx_row] = meta._key;
         poses[idx_row] = pos;
         //fill in past_interval
         indices[idx_feature] = 0;
@@ -406,21 +431,18 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
          }
     );
 
-    return {keys[index[0]], poses[index[0]]};
+    return in_cache_metas[poses[index[0]]].obj;
 }
 
-void LRBCache::evict() {
-    auto epair = rank();
-    evict_with_candidate(epair);
-}
-
-void LRBCache::evict_with_candidate(pair<uint64_t, uint32_t> &epair) {
+void LRBCache::evict(cache_obj_t *obj) {
     is_sampling = true;
 
-    uint64_t &key = epair.first;
-    uint32_t &old_pos = epair.second;
-
+    uint32_t old_pos = obj->LRB.meta_idx;
     auto &meta = in_cache_metas[old_pos];
+    assert(meta.obj == obj);
+    remove_obj_from_list(&lru_head, &lru_tail, obj);
+    _currentSize -= meta._size;
+
     if (memory_window <= current_seq - meta._past_timestamp) {
         //must be the tail of lru
         if (!meta._sample_times.empty()) {
@@ -433,49 +455,49 @@ void LRBCache::evict_with_candidate(pair<uint64_t, uint32_t> &epair) {
             }
             //batch_size ~>= batch_size
             if (training_data->labels.size() >= batch_size) {
-                train();
-                training_data->clear();
+                start_training();
             }
             meta._sample_times.clear();
             meta._sample_times.shrink_to_fit();
         }
 
-        in_cache_lru_queue.dq.erase(meta.p_last_request);
-        meta.p_last_request = in_cache_lru_queue.dq.end();
-        //above is suppose to be below, but to make sure the action is correct
         meta.free();
-        _currentSize -= meta._size;
-        key_map.erase(key);
-
-        uint32_t activate_tail_idx = in_cache_metas.size() - 1;
-        if (old_pos != activate_tail_idx) {
-            //move tail
-            in_cache_metas[old_pos] = in_cache_metas[activate_tail_idx];
-            key_map.find(in_cache_metas[activate_tail_idx]._key)->second.list_pos = old_pos;
-        }
-        in_cache_metas.pop_back();
         ++n_force_eviction;
     } else {
-        //bring list 0 to list 1
-        in_cache_lru_queue.dq.erase(meta.p_last_request);
-        meta.p_last_request = in_cache_lru_queue.dq.end();
-        _currentSize -= meta._size;
+        //bring in-cache meta to out-of-cache meta
         negative_candidate_queue->insert({meta._past_timestamp % memory_window, meta._key});
+        out_cache_key_map.insert({meta._key, (uint32_t) out_cache_metas.size()});
+        out_cache_metas.emplace_back(meta);
+    }
 
-        uint32_t new_pos = out_cache_metas.size();
-        out_cache_metas.emplace_back(in_cache_metas[old_pos]);
-        uint32_t activate_tail_idx = in_cache_metas.size() - 1;
-        if (old_pos != activate_tail_idx) {
-            //move tail
-            in_cache_metas[old_pos] = in_cache_metas[activate_tail_idx];
-            key_map.find(in_cache_metas[activate_tail_idx]._key)->second.list_pos = old_pos;
-        }
-        in_cache_metas.pop_back();
-        key_map.find(key)->second = {1, new_pos};
+    uint32_t activate_tail_idx = in_cache_metas.size() - 1;
+    if (old_pos != activate_tail_idx) {
+        //move tail
+        in_cache_metas[old_pos] = in_cache_metas[activate_tail_idx];
+        in_cache_metas[old_pos].obj->LRB.meta_idx = old_pos;
+    }
+    in_cache_metas.pop_back();
+}
+
+void LRBCache::remove(cache_obj_t *obj) {
+    uint32_t old_pos = obj->LRB.meta_idx;
+    auto &meta = in_cache_metas[old_pos];
+    assert(meta.obj == obj);
+    remove_obj_from_list(&lru_head, &lru_tail, obj);
+    _currentSize -= meta._size;
+    //the object is not evicted by the model, so it gives no training label
+    meta.free();
+
+    uint32_t activate_tail_idx = in_cache_metas.size() - 1;
+    if (old_pos != activate_tail_idx) {
+        //move tail
+        in_cache_metas[old_pos] = in_cache_metas[activate_tail_idx];
+        in_cache_metas[old_pos].obj->LRB.meta_idx = old_pos;
     }
+    in_cache_metas.pop_back();
 }
 
-void LRBCache::remove_from_outcache_metas(Meta &meta, unsigned int &pos, const uint64_t &key) {
+void LRBCache::remove_from_outcache_metas(Meta &meta, uint32_t &pos, const uint64_t &key) {
     //free the actual content
     meta.free();
     //TODO: can add a function to delete from a queue with (key, pos)
@@ -484,9 +506,9 @@ void LRBCache::remove_from_outcache_metas(Meta &meta, unsigned int &pos, const u
     if (pos != tail_pos) {
         //swap tail
         out_cache_metas[pos] = out_cache_metas[tail_pos];
-        key_map.find(out_cache_metas[tail_pos]._key)->second.list_pos = pos;
+        out_cache_key_map.find(out_cache_metas[tail_pos]._key)->second = pos;
     }
     out_cache_metas.pop_back();
-    key_map.erase(key);
+    out_cache_key_map.erase(key);
     negative_candidate_queue->erase(current_seq % memory_window);
 }
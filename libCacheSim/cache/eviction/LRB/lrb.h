@@ -6,6 +6,8 @@
 #define WEBCACHESIM_LRB_H
 
 #include "cache.h"
+#include "../../../include/libCacheSim/cacheObj.h"
+#include "../../../utils/include/bgTask.h"
 #include <unordered_map>
 #include <unordered_set>
 #include "../../../dataStructure/sparsepp/spp.h"
@@ -16,7 +18,6 @@
 #include <assert.h>
 #include <sstream>
 #include <fstream>
-#include <list>
 
 using namespace webcachesim;
 using namespace std;
@@ -137,43 +138,23 @@ public:
 
 class InCacheMeta : public Meta {
 public:
-    //pointer to lru0
-    list<int64_t>::const_iterator p_last_request;
-    //any change to functions?
+    //the object in libCacheSim's hashtable, obj->LRB.meta_idx is the index of this meta
+    cache_obj_t *obj;
 
     InCacheMeta(const uint64_t &key,
                 const uint64_t &size,
                 const uint64_t &past_timestamp,
-                const vector<uint16_t> &extra_features, const list<int64_t>::const_iterator &it) :
+                const vector<uint16_t> &extra_features, cache_obj_t *_obj) :
             Meta(key, size, past_timestamp, extra_features) {
-        p_last_request = it;
+        obj = _obj;
     };
 
-    InCacheMeta(const Meta &meta, const list<int64_t>::const_iterator &it) : Meta(meta) {
-        p_last_request = it;
+    InCacheMeta(const Meta &meta, cache_obj_t *_obj) : Meta(meta) {
+        obj = _obj;
     };
 
 };
 
-class InCacheLRUQueue {
-public:
-    list<int64_t> dq;
-
-    //the hashtable (location information is maintained outside, and assume it is always correct)
-    list<int64_t>::const_iterator request(int64_t key) {
-        dq.emplace_front(key);
-        return dq.cbegin();
-    }
-
-    list<int64_t>::const_iterator re_request(list<int64_t>::const_iterator it) {
-        if (it != dq.cbegin()) {
-            dq.emplace_front(*it);
-            dq.erase(it);
-        }
-        return dq.cbegin();
-    }
-};
-
 class TrainingData {
 public:
     vector<float> labels;
@@ -264,11 +245,6 @@ public:
 };
 
 
-struct KeyMapEntryT {
-    unsigned int list_idx: 1;
-    unsigned int list_pos: 31;
-};
-
 class LRBCache : public Cache {
 public:
     uint32_t current_seq = -1;
@@ -278,14 +254,20 @@ public:
     uint32_t memory_window = 67108864;
     uint32_t n_feature;
 
-    //key -> (0/1 list, idx)
-    sparse_hash_map<uint64_t, KeyMapEntryT> key_map;
+    //in-cache objects are found through libCacheSim's hashtable,
+    //only the objects evicted within the memory window are in the key map
+    //key -> idx in out_cache_metas
+    sparse_hash_map<uint64_t, uint32_t> out_cache_key_map;
     vector<InCacheMeta> in_cache_metas;
     vector<Meta> out_cache_metas;
 
-    InCacheLRUQueue in_cache_lru_queue;
+    //in-cache objects in LRU order, linked through cache_obj_t queue, head is the most recent
+    cache_obj_t *lru_head = nullptr;
+    cache_obj_t *lru_tail = nullptr;
     shared_ptr<sparse_hash_map<uint64_t, uint64_t>> negative_candidate_queue;
-    TrainingData *training_data;
+    TrainingData *training_data = nullptr;
+    //the batch being trained in the background, swapped with training_data when a batch is full
+    TrainingData *pending_training_data = nullptr;
 
     // sample_size: use n_memorize keys + random choose (sample_rate - n_memorize) keys
     uint sample_rate = 64;
@@ -298,6 +280,16 @@ public:
 
     BoosterHandle booster = nullptr;
 
+    //training runs in a background task and the new booster is swapped in
+    //on a later request, the background task only touches the pending_* fields
+    bg_task_t train_task;
+    bool train_inline = false;
+    BoosterHandle pending_booster = nullptr;
+    string pending_training_params;
+    int pending_num_iterations = 0;
+    double pending_se = 0;
+    double pending_training_time = 0;
+
     unordered_map<string, string> training_params = {
             //don't use alias here. C api may not recongize
             {"boosting",         "gbdt"},
@@ -358,6 +350,15 @@ public:
                     abort();
                 }
 //                n_edc_feature = stoull(it.second);
+            } else if (it.first == "train_mode") {
+                if (it.second == "inline")
+                    train_inline = true;
+                else if (it.second == "async")
+                    train_inline = false;
+                else {
+                    cerr << "error: unknown train_mode" << endl;
+                    exit(-1);
+                }
             } else if (it.first == "objective") {
                 if (it.second == "byte-miss-ratio")
                     objective = byte_miss_ratio;
@@ -398,6 +399,22 @@ public:
         }
         inference_params = training_params;
         training_data = new TrainingData(n_feature, memory_window);
+        pending_training_data = new TrainingData(n_feature, memory_window);
+        bg_task_init(&train_task, train_inline);
+    }
+
+    LRBCache() {
+        bg_task_init(&train_task, train_inline);
+    }
+
+    ~LRBCache() override {
+        if (bg_task_is_pending(&train_task)) {
+            bg_task_wait(&train_task);
+        }
+        if (booster) LGBM_BoosterFree(booster);
+        if (pending_booster) LGBM_BoosterFree(pending_booster);
+        delete training_data;
+        delete pending_training_data;
     }
 
     string map_to_string(unordered_map<string, string> &map) {
@@ -409,21 +426,33 @@ public:
         return ss.str();
     }
 
-    bool lookup(const SimpleRequest &req) override;
+    //obj is the object found in libCacheSim's hashtable, nullptr on miss
+    bool lookup(const SimpleRequest &req, cache_obj_t *obj);
 
-    void admit(const SimpleRequest &req) override;
+    //obj is the object just inserted into libCacheSim's hashtable
+    void admit(const SimpleRequest &req, cache_obj_t *obj);
 
-    void evict();
+    //the caller removes obj from libCacheSim's hashtable afterwards
+    void evict(cache_obj_t *obj);
 
-    void evict_with_candidate(pair<uint64_t, uint32_t> &epair);
+    //drop obj without keeping its history, used for expired objects,
+    //the caller removes obj from libCacheSim's hashtable afterwards
+    void remove(cache_obj_t *obj);
 
     void forget();
 
     //sample, rank the 1st and return
-    pair<uint64_t, uint32_t> rank();
+    cache_obj_t *rank();
 
+    //train on pending_training_data, runs in the background task
     void train();
 
+    //hand the full training_data to the background task
+    void start_training();
+
+    //swap in the booster trained by the background task
+    void install_model();
+
     void sample();
 
     void update_stat_periodic() override;
@@ -435,14 +464,7 @@ public:
             hash_edc[i] = pow(0.5, i);
     }
 
-    void remove_from_outcache_metas(Meta &meta, unsigned int &pos, const uint64_t &key);
-
-    bool has(const uint64_t &id) {
-        auto it = key_map.find(id);
-        if (it == key_map.end())
-            return false;
-        return !it->second.list_idx;
-    }
+    void remove_from_outcache_metas(Meta &meta, uint32_t &pos, const uint64_t &key);
 
     vector<int> get_object_distribution_n_past_timestamps() {
         vector<int> distribution(max_n_past_timestamps, 0);
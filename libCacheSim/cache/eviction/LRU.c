@@ -10,6 +10,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/checkpoint.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -33,6 +34,8 @@ static cache_obj_t *LRU_to_evict(cache_t *cache, const request_t *req);
 static void LRU_evict(cache_t *cache, const request_t *req);
 static bool LRU_remove(cache_t *cache, const obj_id_t obj_id);
 static void LRU_print_cache(const cache_t *cache);
+static bool LRU_checkpoint(const cache_t *cache, FILE *ofile);
+static bool LRU_restore(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -62,12 +65,15 @@ cache_t *LRU_init(const common_cache_params_t ccache_params,
   cache->can_insert = cache_can_insert_default;
   cache->get_n_obj = cache_get_n_obj_default;
   cache->print_cache = LRU_print_cache;
+  cache->checkpoint = LRU_checkpoint;
+  cache->restore = LRU_restore;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2;
   } else {
     cache->obj_md_size = 0;
   }
+  cache->algo_obj_md_size = 0;
 
 #ifdef USE_BELADY
   snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "LRU_Belady");
@@ -280,6 +286,25 @@ static void LRU_print_cache(const cache_t *cache) {
   printf("END\n");
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                  checkpoint and restore                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief write the queue from the head (most recently used) to the tail
+ */
+static bool LRU_checkpoint(const cache_t *cache, FILE *ofile) {
+  const LRU_params_t *params = (const LRU_params_t *)cache->eviction_params;
+  return checkpoint_queue(cache, params->q_head, ofile);
+}
+
+static bool LRU_restore(cache_t *cache, FILE *ifile) {
+  LRU_params_t *params = (LRU_params_t *)cache->eviction_params;
+  return restore_queue(cache, &params->q_head, &params->q_tail, ifile);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,752 @@
+//
+//  a cache partitioned by tenant, namespace, content type or object,
+//  each partition runs its own cache of the same algorithm and the capacity
+//  is shared with one of the policies
+//
+//  static: the partitions have fixed sizes given by shares (equal by default)
+//  proportional: every interval, the partitions are resized proportionally to
+//    their recently requested bytes
+//  dynamic: every interval, the partitions are resized to minimize the misses
+//    using the miss curve of each partition, the curves are estimated by a
+//    mini sim of each partition at n-curve-point sizes (see miniSim.h) and the
+//    capacity is allocated with the lookahead of utility-based cache
+//    partitioning (UCP), which also works for curves that are not convex
+//
+//  the partitions are resized by changing their cache_size, so the
+//  proportional and dynamic policies only support the algorithms whose
+//  structure does not depend on the cache size at initialization
+//
+//  the admissioner and prefetcher of the partitioned cache are not used,
+//  partitions are selected with key % n-partition
+//
+//  Partition.c
+//  libCacheSim
+//
+
+#include "../../include/libCacheSim/evictionAlgo/Partition.h"
+
+#include "../../dataStructure/hash/hash.h"
+#include "../../include/libCacheSim/evictionAlgo.h"
+#include "../../include/libCacheSim/miniSim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PARTITION_MAX_N 64
+/* the proportional and dynamic policies allocate the capacity in units of
+ * cache_size / (n_partition * PARTITION_N_UNIT) */
+#define PARTITION_N_UNIT 16
+/* the weight of the previous intervals when an interval ends */
+#define PARTITION_DECAY 0.5
+/* the dynamic policy only resizes the partitions if the new allocation is
+ * expected to reduce the misses by this fraction, because resizing evicts
+ * objects and the curves are noisy */
+#define PARTITION_MIN_GAIN 0.01
+
+typedef enum {
+  PARTITION_BY_TENANT,
+  PARTITION_BY_NS,
+  PARTITION_BY_CONTENT_TYPE,
+  PARTITION_BY_OBJ,
+} partition_by_e;
+
+static const char *partition_by_str[] = {"tenant", "ns", "content-type", "obj"};
+
+typedef enum {
+  PARTITION_STATIC,
+  PARTITION_PROPORTIONAL,
+  PARTITION_DYNAMIC,
+} partition_policy_e;
+
+static const char *partition_policy_str[] = {"static", "proportional",
+                                             "dynamic"};
+
+typedef struct {
+  cache_t *cache;
+  cache_stat_t stat;
+  /* the requested bytes, decayed at the end of each interval */
+  double demand;
+} partition_t;
+
+typedef struct Partition_params {
+  partition_t *parts;
+  int n_partition;
+  partition_by_e partition_by;
+  partition_policy_e policy;
+  char sub_cache_type[32];
+
+  int n_share;
+  double shares[PARTITION_MAX_N];
+
+  int64_t interval;
+  int64_t n_req_in_interval;
+
+  double shadow_sample_ratio;
+  int n_curve_point;
+} Partition_params_t;
+
+static const char *DEFAULT_PARAMS =
+    "sub-cache=LRU,partition-by=tenant,n-partition=4,policy=static,"
+    "interval=100000,shadow-sample-ratio=0.01,n-curve-point=8";
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void Partition_free(cache_t *cache);
+static bool Partition_get(cache_t *cache, const request_t *req);
+static cache_obj_t *Partition_find(cache_t *cache, const request_t *req,
+                                   const bool update_cache);
+static cache_obj_t *Partition_insert(cache_t *cache, const request_t *req);
+static cache_obj_t *Partition_to_evict(cache_t *cache, const request_t *req);
+static void Partition_evict(cache_t *cache, const request_t *req);
+static bool Partition_remove(cache_t *cache, const obj_id_t obj_id);
+static bool Partition_can_insert(cache_t *cache, const request_t *req);
+static int64_t Partition_get_occupied_byte(const cache_t *cache);
+static int64_t Partition_get_n_obj(const cache_t *cache);
+
+static void Partition_parse_params(cache_t *cache,
+                                   const char *cache_specific_params);
+static cache_t *_create_sub_cache(const char *cache_type,
+                                  const common_cache_params_t ccache_params);
+static void _reallocate(cache_t *cache, const request_t *req);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ****                       init, free, get                         ****
+// ***********************************************************************
+
+/**
+ * @brief initialize a partitioned cache
+ *
+ * @param ccache_params some common cache parameters
+ * @param cache_specific_params cache specific parameters, see parse_params
+ * function or use -e "print" with the cachesim binary
+ */
+cache_t *Partition_init(const common_cache_params_t ccache_params,
+                        const char *cache_specific_params) {
+  cache_t *cache =
+      cache_struct_init("Partition", ccache_params, cache_specific_params);
+  cache->cache_init = Partition_init;
+  cache->cache_free = Partition_free;
+  cache->get = Partition_get;
+  cache->find = Partition_find;
+  cache->insert = Partition_insert;
+  cache->evict = Partition_evict;
+  cache->remove = Partition_remove;
+  cache->to_evict = Partition_to_evict;
+  cache->can_insert = Partition_can_insert;
+  cache->get_occupied_byte = Partition_get_occupied_byte;
+  cache->get_n_obj = Partition_get_n_obj;
+
+  cache->eviction_params = malloc(sizeof(Partition_params_t));
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  memset(params, 0, sizeof(Partition_params_t));
+
+  Partition_parse_params(cache, DEFAULT_PARAMS);
+  if (cache_specific_params != NULL) {
+    Partition_parse_params(cache, cache_specific_params);
+  }
+
+  if (params->n_share != 0 && params->n_share != params->n_partition) {
+    ERROR("%d shares are given for %d partitions\n", params->n_share,
+          params->n_partition);
+    exit(1);
+  }
+  if (params->n_share != 0 && params->policy != PARTITION_STATIC) {
+    WARN("shares are only used by the static policy\n");
+  }
+  if (params->policy != PARTITION_STATIC) {
+    const char *resizable[] = {"LRU", "FIFO", "Clock", "Sieve", "LFU", "ARC"};
+    bool can_resize = false;
+    for (int i = 0; i < (int)(sizeof(resizable) / sizeof(resizable[0])); i++) {
+      can_resize |= strcasecmp(params->sub_cache_type, resizable[i]) == 0;
+    }
+    if (!can_resize) {
+      ERROR("the %s policy cannot resize %s, use the static policy\n",
+            partition_policy_str[params->policy], params->sub_cache_type);
+      exit(1);
+    }
+  }
+  if (params->n_share == 0) {
+    for (int i = 0; i < params->n_partition; i++) params->shares[i] = 1;
+  }
+
+  double share_sum = 0;
+  for (int i = 0; i < params->n_partition; i++) {
+    share_sum += params->shares[i];
+  }
+  if (share_sum <= 0) {
+    ERROR("the shares cannot all be 0\n");
+    exit(1);
+  }
+
+  /* the hash tables grow as needed, so the partitions start small */
+  int hashpower_shift = 0;
+  while ((1 << hashpower_shift) < params->n_partition) hashpower_shift++;
+  common_cache_params_t ccache_params_local = ccache_params;
+  ccache_params_local.hashpower =
+      MAX(ccache_params.hashpower - hashpower_shift, 12);
+
+  params->parts = calloc(params->n_partition, sizeof(partition_t));
+  int64_t allocated = 0;
+  for (int i = 0; i < params->n_partition; i++) {
+    partition_t *part = &params->parts[i];
+    int64_t size =
+        (int64_t)((double)ccache_params.cache_size * params->shares[i] /
+                  share_sum);
+    if (i == params->n_partition - 1) {
+      size = (int64_t)ccache_params.cache_size - allocated;
+    }
+    allocated += size;
+
+    ccache_params_local.cache_size = size;
+    part->cache =
+        _create_sub_cache(params->sub_cache_type, ccache_params_local);
+  }
+  cache->obj_md_size = params->parts[0].cache->obj_md_size;
+
+  if (params->policy == PARTITION_DYNAMIC) {
+    /* the curves cover the sizes a partition can grow to, they are decayed
+     * at the end of each interval */
+    mini_sim_params_t mini_sim_params = default_mini_sim_params();
+    mini_sim_params.n_size = params->n_curve_point;
+    mini_sim_params.max_size = ccache_params.cache_size;
+    mini_sim_params.sampling_ratio = params->shadow_sample_ratio;
+    for (int i = 0; i < params->n_partition; i++) {
+      cache_enable_mini_sim(params->parts[i].cache, &mini_sim_params);
+    }
+  }
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "Partition-%s-%s-%d",
+           params->sub_cache_type, partition_policy_str[params->policy],
+           params->n_partition);
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void Partition_free(cache_t *cache) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  for (int i = 0; i < params->n_partition; i++) {
+    params->parts[i].cache->cache_free(params->parts[i].cache);
+  }
+  free(params->parts);
+  free(params);
+  cache_struct_free(cache);
+}
+
+static inline int _get_partition_idx(const Partition_params_t *params,
+                                     const request_t *req, uint64_t hv) {
+  int64_t key;
+  switch (params->partition_by) {
+    case PARTITION_BY_TENANT:
+      key = req->tenant_id;
+      break;
+    case PARTITION_BY_NS:
+      key = req->ns;
+      break;
+    case PARTITION_BY_CONTENT_TYPE:
+      key = req->content_type;
+      break;
+    default:
+      /* the low bits are used by the sampling of the mini sim */
+      key = (int64_t)(hv >> 32);
+      break;
+  }
+  key %= params->n_partition;
+  return (int)(key < 0 ? key + params->n_partition : key);
+}
+
+static inline partition_t *_get_partition(const Partition_params_t *params,
+                                          const request_t *req) {
+  uint64_t hv = 0;
+  if (params->partition_by == PARTITION_BY_OBJ) {
+    hv = get_hash_value_int_64(&req->obj_id);
+  }
+  return &params->parts[_get_partition_idx(params, req, hv)];
+}
+
+/**
+ * @brief the requests are served by the cache of their partition
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit
+ */
+static bool Partition_get(cache_t *cache, const request_t *req) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  cache->n_req += 1;
+
+  partition_t *part = _get_partition(params, req);
+  bool hit = part->cache->get(part->cache, req);
+  part->stat.n_req += 1;
+  part->stat.n_req_byte += req->obj_size;
+  if (!hit) {
+    part->stat.n_miss += 1;
+    part->stat.n_miss_byte += req->obj_size;
+  }
+  part->stat.curr_rtime = req->clock_time;
+  part->demand += (double)req->obj_size;
+
+  if (params->policy != PARTITION_STATIC &&
+      ++params->n_req_in_interval >= params->interval) {
+    _reallocate(cache, req);
+    params->n_req_in_interval = 0;
+  }
+
+  return hit;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****       developer facing APIs (used by cache developer)         ****
+// ****                                                               ****
+// ***********************************************************************
+
+static cache_obj_t *Partition_find(cache_t *cache, const request_t *req,
+                                   const bool update_cache) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  cache_t *sub = _get_partition(params, req)->cache;
+  return sub->find(sub, req, update_cache);
+}
+
+/**
+ * @brief insert the object into its partition, objects of the partition are
+ * evicted if the partition is full
+ */
+static cache_obj_t *Partition_insert(cache_t *cache, const request_t *req) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  cache_t *sub = _get_partition(params, req)->cache;
+  while (sub->get_occupied_byte(sub) + req->obj_size + sub->obj_md_size >
+         sub->cache_size) {
+    sub->evict(sub, req);
+  }
+  return sub->insert(sub, req);
+}
+
+/* the partition that uses the most bytes beyond its size */
+static partition_t *_find_victim_partition(const Partition_params_t *params) {
+  partition_t *victim = NULL;
+  int64_t max_over = INT64_MIN;
+  for (int i = 0; i < params->n_partition; i++) {
+    partition_t *part = &params->parts[i];
+    int64_t occupied = part->cache->get_occupied_byte(part->cache);
+    if (occupied > 0 && occupied - part->cache->cache_size > max_over) {
+      max_over = occupied - part->cache->cache_size;
+      victim = part;
+    }
+  }
+  return victim;
+}
+
+static cache_obj_t *Partition_to_evict(cache_t *cache, const request_t *req) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  partition_t *part = _find_victim_partition(params);
+  if (part == NULL || part->cache->to_evict == NULL) {
+    return NULL;
+  }
+  return part->cache->to_evict(part->cache, req);
+}
+
+static void Partition_evict(cache_t *cache, const request_t *req) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  partition_t *part = _find_victim_partition(params);
+  DEBUG_ASSERT(part != NULL);
+  part->cache->evict(part->cache, req);
+}
+
+static bool Partition_remove(cache_t *cache, const obj_id_t obj_id) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  for (int i = 0; i < params->n_partition; i++) {
+    cache_t *sub = params->parts[i].cache;
+    if (sub->remove(sub, obj_id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool Partition_can_insert(cache_t *cache, const request_t *req) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  cache_t *sub = _get_partition(params, req)->cache;
+  return cache_can_insert_default(cache, req) && sub->can_insert(sub, req);
+}
+
+static int64_t Partition_get_occupied_byte(const cache_t *cache) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  int64_t occupied_byte = 0;
+  for (int i = 0; i < params->n_partition; i++) {
+    cache_t *sub = params->parts[i].cache;
+    occupied_byte += sub->get_occupied_byte(sub);
+  }
+  return occupied_byte;
+}
+
+static int64_t Partition_get_n_obj(const cache_t *cache) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  int64_t n_obj = 0;
+  for (int i = 0; i < params->n_partition; i++) {
+    cache_t *sub = params->parts[i].cache;
+    n_obj += sub->get_n_obj(sub);
+  }
+  return n_obj;
+}
+
+int Partition_get_n_partition(const cache_t *cache) {
+  DEBUG_ASSERT(is_partition_cache(cache));
+  return ((Partition_params_t *)cache->eviction_params)->n_partition;
+}
+
+void Partition_get_stat(const cache_t *cache, int partition,
+                        cache_stat_t *stat) {
+  DEBUG_ASSERT(is_partition_cache(cache));
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  DEBUG_ASSERT(partition >= 0 && partition < params->n_partition);
+  partition_t *part = &params->parts[partition];
+
+  *stat = part->stat;
+  stat->n_obj = part->cache->get_n_obj(part->cache);
+  stat->occupied_byte = part->cache->get_occupied_byte(part->cache);
+  stat->cache_size = part->cache->cache_size;
+  snprintf(stat->cache_name, CACHE_NAME_ARRAY_LEN, "%.40s-%s%d",
+           part->cache->cache_name, partition_by_str[params->partition_by],
+           partition);
+}
+
+void Partition_reset_stat(cache_t *cache) {
+  DEBUG_ASSERT(is_partition_cache(cache));
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  for (int i = 0; i < params->n_partition; i++) {
+    memset(&params->parts[i].stat, 0, sizeof(cache_stat_t));
+  }
+}
+
+int Partition_get_miss_ratio_curve(const cache_t *cache, int partition,
+                                   int64_t *cache_sizes, double *miss_ratios) {
+  DEBUG_ASSERT(is_partition_cache(cache));
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  DEBUG_ASSERT(partition >= 0 && partition < params->n_partition);
+  const mini_sim_t *mini_sim = params->parts[partition].cache->mini_sim;
+  if (mini_sim == NULL) {
+    return 0;
+  }
+
+  cache_sizes[0] = 0;
+  miss_ratios[0] = mini_sim_get_n_req(mini_sim) > 0 ? 1.0 : 0;
+  return mini_sim_get_mrc(mini_sim, cache_sizes + 1, miss_ratios + 1, NULL) +
+         1;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  cache internal functions                     ****
+// ****                                                               ****
+// ***********************************************************************
+
+static cache_t *_create_sub_cache(const char *cache_type,
+                                  const common_cache_params_t ccache_params) {
+  cache_t *cache = NULL;
+  if (strcasecmp(cache_type, "LRU") == 0) {
+    cache = LRU_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "FIFO") == 0) {
+    cache = FIFO_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "Clock") == 0) {
+    cache = Clock_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "Sieve") == 0) {
+    cache = Sieve_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "LFU") == 0) {
+    cache = LFU_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "ARC") == 0) {
+    cache = ARC_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "SLRU") == 0) {
+    cache = SLRU_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "TwoQ") == 0) {
+    cache = TwoQ_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "S3FIFO") == 0) {
+    cache = S3FIFO_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "LIRS") == 0) {
+    cache = LIRS_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "WTinyLFU") == 0) {
+    cache = WTinyLFU_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "LHD") == 0) {
+    cache = LHD_init(ccache_params, NULL);
+  } else {
+    ERROR("Partition does not support %s\n", cache_type);
+    exit(1);
+  }
+  return cache;
+}
+
+/**
+ * @brief resize a partition, the objects beyond the new size are evicted
+ */
+static void _resize_partition(partition_t *part, int64_t new_size,
+                              const request_t *req) {
+  cache_t *sub = part->cache;
+  sub->cache_size = new_size;
+  while (sub->get_occupied_byte(sub) > new_size) {
+    sub->evict(sub, req);
+  }
+}
+
+/* the misses of the sampled requests if the partition has n_unit units */
+static double _expected_miss(const partition_t *part, int64_t cache_size,
+                             int64_t n_unit, int64_t n_total_unit) {
+  const mini_sim_t *mini_sim = part->cache->mini_sim;
+  return mini_sim_get_n_req(mini_sim) *
+         mini_sim_get_miss_ratio(mini_sim, cache_size * n_unit / n_total_unit);
+}
+
+/**
+ * @brief the lookahead allocation of UCP, each step gives the units to the
+ * partition with the largest miss reduction per unit, looking ahead as many
+ * units as left so that the plateaus of the curves are crossed
+ *
+ * @return true if the new allocation should be used
+ */
+static bool _allocate_by_miss_curve(const Partition_params_t *params,
+                                    int64_t cache_size, int64_t *n_units,
+                                    int64_t n_total_unit) {
+  double n_sampled_req = 0;
+  for (int i = 0; i < params->n_partition; i++) {
+    n_sampled_req += mini_sim_get_n_req(params->parts[i].cache->mini_sim);
+  }
+  if (n_sampled_req == 0) {
+    return false;
+  }
+
+  int64_t n_curr_units[PARTITION_MAX_N];
+  for (int i = 0; i < params->n_partition; i++) {
+    n_curr_units[i] = params->parts[i].cache->cache_size * n_total_unit /
+                      cache_size;
+  }
+
+  int64_t n_left = n_total_unit;
+  for (int i = 0; i < params->n_partition; i++) {
+    n_units[i] = 1;
+    n_left -= 1;
+  }
+
+  int next_idx = 0;
+  while (n_left > 0) {
+    int best_idx = -1;
+    int64_t best_n_unit = 0;
+    double best_utility = 0;
+    for (int i = 0; i < params->n_partition; i++) {
+      const partition_t *part = &params->parts[i];
+      double curr_miss =
+          _expected_miss(part, cache_size, n_units[i], n_total_unit);
+      for (int64_t k = 1; k <= n_left; k++) {
+        double utility =
+            (curr_miss -
+             _expected_miss(part, cache_size, n_units[i] + k, n_total_unit)) /
+            (double)k;
+        if (utility > best_utility) {
+          best_utility = utility;
+          best_idx = i;
+          best_n_unit = k;
+        }
+      }
+    }
+
+    if (best_idx == -1) {
+      /* no partition benefits from more space, spread the rest */
+      n_units[next_idx] += 1;
+      next_idx = (next_idx + 1) % params->n_partition;
+      n_left -= 1;
+    } else {
+      n_units[best_idx] += best_n_unit;
+      n_left -= best_n_unit;
+    }
+  }
+
+  double curr_miss = 0, new_miss = 0;
+  for (int i = 0; i < params->n_partition; i++) {
+    const partition_t *part = &params->parts[i];
+    curr_miss +=
+        _expected_miss(part, cache_size, n_curr_units[i], n_total_unit);
+    new_miss += _expected_miss(part, cache_size, n_units[i], n_total_unit);
+  }
+  return curr_miss - new_miss > curr_miss * PARTITION_MIN_GAIN;
+}
+
+/* each partition has at least one unit, the rest is proportional to the
+ * requested bytes */
+static bool _allocate_by_demand(const Partition_params_t *params,
+                                int64_t *n_units, int64_t n_total_unit) {
+  double demand_sum = 0;
+  int max_idx = 0;
+  for (int i = 0; i < params->n_partition; i++) {
+    demand_sum += params->parts[i].demand;
+    if (params->parts[i].demand > params->parts[max_idx].demand) max_idx = i;
+  }
+  if (demand_sum == 0) {
+    return false;
+  }
+
+  int64_t n_free_unit = n_total_unit - params->n_partition;
+  int64_t n_left = n_total_unit;
+  for (int i = 0; i < params->n_partition; i++) {
+    n_units[i] = 1 + (int64_t)((double)n_free_unit * params->parts[i].demand /
+                               demand_sum);
+    n_left -= n_units[i];
+  }
+  n_units[max_idx] += n_left;
+
+  return true;
+}
+
+/**
+ * @brief resize the partitions at the end of an interval and decay the
+ * statistics the allocation is based on
+ */
+static void _reallocate(cache_t *cache, const request_t *req) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  int64_t n_total_unit = (int64_t)params->n_partition * PARTITION_N_UNIT;
+  int64_t n_units[PARTITION_MAX_N];
+
+  bool changed;
+  if (params->policy == PARTITION_DYNAMIC) {
+    changed = _allocate_by_miss_curve(params, cache->cache_size, n_units,
+                                      n_total_unit);
+  } else {
+    changed = _allocate_by_demand(params, n_units, n_total_unit);
+  }
+
+  if (changed) {
+    int64_t allocated = 0;
+    for (int i = 0; i < params->n_partition; i++) {
+      int64_t size = cache->cache_size * n_units[i] / n_total_unit;
+      if (i == params->n_partition - 1) {
+        size = cache->cache_size - allocated;
+      }
+      allocated += size;
+      _resize_partition(&params->parts[i], size, req);
+    }
+  }
+
+  for (int i = 0; i < params->n_partition; i++) {
+    partition_t *part = &params->parts[i];
+    part->demand *= PARTITION_DECAY;
+    if (part->cache->mini_sim != NULL) {
+      mini_sim_decay(part->cache->mini_sim, PARTITION_DECAY);
+    }
+  }
+}
+
+static const char *Partition_current_params(Partition_params_t *params) {
+  static __thread char params_str[256];
+  snprintf(params_str, 256,
+           "sub-cache=%s,partition-by=%s,n-partition=%d,policy=%s,"
+           "interval=%ld,shadow-sample-ratio=%.4lf,n-curve-point=%d",
+           params->sub_cache_type, partition_by_str[params->partition_by],
+           params->n_partition, partition_policy_str[params->policy],
+           (long)params->interval, params->shadow_sample_ratio,
+           params->n_curve_point);
+  return params_str;
+}
+
+static void Partition_parse_params(cache_t *cache,
+                                   const char *cache_specific_params) {
+  Partition_params_t *params = (Partition_params_t *)cache->eviction_params;
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "sub-cache") == 0) {
+      strncpy(params->sub_cache_type, value, 31);
+    } else if (strcasecmp(key, "partition-by") == 0) {
+      int n = (int)(sizeof(partition_by_str) / sizeof(partition_by_str[0]));
+      int i = 0;
+      while (i < n && strcasecmp(value, partition_by_str[i]) != 0) i++;
+      if (i == n) {
+        ERROR("unknown partition-by %s, use tenant, ns, content-type or obj\n",
+              value);
+        exit(1);
+      }
+      params->partition_by = (partition_by_e)i;
+    } else if (strcasecmp(key, "n-partition") == 0) {
+      params->n_partition = (int)strtol(value, &end, 0);
+      if (params->n_partition < 1 || params->n_partition > PARTITION_MAX_N) {
+        ERROR("n-partition must be in [1, %d]\n", PARTITION_MAX_N);
+        exit(1);
+      }
+    } else if (strcasecmp(key, "policy") == 0) {
+      int n = (int)(sizeof(partition_policy_str) /
+                    sizeof(partition_policy_str[0]));
+      int i = 0;
+      while (i < n && strcasecmp(value, partition_policy_str[i]) != 0) i++;
+      if (i == n) {
+        ERROR("unknown policy %s, use static, proportional or dynamic\n",
+              value);
+        exit(1);
+      }
+      params->policy = (partition_policy_e)i;
+    } else if (strcasecmp(key, "shares") == 0) {
+      params->n_share = 0;
+      char *v = strsep((char **)&value, ":");
+      while (v != NULL) {
+        if (params->n_share == PARTITION_MAX_N) {
+          ERROR("at most %d shares are supported\n", PARTITION_MAX_N);
+          exit(1);
+        }
+        params->shares[params->n_share++] = strtod(v, &end);
+        if (params->shares[params->n_share - 1] < 0) {
+          ERROR("shares must be non-negative\n");
+          exit(1);
+        }
+        v = strsep((char **)&value, ":");
+      }
+    } else if (strcasecmp(key, "interval") == 0) {
+      params->interval = strtol(value, &end, 0);
+      if (params->interval <= 0) {
+        ERROR("interval must be positive\n");
+        exit(1);
+      }
+    } else if (strcasecmp(key, "shadow-sample-ratio") == 0) {
+      params->shadow_sample_ratio = strtod(value, &end);
+      if (params->shadow_sample_ratio <= 0 || params->shadow_sample_ratio > 1) {
+        ERROR("shadow-sample-ratio must be in (0, 1]\n");
+        exit(1);
+      }
+    } else if (strcasecmp(key, "n-curve-point") == 0) {
+      params->n_curve_point = (int)strtol(value, &end, 0);
+      if (params->n_curve_point < 1) {
+        ERROR("n-curve-point must be positive\n");
+        exit(1);
+      }
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: %s\n", Partition_current_params(params));
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s\n", cache->cache_name, key);
+      exit(1);
+    }
+  }
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
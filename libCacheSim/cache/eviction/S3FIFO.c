@@ -21,6 +21,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../include/libCacheSim/checkpoint.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -73,6 +74,9 @@ static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req);
 static void S3FIFO_parse_params(cache_t *cache,
                                 const char *cache_specific_params);
 
+static bool S3FIFO_checkpoint(const cache_t *cache, FILE *ofile);
+static bool S3FIFO_restore(cache_t *cache, FILE *ifile);
+
 static void S3FIFO_evict_fifo(cache_t *cache, const request_t *req);
 static void S3FIFO_evict_main(cache_t *cache, const request_t *req);
 
@@ -97,6 +101,8 @@ cache_t *S3FIFO_init(const common_cache_params_t ccache_params,
   cache->get_n_obj = S3FIFO_get_n_obj;
   cache->get_occupied_byte = S3FIFO_get_occupied_byte;
   cache->can_insert = S3FIFO_can_insert;
+  cache->checkpoint = S3FIFO_checkpoint;
+  cache->restore = S3FIFO_restore;
 
   cache->obj_md_size = 0;
 
@@ -530,6 +536,67 @@ static void S3FIFO_parse_params(cache_t *cache,
   free(old_params_str);
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                  checkpoint and restore                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief write the counters followed by the small FIFO, the ghost FIFO
+ * (if any) and the main FIFO, the S3FIFO metadata of an object is stored
+ * in the object of the FIFO that holds it
+ */
+static bool S3FIFO_checkpoint(const cache_t *cache, FILE *ofile) {
+  const S3FIFO_params_t *params =
+      (const S3FIFO_params_t *)cache->eviction_params;
+
+  bool ok = checkpoint_write(ofile, &params->n_obj_admit_to_fifo,
+                             sizeof(int64_t)) &&
+            checkpoint_write(ofile, &params->n_obj_admit_to_main,
+                             sizeof(int64_t)) &&
+            checkpoint_write(ofile, &params->n_obj_move_to_main,
+                             sizeof(int64_t)) &&
+            checkpoint_write(ofile, &params->n_byte_admit_to_fifo,
+                             sizeof(int64_t)) &&
+            checkpoint_write(ofile, &params->n_byte_admit_to_main,
+                             sizeof(int64_t)) &&
+            checkpoint_write(ofile, &params->n_byte_move_to_main,
+                             sizeof(int64_t));
+  ok = ok && cache_checkpoint_state(params->fifo, ofile);
+  if (params->fifo_ghost != NULL) {
+    ok = ok && cache_checkpoint_state(params->fifo_ghost, ofile);
+  }
+  ok = ok && cache_checkpoint_state(params->main_cache, ofile);
+
+  return ok;
+}
+
+static bool S3FIFO_restore(cache_t *cache, FILE *ifile) {
+  S3FIFO_params_t *params = (S3FIFO_params_t *)cache->eviction_params;
+
+  bool ok = checkpoint_read(ifile, &params->n_obj_admit_to_fifo,
+                            sizeof(int64_t)) &&
+            checkpoint_read(ifile, &params->n_obj_admit_to_main,
+                            sizeof(int64_t)) &&
+            checkpoint_read(ifile, &params->n_obj_move_to_main,
+                            sizeof(int64_t)) &&
+            checkpoint_read(ifile, &params->n_byte_admit_to_fifo,
+                            sizeof(int64_t)) &&
+            checkpoint_read(ifile, &params->n_byte_admit_to_main,
+                            sizeof(int64_t)) &&
+            checkpoint_read(ifile, &params->n_byte_move_to_main,
+                            sizeof(int64_t));
+  ok = ok && cache_restore_state(params->fifo, ifile);
+  if (params->fifo_ghost != NULL) {
+    ok = ok && cache_restore_state(params->fifo_ghost, ifile);
+  }
+  ok = ok && cache_restore_state(params->main_cache, ifile);
+  params->hit_on_ghost = false;
+
+  return ok;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -2,6 +2,7 @@
 
 #include "../../dataStructure/hashtable/hashtable.h"
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/checkpoint.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -27,6 +28,8 @@ static cache_obj_t *Sieve_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *Sieve_to_evict(cache_t *cache, const request_t *req);
 static void Sieve_evict(cache_t *cache, const request_t *req);
 static bool Sieve_remove(cache_t *cache, const obj_id_t obj_id);
+static bool Sieve_checkpoint(const cache_t *cache, FILE *ofile);
+static bool Sieve_restore(cache_t *cache, FILE *ifile);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -54,12 +57,15 @@ cache_t *Sieve_init(const common_cache_params_t ccache_params,
   cache->evict = Sieve_evict;
   cache->remove = Sieve_remove;
   cache->to_evict = Sieve_to_evict;
+  cache->checkpoint = Sieve_checkpoint;
+  cache->restore = Sieve_restore;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 1;
   } else {
     cache->obj_md_size = 0;
   }
+  cache->algo_obj_md_size = sizeof(Sieve_obj_params_t);
 
   cache->eviction_params = my_malloc(Sieve_params_t);
   memset(cache->eviction_params, 0, sizeof(Sieve_params_t));
@@ -281,6 +287,50 @@ static void Sieve_verify(cache_t *cache) {
   assert(n_byte == cache->get_occupied_byte(cache));
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                  checkpoint and restore                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * @brief write the queue and the position of the hand in the queue
+ * (counted from the head), -1 if the hand is not set
+ */
+static bool Sieve_checkpoint(const cache_t *cache, FILE *ofile) {
+  const Sieve_params_t *params = cache->eviction_params;
+  int64_t hand_pos = -1;
+  if (params->pointer != NULL) {
+    hand_pos = 0;
+    for (const cache_obj_t *obj = params->q_head; obj != params->pointer;
+         obj = obj->queue.next) {
+      hand_pos++;
+    }
+  }
+
+  return checkpoint_queue(cache, params->q_head, ofile) &&
+         checkpoint_write(ofile, &hand_pos, sizeof(int64_t));
+}
+
+static bool Sieve_restore(cache_t *cache, FILE *ifile) {
+  Sieve_params_t *params = cache->eviction_params;
+  int64_t hand_pos;
+  if (!restore_queue(cache, &params->q_head, &params->q_tail, ifile) ||
+      !checkpoint_read(ifile, &hand_pos, sizeof(int64_t))) {
+    return false;
+  }
+
+  params->pointer = NULL;
+  if (hand_pos >= 0) {
+    params->pointer = params->q_head;
+    for (int64_t i = 0; i < hand_pos && params->pointer != NULL; i++) {
+      params->pointer = params->pointer->queue.next;
+    }
+  }
+
+  return hand_pos < 0 || params->pointer != NULL;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,7 +10,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
-#include "../../dataStructure/pqueue.h"
+#include "../../dataStructure/indexedHeap.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -18,8 +18,9 @@ extern "C" {
 #endif
 
 typedef struct Size_params {
-  /* a priority queue ordering the object size */
-  pqueue_t *pq;
+  /* a heap ordered by the negative object size, so the top is
+   * the largest object */
+  indexed_heap_t *heap;
 } Size_params_t;
 
 // ***********************************************************************
@@ -67,7 +68,8 @@ cache_t *Size_init(const common_cache_params_t ccache_params,
   Size_params_t *params = my_malloc(Size_params_t);
   cache->eviction_params = params;
 
-  params->pq = pqueue_init((unsigned long)8e6);
+  params->heap =
+      create_indexed_heap(1024, offsetof(cache_obj_t, Size.heap_pos));
   return cache;
 }
 
@@ -78,12 +80,8 @@ cache_t *Size_init(const common_cache_params_t ccache_params,
  */
 static void Size_free(cache_t *cache) {
   Size_params_t *params = cache->eviction_params;
-  pq_node_t *node = pqueue_pop(params->pq);
-  while (node) {
-    my_free(sizeof(pq_node_t), node);
-    node = pqueue_pop(params->pq);
-  }
-  pqueue_free(params->pq);
+  free_indexed_heap(params->heap);
+  my_free(sizeof(Size_params_t), params);
 
   cache_struct_free(cache);
 }
@@ -109,7 +107,7 @@ static void Size_free(cache_t *cache) {
  */
 static bool Size_get(cache_t *cache, const request_t *req) {
   Size_params_t *params = cache->eviction_params;
-  DEBUG_ASSERT(cache->n_obj == params->pq->size - 1);
+  DEBUG_ASSERT(cache->n_obj == params->heap->n_entry);
   bool ret = cache_get_base(cache, req);
 
   return ret;
@@ -142,9 +140,8 @@ static cache_obj_t *Size_find(cache_t *cache, const request_t *req,
     return NULL;
   }
 
-  pqueue_pri_t pri = {.pri = req->obj_size};
-  pqueue_change_priority(params->pq, pri,
-                         (pq_node_t *)(cached_obj->Size.pq_node));
+  indexed_heap_update(params->heap, cached_obj, -(double)req->obj_size,
+                      cache->n_req);
   return cached_obj;
 }
 
@@ -163,11 +160,8 @@ static cache_obj_t *Size_insert(cache_t *cache, const request_t *req) {
 
   cache_obj_t *cached_obj = cache_insert_base(cache, req);
 
-  pq_node_t *node = my_malloc(pq_node_t);
-  node->obj_id = req->obj_id;
-  node->pri.pri = req->obj_size;
-  pqueue_insert(params->pq, (void *)node);
-  cached_obj->Size.pq_node = node;
+  indexed_heap_push(params->heap, cached_obj, -(double)req->obj_size,
+                    cache->n_req);
 
   return cached_obj;
 }
@@ -185,8 +179,8 @@ static cache_obj_t *Size_insert(cache_t *cache, const request_t *req) {
 static cache_obj_t *Size_to_evict(cache_t *cache, __attribute__((unused))
                                                     const request_t *req) {
   Size_params_t *params = cache->eviction_params;
-  pq_node_t *node = (pq_node_t *)pqueue_peek(params->pq);
-  return hashtable_find_obj_id(cache->hashtable, node->obj_id);
+  const heap_entry_t *entry = indexed_heap_peek(params->heap);
+  return entry == NULL ? NULL : entry->obj;
 }
 
 /**
@@ -200,14 +194,8 @@ static cache_obj_t *Size_to_evict(cache_t *cache, __attribute__((unused))
 static void Size_evict(cache_t *cache,
                          __attribute__((unused)) const request_t *req) {
   Size_params_t *params = cache->eviction_params;
-  pq_node_t *node = (pq_node_t *)pqueue_pop(params->pq);
-
-  cache_obj_t *obj_to_evict =
-      hashtable_find_obj_id(cache->hashtable, node->obj_id);
-  DEBUG_ASSERT(node == obj_to_evict->Size.pq_node);
-
-  obj_to_evict->Size.pq_node = NULL;
-  my_free(sizeof(pq_node_t), node);
+  heap_entry_t entry = indexed_heap_pop(params->heap);
+  cache_obj_t *obj_to_evict = entry.obj;
 
   cache_evict_base(cache, obj_to_evict, true);
 }
@@ -216,13 +204,7 @@ static void Size_remove_obj(cache_t *cache, cache_obj_t *obj) {
   Size_params_t *params = cache->eviction_params;
   DEBUG_ASSERT(obj != NULL);
 
-  if (obj->Size.pq_node != NULL) {
-    /* if it is NULL, it means we have deleted the entry in pq before this */
-    pqueue_remove(params->pq, obj->Size.pq_node);
-    my_free(sizeof(pq_node_t), obj->Size.pq_node);
-    obj->Size.pq_node = NULL;
-  }
-
+  indexed_heap_remove(params->heap, obj);
   cache_remove_obj_base(cache, obj, true);
 }
 
@@ -15,7 +15,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
-#include "../../dataStructure/minimalIncrementCBF.h"
+#include "../../dataStructure/freqSketch.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -32,9 +32,13 @@ typedef struct WTinyLFU_params {
   cache_t *main_cache;  // any eviction policy
   double window_size;
   int64_t n_admit_bytes;
-  struct minimalIncrementCBF *CBF;
-  size_t max_request_num;
-  size_t request_counter;
+  /* the frequency of the recent requests, it is halved after
+   * 10 * sketch_n_entry adds */
+  freq_sketch_t *sketch;
+  /* the number of objects the sketch is sized for, 0 uses the main cache
+   * size (which is in bytes unless obj sizes are ignored) capped at
+   * WTINYLFU_MAX_SKETCH_N_ENTRY */
+  int64_t sketch_n_entry;
   char main_cache_type[32];
 
   request_t *req_local;
@@ -42,6 +46,8 @@ typedef struct WTinyLFU_params {
 
 static const char *DEFAULT_PARAMS = "main-cache=SLRU,window-size=0.01";
 
+#define WTINYLFU_MAX_SKETCH_N_ENTRY (1LL << 20)
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                   function declarations                       ****
@@ -96,6 +102,7 @@ cache_t *WTinyLFU_init(const common_cache_params_t ccache_params,
   cache->eviction_params =
       (WTinyLFU_params_t *)malloc(sizeof(WTinyLFU_params_t));
   WTinyLFU_params_t *params = (WTinyLFU_params_t *)(cache->eviction_params);
+  params->sketch_n_entry = 0;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = params->main_cache->obj_md_size;
@@ -150,26 +157,12 @@ cache_t *WTinyLFU_init(const common_cache_params_t ccache_params,
   params->req_local = new_request();
   params->n_admit_bytes = 0;
 
-  params->max_request_num =
-      32 * params->main_cache->cache_size;  // sample size is 32
-
-  params->CBF =
-      (struct minimalIncrementCBF *)malloc(sizeof(struct minimalIncrementCBF));
-  DEBUG_ASSERT(params->CBF != NULL);
-  params->CBF->ready = 0;
-
-  // TODO @ Ziyue: how to set entries and error rate?
-  int ret = minimalIncrementCBF_init(params->CBF,
-                                     params->main_cache->cache_size, 0.001);
-  if (ret != 0) {
-    ERROR("CBF init failed\n");
+  if (params->sketch_n_entry == 0) {
+    params->sketch_n_entry =
+        MIN(MAX((int64_t)params->main_cache->cache_size, 1),
+            WTINYLFU_MAX_SKETCH_N_ENTRY);
   }
-
-#ifdef DEBUG_MODE
-  minimalIncrementCBF_print(params->CBF);
-#endif
-
-  params->request_counter = 0;  // initialize request counter
+  params->sketch = create_freq_sketch(params->sketch_n_entry, 0);
 
 #if defined(TRACK_DEMOTION)
   params->LRU->track_demotion = false;
@@ -189,8 +182,7 @@ static void WTinyLFU_free(cache_t *cache) {
   params->LRU->cache_free(params->LRU);
   params->main_cache->cache_free(params->main_cache);
 
-  minimalIncrementCBF_free(params->CBF);
-  free(params->CBF);
+  free_freq_sketch(params->sketch);
   free_request(params->req_local);
 
   cache_struct_free(cache);
@@ -223,13 +215,7 @@ static cache_obj_t *WTinyLFU_find(cache_t *cache, const request_t *req,
 
   if (obj_main != NULL) {
     // frequency update
-    minimalIncrementCBF_add(params->CBF, (void *)&req->obj_id, sizeof(obj_id_t));
-
-    params->request_counter++;
-    if (params->request_counter >= params->max_request_num) {
-      params->request_counter = 0;
-      minimalIncrementCBF_decay(params->CBF);
-    }
+    freq_sketch_add(params->sketch, req->obj_id);
   }
 
   return obj;
@@ -241,7 +227,7 @@ cache_obj_t *WTinyLFU_insert(cache_t *cache, const request_t *req) {
   cache_obj_t *obj = NULL;
   obj = params->LRU->insert(params->LRU, req);
 
-  minimalIncrementCBF_add(params->CBF, (void *)&req->obj_id, sizeof(obj_id_t));
+  freq_sketch_add(params->sketch, req->obj_id);
 
 #if defined(TRACK_DEMOTION)
   obj->create_time = cache->n_req;
@@ -292,18 +278,20 @@ static void WTinyLFU_evict(cache_t *cache, const request_t *req) {
         cache_obj_t *main_cache_victim = main->to_evict(main, req);
         DEBUG_ASSERT(main_cache_victim != NULL);
         // if window_victim is more frequent, insert it into main_cache
-        if (minimalIncrementCBF_estimate(params->CBF,
-                                         (void *)&window_victim->obj_id,
-                                         sizeof(window_victim->obj_id)) >
-            minimalIncrementCBF_estimate(params->CBF,
-                                         (void *)&main_cache_victim->obj_id,
-                                         sizeof(main_cache_victim->obj_id))) {
+        if (freq_sketch_estimate(params->sketch, window_victim->obj_id) >
+            freq_sketch_estimate(params->sketch, main_cache_victim->obj_id)) {
 #if defined(TRACK_DEMOTION)
           printf("%ld keep %ld %ld\n", cache->n_req, window_victim->create_time,
                  window_victim->misc.next_access_vtime);
 #endif
 
-          main->evict(main, req);
+          /* objects have different sizes, evicting the main cache victim
+           * may not make enough room */
+          while (main->get_occupied_byte(main) +
+                     params->req_local->obj_size + cache->obj_md_size >
+                 main->cache_size) {
+            main->evict(main, req);
+          }
 
           bool ret = window->remove(window, window_victim->obj_id);
           DEBUG_ASSERT(ret);
@@ -323,8 +311,7 @@ static void WTinyLFU_evict(cache_t *cache, const request_t *req) {
         }
       }
       // TODO @ Ziyue: add doorkeeper
-      minimalIncrementCBF_add(params->CBF, (void *)(&params->req_local->obj_id),
-                              sizeof(obj_id_t));
+      freq_sketch_add(params->sketch, params->req_local->obj_id);
     } else {
       DEBUG_ASSERT(window->get_occupied_byte(window) == 0);
       return main->evict(main, req);
@@ -369,6 +356,12 @@ static void WTinyLFU_parse_params(cache_t *cache,
         ERROR("window_size must be in [0, 1)\n");
         exit(1);
       }
+    } else if (strcasecmp(key, "sketch-n-entry") == 0) {
+      params->sketch_n_entry = strtoll(value, NULL, 0);
+      if (params->sketch_n_entry <= 0) {
+        ERROR("sketch-n-entry must be positive\n");
+        exit(1);
+      }
     } else {
       ERROR("%s does not have parameter %s\n", cache->cache_name, key);
       exit(1);
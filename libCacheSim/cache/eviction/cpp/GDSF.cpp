@@ -131,13 +131,9 @@ static cache_obj_t *GDSF_find(cache_t *cache, const request_t *req,
     /* update frequency */
     obj->lfu.freq += 1;
 
-    auto itr = gdsf->itr_map[obj];
-    gdsf->pq.erase(itr);
-
     double pri =
         gdsf->pri_last_evict + (double)(obj->lfu.freq) * 1.0e6 / obj->obj_size;
-    itr = gdsf->pq.emplace(obj, pri, cache->n_req).first;
-    gdsf->itr_map[obj] = itr;
+    gdsf->update(obj, pri, cache->n_req);
   }
 
   return obj;
@@ -162,8 +158,7 @@ static cache_obj_t *GDSF_insert(cache_t *cache, const request_t *req) {
 
   double pri = gdsf->pri_last_evict + 1.0e6 / obj->obj_size;
 
-  auto itr = gdsf->pq.emplace(obj, pri, cache->n_req).first;
-  gdsf->itr_map[obj] = itr;
+  gdsf->insert(obj, pri, cache->n_req);
 
   return obj;
 }
@@ -131,10 +131,7 @@ static cache_obj_t *LFUCpp_find(cache_t *cache, const request_t *req,
   cache_obj_t *obj = cache_find_base(cache, req, update_cache);
   if (obj != nullptr && update_cache) {
     obj->lfu.freq++;
-    auto itr = lfu->itr_map[obj];
-    lfu->pq.erase(itr);
-    itr = lfu->pq.emplace(obj, (double)obj->lfu.freq, cache->n_req).first;
-    lfu->itr_map[obj] = itr;
+    lfu->update(obj, (double)obj->lfu.freq, cache->n_req);
   }
 
   return obj;
@@ -157,9 +154,8 @@ static cache_obj_t *LFUCpp_insert(cache_t *cache, const request_t *req) {
   cache_obj_t *obj = cache_insert_base(cache, req);
   obj->lfu.freq = 1;
 
-  auto itr = lfu->pq.emplace_hint(lfu->pq.begin(), obj, 1.0, cache->n_req);
-  lfu->itr_map[obj] = itr;
-  DEBUG_ASSERT(lfu->itr_map.size() == cache->n_obj);
+  lfu->insert(obj, 1.0, cache->n_req);
+  DEBUG_ASSERT(lfu->heap->n_entry == cache->n_obj);
 
   return obj;
 }
@@ -201,18 +197,11 @@ static void LFUCpp_evict(cache_t *cache, const request_t *req) {
 static void LFUCpp_remove_obj(cache_t *cache, cache_obj_t *obj) {
   auto *lfu = static_cast<eviction::LFUCpp *>(cache->eviction_params);
   lfu->remove_obj(cache, obj);
-  cache_remove_obj_base(cache, obj, true);
 }
 
 static bool LFUCpp_remove(cache_t *cache, const obj_id_t obj_id) {
   auto *lfu = static_cast<eviction::LFUCpp *>(cache->eviction_params);
-  cache_obj_t *obj = hashtable_find_obj_id(cache->hashtable, obj_id);
-  if (obj == nullptr) {
-    return false;
-  }
-  bool ret = lfu->remove(cache, obj_id);
-  cache_remove_obj_base(cache, obj, true);
-  return true;
+  return lfu->remove(cache, obj_id);
 }
 
 #ifdef __cplusplus
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "../../../dataStructure/hashtable/hashtable.h"
+#include "../../../dataStructure/indexedHeap.h"
 #include "../../../include/libCacheSim/cache.h"
 #include "../../../include/libCacheSim/cacheObj.h"
 
@@ -33,52 +34,48 @@ struct pq_node_type {
   pq_node_type(cache_obj_t *obj, double priority, int64_t last_request_vtime)
       : obj(obj), priority(priority), last_request_vtime(last_request_vtime){};
 
+  explicit pq_node_type(const heap_entry_t &entry)
+      : obj(entry.obj), priority(entry.pri), last_request_vtime(entry.tie){};
+
   void print() const {
     printf("obj %lu, priority %f, last_request_vtime %ld\n",
            (unsigned long)obj->obj_id, priority, (long)last_request_vtime);
   }
-
-  bool operator<(const pq_node_type &rhs) const {
-    if (this->priority == rhs.priority) {
-      /* use FIFO when objects have the same priority */
-      return this->last_request_vtime < rhs.last_request_vtime;
-    }
-
-    return this->priority < rhs.priority;
-  }
-
-  bool operator==(const pq_node_type &n) {
-    return this->obj->obj_id == n.obj->obj_id;
-  }
 };
 
 class abstractRank {
-  /* ranking based eviction algorithm */
+  /* ranking based eviction algorithm, objects are kept in an indexed heap
+   * and the heap position is stored in obj->lfu.heap_pos */
 
  public:
-  abstractRank() = default;
+  abstractRank()
+      : heap(create_indexed_heap(1024, offsetof(cache_obj_t, lfu.heap_pos))) {}
 
-  inline pq_node_type peek_lowest_score() {
-    auto p = pq.begin();
-    pq_node_type p_copy(*p);
+  ~abstractRank() { free_indexed_heap(heap); }
 
-    return std::move(p_copy);
+  abstractRank(const abstractRank &) = delete;
+  abstractRank &operator=(const abstractRank &) = delete;
+
+  inline void insert(cache_obj_t *obj, double priority,
+                     int64_t last_request_vtime) {
+    indexed_heap_push(heap, obj, priority, last_request_vtime);
   }
 
-  inline pq_node_type pop_lowest_score() {
-    auto p = pq.begin();
-    pq_node_type p_copy(*p);
-    // itr_map.erase(get<0>(*p));
-    itr_map.erase(p->obj);
-    pq.erase(p);
+  inline void update(cache_obj_t *obj, double priority,
+                     int64_t last_request_vtime) {
+    indexed_heap_update(heap, obj, priority, last_request_vtime);
+  }
+
+  inline pq_node_type peek_lowest_score() {
+    return pq_node_type(*indexed_heap_peek(heap));
+  }
 
-    return std::move(p_copy);
+  inline pq_node_type pop_lowest_score() {
+    return pq_node_type(indexed_heap_pop(heap));
   }
 
   inline void remove_obj(cache_t *cache, cache_obj_t *obj) {
-    auto itr = itr_map[obj];
-    pq.erase(itr);
-    itr_map.erase(obj);
+    indexed_heap_remove(heap, obj);
     cache_remove_obj_base(cache, obj, true);
   }
 
@@ -92,9 +89,6 @@ class abstractRank {
     return true;
   }
 
-  std::set<pq_node_type> pq{};
-  std::unordered_map<cache_obj_t *, std::set<pq_node_type>::iterator> itr_map{};
-
- private:
+  indexed_heap_t *heap;
 };
 }  // namespace eviction
@@ -0,0 +1,183 @@
+//
+// miniature simulation with spatially sampled shadow caches, see miniSim.h
+//
+// miniSim.c
+// libCacheSim
+//
+
+#include "../include/libCacheSim/miniSim.h"
+
+#include "../dataStructure/hash/hash.h"
+#include "../dataStructure/hashtable/hashtable.h"
+#include "../include/libCacheSim/sampling.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct mini_sim {
+  int n_size;
+  int64_t *cache_sizes;
+  cache_t **shadows;
+
+  /* a request is sampled if hash % SAMPLING_RATIO_SCALE < sampling_boundary */
+  uint64_t sampling_boundary;
+  int64_t decay_interval;
+  double decay;
+  int64_t n_sampled_since_decay;
+
+  /* the (decayed) sampled requests and the misses at each size */
+  double n_req;
+  double n_req_byte;
+  double *n_miss;
+  double *n_miss_byte;
+};
+
+mini_sim_t *create_mini_sim(const cache_t *cache,
+                            const mini_sim_params_t *params) {
+  if (params->n_size < 1) {
+    ERROR("mini sim needs at least one size\n");
+    abort();
+  }
+  if (params->sampling_ratio <= 0 || params->sampling_ratio > 1) {
+    ERROR("mini sim sampling ratio must be in (0, 1], %lf\n",
+          params->sampling_ratio);
+    abort();
+  }
+
+  mini_sim_t *mini_sim = my_malloc(mini_sim_t);
+  memset(mini_sim, 0, sizeof(mini_sim_t));
+  mini_sim->n_size = params->n_size;
+  mini_sim->sampling_boundary =
+      (uint64_t)(params->sampling_ratio * SAMPLING_RATIO_SCALE);
+  mini_sim->decay_interval = params->decay_interval;
+  mini_sim->decay = params->decay;
+
+  mini_sim->cache_sizes = my_malloc_n(int64_t, params->n_size);
+  mini_sim->shadows = my_malloc_n(cache_t *, params->n_size);
+  mini_sim->n_miss = calloc(params->n_size, sizeof(double));
+  mini_sim->n_miss_byte = calloc(params->n_size, sizeof(double));
+
+  int64_t max_size =
+      params->max_size > 0 ? params->max_size : cache->cache_size * 2;
+  common_cache_params_t cc_params = {
+      .cache_size = 0,
+      .default_ttl = cache->default_ttl,
+      .hashpower = params->hashpower,
+      .consider_obj_metadata = cache->obj_md_size != 0,
+  };
+  for (int i = 0; i < params->n_size; i++) {
+    mini_sim->cache_sizes[i] =
+        (int64_t)((double)max_size * (i + 1) / params->n_size);
+    cc_params.cache_size = (uint64_t)((double)mini_sim->cache_sizes[i] *
+                                      params->sampling_ratio);
+    cache_t *shadow = cache->cache_init(cc_params, cache->init_params);
+    if (cache->admissioner != NULL) {
+      shadow->admissioner = cache->admissioner->clone(cache->admissioner);
+    }
+    if (cache->hashtable->obj_struct_size != sizeof(cache_obj_t)) {
+      cache_use_compact_obj(shadow);
+    }
+    mini_sim->shadows[i] = shadow;
+  }
+
+  return mini_sim;
+}
+
+void free_mini_sim(mini_sim_t *mini_sim) {
+  for (int i = 0; i < mini_sim->n_size; i++) {
+    mini_sim->shadows[i]->cache_free(mini_sim->shadows[i]);
+  }
+  my_free(sizeof(int64_t) * mini_sim->n_size, mini_sim->cache_sizes);
+  my_free(sizeof(cache_t *) * mini_sim->n_size, mini_sim->shadows);
+  free(mini_sim->n_miss);
+  free(mini_sim->n_miss_byte);
+  my_free(sizeof(mini_sim_t), mini_sim);
+}
+
+bool mini_sim_feed(mini_sim_t *mini_sim, const request_t *req) {
+  uint64_t hv = req->hv != 0 ? req->hv : get_hash_value_int_64(&req->obj_id);
+  if (hv % SAMPLING_RATIO_SCALE >= mini_sim->sampling_boundary) {
+    return false;
+  }
+
+  mini_sim->n_req += 1;
+  mini_sim->n_req_byte += (double)req->obj_size;
+  for (int i = 0; i < mini_sim->n_size; i++) {
+    cache_t *shadow = mini_sim->shadows[i];
+    if (!shadow->get(shadow, req)) {
+      mini_sim->n_miss[i] += 1;
+      mini_sim->n_miss_byte[i] += (double)req->obj_size;
+    }
+  }
+
+  if (mini_sim->decay_interval > 0 &&
+      ++mini_sim->n_sampled_since_decay >= mini_sim->decay_interval) {
+    mini_sim_decay(mini_sim, mini_sim->decay);
+    mini_sim->n_sampled_since_decay = 0;
+  }
+
+  return true;
+}
+
+void mini_sim_decay(mini_sim_t *mini_sim, double decay) {
+  mini_sim->n_req *= decay;
+  mini_sim->n_req_byte *= decay;
+  for (int i = 0; i < mini_sim->n_size; i++) {
+    mini_sim->n_miss[i] *= decay;
+    mini_sim->n_miss_byte[i] *= decay;
+  }
+}
+
+double mini_sim_get_n_req(const mini_sim_t *mini_sim) {
+  return mini_sim->n_req;
+}
+
+int mini_sim_get_mrc(const mini_sim_t *mini_sim, int64_t *cache_sizes,
+                     double *miss_ratios, double *byte_miss_ratios) {
+  for (int i = 0; i < mini_sim->n_size; i++) {
+    cache_sizes[i] = mini_sim->cache_sizes[i];
+    miss_ratios[i] =
+        mini_sim->n_req > 0 ? mini_sim->n_miss[i] / mini_sim->n_req : 0;
+    if (byte_miss_ratios != NULL) {
+      byte_miss_ratios[i] =
+          mini_sim->n_req_byte > 0
+              ? mini_sim->n_miss_byte[i] / mini_sim->n_req_byte
+              : 0;
+    }
+  }
+  return mini_sim->n_size;
+}
+
+double mini_sim_get_miss_ratio(const mini_sim_t *mini_sim, int64_t cache_size) {
+  if (mini_sim->n_req == 0) {
+    return 0;
+  }
+
+  int64_t lo_size = 0;
+  double lo_miss = mini_sim->n_req;
+  for (int i = 0; i < mini_sim->n_size; i++) {
+    int64_t hi_size = mini_sim->cache_sizes[i];
+    double hi_miss = mini_sim->n_miss[i];
+    if (cache_size <= hi_size) {
+      double frac = hi_size == lo_size ? 1.0
+                                       : (double)(cache_size - lo_size) /
+                                             (double)(hi_size - lo_size);
+      return (lo_miss + (hi_miss - lo_miss) * frac) / mini_sim->n_req;
+    }
+    lo_size = hi_size;
+    lo_miss = hi_miss;
+  }
+  return lo_miss / mini_sim->n_req;
+}
+
+void cache_enable_mini_sim(cache_t *cache, const mini_sim_params_t *params) {
+  if (cache->mini_sim != NULL) {
+    free_mini_sim(cache->mini_sim);
+  }
+  cache->mini_sim = create_mini_sim(cache, params);
+}
+
+#ifdef __cplusplus
+}
+#endif
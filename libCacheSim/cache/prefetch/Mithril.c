@@ -18,6 +18,7 @@
 
 #include "../../include/libCacheSim/prefetchAlgo.h"
 #include "../../include/libCacheSim/prefetchAlgo/Mithril.h"
+#include "../../utils/include/bgTask.h"
 #include "glibconfig.h"
 
 #define TRACK_BLOCK 192618l
@@ -29,6 +30,38 @@
 extern "C" {
 #endif
 
+/** the input and output of one mining, the task only uses the fields
+ *  of the job, so it does not touch the tables used in the request path
+ **/
+typedef struct {
+  /** the mining table being mined, it is swapped with
+   *  rmtable->mining_table when mining starts, so that new entries are
+   *  recorded into the other table while the mining runs in the background
+   **/
+  GArray *mining_table;
+  gint mtable_row_len;
+  gint lookahead_range;
+  gint max_support;
+  gint confidence;
+  guint64 ts;
+
+  /** the timestamps of the sorted rows decoded to 32-bit integers,
+   *  row i is timestamps[i * max_support, (i + 1) * max_support),
+   *  so that the rows are compared with a loop on contiguous integers
+   **/
+  gint32 *timestamps;
+  gint *n_timestamps;
+  gint n_row_allocated;
+
+  /* the (source, associated) obj_id pairs found, in the order of mining */
+  GArray *assoc;
+} Mithril_mining_job_t;
+
+typedef struct Mithril_mining {
+  Mithril_mining_job_t job;
+  bg_task_t task;
+} Mithril_mining_t;
+
 // ***********************************************************************
 // ****                                                               ****
 // ****               helper function declarations                    ****
@@ -42,6 +75,8 @@ static inline void _Mithril_rec_min_support_one(cache_t *Mithril,
                                                 const request_t *req);
 static inline gint _Mithril_get_total_num_of_ts(gint64 *row, gint row_length);
 static void _Mithril_mining(cache_t *Mithril);
+static void _Mithril_mining_task(void *job);
+static void _Mithril_merge_mining_result(cache_t *Mithril);
 
 static void _Mithril_add_to_prefetch_table(cache_t *Mithril, gpointer gp1,
                                            gpointer gp2);
@@ -51,7 +86,7 @@ const char *Mithril_default_params(void) {
          "max-support=8, min-support=2, confidence=1, pf-list-size=2, "
          "rec-trigger=miss, block-size=1, max-metadata-size=0.1, "
          "cycle-time=2, mining-threshold=5120, sequential-type=0, "
-         "sequential-K=-1, AMP-pthreshold=-1";
+         "sequential-K=-1, AMP-pthreshold=-1, mining-mode=inline";
 }
 
 static void set_Mithril_default_init_params(
@@ -71,6 +106,8 @@ static void set_Mithril_default_init_params(
   init_params->sequential_K = -1;
 
   init_params->AMP_pthreshold = -1;
+
+  init_params->mining_mode = mining_inline;
 }
 
 static void Mithril_parse_init_params(const char *cache_specific_params,
@@ -119,6 +156,17 @@ static void Mithril_parse_init_params(const char *cache_specific_params,
       init_params->sequential_K = atoi(value);
     } else if (strcasecmp(key, "AMP-pthreshold") == 0) {
       init_params->AMP_pthreshold = atoi(value);
+    } else if (strcasecmp(key, "mining-mode") == 0) {
+      if (strcasecmp(value, "inline") == 0) {
+        init_params->mining_mode = mining_inline;
+      } else if (strcasecmp(value, "epoch") == 0) {
+        init_params->mining_mode = mining_epoch;
+      } else if (strcasecmp(value, "async") == 0) {
+        init_params->mining_mode = mining_async;
+      } else {
+        ERROR("Unknown mining-mode %s, support inline/epoch/async\n", value);
+        exit(1);
+      }
     } else if (strcasecmp(key, "print") == 0 ||
                strcasecmp(key, "default") == 0) {
       printf("default params: %s\n", Mithril_default_params());
@@ -151,6 +199,7 @@ static void set_Mithril_params(Mithril_params_t *Mithril_params,
       (gint)(init_params->mining_threshold / Mithril_params->min_support);
 
   Mithril_params->rec_trigger = init_params->rec_trigger;
+  Mithril_params->mining_mode = init_params->mining_mode;
 
   Mithril_params->max_metadata_size =
       (gint64)(init_params->block_size * cache_size *
@@ -167,6 +216,11 @@ static void set_Mithril_params(Mithril_params_t *Mithril_params,
       (init_params->max_support * 2 + 8 + 4) * Mithril_params->mtable_size +
       max_num_of_shards_in_prefetch_table * 8 +
       PREFETCH_TABLE_SHARD_SIZE * (Mithril_params->pf_list_size * 8 + 8 + 4);
+  if (Mithril_params->mining_mode != mining_inline) {
+    /* the second mining table used when mining in the background */
+    Mithril_params->cur_metadata_size +=
+        (init_params->max_support * 2 + 8 + 4) * Mithril_params->mtable_size;
+  }
 
   Mithril_params->rmtable = g_new0(rec_mining_t, 1);
   rec_mining_t *rmtable = Mithril_params->rmtable;
@@ -181,6 +235,17 @@ static void set_Mithril_params(Mithril_params_t *Mithril_params,
                         Mithril_params->mtable_size);
   rmtable->hashtable =
       g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+
+  Mithril_params->mining = my_malloc(Mithril_mining_t);
+  memset(Mithril_params->mining, 0, sizeof(Mithril_mining_t));
+  Mithril_mining_job_t *job = &Mithril_params->mining->job;
+  job->mining_table =
+      g_array_sized_new(FALSE, TRUE, sizeof(int64_t) * rmtable->mtable_row_len,
+                        Mithril_params->mtable_size);
+  job->assoc = g_array_new(FALSE, FALSE, sizeof(gint64) * 2);
+  bg_task_init(&Mithril_params->mining->task,
+               Mithril_params->mining_mode == mining_inline);
+
   Mithril_params->prefetch_hashtable =
       g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
   Mithril_params->cache_size_map =
@@ -331,6 +396,11 @@ void Mithril_prefetch(cache_t *cache, const request_t *req) {
   Mithril_params_t *Mithril_params =
       (Mithril_params_t *)(cache->prefetcher->params);
 
+  if (Mithril_params->mining_mode == mining_async &&
+      bg_task_try_collect(&Mithril_params->mining->task)) {
+    _Mithril_merge_mining_result(cache);
+  }
+
   gint prefetch_table_index = GPOINTER_TO_INT(g_hash_table_lookup(
       Mithril_params->prefetch_hashtable, GINT_TO_POINTER(req->obj_id)));
 
@@ -413,6 +483,14 @@ void Mithril_prefetch(cache_t *cache, const request_t *req) {
 void free_Mithril_prefetcher(prefetcher_t *prefetcher) {
   Mithril_params_t *Mithril_params = (Mithril_params_t *)prefetcher->params;
 
+  /* the associations of an unfinished mining are dropped */
+  bg_task_wait(&Mithril_params->mining->task);
+  g_array_free(Mithril_params->mining->job.mining_table, TRUE);
+  g_array_free(Mithril_params->mining->job.assoc, TRUE);
+  g_free(Mithril_params->mining->job.timestamps);
+  g_free(Mithril_params->mining->job.n_timestamps);
+  my_free(sizeof(Mithril_mining_t), Mithril_params->mining);
+
   g_hash_table_destroy(Mithril_params->prefetch_hashtable);
   g_hash_table_destroy(Mithril_params->cache_size_map);
   g_hash_table_destroy(Mithril_params->rmtable->hashtable);
@@ -919,7 +997,13 @@ void print_prefetch_table(Mithril_params_t *Mithril_params) {
 }
 
 /**
- the mining funciton, it is called when mining table is ready
+ the mining funciton, it is called when mining table is ready,
+ the mining table is handed to the mining task and new entries are recorded
+ into the other mining table, the associations found are added to the
+ prefetch table by _Mithril_merge_mining_result,
+ which happens before returning in inline mode,
+ at the start of the next mining in epoch mode,
+ and at the first request after the mining finishes in async mode
 
  @param Mithril the cache struct
  */
@@ -927,6 +1011,83 @@ static void _Mithril_mining(cache_t *cache) {
   Mithril_params_t *Mithril_params =
       (Mithril_params_t *)(cache->prefetcher->params);
   rec_mining_t *rmtable = Mithril_params->rmtable;
+  Mithril_mining_job_t *job = &Mithril_params->mining->job;
+
+  /* the previous mining must finish before its table is reused */
+  if (bg_task_wait(&Mithril_params->mining->task)) {
+    _Mithril_merge_mining_result(cache);
+  }
+
+  /* first remove all elements from hashtable, the rows will be sorted and
+   new requests of these blocks are recorded as new entries */
+  gint64 *item = (gint64 *)rmtable->mining_table->data;
+  for (int i = 0; i < (int)rmtable->mining_table->len; i++) {
+    g_hash_table_remove(rmtable->hashtable, GINT_TO_POINTER(*item));
+    item += rmtable->mtable_row_len;
+  }
+
+  /* swap the mining tables, the table of the job has been cleared */
+  GArray *empty_table = job->mining_table;
+  job->mining_table = rmtable->mining_table;
+  rmtable->mining_table = empty_table;
+
+  job->mtable_row_len = rmtable->mtable_row_len;
+  job->lookahead_range = Mithril_params->lookahead_range;
+  job->max_support = Mithril_params->max_support;
+  job->confidence = Mithril_params->confidence;
+  job->ts = Mithril_params->ts;
+
+  bg_task_submit(&Mithril_params->mining->task, _Mithril_mining_task, job);
+  if (Mithril_params->mining_mode != mining_epoch &&
+      bg_task_try_collect(&Mithril_params->mining->task)) {
+    _Mithril_merge_mining_result(cache);
+  }
+
+#ifdef debug
+  print_prefetch_table(Mithril_params);
+#endif
+}
+
+/**
+ decode the timestamps of the sorted mining table into job->timestamps,
+ the n-th timestamp of row i is the same as GET_NTH_TS(row i, n)
+
+ @param job the mining job
+ */
+static void _Mithril_decode_timestamps(Mithril_mining_job_t *job) {
+  GArray *mining_table = job->mining_table;
+  gint n_row = (gint)mining_table->len;
+  gint max_support = job->max_support;
+
+  if (n_row > job->n_row_allocated) {
+    g_free(job->timestamps);
+    g_free(job->n_timestamps);
+    job->timestamps = g_new(gint32, (gsize)n_row * max_support);
+    job->n_timestamps = g_new(gint, n_row);
+    job->n_row_allocated = n_row;
+  }
+
+  gint64 *row = (gint64 *)mining_table->data;
+  for (gint i = 0; i < n_row; i++) {
+    gint32 *ts = job->timestamps + (gsize)i * max_support;
+    ts[0] = 0;
+    for (gint n = 1; n < max_support; n++) {
+      ts[n] = GET_NTH_TS(row, n);
+    }
+    job->n_timestamps[i] =
+        _Mithril_get_total_num_of_ts(row, job->mtable_row_len);
+    row += job->mtable_row_len;
+  }
+}
+
+/**
+ sort the mining table and find the associated blocks,
+ the associations are appended to job->assoc
+
+ @param job the mining job
+ */
+static void _Mithril_mining_task(void *arg) {
+  Mithril_mining_job_t *job = (Mithril_mining_job_t *)arg;
 
 #ifdef PROFILING
   GTimer *timer = g_timer_new();
@@ -935,39 +1096,35 @@ static void _Mithril_mining(cache_t *cache) {
 #endif
 
   int i, j, k;
+  GArray *mining_table = job->mining_table;
+  gint n_row = (gint)mining_table->len;
+  gint max_support = job->max_support;
+  gint lookahead_range = job->lookahead_range;
+  gint confidence = job->confidence;
 
-  /* first sort mining table, then do the mining */
-  /* first remove all elements from hashtable, otherwise after sort, it will
-   mess up for obj_id_type l but we can't do this for dataType c, otherwise
-   the string will be freed during remove in hashtable
-   */
-  gint64 *item = (gint64 *)rmtable->mining_table->data;
-  for (i = 0; i < (int)rmtable->mining_table->len; i++) {
-    g_hash_table_remove(rmtable->hashtable, GINT_TO_POINTER(*item));
-    item += rmtable->mtable_row_len;
-  }
-
-  g_array_sort(rmtable->mining_table, mining_table_entry_cmp);
+  g_array_sort(mining_table, mining_table_entry_cmp);
+  _Mithril_decode_timestamps(job);
+  gint64 *rows = (gint64 *)mining_table->data;
 
   gboolean associated_flag, first_flag;
-  gint64 *item1, *item2;
+  gint32 *ts1, *ts2;
   gint num_of_ts1, num_of_ts2, shorter_length;
-  for (i = 0; i < (long)rmtable->mining_table->len - 1; i++) {
-    item1 = GET_ROW_IN_MTABLE(Mithril_params, i);
-    num_of_ts1 = _Mithril_get_total_num_of_ts(item1, rmtable->mtable_row_len);
+  gint64 pair[2];
+  for (i = 0; i < n_row - 1; i++) {
+    ts1 = job->timestamps + (gsize)i * max_support;
+    num_of_ts1 = job->n_timestamps[i];
     first_flag = TRUE;
 
-    for (j = i + 1; j < (long)rmtable->mining_table->len; j++) {
-      item2 = GET_ROW_IN_MTABLE(Mithril_params, j);
+    for (j = i + 1; j < n_row; j++) {
+      ts2 = job->timestamps + (gsize)j * max_support;
 
       // check first timestamp
-      if (GET_NTH_TS(item2, 1) - GET_NTH_TS(item1, 1) >
-          Mithril_params->lookahead_range) {
+      if (ts2[1] - ts1[1] > lookahead_range) {
         break;
       }
-      num_of_ts2 = _Mithril_get_total_num_of_ts(item2, rmtable->mtable_row_len);
+      num_of_ts2 = job->n_timestamps[j];
 
-      if (ABS(num_of_ts1 - num_of_ts2) > Mithril_params->confidence) {
+      if (ABS(num_of_ts1 - num_of_ts2) > confidence) {
         continue;
       }
 
@@ -979,48 +1136,59 @@ static void _Mithril_mining(cache_t *cache) {
         first_flag = FALSE;
       }
       // is next line useless??
-      if (shorter_length == 1 &&
-          ABS(GET_NTH_TS(item1, 1) - GET_NTH_TS(item2, 1)) == 1) {
+      if (shorter_length == 1 && ABS(ts1[1] - ts2[1]) == 1) {
         associated_flag = TRUE;
       }
 
-      gint error = 0;
+      /* count without branches so that the loop can be vectorized,
+       * too many errors reject the pair regardless of the adjacent ones */
+      gint error = 0, adjacent = 0;
       for (k = 1; k < shorter_length; k++) {
-        if (ABS(GET_NTH_TS(item1, k) - GET_NTH_TS(item2, k)) >
-            Mithril_params->lookahead_range) {
-          error++;
-          if (error > Mithril_params->confidence) {
-            associated_flag = FALSE;
-            break;
-          }
-        }
-
-        if (ABS(GET_NTH_TS(item1, k) - GET_NTH_TS(item2, k)) == 1) {
-          associated_flag = TRUE;
-        }
+        gint32 diff = ABS(ts1[k] - ts2[k]);
+        error += diff > lookahead_range;
+        adjacent += diff == 1;
+      }
+      if (error > confidence) {
+        associated_flag = FALSE;
+      } else if (adjacent > 0) {
+        associated_flag = TRUE;
       }
+
       if (associated_flag) {
-        // finally, add to prefetch table
-        _Mithril_add_to_prefetch_table(cache, GINT_TO_POINTER(item1[0]),
-                                       GINT_TO_POINTER(item2[0]));
+        pair[0] = rows[(gsize)i * job->mtable_row_len];
+        pair[1] = rows[(gsize)j * job->mtable_row_len];
+        g_array_append_val(job->assoc, pair);
       }
     }
   }
 
-  // may be just following?
-  rmtable->mining_table->len = 0;
+  mining_table->len = 0;
 
 #ifdef PROFILING
   printf("ts: %lu, clearing training data takes %lf seconds\n",
-         (unsigned long)Mithril_params->ts,
-         g_timer_elapsed(timer, &microsecond));
+         (unsigned long)job->ts, g_timer_elapsed(timer, &microsecond));
   g_timer_stop(timer);
   g_timer_destroy(timer);
 #endif
+}
 
-#ifdef debug
-  print_prefetch_table(Mithril_params);
-#endif
+/**
+ add the associations of the finished mining into prefetch table
+
+ @param Mithril the cache struct
+ */
+static void _Mithril_merge_mining_result(cache_t *cache) {
+  Mithril_params_t *Mithril_params =
+      (Mithril_params_t *)(cache->prefetcher->params);
+  GArray *assoc = Mithril_params->mining->job.assoc;
+
+  gint64 *pair = (gint64 *)assoc->data;
+  for (guint i = 0; i < assoc->len; i++) {
+    _Mithril_add_to_prefetch_table(cache, GINT_TO_POINTER(pair[0]),
+                                   GINT_TO_POINTER(pair[1]));
+    pair += 2;
+  }
+  assoc->len = 0;
 }
 
 /**
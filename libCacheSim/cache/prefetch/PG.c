@@ -1,6 +1,9 @@
 //
 //  a PG module that supports different obj size
 //
+//  PG records the objects requested within lookahead-range requests after
+//  each object as its successors, and prefetches the successors whose share
+//  of the recorded pairs is larger than prefetch-threshold
 //
 //  PG.c
 //  libCacheSim
@@ -17,15 +20,9 @@
 #include <strings.h>
 #include <sys/types.h>
 
+#include "../../dataStructure/hash/hash.h"
 #include "../../include/libCacheSim/prefetchAlgo.h"
-
-#define TRACK_BLOCK 192618l
-#define SANITY_CHECK 1
-#define PROFILING
-// #define DEBUG
-
 #include "../../include/libCacheSim/prefetchAlgo/PG.h"
-#include "glibconfig.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,18 +33,18 @@ extern "C" {
 // ****               helper function declarations                    ****
 // ****                                                               ****
 // ***********************************************************************
-static inline void _graphNode_destroy(gpointer data);
-static inline void _PG_add_to_graph(cache_t *cache, const request_t *req);
-static inline GList *_PG_get_prefetch_list(cache_t *cache, const request_t *req);
+static inline void _PG_add_to_graph(PG_params_t *PG_params, const request_t *req);
+static inline int _PG_get_prefetch_list(PG_params_t *PG_params, const request_t *req);
 
 const char *PG_default_params(void) {
-  return "lookahead-range=20, "
+  return "lookahead-range=20, n-successor=20, "
          "block-size=1, max-metadata-size=0.1, "
          "prefetch-threshold=0.05";
 }
 
 static void set_PG_default_init_params(PG_init_params_t *init_params) {
   init_params->lookahead_range = 20;
+  init_params->n_successor = 20;
   init_params->block_size = 1;  // for general use
   init_params->max_metadata_size = 0.1;
   init_params->prefetch_threshold = 0.05;
@@ -55,6 +52,7 @@ static void set_PG_default_init_params(PG_init_params_t *init_params) {
 
 static void PG_parse_init_params(const char *cache_specific_params, PG_init_params_t *init_params) {
   char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
 
   while (params_str != NULL && params_str[0] != '\0') {
     char *key = strsep((char **)&params_str, "=");
@@ -64,6 +62,8 @@ static void PG_parse_init_params(const char *cache_specific_params, PG_init_para
     }
     if (strcasecmp(key, "lookahead-range") == 0) {
       init_params->lookahead_range = atoi(value);
+    } else if (strcasecmp(key, "n-successor") == 0) {
+      init_params->n_successor = atoi(value);
     } else if (strcasecmp(key, "block-size") == 0) {
       init_params->block_size = (unsigned long)atoi(value);
     } else if (strcasecmp(key, "max-metadata-size") == 0) {
@@ -79,26 +79,67 @@ static void PG_parse_init_params(const char *cache_specific_params, PG_init_para
       exit(1);
     }
   }
+  free(old_params_str);
+}
+
+static void PG_check_init_params(const PG_init_params_t *init_params) {
+  if (init_params->lookahead_range <= 0 || init_params->lookahead_range > PG_MAX_LOOKAHEAD_RANGE) {
+    ERROR("pg lookahead-range must be in [1, %d]\n", PG_MAX_LOOKAHEAD_RANGE);
+  }
+  if (init_params->n_successor <= 0 || init_params->n_successor > PG_MAX_N_SUCCESSOR) {
+    ERROR("pg n-successor must be in [1, %d]\n", PG_MAX_N_SUCCESSOR);
+  }
+  if (init_params->max_metadata_size <= 0 || init_params->max_metadata_size >= 1) {
+    ERROR("pg max-metadata-size must be in (0, 1)\n");
+  }
+  if (init_params->prefetch_threshold <= 0 || init_params->prefetch_threshold >= 1) {
+    ERROR("pg prefetch-threshold must be in (0, 1)\n");
+  }
+  if (init_params->block_size == 0) {
+    ERROR("pg block-size must be positive\n");
+  }
 }
 
 static void set_PG_params(PG_params_t *PG_params, PG_init_params_t *init_params, uint64_t cache_size) {
+  memset(PG_params, 0, sizeof(PG_params_t));
   PG_params->lookahead_range = init_params->lookahead_range;
+  PG_params->n_successor = init_params->n_successor;
   PG_params->block_size = init_params->block_size;
-  PG_params->cur_metadata_size = 0;
   PG_params->max_metadata_size = (uint64_t)(init_params->block_size * cache_size * init_params->max_metadata_size);
   PG_params->prefetch_threshold = init_params->prefetch_threshold;
 
-  PG_params->stop_recording = FALSE;
-
-  PG_params->graph = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, _graphNode_destroy);
-  PG_params->prefetched = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
-  PG_params->past_requests = g_new0(guint64, PG_params->lookahead_range);
+  /* a node uses its struct, its successors and two index slots */
+  uint64_t node_size =
+      sizeof(PG_node_t) + sizeof(PG_successor_t) * PG_params->n_successor + sizeof(uint32_t) * 2;
+  uint64_t n_node = MAX(PG_params->max_metadata_size / node_size, 1);
+  PG_params->n_node = (int32_t)MIN(n_node, (uint64_t)INT32_MAX / 2);
+  PG_params->n_used_node = 0;
+  PG_params->lru_head = -1;
+  PG_params->lru_tail = -1;
+
+  /* calloc so that the pages of a large graph are not touched until used */
+  PG_params->nodes = calloc(PG_params->n_node, sizeof(PG_node_t));
+  PG_params->successors = calloc((size_t)PG_params->n_node * PG_params->n_successor, sizeof(PG_successor_t));
+  uint64_t index_size = 2;
+  while (index_size < (uint64_t)PG_params->n_node * 2) {
+    index_size *= 2;
+  }
+  PG_params->index = calloc(index_size, sizeof(uint32_t));
+  PG_params->index_mask = index_size - 1;
+  if (PG_params->nodes == NULL || PG_params->successors == NULL || PG_params->index == NULL) {
+    ERROR("pg fails to allocate %d nodes\n", PG_params->n_node);
+  }
 
+  PG_params->past_obj_ids = calloc(PG_params->lookahead_range, sizeof(obj_id_t));
+  PG_params->past_obj_sizes = calloc(PG_params->lookahead_range, sizeof(int32_t));
   PG_params->past_request_pointer = 0;
-  PG_params->num_of_hit = 0;
-  PG_params->num_of_prefetch = 0;
+  PG_params->n_past_request = 0;
+
+  PG_params->prefetch_list = calloc(PG_params->n_successor, sizeof(PG_successor_t));
+  PG_params->prefetch_req = new_request();
 
-  PG_params->cache_size_map = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+  PG_params->num_of_prefetch = 0;
+  PG_params->num_of_node_eviction = 0;
 }
 
 // ***********************************************************************
@@ -109,9 +150,7 @@ static void set_PG_params(PG_params_t *PG_params, PG_init_params_t *init_params,
 // ***********************************************************************
 prefetcher_t *create_PG_prefetcher(const char *init_params, uint64_t cache_size);
 /**
- 1. record the request in cache_size_map for being aware of prefetching object's
- size in the future.
- 2. call `_PG_add_to_graph` to update graph.
+ call `_PG_add_to_graph` to update graph.
 
  @param cache the cache struct
  @param req the request containing the request
@@ -120,31 +159,7 @@ prefetcher_t *create_PG_prefetcher(const char *init_params, uint64_t cache_size)
 static void PG_handle_find(cache_t *cache, const request_t *req, bool hit) {
   PG_params_t *PG_params = (PG_params_t *)(cache->prefetcher->params);
 
-  /*use cache_size_map to record the current requested obj's size*/
-  g_hash_table_insert(PG_params->cache_size_map, GINT_TO_POINTER(req->obj_id), GINT_TO_POINTER(req->obj_size));
-
-  _PG_add_to_graph(cache, req);
-
-  if (g_hash_table_contains(PG_params->prefetched, GINT_TO_POINTER(req->obj_id))) {
-    PG_params->num_of_hit++;
-    g_hash_table_remove(PG_params->prefetched, GINT_TO_POINTER(req->obj_id));
-    if (g_hash_table_contains(PG_params->prefetched, GINT_TO_POINTER(req->obj_id))) {
-      fprintf(stderr, "ERROR found prefetch\n");
-    }
-  }
-}
-
-/**
- remove this obj from `prefetched` if it was previously prefetched into cache.
-
- @param cache the cache struct
- @param req the request containing the request
- @return
-*/
-void PG_handle_evict(cache_t *cache, const request_t *check_req) {
-  PG_params_t *PG_params = (PG_params_t *)(cache->prefetcher->params);
-
-  g_hash_table_remove(PG_params->prefetched, GINT_TO_POINTER(check_req->obj_id));
+  _PG_add_to_graph(PG_params, req);
 }
 
 /**
@@ -157,43 +172,38 @@ void PG_handle_evict(cache_t *cache, const request_t *check_req) {
 void PG_prefetch(cache_t *cache, const request_t *req) {
   PG_params_t *PG_params = (PG_params_t *)(cache->prefetcher->params);
 
-  // begin prefetching
-  GList *prefetch_list = _PG_get_prefetch_list(cache, req);
-  if (prefetch_list) {
-    GList *node = prefetch_list;
-    request_t *new_req = my_malloc(request_t);
-    copy_request(new_req, req);
-    while (node) {
-      new_req->obj_id = GPOINTER_TO_INT(node->data);
-      new_req->obj_size =
-          GPOINTER_TO_INT(g_hash_table_lookup(PG_params->cache_size_map, GINT_TO_POINTER(new_req->obj_id)));
-      if (!cache->find(cache, new_req, false)) {
-        while ((long)cache->get_occupied_byte(cache) + new_req->obj_size + cache->obj_md_size >
-               (long)cache->cache_size) {
-          cache->evict(cache, new_req);
-        }
-        cache->insert(cache, new_req);
-
-        PG_params->num_of_prefetch += 1;
-
-        g_hash_table_insert(PG_params->prefetched, GINT_TO_POINTER(new_req->obj_id), GINT_TO_POINTER(1));
+  int n_prefetch = _PG_get_prefetch_list(PG_params, req);
+  if (n_prefetch == 0) {
+    return;
+  }
+
+  request_t *new_req = PG_params->prefetch_req;
+  copy_request(new_req, req);
+  for (int i = 0; i < n_prefetch; i++) {
+    new_req->obj_id = PG_params->prefetch_list[i].obj_id;
+    new_req->obj_size = PG_params->prefetch_list[i].obj_size;
+    if (!cache->find(cache, new_req, false)) {
+      while ((long)cache->get_occupied_byte(cache) + new_req->obj_size + cache->obj_md_size >
+             (long)cache->cache_size) {
+        cache->evict(cache, new_req);
       }
-      node = node->next;
-    }
+      cache->insert(cache, new_req);
 
-    my_free(sizeof(request_t), new_req);
-    g_list_free(prefetch_list);
+      PG_params->num_of_prefetch += 1;
+    }
   }
 }
 
 void free_PG_prefetcher(prefetcher_t *prefetcher) {
   PG_params_t *PG_params = (PG_params_t *)prefetcher->params;
 
-  g_hash_table_destroy(PG_params->cache_size_map);
-  g_hash_table_destroy(PG_params->graph);
-  g_hash_table_destroy(PG_params->prefetched);
-
-  g_free(PG_params->past_requests);
+  free(PG_params->nodes);
+  free(PG_params->successors);
+  free(PG_params->index);
+  free(PG_params->past_obj_ids);
+  free(PG_params->past_obj_sizes);
+  free(PG_params->prefetch_list);
+  free_request(PG_params->prefetch_req);
 
   my_free(sizeof(PG_params_t), PG_params);
   if (prefetcher->init_params) {
@@ -213,7 +223,7 @@ prefetcher_t *create_PG_prefetcher(const char *init_params, uint64_t cache_size)
   set_PG_default_init_params(PG_init_params);
   if (init_params != NULL) {
     PG_parse_init_params(init_params, PG_init_params);
-    check_params((PG_init_params));
+    PG_check_init_params(PG_init_params);
   }
 
   PG_params_t *PG_params = my_malloc(PG_params_t);
@@ -226,7 +236,7 @@ prefetcher_t *create_PG_prefetcher(const char *init_params, uint64_t cache_size)
   prefetcher->prefetch = PG_prefetch;
   prefetcher->handle_find = PG_handle_find;
   prefetcher->handle_insert = NULL;
-  prefetcher->handle_evict = PG_handle_evict;
+  prefetcher->handle_evict = NULL;
   prefetcher->free = free_PG_prefetcher;
   prefetcher->clone = clone_PG_prefetcher;
   if (init_params) {
@@ -238,141 +248,201 @@ prefetcher_t *create_PG_prefetcher(const char *init_params, uint64_t cache_size)
 }
 
 /******************** PG help function ********************/
-static inline void _graphNode_destroy(gpointer data) {
-  graphNode_t *graphNode = (graphNode_t *)data;
-  g_hash_table_destroy(graphNode->graph);
-  pqueue_free(graphNode->pq);
-  g_free(graphNode);
+static inline PG_successor_t *_PG_get_successors(const PG_params_t *PG_params, int32_t node_idx) {
+  return PG_params->successors + (size_t)node_idx * PG_params->n_successor;
 }
 
 /**
- 1. insert the `req->obj_id` to the past_request_pointer.
- 2. update the graph using `past_requests[past_request_pointer]` as the
- node and `node->past_requests[i]` as the directed arc.
+ find the index slot of obj_id, the slot is empty if obj_id is not in the graph
 
- @param cache the cache struct
- @param req the request containing the request
- @return
+ @return the slot in PG_params->index
  */
-static inline void _PG_add_to_graph(cache_t *cache, const request_t *req) {
-  PG_params_t *PG_params = (PG_params_t *)(cache->prefetcher->params);
-  guint64 block, current_block = 0;
-  char req_lbl[MAX_OBJ_ID_LEN], current_req_lbl[MAX_OBJ_ID_LEN];
-  graphNode_t *graphNode = NULL;
-
-  current_block = get_Nth_past_request_l(PG_params, PG_params->past_request_pointer);
-  if (current_block) {
-    graphNode = (graphNode_t *)g_hash_table_lookup(PG_params->graph, GINT_TO_POINTER(current_block));
+static inline uint64_t _PG_find_slot(const PG_params_t *PG_params, obj_id_t obj_id) {
+  uint64_t slot = get_hash_value_int_64(&obj_id) & PG_params->index_mask;
+  while (PG_params->index[slot] != 0 && PG_params->nodes[PG_params->index[slot] - 1].obj_id != obj_id) {
+    slot = (slot + 1) & PG_params->index_mask;
   }
+  return slot;
+}
 
-  // now update past requests
-  set_Nth_past_request_l(PG_params, PG_params->past_request_pointer++, (guint64)(req->obj_id));
+static inline PG_node_t *_PG_find_node(const PG_params_t *PG_params, obj_id_t obj_id) {
+  uint32_t node_idx = PG_params->index[_PG_find_slot(PG_params, obj_id)];
+  return node_idx == 0 ? NULL : &PG_params->nodes[node_idx - 1];
+}
 
-  PG_params->past_request_pointer = PG_params->past_request_pointer % PG_params->lookahead_range;
+/**
+ remove the slot from the index, the following slots of the same cluster
+ are shifted back so that the lookups do not need tombstones
+ */
+static void _PG_remove_slot(PG_params_t *PG_params, uint64_t slot) {
+  uint64_t mask = PG_params->index_mask;
+  uint64_t next = (slot + 1) & mask;
+  while (PG_params->index[next] != 0) {
+    obj_id_t obj_id = PG_params->nodes[PG_params->index[next] - 1].obj_id;
+    uint64_t home = get_hash_value_int_64(&obj_id) & mask;
+    /* move the entry if its home is not in (slot, next] */
+    if (((next - home) & mask) >= ((next - slot) & mask)) {
+      PG_params->index[slot] = PG_params->index[next];
+      slot = next;
+    }
+    next = (next + 1) & mask;
+  }
+  PG_params->index[slot] = 0;
+}
 
-  if (!(current_req_lbl[0] || current_block)) {
-    // this is the first request
-    return;
+static inline void _PG_lru_unlink(PG_params_t *PG_params, int32_t node_idx) {
+  PG_node_t *node = &PG_params->nodes[node_idx];
+  if (node->prev != -1) {
+    PG_params->nodes[node->prev].next = node->next;
+  } else {
+    PG_params->lru_head = node->next;
   }
+  if (node->next != -1) {
+    PG_params->nodes[node->next].prev = node->prev;
+  } else {
+    PG_params->lru_tail = node->prev;
+  }
+}
 
-  if (graphNode == NULL) {
-    if (!PG_params->stop_recording) {
-      // current block is not in graph, insert
-      gpointer key = GINT_TO_POINTER(current_block);
-      graphNode = g_new0(graphNode_t, 1);
-      graphNode->graph = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
-      graphNode->pq = pqueue_init(2);
-      graphNode->total_count = 0;
-      g_hash_table_insert(PG_params->graph, key, graphNode);
-      PG_params->cur_metadata_size += (8 + 8 * 3);
-    } else {
-      // no space for meta data
-      return;
-    }
+static inline void _PG_lru_push_head(PG_params_t *PG_params, int32_t node_idx) {
+  PG_node_t *node = &PG_params->nodes[node_idx];
+  node->prev = -1;
+  node->next = PG_params->lru_head;
+  if (PG_params->lru_head != -1) {
+    PG_params->nodes[PG_params->lru_head].prev = node_idx;
   }
+  PG_params->lru_head = node_idx;
+  if (PG_params->lru_tail == -1) {
+    PG_params->lru_tail = node_idx;
+  }
+}
 
-  for (int i = 0; i < PG_params->lookahead_range; i++) {
-    graphNode->total_count++;
+/**
+ get the node of obj_id and move it to the head of the LRU list, if obj_id is
+ not in the graph, a free node or the least recently updated node is used
 
-    block = get_Nth_past_request_l(PG_params, i);
-    if (block == 0) break;
+ @return the index of the node
+ */
+static int32_t _PG_get_or_insert_node(PG_params_t *PG_params, obj_id_t obj_id) {
+  uint64_t slot = _PG_find_slot(PG_params, obj_id);
+  int32_t node_idx;
+  if (PG_params->index[slot] != 0) {
+    node_idx = (int32_t)PG_params->index[slot] - 1;
+    _PG_lru_unlink(PG_params, node_idx);
+    _PG_lru_push_head(PG_params, node_idx);
+    return node_idx;
+  }
 
-    pq_node_t *pq_node = (pq_node_t *)g_hash_table_lookup(graphNode->graph, GINT_TO_POINTER(block));
-    if (pq_node) {
-      // relation already exists
-      pq_node->pri.pri++;
-      pqueue_change_priority(graphNode->pq, pq_node->pri, pq_node);
+  if (PG_params->n_used_node < PG_params->n_node) {
+    node_idx = PG_params->n_used_node++;
+  } else {
+    /* reuse the least recently updated node */
+    node_idx = PG_params->lru_tail;
+    _PG_lru_unlink(PG_params, node_idx);
+    _PG_remove_slot(PG_params, _PG_find_slot(PG_params, PG_params->nodes[node_idx].obj_id));
+    PG_params->num_of_node_eviction += 1;
+    /* the removal may shift the slot of obj_id */
+    slot = _PG_find_slot(PG_params, obj_id);
+  }
 
-#ifdef SANITY_CHECK
-      if (pq_node->obj_id != block) {
-        ERROR("pq node content not equal block\n");
-      }
-#endif
+  PG_node_t *node = &PG_params->nodes[node_idx];
+  node->obj_id = obj_id;
+  node->total_count = 0;
+  node->n_successor = 0;
+  PG_params->index[slot] = (uint32_t)node_idx + 1;
+  _PG_lru_push_head(PG_params, node_idx);
+  return node_idx;
+}
 
-    } else {
-      // there is no probability between current_block->block
-      if (!PG_params->stop_recording) {
-        pq_node_t *pq_node = g_new0(pq_node_t, 1);
-        pq_node->obj_id = block;
-        pq_node->pri.pri = 1;
-        pqueue_insert(graphNode->pq, pq_node);
-        g_hash_table_insert(graphNode->graph, GINT_TO_POINTER(pq_node->obj_id), pq_node);
-        PG_params->cur_metadata_size += (8 + 8 * 3);
-      } else {
-        // no space for meta data
-        return;
-      }
+/**
+ add one (source, successor) pair to the node, if the successor array is
+ full, the successor with the smallest weight is replaced
+ */
+static inline void _PG_add_successor(PG_params_t *PG_params, int32_t node_idx, obj_id_t obj_id, int32_t obj_size) {
+  PG_node_t *node = &PG_params->nodes[node_idx];
+  PG_successor_t *successors = _PG_get_successors(PG_params, node_idx);
+
+  int min_idx = 0;
+  for (int i = 0; i < node->n_successor; i++) {
+    if (successors[i].obj_id == obj_id) {
+      successors[i].weight += 1;
+      successors[i].obj_size = obj_size;
+      return;
+    }
+    if (successors[i].weight < successors[min_idx].weight) {
+      min_idx = i;
     }
   }
 
-  if (PG_params->max_metadata_size <= PG_params->cur_metadata_size) {
-    PG_params->stop_recording = TRUE;
-  }
+  int idx = node->n_successor < PG_params->n_successor ? node->n_successor++ : min_idx;
+  successors[idx].obj_id = obj_id;
+  successors[idx].obj_size = obj_size;
+  successors[idx].weight = 1;
 }
 
 /**
- get some objs which are associated with req->obj_id and their probability
- is higher than `prefetch_threshold`.
+ 1. the request lookahead_range requests ago is the source.
+ 2. insert the `req->obj_id` to the past_request_pointer.
+ 3. add the past requests (including req) as the successors of the source.
 
- @param cache the cache struct
+ @param PG_params the PG params
  @param req the request containing the request
- @return list containing all objs that should be prefetched
+ @return
  */
-static inline GList *_PG_get_prefetch_list(cache_t *cache, const request_t *req) {
-  PG_params_t *PG_params = (PG_params_t *)(cache->prefetcher->params);
-  GList *list = NULL;
-  graphNode_t *graphNode = g_hash_table_lookup(PG_params->graph, GINT_TO_POINTER(req->obj_id));
+static inline void _PG_add_to_graph(PG_params_t *PG_params, const request_t *req) {
+  int32_t lookahead_range = PG_params->lookahead_range;
+  int32_t pointer = PG_params->past_request_pointer;
+  bool has_source = PG_params->n_past_request == lookahead_range;
+  obj_id_t source = PG_params->past_obj_ids[pointer];
 
-  if (graphNode == NULL) {
-    return list;
+  // now update past requests
+  PG_params->past_obj_ids[pointer] = req->obj_id;
+  PG_params->past_obj_sizes[pointer] = (int32_t)req->obj_size;
+  PG_params->past_request_pointer = (pointer + 1) % lookahead_range;
+  if (!has_source) {
+    PG_params->n_past_request += 1;
+    return;
   }
 
-  GList *pq_node_list = NULL;
-  while (1) {
-    pq_node_t *pqNode = pqueue_pop(graphNode->pq);
-    if (pqNode == NULL) {
-      break;
-    }
-    if ((double)(pqNode->pri.pri) / (graphNode->total_count) > PG_params->prefetch_threshold) {
-      list = g_list_prepend(list, GINT_TO_POINTER(pqNode->obj_id));
-      pq_node_list = g_list_prepend(pq_node_list, pqNode);
-    } else {
-      //            printf("threshold %lf\n",
-      //            (double)(pqNode->pri)/(graphNode->total_count));
-      break;
-    }
+  int32_t node_idx = _PG_get_or_insert_node(PG_params, source);
+  PG_params->nodes[node_idx].total_count += lookahead_range;
+  for (int i = 0; i < lookahead_range; i++) {
+    _PG_add_successor(PG_params, node_idx, PG_params->past_obj_ids[i], PG_params->past_obj_sizes[i]);
+  }
+}
+
+/**
+ get the successors of req->obj_id whose probability is higher than
+ `prefetch_threshold`, in increasing order of weight so that the most likely
+ one is inserted last.
+
+ @param PG_params the PG params
+ @param req the request containing the request
+ @return the number of successors in PG_params->prefetch_list
+ */
+static inline int _PG_get_prefetch_list(PG_params_t *PG_params, const request_t *req) {
+  PG_node_t *node = _PG_find_node(PG_params, req->obj_id);
+  if (node == NULL) {
+    return 0;
   }
 
-  if (pq_node_list) {
-    GList *node = pq_node_list;
-    while (node) {
-      pqueue_insert(graphNode->pq, node->data);
-      node = node->next;
+  const PG_successor_t *successors = _PG_get_successors(PG_params, (int32_t)(node - PG_params->nodes));
+  PG_successor_t *list = PG_params->prefetch_list;
+  int n = 0;
+  for (int i = 0; i < node->n_successor; i++) {
+    if ((double)successors[i].weight / node->total_count <= PG_params->prefetch_threshold) {
+      continue;
+    }
+    /* insertion sort, the list has at most n_successor entries */
+    int j = n++;
+    while (j > 0 && list[j - 1].weight > successors[i].weight) {
+      list[j] = list[j - 1];
+      j--;
     }
+    list[j] = successors[i];
   }
-  g_list_free(pq_node_list);
 
-  return list;
+  return n;
 }
 
 #ifdef __cplusplus
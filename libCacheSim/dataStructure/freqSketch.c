@@ -0,0 +1,147 @@
+//
+// a frequency sketch with 4-bit counters, see freqSketch.h
+//
+// freqSketch.c
+// libCacheSim
+//
+
+#include "freqSketch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/mem.h"
+#include "hash/hash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FREQ_SKETCH_CACHE_LINE 64
+/* the low three bits of each 4-bit counter */
+#define FREQ_SKETCH_HALVE_MASK 0x7777777777777777ULL
+#define FREQ_SKETCH_MAX_N_WORD (1LL << 32)
+
+/**
+ * @brief the hash value of the object, the low bits choose the block and the
+ * high 32 bits choose the counters in the block, 8 bits per counter
+ */
+static inline uint64_t _hash(obj_id_t obj_id) {
+  uint64_t hv = get_hash_value_int_64(&obj_id);
+  /* mix the low bits into the high bits in case the hash is weak */
+  uint64_t mixed = (hv & 0xffffffffULL) * 0x9E3779B97F4A7C15ULL;
+  return hv ^ (mixed & 0xffffffff00000000ULL);
+}
+
+static inline uint64_t *_get_block(const freq_sketch_t *sketch, uint64_t hv) {
+  return sketch->table + (hv & sketch->block_mask) * FREQ_SKETCH_BLOCK_N_WORD;
+}
+
+/* the i-th counter is in the words 2i and 2i + 1 of the block */
+static inline void _get_counter(uint64_t hv, int i, int *word, int *shift) {
+  uint32_t h = (uint32_t)(hv >> (32 + i * 8));
+  *word = i * 2 + (int)(h & 1);
+  *shift = (int)((h >> 1) & 15) * 4;
+}
+
+freq_sketch_t *create_freq_sketch(int64_t n_entry, int64_t sample_size) {
+  if (n_entry <= 0) {
+    ERROR("frequency sketch needs a positive number of entries, %ld\n",
+          (long)n_entry);
+    abort();
+  }
+
+  freq_sketch_t *sketch = my_malloc(freq_sketch_t);
+  memset(sketch, 0, sizeof(freq_sketch_t));
+
+  /* one word (16 counters) per entry, rounded to a power of two blocks */
+  int64_t n_word = FREQ_SKETCH_BLOCK_N_WORD;
+  while (n_word < n_entry && n_word < FREQ_SKETCH_MAX_N_WORD) {
+    n_word *= 2;
+  }
+  sketch->n_word = n_word;
+  sketch->block_mask = (uint64_t)(n_word / FREQ_SKETCH_BLOCK_N_WORD - 1);
+  sketch->sample_size = sample_size > 0 ? sample_size : n_entry * 10;
+
+  /* calloc so that the pages of a large table are not touched until used */
+  sketch->table_alloc =
+      calloc(n_word * sizeof(uint64_t) + FREQ_SKETCH_CACHE_LINE, 1);
+  if (sketch->table_alloc == NULL) {
+    ERROR("frequency sketch fails to allocate %ld words\n", (long)n_word);
+    abort();
+  }
+  uintptr_t addr = (uintptr_t)sketch->table_alloc;
+  sketch->table =
+      (uint64_t *)((addr + FREQ_SKETCH_CACHE_LINE - 1) &
+                   ~(uintptr_t)(FREQ_SKETCH_CACHE_LINE - 1));
+
+  return sketch;
+}
+
+void free_freq_sketch(freq_sketch_t *sketch) {
+  free(sketch->table_alloc);
+  my_free(sizeof(freq_sketch_t), sketch);
+}
+
+int freq_sketch_estimate(const freq_sketch_t *sketch, obj_id_t obj_id) {
+  uint64_t hv = _hash(obj_id);
+  const uint64_t *block = _get_block(sketch, hv);
+
+  int freq = FREQ_SKETCH_MAX_COUNT;
+  for (int i = 0; i < FREQ_SKETCH_DEPTH; i++) {
+    int word, shift;
+    _get_counter(hv, i, &word, &shift);
+    int count = (int)((block[word] >> shift) & 0xf);
+    freq = MIN(freq, count);
+  }
+  return freq;
+}
+
+int freq_sketch_add(freq_sketch_t *sketch, obj_id_t obj_id) {
+  uint64_t hv = _hash(obj_id);
+  uint64_t *block = _get_block(sketch, hv);
+
+  int words[FREQ_SKETCH_DEPTH], shifts[FREQ_SKETCH_DEPTH];
+  int counts[FREQ_SKETCH_DEPTH];
+  int freq = FREQ_SKETCH_MAX_COUNT;
+  for (int i = 0; i < FREQ_SKETCH_DEPTH; i++) {
+    _get_counter(hv, i, &words[i], &shifts[i]);
+    counts[i] = (int)((block[words[i]] >> shifts[i]) & 0xf);
+    freq = MIN(freq, counts[i]);
+  }
+
+  if (freq < FREQ_SKETCH_MAX_COUNT) {
+    /* conservative update, only the minimal counters are incremented */
+    for (int i = 0; i < FREQ_SKETCH_DEPTH; i++) {
+      if (counts[i] == freq) {
+        block[words[i]] += 1ULL << shifts[i];
+      }
+    }
+    freq += 1;
+  }
+
+  if (++sketch->n_add >= sketch->sample_size) {
+    freq_sketch_halve(sketch);
+  }
+
+  return freq;
+}
+
+void freq_sketch_halve(freq_sketch_t *sketch) {
+  for (int64_t i = 0; i < sketch->n_word; i++) {
+    sketch->table[i] = (sketch->table[i] >> 1) & FREQ_SKETCH_HALVE_MASK;
+  }
+  sketch->n_add /= 2;
+  sketch->n_halving += 1;
+}
+
+void freq_sketch_reset(freq_sketch_t *sketch) {
+  memset(sketch->table, 0, sketch->n_word * sizeof(uint64_t));
+  sketch->n_add = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,87 @@
+//
+// a frequency sketch (count-min sketch) with 4-bit counters, used by TinyLFU
+// to estimate the recent access frequency of objects, similar to the
+// frequency sketch of Caffeine
+//
+// the counters are packed 16 per 64-bit word, and the table is divided into
+// blocks of FREQ_SKETCH_BLOCK_N_WORD words (one cache line). an object maps
+// to one block, and each of its FREQ_SKETCH_DEPTH counters is in a different
+// pair of words of the block, so an add or an estimate touches one cache line.
+// the counters are incremented conservatively (only the minimal ones) and
+// saturate at FREQ_SKETCH_MAX_COUNT
+//
+// after sample_size adds, all counters are halved so that the sketch follows
+// the recent requests, the halving shifts 16 counters with one operation, and
+// its cost is amortized over the adds
+//
+// freqSketch.h
+// libCacheSim
+//
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../include/libCacheSim/request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FREQ_SKETCH_DEPTH 4
+#define FREQ_SKETCH_MAX_COUNT 15
+#define FREQ_SKETCH_BLOCK_N_WORD 8
+
+typedef struct freq_sketch {
+  /* aligned to the cache line */
+  uint64_t *table;
+  void *table_alloc;
+  int64_t n_word;
+  uint64_t block_mask;
+
+  /* the counters are halved after sample_size adds */
+  int64_t sample_size;
+  int64_t n_add;
+  int64_t n_halving;
+} freq_sketch_t;
+
+/**
+ * @brief create a frequency sketch
+ *
+ * @param n_entry the expected number of objects (e.g., the number of objects
+ * in the cache), the sketch uses about 8 - 16 bytes per entry
+ * @param sample_size the number of adds between two halvings,
+ * 0 uses 10 * n_entry
+ * @return freq_sketch_t*
+ */
+freq_sketch_t *create_freq_sketch(int64_t n_entry, int64_t sample_size);
+
+void free_freq_sketch(freq_sketch_t *sketch);
+
+/**
+ * @brief estimate the frequency of an object, in [0, FREQ_SKETCH_MAX_COUNT]
+ */
+int freq_sketch_estimate(const freq_sketch_t *sketch, obj_id_t obj_id);
+
+/**
+ * @brief add one access of an object, the counters are halved if this is the
+ * sample_size-th add since the last halving
+ *
+ * @return the frequency estimate after the add
+ */
+int freq_sketch_add(freq_sketch_t *sketch, obj_id_t obj_id);
+
+/**
+ * @brief halve all counters
+ */
+void freq_sketch_halve(freq_sketch_t *sketch);
+
+/**
+ * @brief clear all counters
+ */
+void freq_sketch_reset(freq_sketch_t *sketch);
+
+#ifdef __cplusplus
+}
+#endif
@@ -78,10 +78,16 @@ static inline void add_to_bucket(hashtable_t *hashtable,
 #endif
 }
 
+/* free an object allocated by the hash table */
+static inline void free_hashtable_obj(hashtable_t *hashtable,
+                                      cache_obj_t *cache_obj) {
+  free_sized_cache_obj(cache_obj, hashtable->obj_struct_size);
+}
+
 /* free object, called by other functions when iterating through the hashtable
  */
 static inline void foreach_free_obj(cache_obj_t *cache_obj, void *user_data) {
-  my_free(sizeof(cache_obj_t), cache_obj);
+  free_hashtable_obj((hashtable_t *)user_data, cache_obj);
 }
 
 /************************ hashtable func ************************/
@@ -103,6 +109,7 @@ hashtable_t *create_chained_hashtable_v2(const uint16_t hashpower) {
   madvise(hashtable->table, size, MADV_HUGEPAGE);
 #endif
   hashtable->external_obj = false;
+  hashtable->obj_struct_size = sizeof(cache_obj_t);
   hashtable->hashpower = hashpower;
   hashtable->n_obj = 0;
   return hashtable;
@@ -115,12 +122,23 @@ cache_obj_t *chained_hashtable_find_obj_id_v2(const hashtable_t *hashtable,
   hv = hv & hashmask(hashtable->hashpower);
   cache_obj = hashtable->ptr_table[hv];
 
+#ifdef ENABLE_PERF_STAT
+  /* the statistics are not part of the hash table content */
+  perf_hist_t *chain_len = &((hashtable_t *)hashtable)->chain_len;
+  uint64_t n_visited = 0;
+#endif
   while (cache_obj) {
+#ifdef ENABLE_PERF_STAT
+    n_visited += 1;
+#endif
     if (cache_obj->obj_id == obj_id) {
-      return cache_obj;
+      break;
     }
     cache_obj = cache_obj->hash_next;
   }
+#ifdef ENABLE_PERF_STAT
+  perf_hist_record(chain_len, n_visited);
+#endif
   return cache_obj;
 }
 
@@ -142,7 +160,8 @@ cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable,
     _chained_hashtable_expand_v2(hashtable);
   }
 
-  cache_obj_t *new_cache_obj = create_cache_obj_from_request(req);
+  cache_obj_t *new_cache_obj =
+      create_sized_cache_obj_from_request(req, hashtable->obj_struct_size);
   add_to_bucket(hashtable, new_cache_obj);
   hashtable->n_obj += 1;
   return new_cache_obj;
@@ -169,7 +188,7 @@ void chained_hashtable_delete_v2(hashtable_t *hashtable,
                 hashmask(hashtable->hashpower);
   if (hashtable->ptr_table[hv] == cache_obj) {
     hashtable->ptr_table[hv] = cache_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    if (!hashtable->external_obj) free_hashtable_obj(hashtable, cache_obj);
     return;
   }
 
@@ -195,7 +214,7 @@ void chained_hashtable_delete_v2(hashtable_t *hashtable,
   DEBUG_ASSERT(cur_obj != NULL);
   cur_obj->hash_next = cache_obj->hash_next;
   if (!hashtable->external_obj) {
-    free_cache_obj(cache_obj);
+    free_hashtable_obj(hashtable, cache_obj);
   }
 }
 
@@ -208,7 +227,7 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable,
   if (hashtable->ptr_table[hv] == cache_obj) {
     hashtable->ptr_table[hv] = cache_obj->hash_next;
     hashtable->n_obj -= 1;
-    if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    if (!hashtable->external_obj) free_hashtable_obj(hashtable, cache_obj);
     return true;
   }
 
@@ -241,7 +260,7 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable,
   if (cur_obj != NULL) {
     cur_obj->hash_next = cache_obj->hash_next;
     hashtable->n_obj -= 1;
-    if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    if (!hashtable->external_obj) free_hashtable_obj(hashtable, cache_obj);
     return true;
   }
   return false;
@@ -271,7 +290,7 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable,
   // the object to remove is the first object in the hash bucket
   if (cur_obj->obj_id == obj_id) {
     hashtable->ptr_table[hv] = cur_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cur_obj);
+    if (!hashtable->external_obj) free_hashtable_obj(hashtable, cur_obj);
     hashtable->n_obj -= 1;
     return true;
   }
@@ -286,7 +305,7 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable,
   // the object to remove is in the hash bucket
   if (cur_obj != NULL) {
     prev_obj->hash_next = cur_obj->hash_next;
-    if (!hashtable->external_obj) free_cache_obj(cur_obj);
+    if (!hashtable->external_obj) free_hashtable_obj(hashtable, cur_obj);
     hashtable->n_obj -= 1;
     return true;
   }
@@ -316,7 +335,7 @@ void chained_hashtable_foreach_v2(hashtable_t *hashtable,
 
 void free_chained_hashtable_v2(hashtable_t *hashtable) {
   if (!hashtable->external_obj)
-    chained_hashtable_foreach_v2(hashtable, foreach_free_obj, NULL);
+    chained_hashtable_foreach_v2(hashtable, foreach_free_obj, hashtable);
   my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower),
           hashtable->ptr_table);
   my_free(sizeof(hashtable_t), hashtable);
@@ -324,6 +343,9 @@ void free_chained_hashtable_v2(hashtable_t *hashtable) {
 
 /* grows the hashtable to the next power of 2. */
 static void _chained_hashtable_expand_v2(hashtable_t *hashtable) {
+#ifdef ENABLE_PERF_STAT
+  hashtable->n_expand += 1;
+#endif
   cache_obj_t **old_table = hashtable->ptr_table;
   hashtable->ptr_table =
       my_malloc_n(cache_obj_t *, hashsize(++hashtable->hashpower));
@@ -0,0 +1,106 @@
+//
+// a chained hash table with striped bucket locks,
+// see concurrentHashTable.h for the usage
+//
+// concurrentHashTable.c
+// libCacheSim
+//
+
+#include "concurrentHashTable.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
+#include "../../include/libCacheSim/mem.h"
+#include "hashtableStruct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+concurrent_hashtable_t *create_concurrent_hashtable(const uint16_t hashpower,
+                                                    const uint16_t lockpower) {
+  concurrent_hashtable_t *hashtable = my_malloc(concurrent_hashtable_t);
+  memset(hashtable, 0, sizeof(concurrent_hashtable_t));
+
+  hashtable->hashpower = hashpower;
+  /* a lock covers whole buckets, so it cannot use more bits than buckets */
+  hashtable->lockpower = MIN(lockpower, hashpower);
+  hashtable->hashmask = hashmask(hashtable->hashpower);
+  hashtable->lockmask = hashmask(hashtable->lockpower);
+
+  hashtable->ptr_table =
+      (concurrent_obj_t **)calloc(hashsize(hashpower), sizeof(void *));
+  if (hashtable->ptr_table == NULL) {
+    ERROR("allocate concurrent hash table %lu entries failed\n",
+          (unsigned long)hashsize(hashpower));
+  }
+#ifdef USE_HUGEPAGE
+  madvise(hashtable->ptr_table, hashsize(hashpower) * sizeof(void *),
+          MADV_HUGEPAGE);
+#endif
+
+  hashtable->locks = (concurrent_hashtable_lock_t *)aligned_alloc(
+      CONCURRENT_HASHTABLE_CACHE_LINE_SIZE,
+      sizeof(concurrent_hashtable_lock_t) * hashsize(hashtable->lockpower));
+  ASSERT_NOT_NULL(hashtable->locks, "allocate %lu hash table locks failed\n",
+                  (unsigned long)hashsize(hashtable->lockpower));
+  memset(hashtable->locks, 0,
+         sizeof(concurrent_hashtable_lock_t) * hashsize(hashtable->lockpower));
+
+  return hashtable;
+}
+
+void free_concurrent_hashtable(concurrent_hashtable_t *hashtable) {
+  for (uint64_t i = 0; i < hashsize(hashtable->hashpower); i++) {
+    concurrent_obj_t *obj = hashtable->ptr_table[i];
+    while (obj != NULL) {
+      concurrent_obj_t *next = obj->hash_next;
+      my_free(sizeof(concurrent_obj_t), obj);
+      obj = next;
+    }
+  }
+  free(hashtable->ptr_table);
+  free(hashtable->locks);
+  my_free(sizeof(concurrent_hashtable_t), hashtable);
+}
+
+concurrent_obj_t *concurrent_hashtable_find_locked(
+    const concurrent_hashtable_t *hashtable, const uint64_t hv,
+    const obj_id_t obj_id) {
+  concurrent_obj_t *obj = hashtable->ptr_table[hv & hashtable->hashmask];
+  while (obj != NULL && obj->obj_id != obj_id) {
+    obj = obj->hash_next;
+  }
+  return obj;
+}
+
+/* the user needs to make sure the object is not in the hash table */
+void concurrent_hashtable_insert_locked(concurrent_hashtable_t *hashtable,
+                                        const uint64_t hv,
+                                        concurrent_obj_t *obj) {
+  concurrent_obj_t **bucket = &hashtable->ptr_table[hv & hashtable->hashmask];
+  obj->hash_next = *bucket;
+  *bucket = obj;
+}
+
+/* remove the object from the table, the object is not freed */
+bool concurrent_hashtable_delete_locked(concurrent_hashtable_t *hashtable,
+                                        const uint64_t hv,
+                                        const concurrent_obj_t *obj) {
+  concurrent_obj_t **pp = &hashtable->ptr_table[hv & hashtable->hashmask];
+  while (*pp != NULL && *pp != obj) {
+    pp = &(*pp)->hash_next;
+  }
+  if (*pp == NULL) return false;
+
+  *pp = obj->hash_next;
+  return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+//
+// a chained hash table that can be shared by multiple threads
+//
+// buckets are protected by striped spin locks, a lock covers all the
+// buckets whose index is the same modulo the number of locks, the table does
+// not expand because expanding requires stopping all threads, so the user
+// should size it for the expected number of objects
+//
+// the caller computes the hash value once, takes the bucket lock and then
+// calls the *_locked functions, so that a lookup and an insert on a miss
+// happen in one critical section
+//
+// concurrentHashTable.h
+// libCacheSim
+//
+
+#ifndef libCacheSim_CONCURRENTHASHTABLE_H
+#define libCacheSim_CONCURRENTHASHTABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../include/libCacheSim/request.h"
+#include "../hash/hash.h"
+
+#define CONCURRENT_HASHTABLE_CACHE_LINE_SIZE 64
+
+/* the object stored in the concurrent hash table,
+ * unlike cache_obj_t, it is not packed so that fields can be updated with
+ * atomic instructions */
+typedef struct concurrent_obj {
+  struct concurrent_obj *hash_next;
+  obj_id_t obj_id;
+  uint32_t obj_size;
+  /* access counter, updated with relaxed atomics on the hit path */
+  uint8_t freq;
+  /* which queue the object is in, defined by the cache */
+  uint8_t queue_id;
+} concurrent_obj_t;
+
+typedef struct {
+  uint8_t locked;
+  char pad[CONCURRENT_HASHTABLE_CACHE_LINE_SIZE - 1];
+} concurrent_hashtable_lock_t;
+
+typedef struct concurrent_hashtable {
+  concurrent_obj_t **ptr_table;
+  concurrent_hashtable_lock_t *locks;
+  uint64_t hashmask;
+  uint64_t lockmask;
+  uint16_t hashpower;
+  uint16_t lockpower;
+} concurrent_hashtable_t;
+
+concurrent_hashtable_t *create_concurrent_hashtable(const uint16_t hashpower,
+                                                    const uint16_t lockpower);
+
+/* free the table and all objects still in the table */
+void free_concurrent_hashtable(concurrent_hashtable_t *hashtable);
+
+static inline uint64_t concurrent_hashtable_hv(const obj_id_t obj_id) {
+  return get_hash_value_int_64(&obj_id);
+}
+
+static inline void concurrent_hashtable_lock(concurrent_hashtable_t *hashtable,
+                                             const uint64_t hv) {
+  uint8_t *lock = &hashtable->locks[hv & hashtable->lockmask].locked;
+  int n_spin = 0;
+  while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+    /* spin on a read to avoid bouncing the cache line */
+    while (__atomic_load_n(lock, __ATOMIC_RELAXED)) {
+      if (++n_spin > 128) {
+        sched_yield();
+        n_spin = 0;
+      }
+    }
+  }
+}
+
+static inline void concurrent_hashtable_unlock(
+    concurrent_hashtable_t *hashtable, const uint64_t hv) {
+  __atomic_store_n(&hashtable->locks[hv & hashtable->lockmask].locked, 0,
+                   __ATOMIC_RELEASE);
+}
+
+/* the following functions must be called with the bucket lock held */
+concurrent_obj_t *concurrent_hashtable_find_locked(
+    const concurrent_hashtable_t *hashtable, const uint64_t hv,
+    const obj_id_t obj_id);
+
+void concurrent_hashtable_insert_locked(concurrent_hashtable_t *hashtable,
+                                        const uint64_t hv,
+                                        concurrent_obj_t *obj);
+
+bool concurrent_hashtable_delete_locked(concurrent_hashtable_t *hashtable,
+                                        const uint64_t hv,
+                                        const concurrent_obj_t *obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // libCacheSim_CONCURRENTHASHTABLE_H
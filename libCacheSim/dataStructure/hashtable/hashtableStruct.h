@@ -12,6 +12,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include "../../include/libCacheSim/cacheObj.h"
+#include "../../include/libCacheSim/perfStat.h"
 
 #define hashsize(n) ((uint64_t)1 << (uint16_t)(n))
 #define hashsizeULL(n) ((unsigned long long)1 << (uint16_t)(n))
@@ -29,6 +30,14 @@ typedef struct hashtable {
   uint16_t hashpower;
   bool external_obj; /* whether the object should be allocated by hash table,
                         this should be true most of the time */
+  /* the size of objects allocated by the hash table (V2 only), smaller than
+   * sizeof(cache_obj_t) if the cache uses compact objects */
+  uint32_t obj_struct_size;
+#ifdef ENABLE_PERF_STAT
+  /* the number of objects visited in each lookup (V2 only) */
+  perf_hist_t chain_len;
+  int64_t n_expand;
+#endif
   union {
     // used for hashtable V1, these cache_obj pointers are used by external
     // modules, so if hashtable needs to move the obj, their pointer need to be
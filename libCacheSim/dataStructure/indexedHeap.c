@@ -0,0 +1,160 @@
+//
+// an indexed 4-ary min-heap, see indexedHeap.h
+//
+// indexedHeap.c
+// libCacheSim
+//
+
+#include "indexedHeap.h"
+
+#include <stdlib.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HEAP_ARITY 4
+
+static inline int64_t _parent(int64_t pos) { return (pos - 1) / HEAP_ARITY; }
+
+static inline int64_t _first_child(int64_t pos) {
+  return pos * HEAP_ARITY + 1;
+}
+
+static inline bool _less(const heap_entry_t *a, const heap_entry_t *b) {
+  if (a->pri == b->pri) return a->tie < b->tie;
+  return a->pri < b->pri;
+}
+
+static inline void _set_pos(indexed_heap_t *heap, cache_obj_t *obj,
+                            int64_t pos) {
+  memcpy((char *)obj + heap->pos_offset, &pos, sizeof(int64_t));
+}
+
+/* move the entry to pos and record its position */
+static inline void _place(indexed_heap_t *heap, int64_t pos,
+                          const heap_entry_t *entry) {
+  heap->entries[pos] = *entry;
+  _set_pos(heap, entry->obj, pos);
+}
+
+static void _sift_up(indexed_heap_t *heap, int64_t pos) {
+  heap_entry_t entry = heap->entries[pos];
+  while (pos > 0) {
+    int64_t parent = _parent(pos);
+    if (!_less(&entry, &heap->entries[parent])) break;
+    _place(heap, pos, &heap->entries[parent]);
+    pos = parent;
+  }
+  _place(heap, pos, &entry);
+}
+
+static void _sift_down(indexed_heap_t *heap, int64_t pos) {
+  heap_entry_t entry = heap->entries[pos];
+  while (true) {
+    int64_t first = _first_child(pos);
+    if (first >= heap->n_entry) break;
+
+    int64_t last = MIN(first + HEAP_ARITY, heap->n_entry);
+    int64_t min_child = first;
+    for (int64_t child = first + 1; child < last; child++) {
+      if (_less(&heap->entries[child], &heap->entries[min_child])) {
+        min_child = child;
+      }
+    }
+    if (!_less(&heap->entries[min_child], &entry)) break;
+
+    _place(heap, pos, &heap->entries[min_child]);
+    pos = min_child;
+  }
+  _place(heap, pos, &entry);
+}
+
+/* remove the entry at pos by moving the last entry into it */
+static void _remove_at(indexed_heap_t *heap, int64_t pos) {
+  _set_pos(heap, heap->entries[pos].obj, INDEXED_HEAP_NOT_IN_HEAP);
+  heap->n_entry -= 1;
+  if (pos == heap->n_entry) return;
+
+  heap_entry_t last = heap->entries[heap->n_entry];
+  heap->entries[pos] = last;
+  if (pos > 0 && _less(&last, &heap->entries[_parent(pos)])) {
+    _sift_up(heap, pos);
+  } else {
+    _sift_down(heap, pos);
+  }
+}
+
+indexed_heap_t *create_indexed_heap(int64_t init_capacity, size_t pos_offset) {
+  indexed_heap_t *heap = my_malloc(indexed_heap_t);
+  heap->n_entry = 0;
+  heap->capacity = MAX(init_capacity, 16);
+  heap->pos_offset = pos_offset;
+  heap->entries =
+      (heap_entry_t *)malloc(sizeof(heap_entry_t) * heap->capacity);
+  ASSERT_NOT_NULL(heap->entries, "cannot allocate heap of %ld entries\n",
+                  (long)heap->capacity);
+  return heap;
+}
+
+void free_indexed_heap(indexed_heap_t *heap) {
+  free(heap->entries);
+  my_free(sizeof(indexed_heap_t), heap);
+}
+
+void indexed_heap_push(indexed_heap_t *heap, cache_obj_t *obj, double pri,
+                       int64_t tie) {
+  if (heap->n_entry == heap->capacity) {
+    heap->capacity *= 2;
+    heap->entries = (heap_entry_t *)realloc(
+        heap->entries, sizeof(heap_entry_t) * heap->capacity);
+    ASSERT_NOT_NULL(heap->entries, "cannot grow heap to %ld entries\n",
+                    (long)heap->capacity);
+  }
+
+  heap_entry_t entry = {.pri = pri, .tie = tie, .obj = obj};
+  int64_t pos = heap->n_entry++;
+  _place(heap, pos, &entry);
+  _sift_up(heap, pos);
+}
+
+void indexed_heap_update(indexed_heap_t *heap, cache_obj_t *obj, double pri,
+                         int64_t tie) {
+  int64_t pos = indexed_heap_get_pos(heap, obj);
+  DEBUG_ASSERT(pos >= 0 && pos < heap->n_entry);
+  DEBUG_ASSERT(heap->entries[pos].obj == obj);
+
+  heap_entry_t *entry = &heap->entries[pos];
+  heap_entry_t old_entry = *entry;
+  entry->pri = pri;
+  entry->tie = tie;
+  if (_less(entry, &old_entry)) {
+    _sift_up(heap, pos);
+  } else {
+    _sift_down(heap, pos);
+  }
+}
+
+void indexed_heap_remove(indexed_heap_t *heap, cache_obj_t *obj) {
+  int64_t pos = indexed_heap_get_pos(heap, obj);
+  if (pos == INDEXED_HEAP_NOT_IN_HEAP) return;
+
+  DEBUG_ASSERT(pos >= 0 && pos < heap->n_entry);
+  DEBUG_ASSERT(heap->entries[pos].obj == obj);
+  _remove_at(heap, pos);
+}
+
+heap_entry_t indexed_heap_pop(indexed_heap_t *heap) {
+  DEBUG_ASSERT(heap->n_entry > 0);
+  heap_entry_t top = heap->entries[0];
+  _remove_at(heap, 0);
+  return top;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,96 @@
+//
+// an indexed 4-ary min-heap of cache objects used by ranking-based eviction
+//
+// entries are (priority, tie, obj) stored by value in one array, entries with
+// the same priority are ordered by tie (e.g., the last request vtime for
+// FIFO order), the position of an entry in the array is stored in the cache
+// object at pos_offset, so an object can be updated or removed in
+// O(log n) without a lookup, and no memory is allocated per request
+//
+// a 4-ary heap is shallower than a binary heap and the four children of a
+// node are in the same one or two cache lines
+//
+// indexedHeap.h
+// libCacheSim
+//
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/libCacheSim/cacheObj.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define INDEXED_HEAP_NOT_IN_HEAP (-1)
+
+typedef struct {
+  double pri;
+  int64_t tie;
+  cache_obj_t *obj;
+} heap_entry_t;
+
+typedef struct indexed_heap {
+  heap_entry_t *entries;
+  int64_t n_entry;
+  int64_t capacity;
+  /* the offset of the int64_t position in cache_obj_t */
+  size_t pos_offset;
+} indexed_heap_t;
+
+/**
+ * @brief create a heap, the position of an object is stored as an int64_t
+ * at pos_offset in the object, e.g., offsetof(cache_obj_t, Belady.heap_pos)
+ */
+indexed_heap_t *create_indexed_heap(int64_t init_capacity, size_t pos_offset);
+
+void free_indexed_heap(indexed_heap_t *heap);
+
+void indexed_heap_push(indexed_heap_t *heap, cache_obj_t *obj, double pri,
+                       int64_t tie);
+
+/**
+ * @brief change the priority of an object in the heap
+ */
+void indexed_heap_update(indexed_heap_t *heap, cache_obj_t *obj, double pri,
+                         int64_t tie);
+
+/**
+ * @brief remove an object from the heap, it is a no-op if the object is not
+ * in the heap
+ */
+void indexed_heap_remove(indexed_heap_t *heap, cache_obj_t *obj);
+
+/**
+ * @brief remove and return the entry with the lowest priority,
+ * the heap must not be empty
+ */
+heap_entry_t indexed_heap_pop(indexed_heap_t *heap);
+
+/* the entry with the lowest priority or NULL if the heap is empty */
+static inline const heap_entry_t *indexed_heap_peek(
+    const indexed_heap_t *heap) {
+  return heap->n_entry > 0 ? &heap->entries[0] : NULL;
+}
+
+/* the position is read with memcpy because cache_obj_t is packed */
+static inline int64_t indexed_heap_get_pos(const indexed_heap_t *heap,
+                                           const cache_obj_t *obj) {
+  int64_t pos;
+  memcpy(&pos, (const char *)obj + heap->pos_offset, sizeof(int64_t));
+  return pos;
+}
+
+static inline bool indexed_heap_contains(const indexed_heap_t *heap,
+                                         const cache_obj_t *obj) {
+  return indexed_heap_get_pos(heap, obj) != INDEXED_HEAP_NOT_IN_HEAP;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,131 @@
+//
+// a bounded multi-producer single-consumer lock-free ring of pointers
+//
+// producers claim a slot with one atomic fetch_add on the tail and then
+// publish the pointer into the slot, the consumer waits for the slot to be
+// published, takes the pointer and clears the slot, so pushes never take a
+// lock and a push that is preempted between claiming and publishing only
+// delays the consumer
+//
+// the ring does not check for overflow on the fast path, the user must
+// bound the number of items in the ring (e.g., by reserving a count before
+// pushing), the capacity should include some headroom for concurrent pushes
+//
+// mpscRing.h
+// libCacheSim
+//
+
+#pragma once
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../utils/include/mymath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MPSC_RING_CACHE_LINE_SIZE 64
+
+typedef struct mpsc_ring {
+  /* only written by the consumer */
+  uint64_t head __attribute__((aligned(MPSC_RING_CACHE_LINE_SIZE)));
+
+  /* claimed by the producers with fetch_add */
+  uint64_t tail __attribute__((aligned(MPSC_RING_CACHE_LINE_SIZE)));
+
+  void **slots __attribute__((aligned(MPSC_RING_CACHE_LINE_SIZE)));
+  uint64_t capacity;
+  uint64_t mask;
+} mpsc_ring_t;
+
+/**
+ * @brief create a ring that can hold at least n_items pointers,
+ * the capacity is rounded up to the next power of two
+ *
+ * @param n_items
+ * @return mpsc_ring_t*
+ */
+static inline mpsc_ring_t *create_mpsc_ring(uint64_t n_items) {
+  mpsc_ring_t *ring = (mpsc_ring_t *)aligned_alloc(MPSC_RING_CACHE_LINE_SIZE,
+                                                   sizeof(mpsc_ring_t));
+  ASSERT_NOT_NULL(ring, "cannot allocate mpsc ring\n");
+  memset(ring, 0, sizeof(mpsc_ring_t));
+
+  ring->capacity = next_power_of_2_v2(n_items < 2 ? 2 : n_items);
+  ring->mask = ring->capacity - 1;
+  /* calloc so that the pages are only touched when the ring grows */
+  ring->slots = (void **)calloc(ring->capacity, sizeof(void *));
+  ASSERT_NOT_NULL(ring->slots, "cannot allocate mpsc ring of %lu slots\n",
+                  (unsigned long)ring->capacity);
+
+  return ring;
+}
+
+static inline void free_mpsc_ring(mpsc_ring_t *ring) {
+  free(ring->slots);
+  free(ring);
+}
+
+/**
+ * @brief push one non-NULL pointer, can be called by any thread
+ */
+static inline void mpsc_ring_push(mpsc_ring_t *ring, void *item) {
+  DEBUG_ASSERT(item != NULL);
+  uint64_t pos = __atomic_fetch_add(&ring->tail, 1, __ATOMIC_RELAXED);
+  void **slot = &ring->slots[pos & ring->mask];
+
+  /* the slot is only occupied if the user overfills the ring,
+   * in which case we wait for the consumer to drain it */
+  int n_spin = 0;
+  while (__atomic_load_n(slot, __ATOMIC_ACQUIRE) != NULL) {
+    if (++n_spin > 64) {
+      sched_yield();
+      n_spin = 0;
+    }
+  }
+  __atomic_store_n(slot, item, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief pop the oldest pointer, only called by the consumer
+ *
+ * @return the pointer or NULL if the ring is empty
+ */
+static inline void *mpsc_ring_pop(mpsc_ring_t *ring) {
+  uint64_t head = ring->head;
+  if (head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) return NULL;
+
+  /* the slot is claimed, wait until the producer publishes it */
+  void **slot = &ring->slots[head & ring->mask];
+  void *item;
+  int n_spin = 0;
+  while ((item = __atomic_load_n(slot, __ATOMIC_ACQUIRE)) == NULL) {
+    if (++n_spin > 64) {
+      sched_yield();
+      n_spin = 0;
+    }
+  }
+
+  __atomic_store_n(slot, NULL, __ATOMIC_RELEASE);
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+  return item;
+}
+
+/**
+ * @brief the number of claimed slots, only a hint when producers are active
+ */
+static inline uint64_t mpsc_ring_size(const mpsc_ring_t *ring) {
+  return __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) -
+         __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,150 @@
+//
+// a bounded single-producer single-consumer lock-free ring buffer
+//
+// the ring stores fixed-size items by value, so passing an item from one
+// thread to another does not allocate, the producer and the consumer only
+// synchronize through the head and tail counters, which live on different
+// cache lines to avoid false sharing
+//
+// spscRing.h
+// libCacheSim
+//
+
+#pragma once
+
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../utils/include/mymath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPSC_RING_CACHE_LINE_SIZE 64
+
+typedef struct spsc_ring {
+  /* written by the consumer, read by the producer */
+  uint64_t head __attribute__((aligned(SPSC_RING_CACHE_LINE_SIZE)));
+  /* the producer's cached copy of head */
+  uint64_t cached_head;
+
+  /* written by the producer, read by the consumer */
+  uint64_t tail __attribute__((aligned(SPSC_RING_CACHE_LINE_SIZE)));
+  /* the consumer's cached copy of tail */
+  uint64_t cached_tail;
+
+  char *buf __attribute__((aligned(SPSC_RING_CACHE_LINE_SIZE)));
+  uint64_t capacity;
+  uint64_t mask;
+  uint32_t item_size;
+} spsc_ring_t;
+
+/**
+ * @brief create a ring that can hold at least n_items items of item_size
+ * bytes, the capacity is rounded up to the next power of two
+ *
+ * @param item_size
+ * @param n_items
+ * @return spsc_ring_t*
+ */
+static inline spsc_ring_t *create_spsc_ring(uint32_t item_size,
+                                            uint64_t n_items) {
+  spsc_ring_t *ring = (spsc_ring_t *)aligned_alloc(
+      SPSC_RING_CACHE_LINE_SIZE, sizeof(spsc_ring_t));
+  ASSERT_NOT_NULL(ring, "cannot allocate spsc ring\n");
+  memset(ring, 0, sizeof(spsc_ring_t));
+
+  ring->capacity = next_power_of_2_v2(n_items < 2 ? 2 : n_items);
+  ring->mask = ring->capacity - 1;
+  ring->item_size = item_size;
+  ring->buf = (char *)malloc((size_t)item_size * ring->capacity);
+  ASSERT_NOT_NULL(ring->buf, "cannot allocate spsc ring buffer %lu items\n",
+                  (unsigned long)ring->capacity);
+
+  return ring;
+}
+
+static inline void free_spsc_ring(spsc_ring_t *ring) {
+  free(ring->buf);
+  free(ring);
+}
+
+/**
+ * @brief try to push one item, only called by the producer
+ *
+ * @return true if the item is pushed, false if the ring is full
+ */
+static inline bool spsc_ring_try_push(spsc_ring_t *ring, const void *item) {
+  uint64_t tail = ring->tail;
+  if (tail - ring->cached_head >= ring->capacity) {
+    ring->cached_head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    if (tail - ring->cached_head >= ring->capacity) return false;
+  }
+
+  memcpy(ring->buf + (tail & ring->mask) * ring->item_size, item,
+         ring->item_size);
+  __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+/**
+ * @brief push one item, spin (and yield) until there is space
+ */
+static inline void spsc_ring_push(spsc_ring_t *ring, const void *item) {
+  int n_spin = 0;
+  while (!spsc_ring_try_push(ring, item)) {
+    if (++n_spin > 64) {
+      sched_yield();
+      n_spin = 0;
+    }
+  }
+}
+
+/**
+ * @brief get a pointer to the oldest item without removing it, only called
+ * by the consumer
+ *
+ * @return the item or NULL if the ring is empty
+ */
+static inline void *spsc_ring_peek(spsc_ring_t *ring) {
+  uint64_t head = ring->head;
+  if (head == ring->cached_tail) {
+    ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    if (head == ring->cached_tail) return NULL;
+  }
+
+  return ring->buf + (head & ring->mask) * ring->item_size;
+}
+
+/**
+ * @brief spin (and yield) until an item is available and return it
+ */
+static inline void *spsc_ring_wait_peek(spsc_ring_t *ring) {
+  int n_spin = 0;
+  void *item;
+  while ((item = spsc_ring_peek(ring)) == NULL) {
+    if (++n_spin > 64) {
+      sched_yield();
+      n_spin = 0;
+    }
+  }
+  return item;
+}
+
+/**
+ * @brief release the item returned by peek, only called by the consumer
+ */
+static inline void spsc_ring_pop(spsc_ring_t *ring) {
+  DEBUG_ASSERT(ring->head != ring->cached_tail);
+  __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
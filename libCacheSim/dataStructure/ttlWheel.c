@@ -0,0 +1,153 @@
+//
+// a hierarchical timing wheel, see ttlWheel.h
+//
+// ttlWheel.c
+// libCacheSim
+//
+
+#include "ttlWheel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TTL_WHEEL_SLOT_MASK (TTL_WHEEL_N_SLOT - 1)
+
+static inline int _slot_idx(int64_t time, int level) {
+  return (int)(((uint64_t)time >> (TTL_WHEEL_SLOT_BITS * level)) &
+               TTL_WHEEL_SLOT_MASK);
+}
+
+/**
+ * @brief place an entry relative to ref_time, which is the next time the
+ * wheel will tick, the entry goes to the highest level where its fire time
+ * differs from ref_time
+ */
+static void _place_entry(ttl_wheel_t *wheel, const ttl_wheel_entry_t *entry,
+                         int64_t ref_time) {
+  int64_t time = MAX(entry->fire_time, ref_time);
+  uint64_t diff = (uint64_t)time ^ (uint64_t)ref_time;
+  int level = 0;
+  while (level < TTL_WHEEL_N_LEVEL - 1 &&
+         (diff >> (TTL_WHEEL_SLOT_BITS * (level + 1))) != 0) {
+    level++;
+  }
+
+  ttl_wheel_slot_t *slot = &wheel->slots[level][_slot_idx(time, level)];
+  if (slot->n_entry == slot->capacity) {
+    slot->capacity = slot->capacity == 0 ? 8 : slot->capacity * 2;
+    slot->entries = (ttl_wheel_entry_t *)realloc(
+        slot->entries, sizeof(ttl_wheel_entry_t) * slot->capacity);
+    ASSERT_NOT_NULL(slot->entries, "cannot grow ttl wheel slot to %u\n",
+                    slot->capacity);
+  }
+  slot->entries[slot->n_entry++] = *entry;
+  wheel->level_n_entry[level] += 1;
+}
+
+/**
+ * @brief move the entries in the slot of the given level that covers
+ * curr_time to lower levels
+ */
+static void _cascade(ttl_wheel_t *wheel, int level, int64_t curr_time) {
+  ttl_wheel_slot_t *slot = &wheel->slots[level][_slot_idx(curr_time, level)];
+  /* the entries now agree with curr_time on this level,
+   * so none of them is placed back into this slot */
+  for (uint32_t i = 0; i < slot->n_entry; i++) {
+    _place_entry(wheel, &slot->entries[i], curr_time);
+  }
+  wheel->level_n_entry[level] -= slot->n_entry;
+  slot->n_entry = 0;
+}
+
+ttl_wheel_t *create_ttl_wheel(int64_t start_time) {
+  ttl_wheel_t *wheel = my_malloc(ttl_wheel_t);
+  memset(wheel, 0, sizeof(ttl_wheel_t));
+  wheel->curr_time = start_time;
+  return wheel;
+}
+
+void free_ttl_wheel(ttl_wheel_t *wheel) {
+  for (int level = 0; level < TTL_WHEEL_N_LEVEL; level++) {
+    for (int i = 0; i < TTL_WHEEL_N_SLOT; i++) {
+      free(wheel->slots[level][i].entries);
+    }
+  }
+  my_free(sizeof(ttl_wheel_t), wheel);
+}
+
+void ttl_wheel_add(ttl_wheel_t *wheel, obj_id_t obj_id, int64_t fire_time) {
+  ttl_wheel_entry_t entry = {.obj_id = obj_id, .fire_time = fire_time};
+  _place_entry(wheel, &entry, wheel->curr_time + 1);
+  wheel->n_entry += 1;
+}
+
+void ttl_wheel_advance(ttl_wheel_t *wheel, int64_t curr_time,
+                       ttl_wheel_fire_func_ptr fire, void *user_data) {
+  while (wheel->curr_time < curr_time) {
+    if (wheel->n_entry == 0) {
+      wheel->curr_time = curr_time;
+      break;
+    }
+
+    /* if the lowest levels are empty, nothing happens until the next
+     * cascade of the first non-empty level, so skip to it */
+    int n_empty_level = 0;
+    while (n_empty_level < TTL_WHEEL_N_LEVEL - 1 &&
+           wheel->level_n_entry[n_empty_level] == 0) {
+      n_empty_level++;
+    }
+    if (n_empty_level > 0) {
+      int shift = TTL_WHEEL_SLOT_BITS * n_empty_level;
+      int64_t next_cascade =
+          (int64_t)((((uint64_t)wheel->curr_time >> shift) + 1) << shift);
+      if (next_cascade > curr_time) {
+        wheel->curr_time = curr_time;
+        break;
+      }
+      wheel->curr_time = next_cascade - 1;
+    }
+
+    int64_t t = wheel->curr_time + 1;
+    /* cascade from the highest level whose lower bits are all zero */
+    int top_level = 0;
+    while (top_level < TTL_WHEEL_N_LEVEL - 1 &&
+           _slot_idx(t, top_level) == 0) {
+      top_level++;
+    }
+    for (int level = top_level; level > 0; level--) {
+      _cascade(wheel, level, t);
+    }
+
+    /* detach the slot before firing, because fire may add entries,
+     * and an entry added at time t for t + 256 goes to this slot */
+    ttl_wheel_slot_t fired = wheel->slots[0][_slot_idx(t, 0)];
+    memset(&wheel->slots[0][_slot_idx(t, 0)], 0, sizeof(ttl_wheel_slot_t));
+    wheel->level_n_entry[0] -= fired.n_entry;
+    wheel->n_entry -= fired.n_entry;
+    wheel->curr_time = t;
+    for (uint32_t i = 0; i < fired.n_entry; i++) {
+      fire(&fired.entries[i], user_data);
+    }
+
+    ttl_wheel_slot_t *slot = &wheel->slots[0][_slot_idx(t, 0)];
+    if (slot->entries == NULL) {
+      /* reuse the buffer */
+      slot->entries = fired.entries;
+      slot->capacity = fired.capacity;
+    } else {
+      free(fired.entries);
+    }
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
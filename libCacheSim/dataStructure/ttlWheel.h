@@ -0,0 +1,79 @@
+//
+// a hierarchical timing wheel that indexes object expiration time
+//
+// the wheel has TTL_WHEEL_N_LEVEL levels of TTL_WHEEL_N_SLOT slots, a slot
+// at level k covers 2^(8k) seconds, so four levels cover the 32-bit
+// expiration time. an entry is placed at the highest byte where its
+// expiration time differs from the current time, and it is moved to a lower
+// level when the current time reaches its slot (cascade), so each entry
+// is moved at most TTL_WHEEL_N_LEVEL times
+//
+// entries are (obj_id, time) pairs stored by value in per-slot arrays, the
+// wheel does not point to cache objects, so objects can be evicted, updated
+// or freed without notifying the wheel, the user validates an entry when it
+// fires, e.g., by checking that the object is still in the cache and its
+// expiration time has passed
+//
+// ttlWheel.h
+// libCacheSim
+//
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../include/libCacheSim/request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TTL_WHEEL_N_LEVEL 4
+#define TTL_WHEEL_SLOT_BITS 8
+#define TTL_WHEEL_N_SLOT (1 << TTL_WHEEL_SLOT_BITS)
+
+typedef struct {
+  obj_id_t obj_id;
+  int64_t fire_time;
+} ttl_wheel_entry_t;
+
+typedef struct {
+  ttl_wheel_entry_t *entries;
+  uint32_t n_entry;
+  uint32_t capacity;
+} ttl_wheel_slot_t;
+
+typedef struct ttl_wheel {
+  ttl_wheel_slot_t slots[TTL_WHEEL_N_LEVEL][TTL_WHEEL_N_SLOT];
+  int64_t level_n_entry[TTL_WHEEL_N_LEVEL];
+  int64_t n_entry;
+  /* the wheel has fired all entries with fire_time <= curr_time */
+  int64_t curr_time;
+} ttl_wheel_t;
+
+/* called for each entry whose fire time has come */
+typedef void (*ttl_wheel_fire_func_ptr)(const ttl_wheel_entry_t *entry,
+                                        void *user_data);
+
+ttl_wheel_t *create_ttl_wheel(int64_t start_time);
+
+void free_ttl_wheel(ttl_wheel_t *wheel);
+
+/**
+ * @brief add an entry, an entry whose fire time has passed fires at the next
+ * advance
+ */
+void ttl_wheel_add(ttl_wheel_t *wheel, obj_id_t obj_id, int64_t fire_time);
+
+/**
+ * @brief advance the wheel to curr_time and fire all entries
+ * with fire_time <= curr_time, the callback may add entries
+ * that fire after the current time
+ */
+void ttl_wheel_advance(ttl_wheel_t *wheel, int64_t curr_time,
+                       ttl_wheel_fire_func_ptr fire, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -8,26 +8,34 @@
 #include "config.h"
 #include "libCacheSim/cache.h"
 #include "libCacheSim/cacheObj.h"
+#include "libCacheSim/checkpoint.h"
+#include "libCacheSim/concurrentCache.h"
 #include "libCacheSim/const.h"
 #include "libCacheSim/enum.h"
 #include "libCacheSim/logging.h"
 #include "libCacheSim/macro.h"
+#include "libCacheSim/miniSim.h"
+#include "libCacheSim/perfStat.h"
 #include "libCacheSim/reader.h"
 #include "libCacheSim/request.h"
 #include "libCacheSim/sampling.h"
+#include "libCacheSim/simOutput.h"
 
 /* admission */
 #include "libCacheSim/admissionAlgo.h"
 
 /* eviction */
 #include "libCacheSim/evictionAlgo.h"
+#include "libCacheSim/evictionAlgo/Partition.h"
 
 /* sampling */
 #include "libCacheSim/sampling.h"
 
 /* cache simulator */
+#include "libCacheSim/heatmap.h"
 #include "libCacheSim/plugin.h"
 #include "libCacheSim/profilerLRU.h"
+#include "libCacheSim/profilerOPT.h"
 #include "libCacheSim/simulator.h"
 
 #endif  // libCacheSim_H
@@ -17,6 +17,7 @@
 #include "const.h"
 #include "logging.h"
 #include "macro.h"
+#include "perfStat.h"
 #include "request.h"
 
 #ifdef __cplusplus
@@ -66,6 +67,29 @@ typedef int64_t (*cache_get_n_obj_func_ptr)(const cache_t *);
 
 typedef void (*cache_print_cache_func_ptr)(const cache_t *);
 
+typedef bool (*cache_checkpoint_func_ptr)(const cache_t *, FILE *);
+
+typedef bool (*cache_restore_func_ptr)(cache_t *, FILE *);
+
+/* the admission and eviction decisions made in cache_get_base */
+typedef enum {
+  /* a missed object is inserted */
+  CACHE_EVENT_ADMIT,
+  /* a missed object is rejected by the admission */
+  CACHE_EVENT_BYPASS,
+  /* an object is evicted to make room for the missed one */
+  CACHE_EVENT_EVICT,
+} cache_event_e;
+
+/* obj is the inserted object for CACHE_EVENT_ADMIT, the victim for
+ * CACHE_EVENT_EVICT and NULL for CACHE_EVENT_BYPASS, the victim has been
+ * freed, only its obj_id and obj_size are set */
+typedef void (*cache_event_hook_func_ptr)(const cache_t *cache,
+                                          cache_event_e event,
+                                          const request_t *req,
+                                          const cache_obj_t *obj,
+                                          void *user_data);
+
 // #define EVICTION_AGE_ARRAY_SZE 40
 #define EVICTION_AGE_ARRAY_SZE 320
 #define EVICTION_AGE_LOG_BASE 1.08
@@ -84,12 +108,19 @@ typedef struct {
 
   /* current trace time, used to determine obj expiration */
   int64_t curr_rtime;
+  /* the number of objects and bytes removed because they expired,
+   * only counted when SUPPORT_TTL is on */
   int64_t expired_obj_cnt;
   int64_t expired_bytes;
   char cache_name[CACHE_NAME_ARRAY_LEN];
+#ifdef ENABLE_PERF_STAT
+  perf_stat_t perf_stat;
+#endif
 } cache_stat_t;
 
 struct hashtable;
+struct ttl_wheel;
+struct mini_sim;
 struct cache {
   struct hashtable *hashtable;
 
@@ -107,11 +138,26 @@ struct cache {
   cache_get_occupied_byte_func_ptr get_occupied_byte;
   cache_get_n_obj_func_ptr get_n_obj;
   cache_print_cache_func_ptr print_cache;
+  /* save and load the algorithm state, NULL if not supported,
+   * see checkpoint.h */
+  cache_checkpoint_func_ptr checkpoint;
+  cache_restore_func_ptr restore;
+  /* if not NULL, cache_get_base reports each admission and eviction to it,
+   * the victims are the objects removed by cache_remove_obj_base (in this
+   * cache or its sub-caches) during the eviction that are no longer in the
+   * cache afterwards, see simOutput.h */
+  cache_event_hook_func_ptr event_hook;
+  void *event_hook_data;
+  struct cache_evict_log *evict_log;
 
   admissioner_t *admissioner;
 
   prefetcher_t *prefetcher;
 
+  /* if not NULL, cache_get_base feeds the requests to it so that the miss
+   * ratio curve of the cache can be queried, see miniSim.h */
+  struct mini_sim *mini_sim;
+
   void *eviction_params;
 
   // other name: logical_time, virtual_time, reference_count
@@ -139,6 +185,12 @@ struct cache {
   int64_t cache_size;
   int64_t default_ttl;
   int32_t obj_md_size;
+  /* the bytes of the per-algorithm metadata in cache_obj_t this algorithm
+   * uses, -1 if not declared, see cache_use_compact_obj */
+  int32_t algo_obj_md_size;
+  /* false if the algorithm cannot remove an object on request, e.g.,
+   * GLCache, the ttl wheel is not enabled on such caches */
+  bool support_remove;
 
   /* cache stat is not updated automatically, it is popped up only in
    * some situations */
@@ -147,6 +199,18 @@ struct cache {
   char init_params[CACHE_INIT_PARAMS_LEN];
 
   void *last_request_metadata;
+#ifdef SUPPORT_TTL
+  /* if not NULL, expired objects are removed when the trace time passes
+   * their expiration time, see cache_enable_ttl_wheel */
+  struct ttl_wheel *ttl_wheel;
+  /* objects removed at expiration or found expired at access */
+  int64_t n_expired_obj;
+  int64_t n_expired_byte;
+#endif
+#ifdef ENABLE_PERF_STAT
+  /* the cycles of the operations in cache_get_base */
+  perf_stat_t *perf_stat;
+#endif
 #if defined(TRACK_EVICTION_V_AGE)
   bool track_eviction_age;
 #endif
@@ -202,6 +266,42 @@ cache_t *clone_cache(const cache_t *old_cache);
 cache_t *create_cache_with_new_size(const cache_t *old_cache,
                                     const uint64_t new_size);
 
+/**
+ * @brief allocate the objects of the cache with only the per-algorithm
+ * metadata its eviction algorithm declares in algo_obj_md_size instead of
+ * the union of all algorithms, this is a no-op if the algorithm does not
+ * declare it, must be called before the first request
+ *
+ * do not use it on the caches created inside another algorithm,
+ * which stores its own metadata in their objects
+ *
+ * @param cache
+ */
+void cache_use_compact_obj(cache_t *cache);
+
+/**
+ * @brief index the expiration time of objects in a timing wheel so that
+ * objects are removed as soon as they expire instead of when they are
+ * accessed again, the wheel advances with req->clock_time in cache_get_base,
+ * so it works with the algorithms that use cache_get_base and support remove,
+ * this is a no-op with a warning if SUPPORT_TTL is off or the cache does not
+ * support remove
+ *
+ * @param cache
+ */
+void cache_enable_ttl_wheel(cache_t *cache);
+
+#ifdef ENABLE_PERF_STAT
+/**
+ * @brief copy the operation cycles of the cache and the chain length of its
+ * hash table into perf_stat
+ *
+ * @param cache
+ * @param perf_stat
+ */
+void cache_get_perf_stat(const cache_t *cache, perf_stat_t *perf_stat);
+#endif
+
 /**
  * a function that finds object from the cache, it is used by
  * all eviction algorithms that directly use the hashtable
@@ -7,6 +7,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 
 #include "../config.h"
@@ -19,6 +20,8 @@ extern "C" {
 // ############## per object metadata used in eviction algorithm cache obj
 typedef struct {
   int64_t freq;
+  /* the position in the indexed heap, used by GDSF and LFUCpp */
+  int64_t heap_pos;
 } LFU_obj_metadata_t;
 
 typedef struct {
@@ -26,7 +29,7 @@ typedef struct {
 } Clock_obj_metadata_t;
 
 typedef struct {
-  void *pq_node;
+  int64_t heap_pos;
 } Size_obj_metadata_t;
 
 typedef struct {
@@ -64,7 +67,7 @@ typedef struct {
 } Hyperbolic_obj_metadata_t;
 
 typedef struct Belady_obj_metadata {
-  void *pq_node;
+  int64_t heap_pos;
   int64_t next_access_vtime;
 } Belady_obj_metadata_t;
 
@@ -98,6 +101,23 @@ typedef struct {
   int lru_id;
 } SLRU_obj_metadata_t;
 
+typedef struct {
+  /* the LHD timestamp of the last access */
+  int64_t timestamp;
+  /* ages are bounded by LHD's MAX_AGE */
+  int32_t last_hit_age;
+  int32_t last_last_hit_age;
+  /* the index in the dense array of cached objects used for sampling */
+  int32_t sample_idx;
+  int8_t app;
+  bool explorer;
+} LHD_obj_metadata_t;
+
+typedef struct {
+  /* the index of the in-cache metadata of LRB */
+  int32_t meta_idx;
+} LRB_obj_metadata_t;
+
 typedef struct {
   int64_t last_access_vtime;
 } RandomTwo_obj_metadata_t;
@@ -171,6 +191,8 @@ typedef struct cache_obj {
     LIRS_obj_metadata_t LIRS;
     S3FIFO_obj_metadata_t S3FIFO;
     Sieve_obj_params_t sieve;
+    LHD_obj_metadata_t LHD;
+    LRB_obj_metadata_t LRB;
 
 #if defined(ENABLE_GLCACHE) && ENABLE_GLCACHE == 1
     GLCache_obj_metadata_t GLCache;
@@ -178,6 +200,15 @@ typedef struct cache_obj {
   };
 } __attribute__((packed)) cache_obj_t;
 
+/* the size of cache_obj_t without the per-algorithm metadata union,
+ * the union must stay the last member */
+#define CACHE_OBJ_HEADER_SIZE offsetof(cache_obj_t, lfu)
+
+/* the size of a cache_obj_t that only has md_size bytes of per-algorithm
+ * metadata, accessing the metadata of other algorithms in such an object is
+ * out of bounds */
+#define cache_obj_struct_size(md_size) (CACHE_OBJ_HEADER_SIZE + (md_size))
+
 struct request;
 /**
  * copy the cache_obj to req_dest
@@ -202,6 +233,16 @@ void copy_request_to_cache_obj(cache_obj_t *cache_obj,
  */
 cache_obj_t *create_cache_obj_from_request(const struct request *req);
 
+/**
+ * create a cache_obj of obj_struct_size bytes from request,
+ * obj_struct_size is obtained from cache_obj_struct_size
+ * @param req
+ * @param obj_struct_size
+ * @return
+ */
+cache_obj_t *create_sized_cache_obj_from_request(const struct request *req,
+                                                 size_t obj_struct_size);
+
 /**
  * the cache_obj has built-in a doubly list, in the case the list is used as
  * a singly list (list_prev is not used, next is used)
@@ -274,6 +315,16 @@ static inline void free_cache_obj(cache_obj_t *cache_obj) {
   my_free(sizeof(cache_obj_t), cache_obj);
 }
 
+/**
+ * free cache_obj created by create_sized_cache_obj_from_request
+ * @param cache_obj
+ * @param obj_struct_size
+ */
+static inline void free_sized_cache_obj(cache_obj_t *cache_obj,
+                                        size_t obj_struct_size) {
+  my_free(obj_struct_size, cache_obj);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,92 @@
+//
+// save a warmed cache to a file and load it back
+//
+// a checkpoint records the objects of the cache in eviction order together
+// with their per-algorithm metadata, the algorithm state (e.g., the hand of
+// Sieve and the target size of ARC) and the position of the reader, so that
+// experiments can start from the same warmed state without replaying the
+// warmup requests
+//
+// an algorithm supports checkpoint by setting cache->checkpoint and
+// cache->restore, currently FIFO, LRU, Clock, Sieve, S3FIFO and ARC
+//
+// the file is in the native byte order and only readable by a build with the
+// same cache_obj_t layout
+//
+// checkpoint.h
+// libCacheSim
+//
+
+#pragma once
+
+#include "cache.h"
+#include "reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief write the cache state and the reader position to path
+ *
+ * @param cache
+ * @param reader the reader used to warm up the cache, can be NULL
+ * @param path
+ * @return true on success, false if the algorithm does not support
+ * checkpoint or the file cannot be written
+ */
+bool cache_checkpoint(const cache_t *cache, const reader_t *reader,
+                      const char *path);
+
+/**
+ * @brief load the cache state from path into an empty cache created with the
+ * same eviction algorithm, parameters and cache size as the checkpointed one,
+ * and seek the reader to the request after the last one seen by the cache
+ *
+ * @param cache an empty cache
+ * @param path
+ * @param reader if not NULL, it is moved to the checkpointed position
+ * @return true on success, false if the file does not match the cache,
+ * the cache may be partially restored on failure and should be freed
+ */
+bool cache_restore(cache_t *cache, const char *path, reader_t *reader);
+
+/****************** used by eviction algorithms ******************/
+static inline bool checkpoint_write(FILE *ofile, const void *buf,
+                                    size_t size) {
+  return fwrite(buf, size, 1, ofile) == 1;
+}
+
+static inline bool checkpoint_read(FILE *ifile, void *buf, size_t size) {
+  return fread(buf, size, 1, ifile) == 1;
+}
+
+/**
+ * @brief write the common fields of the cache followed by cache->checkpoint,
+ * an algorithm built from other caches (e.g., S3FIFO) uses it to save them
+ */
+bool cache_checkpoint_state(const cache_t *cache, FILE *ofile);
+
+/**
+ * @brief the reverse of cache_checkpoint_state
+ */
+bool cache_restore_state(cache_t *cache, FILE *ifile);
+
+/**
+ * @brief write the objects in a queue from q_head to the tail,
+ * including the per-algorithm metadata of each object
+ */
+bool checkpoint_queue(const cache_t *cache, const cache_obj_t *q_head,
+                      FILE *ofile);
+
+/**
+ * @brief read the objects written by checkpoint_queue, insert them into the
+ * hash table and append them to the queue in the same order, the number of
+ * objects and occupied bytes are restored by cache_restore_state
+ */
+bool restore_queue(cache_t *cache, cache_obj_t **q_head, cache_obj_t **q_tail,
+                   FILE *ifile);
+
+#ifdef __cplusplus
+}
+#endif
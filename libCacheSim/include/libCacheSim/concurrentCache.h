@@ -0,0 +1,109 @@
+//
+// caches that can be shared by multiple threads
+//
+// cache_t is designed for single-threaded simulation, its metadata (queues,
+// counters and the hash table) are not protected. a concurrent cache is a
+// separate, much smaller interface that supports concurrent get from any
+// number of threads. it is used to measure the scalability of eviction
+// algorithms (throughput vs. number of threads) rather than miss ratio
+//
+// supported algorithms are FIFO, Clock (FIFO-Reinsertion) and S3FIFO,
+// - lookup uses a hash table with striped bucket locks
+// - a hit only sets the frequency bits of the object with a relaxed atomic,
+//   and does not write anything if the bits are saturated
+// - a miss pushes the object into a lock-free multi-producer FIFO ring
+// - eviction is serialized by one lock, it is only taken when the cache is
+//   full and the thread that takes it evicts until the cache fits
+//
+// with one thread, the FIFO and Clock concurrent caches make the same
+// decisions as FIFO and Clock
+//
+// concurrentCache.h
+// libCacheSim
+//
+
+#pragma once
+
+#include <pthread.h>
+
+#include "cache.h"
+#include "request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct concurrent_cache;
+typedef struct concurrent_cache concurrent_cache_t;
+
+typedef bool (*concurrent_cache_get_func_ptr)(concurrent_cache_t *,
+                                              const request_t *);
+
+typedef void (*concurrent_cache_free_func_ptr)(concurrent_cache_t *);
+
+struct concurrent_hashtable;
+
+struct concurrent_cache {
+  /* can be called by multiple threads at the same time */
+  concurrent_cache_get_func_ptr get;
+  concurrent_cache_free_func_ptr cache_free;
+
+  struct concurrent_hashtable *hashtable;
+  void *eviction_params;
+
+  int64_t cache_size;
+  /* the number of objects is also bounded so that the rings do not overflow,
+   * min(cache_size, 2^24) by default, it can be changed using the max-obj
+   * parameter */
+  int64_t max_n_obj;
+
+  /**************** private fields *****************/
+  /* updated with atomic instructions,
+   * use concurrent_cache_get_occupied_byte to read them */
+  int64_t occupied_byte __attribute__((aligned(64)));
+  int64_t n_obj;
+  /* the number of evicted objects */
+  int64_t n_evict;
+
+  pthread_mutex_t evict_lock __attribute__((aligned(64)));
+  /************ end of private fields *************/
+
+  char cache_name[CACHE_NAME_ARRAY_LEN];
+  char init_params[CACHE_INIT_PARAMS_LEN];
+};
+
+concurrent_cache_t *concurrent_FIFO_init(
+    const common_cache_params_t ccache_params,
+    const char *cache_specific_params);
+
+concurrent_cache_t *concurrent_Clock_init(
+    const common_cache_params_t ccache_params,
+    const char *cache_specific_params);
+
+concurrent_cache_t *concurrent_S3FIFO_init(
+    const common_cache_params_t ccache_params,
+    const char *cache_specific_params);
+
+/**
+ * @brief create a concurrent cache by name (fifo, clock, s3fifo)
+ *
+ * @return the cache or NULL if the algorithm does not have a concurrent
+ * implementation
+ */
+concurrent_cache_t *create_concurrent_cache(
+    const char *cache_alg_name, const common_cache_params_t ccache_params,
+    const char *cache_specific_params);
+
+static inline int64_t concurrent_cache_get_occupied_byte(
+    const concurrent_cache_t *cache) {
+  return __atomic_load_n(&cache->occupied_byte, __ATOMIC_RELAXED);
+}
+
+static inline int64_t concurrent_cache_get_n_obj(
+    const concurrent_cache_t *cache) {
+  return __atomic_load_n(&cache->n_obj, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
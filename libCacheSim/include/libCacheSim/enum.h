@@ -22,6 +22,10 @@ static const char *my_bool_str[] = {"false", "true", "unknown"};
 typedef enum {
   BINARY_TRACE_FORMAT,
   TXT_TRACE_FORMAT,
+  /* requests are generated in memory, see SYNTHETIC_TRACE */
+  SYNTHETIC_TRACE_FORMAT,
+  /* requests are read from multiple traces, see MULTI_TRACE */
+  MULTI_TRACE_FORMAT,
 
   INVALID_TRACE_FORMAT
 } trace_format_e;
@@ -62,6 +66,12 @@ typedef enum {
   VALPIN_TRACE,
   // ORACLE_WIKI19t_TRACE,
 
+  /* generated in memory, the trace path is the workload spec */
+  SYNTHETIC_TRACE,
+  /* multiple traces of the same type, the trace path is a comma-separated
+   * list of paths or glob patterns */
+  MULTI_TRACE,
+
   UNKNOWN_TRACE,
 } __attribute__((__packed__)) trace_type_e;
 
@@ -95,6 +105,8 @@ static char *g_trace_type_name[UNKNOWN_TRACE + 2] = {
     "ORACLE_WIKI19u_TRACE",
     "VALPIN_TRACE",
     // "ORACLE_WIKI19t_TRACE",
+    "SYNTHETIC_TRACE",
+    "MULTI_TRACE",
     "UNKNOWN_TRACE",
 };
 
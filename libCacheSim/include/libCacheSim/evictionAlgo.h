@@ -166,6 +166,9 @@ cache_t *FIFO_Belady_init(const common_cache_params_t ccache_params,
 cache_t *Sieve_init(const common_cache_params_t ccache_params,
                     const char *cache_specific_params);
 
+cache_t *Partition_init(const common_cache_params_t ccache_params,
+                        const char *cache_specific_params);
+
 #ifdef ENABLE_LRB
 cache_t *LRB_init(const common_cache_params_t ccache_params,
                   const char *cache_specific_params);
@@ -0,0 +1,63 @@
+//
+// a cache that is partitioned by tenant, namespace, content type or object,
+// each partition is a separate cache of the same algorithm and the capacity
+// is shared with a static, proportional or dynamic allocation policy,
+// see cache/eviction/Partition.c for the parameters
+//
+// Partition.h
+// libCacheSim
+//
+
+#pragma once
+
+#include "../cache.h"
+#include "../evictionAlgo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline bool is_partition_cache(const cache_t *cache) {
+  return cache->cache_init == Partition_init;
+}
+
+/**
+ * @brief the number of partitions of a Partition cache
+ */
+int Partition_get_n_partition(const cache_t *cache);
+
+/**
+ * @brief get the stat of one partition, n_req, n_req_byte, n_miss and
+ * n_miss_byte count the requests since the cache is created or since the last
+ * Partition_reset_stat, cache_size is the current allocation of the partition
+ *
+ * @param cache
+ * @param partition the partition index in [0, n_partition)
+ * @param stat the output
+ */
+void Partition_get_stat(const cache_t *cache, int partition,
+                        cache_stat_t *stat);
+
+/**
+ * @brief clear the request and miss counts of all partitions, e.g., at the end
+ * of the warmup
+ */
+void Partition_reset_stat(cache_t *cache);
+
+/**
+ * @brief get the miss ratio curve of one partition estimated with the mini sim
+ * of the partition (see miniSim.h), the curves are only maintained by the
+ * dynamic policy and weight the recent intervals more
+ *
+ * @param cache
+ * @param partition the partition index in [0, n_partition)
+ * @param cache_sizes the output, n_curve_point + 1 sizes starting from 0
+ * @param miss_ratios the output, the miss ratio at each size
+ * @return the number of points, 0 if the curve is not maintained
+ */
+int Partition_get_miss_ratio_curve(const cache_t *cache, int partition,
+                                   int64_t *cache_sizes, double *miss_ratios);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+//
+// hit ratio heatmap of a trace, pixel (i, j) is the hit ratio of the requests
+// from the start of time pixel i to the end of time pixel j when the cache is
+// empty at the start of pixel i, which shows how the hit ratio of a cache
+// warmed up at different times changes over time
+//
+// heatmap.h
+// libCacheSim
+//
+
+#pragma once
+
+#include "cache.h"
+#include "reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* how the trace is split into time pixels */
+typedef enum {
+  /* each pixel has time_interval requests */
+  HEATMAP_VIRTUAL_TIME,
+  /* each pixel covers time_interval seconds of trace time */
+  HEATMAP_REAL_TIME,
+
+  HEATMAP_TIME_MODE_INVALID,
+} heatmap_time_mode_e;
+
+typedef struct {
+  heatmap_time_mode_e time_mode;
+  /* the length of a pixel in requests or seconds, if 0, the trace is split
+   * into n_pixel pixels of the same length */
+  int64_t time_interval;
+  int n_pixel;
+  int num_of_threads;
+} heatmap_params_t;
+
+typedef struct {
+  heatmap_time_mode_e time_mode;
+  int64_t time_interval;
+  int n_pixel;
+  /* the first request of each pixel and the end of the trace, n_pixel + 1 */
+  int64_t *pixel_start;
+  /* n_pixel x n_pixel in row-major order, matrix[i * n_pixel + j] is the hit
+   * ratio of start pixel i and end pixel j, NAN if j < i or no request */
+  double *matrix;
+} heatmap_t;
+
+static inline heatmap_params_t default_heatmap_params(void) {
+  heatmap_params_t params;
+  params.time_mode = HEATMAP_VIRTUAL_TIME;
+  params.time_interval = 0;
+  params.n_pixel = 200;
+  params.num_of_threads = 8;
+  return params;
+}
+
+/**
+ * compute the hit ratio heatmap of an LRU cache of cache_size objects
+ * using stack distances in one pass of the trace, a request hits in the
+ * cache starting at pixel i if its stack distance is smaller than cache_size
+ * and its last access is not before pixel i
+ *
+ * @param reader
+ * @param cache_size the number of objects
+ * @param params see default_heatmap_params
+ * @return the heatmap, which should be freed with free_heatmap
+ */
+heatmap_t *get_lru_obj_hr_heatmap(reader_t *reader, int64_t cache_size,
+                                  const heatmap_params_t *params);
+
+/**
+ * compute the hit ratio heatmap of any cache by simulating from each start
+ * pixel to the end of the trace, the simulations run in parallel and each
+ * one seeks to its start pixel using reader_seek_to_req, so the trace should
+ * be an uncompressed binary trace or be opened with use_index
+ *
+ * sampling in the reader is not supported
+ *
+ * @param reader
+ * @param cache the cache used as a template, it is not modified
+ * @param params see default_heatmap_params
+ * @return the heatmap, which should be freed with free_heatmap
+ */
+heatmap_t *get_hr_heatmap(reader_t *reader, const cache_t *cache,
+                          const heatmap_params_t *params);
+
+/**
+ * write the heatmap as a 64-byte header (see heatmap.c) followed by
+ * pixel_start (n_pixel + 1 int64) and the matrix (n_pixel * n_pixel double)
+ * in the native byte order, scripts/plot_hr_heatmap.py loads it with numpy
+ *
+ * @return true on success
+ */
+bool save_heatmap(const heatmap_t *heatmap, const char *path);
+
+void free_heatmap(heatmap_t *heatmap);
+
+#ifdef __cplusplus
+}
+#endif
@@ -11,18 +11,21 @@
 #include "glib.h"
 #define my_malloc(type) g_new(type, 1)
 #define my_malloc_n(type, n) g_new(type, n)
+#define my_malloc_bytes(size) g_malloc(size)
 #define my_free(size, addr) g_free(addr)
 
 #elif HEAP_ALLOCATOR == HEAP_ALLOCATOR_G_SLICE_NEW
 #include "gmodule.h"
 #define my_malloc(type) g_slice_new(type)
 #define my_malloc_n(type, n) (type *)g_slice_alloc(sizeof(type) * n)
+#define my_malloc_bytes(size) g_slice_alloc(size)
 #define my_free(size, addr) g_slice_free1(size, addr)
 
 #elif HEAP_ALLOCATOR == HEAP_ALLOCATOR_MALLOC
 #include <stdlib.h>
 #define my_malloc(type) (type *)malloc(sizeof(type))
 #define my_malloc_n(type, n) (type *)calloc(sizeof(type), n)
+#define my_malloc_bytes(size) malloc(size)
 #define my_free(size, addr) free(addr)
 
 #elif HEAP_ALLOCATOR == HEAP_ALLOCATOR_ALIGNED_MALLOC
@@ -30,6 +33,7 @@
 #define my_malloc(type) (type *)aligned_alloc(MEM_ALIGN_SIZE, sizeof(type));
 #define my_malloc_n(type, n) \
   (type *)aligned_alloc(MEM_ALIGN_SIZE, sizeof(type) * n)
+#define my_malloc_bytes(size) aligned_alloc(MEM_ALIGN_SIZE, size)
 #define my_free(size, addr) free(addr)
 #endif
 
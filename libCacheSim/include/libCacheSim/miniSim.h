@@ -0,0 +1,116 @@
+//
+// miniature simulation: estimate the miss ratio curve of a running cache
+// with scaled-down shadow caches fed with a spatially sampled part of the
+// request stream (SHARDS, Waldspurger et al., ATC'17)
+//
+// a request is sampled if the hash of its object id falls in the sampled
+// range, so an object is either always or never sampled. each shadow cache
+// runs the same algorithm and parameters as the cache at size
+// sampling_ratio * size, so with K sizes and a 1% sampling ratio, the
+// overhead is about K% of the cache
+//
+// a mini sim can be attached to a cache with cache_enable_mini_sim, then
+// cache_get_base feeds it, or it can be fed explicitly with mini_sim_feed
+//
+// miniSim.h
+// libCacheSim
+//
+
+#pragma once
+
+#include "cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct mini_sim mini_sim_t;
+
+typedef struct {
+  /* the number of simulated sizes */
+  int n_size;
+  /* the sizes are max_size * (i + 1) / n_size, 0 uses twice the cache size */
+  int64_t max_size;
+  double sampling_ratio;
+  /* after every decay_interval sampled requests, the counts are multiplied
+   * by decay so that the curve follows the recent requests,
+   * 0 keeps the whole history */
+  int64_t decay_interval;
+  double decay;
+  /* the hashpower of the shadow caches, the hash tables grow as needed */
+  int32_t hashpower;
+} mini_sim_params_t;
+
+static inline mini_sim_params_t default_mini_sim_params(void) {
+  mini_sim_params_t params = {.n_size = 8,
+                              .max_size = 0,
+                              .sampling_ratio = 0.01,
+                              .decay_interval = 0,
+                              .decay = 0.5,
+                              .hashpower = 12};
+  return params;
+}
+
+/**
+ * @brief create a mini sim of the algorithm and parameters of the cache,
+ * the admissioner is cloned, the prefetcher is not
+ *
+ * @param cache
+ * @param params
+ * @return mini_sim_t*
+ */
+mini_sim_t *create_mini_sim(const cache_t *cache,
+                            const mini_sim_params_t *params);
+
+void free_mini_sim(mini_sim_t *mini_sim);
+
+/**
+ * @brief feed one request to the shadow caches if it is sampled
+ *
+ * @return true if the request is sampled
+ */
+bool mini_sim_feed(mini_sim_t *mini_sim, const request_t *req);
+
+/**
+ * @brief multiply the request and miss counts by decay
+ */
+void mini_sim_decay(mini_sim_t *mini_sim, double decay);
+
+/**
+ * @brief the (decayed) number of sampled requests
+ */
+double mini_sim_get_n_req(const mini_sim_t *mini_sim);
+
+/**
+ * @brief get the miss ratio curve
+ *
+ * @param mini_sim
+ * @param cache_sizes the output, n_size sizes in increasing order
+ * @param miss_ratios the output, the miss ratio at each size
+ * @param byte_miss_ratios the output, the byte miss ratio at each size,
+ * can be NULL
+ * @return the number of points, the ratios are 0 before any request is sampled
+ */
+int mini_sim_get_mrc(const mini_sim_t *mini_sim, int64_t *cache_sizes,
+                     double *miss_ratios, double *byte_miss_ratios);
+
+/**
+ * @brief the miss ratio at any size, interpolated linearly between the
+ * simulated sizes and from the miss ratio 1 at size 0, the sizes larger than
+ * max_size have the miss ratio at max_size
+ */
+double mini_sim_get_miss_ratio(const mini_sim_t *mini_sim, int64_t cache_size);
+
+/**
+ * @brief create a mini sim of the cache and feed it with the requests of
+ * cache_get_base, it is freed with the cache, the algorithms that do not use
+ * cache_get_base need to feed cache->mini_sim themselves
+ *
+ * @param cache
+ * @param params
+ */
+void cache_enable_mini_sim(cache_t *cache, const mini_sim_params_t *params);
+
+#ifdef __cplusplus
+}
+#endif
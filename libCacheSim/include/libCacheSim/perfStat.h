@@ -0,0 +1,125 @@
+//
+// per-operation cpu cost of the cache, compiled in with ENABLE_PERF_STAT
+//
+// the cycles spent in find, admission (can_insert), evict, insert and
+// prefetch of cache_get_base are recorded in log-bucket histograms, each
+// power of two is split into PERF_HIST_N_SUB buckets, so a value is
+// recorded with at most 25% error, the hash table records the chain length
+// of each lookup and the number of times it expands
+//
+// perfStat.h
+// libCacheSim
+//
+
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERF_HIST_SUB_BITS 2
+#define PERF_HIST_N_SUB (1 << PERF_HIST_SUB_BITS)
+#define PERF_HIST_N_BUCKET (64 * PERF_HIST_N_SUB)
+
+typedef struct {
+  int64_t n;
+  int64_t sum;
+  int64_t max;
+  int64_t buckets[PERF_HIST_N_BUCKET];
+} perf_hist_t;
+
+typedef enum {
+  PERF_OP_FIND,
+  PERF_OP_ADMIT,
+  PERF_OP_EVICT,
+  PERF_OP_INSERT,
+  PERF_OP_PREFETCH,
+
+  N_PERF_OP,
+} perf_op_e;
+
+typedef struct {
+  /* cycles of each operation */
+  perf_hist_t op_cycles[N_PERF_OP];
+  /* the number of objects visited in each hash table lookup */
+  perf_hist_t chain_len;
+  int64_t n_hashtable_expand;
+} perf_stat_t;
+
+/**
+ * @brief read the cycle counter, the time stamp counter on x86,
+ * and nanoseconds on other platforms
+ */
+static inline uint64_t perf_get_cycle(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static inline int perf_hist_bucket_idx(uint64_t value) {
+  if (value < PERF_HIST_N_SUB) return (int)value;
+
+  int msb = 63 - __builtin_clzll(value);
+  int sub = (int)(value >> (msb - PERF_HIST_SUB_BITS)) & (PERF_HIST_N_SUB - 1);
+  return (msb - PERF_HIST_SUB_BITS + 1) * PERF_HIST_N_SUB + sub;
+}
+
+/* the smallest value in the bucket */
+static inline uint64_t perf_hist_bucket_value(int idx) {
+  if (idx < PERF_HIST_N_SUB) return (uint64_t)idx;
+
+  int msb = idx / PERF_HIST_N_SUB + PERF_HIST_SUB_BITS - 1;
+  uint64_t sub = (uint64_t)(idx % PERF_HIST_N_SUB);
+  return (PERF_HIST_N_SUB + sub) << (msb - PERF_HIST_SUB_BITS);
+}
+
+static inline void perf_hist_record(perf_hist_t *hist, uint64_t value) {
+  hist->n += 1;
+  hist->sum += (int64_t)value;
+  if ((int64_t)value > hist->max) hist->max = (int64_t)value;
+  hist->buckets[perf_hist_bucket_idx(value)] += 1;
+}
+
+/**
+ * @brief the value at the given percentile (0 - 1),
+ * it is the lower bound of the bucket the percentile falls in
+ */
+uint64_t perf_hist_percentile(const perf_hist_t *hist, double percentile);
+
+/**
+ * @brief add the counts in src to dst
+ */
+void perf_stat_merge(perf_stat_t *dst, const perf_stat_t *src);
+
+/**
+ * @brief print the count, mean, p50, p99, max and the fraction of total
+ * cycles of each operation, and the hash table chain length
+ */
+void print_perf_stat(FILE *ofile, const char *cache_name,
+                     const perf_stat_t *perf_stat);
+
+#ifdef ENABLE_PERF_STAT
+#define PERF_STAT_START(start) uint64_t start = perf_get_cycle()
+#define PERF_STAT_END(perf_stat, op, start) \
+  perf_hist_record(&(perf_stat)->op_cycles[op], perf_get_cycle() - (start))
+#else
+#define PERF_STAT_START(start)
+#define PERF_STAT_END(perf_stat, op, start)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
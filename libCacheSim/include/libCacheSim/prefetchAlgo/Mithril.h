@@ -158,6 +158,18 @@ typedef enum _recording_loc {
   each_req,
 } rec_trigger_e;
 
+/* where the mining table is mined */
+typedef enum {
+  /* mine in the request path, the associations are used immediately */
+  mining_inline = 0,
+  /* mine in the background, the associations are merged into the prefetch
+   * table when the next mining starts, the result is deterministic */
+  mining_epoch,
+  /* mine in the background, the associations are merged as soon as the
+   * mining finishes, which depends on the thread scheduling */
+  mining_async,
+} mining_mode_e;
+
 /* the data for Mithril initialization */
 typedef struct {
   /** when we say two obj/blocks are associated,
@@ -229,6 +241,9 @@ typedef struct {
   /** this is the control knob for whether printing out statistics **/
   gint output_statistics;
 
+  /* inline/epoch/async, see mining_mode_e */
+  mining_mode_e mining_mode;
+
 } Mithril_init_params_t;
 
 typedef struct {
@@ -281,6 +296,9 @@ typedef struct {
   gint n_avail_mining;
 } rec_mining_t;
 
+/* the background mining job and task, defined in Mithril.c */
+struct Mithril_mining;
+
 typedef struct {
   /* see Mithril_init_params_t */
   gint lookahead_range;
@@ -302,6 +320,9 @@ typedef struct {
   /** when to trigger recording, miss/evict/miss_evict/each_req **/
   rec_trigger_e rec_trigger;
 
+  mining_mode_e mining_mode;
+  struct Mithril_mining *mining;
+
   /** similar to the one in init_params,
    *  but this one uses byts, not percentage
    **/
@@ -6,70 +6,84 @@
 //  Copyright © 2016 Juncheng. All rights reserved.
 //
 //  Modified by Zhelong on 2/21/24.
-
-/** since this is sequence based prefetching, we will use gint64 for block
- * number **/
+//
+//  the successor graph is stored in a fixed number of nodes, each node has a
+//  fixed-size array of (successor, weight), the nodes are indexed by a flat
+//  open addressing table and evicted in LRU order when all nodes are used,
+//  so the memory is bounded by max-metadata-size and no memory is allocated
+//  per request
 
 #ifndef PG_h
 #define PG_h
 
-#include <glib.h>
+#include <stdint.h>
 
-#include "../../../dataStructure/pqueue.h"
-#include "../../../traceReader/generalReader/readerInternal.h"
 #include "../cache.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-/* check params vaild */
-#define check_params(params)                                                                                   \
-  (assert(params->lookahead_range > 0 && params->lookahead_range <= 100 && params->max_metadata_size > 0 &&    \
-          params->max_metadata_size < 1 && params->prefetch_threshold > 0 && params->prefetch_threshold < 1 && \
-          params->block_size > 0))
-
-#define PG_getPage(x) ((struct PG_Page*)g_hashtable_lookup())
+#define PG_MAX_LOOKAHEAD_RANGE 100
+#define PG_MAX_N_SUCCESSOR 64
 
-// #define get_Nth_past_request_c(PG_params, n)
-// ((char**)((PG_params)->past_requests))[(n)]
-#define get_Nth_past_request_c(PG_params, n, des) strcpy((des), ((char**)((PG_params)->past_requests))[(n)])
+typedef struct {
+  obj_id_t obj_id;
+  int32_t obj_size;
+  uint32_t weight;
+} PG_successor_t;
 
-#define get_Nth_past_request_l(PG_params, n) ((guint64*)((PG_params)->past_requests))[(n)]
-#define set_Nth_past_request_c(PG_params, n, v) strcpy(((char**)((PG_params)->past_requests))[(n)], (char*)(v))
-#define set_Nth_past_request_l(PG_params, n, v) ((guint64*)((PG_params)->past_requests))[(n)] = (v)
+typedef struct {
+  obj_id_t obj_id;
+  /* the number of (source, successor) pairs recorded for this source */
+  uint64_t total_count;
+  /* the LRU list of the nodes, -1 is the end */
+  int32_t prev;
+  int32_t next;
+  int32_t n_successor;
+  /* the successors of the node are in PG_params_t.successors */
+} PG_node_t;
 
 typedef struct {
-  uint8_t lookahead_range;
-  uint block_size;  // In the PG algorithm, the existence of block_size, like Mithril, is to correct the maximum
-                    // metadata size while ignoring object size
-  uint64_t cur_metadata_size;
+  int32_t lookahead_range;
+  int32_t n_successor;  // the max number of successors of a node
+  uint32_t block_size;  // In the PG algorithm, the existence of block_size, like
+                        // Mithril, is to correct the maximum metadata size
+                        // while ignoring object size
   uint64_t max_metadata_size;  // unit byte
   double prefetch_threshold;
 
-  gboolean stop_recording;
-
-  GHashTable* graph;  // key -> graphNode_t
-  GHashTable* prefetched;
-  void* past_requests;  // past requests, using array instead of queue to avoid
-                        // frequent memory allocation
-
-  uint32_t past_request_pointer;
-  gint64 num_of_prefetch;
-  gint64 num_of_hit;
-
-  GHashTable* cache_size_map;  // key -> size
+  /* n_node nodes, the successors of node i are
+   * successors[i * n_successor, (i + 1) * n_successor) */
+  PG_node_t *nodes;
+  PG_successor_t *successors;
+  int32_t n_node;
+  int32_t n_used_node;
+  int32_t lru_head;  // the most recently updated node
+  int32_t lru_tail;
+
+  /* open addressing index of the nodes, node index + 1, 0 is empty */
+  uint32_t *index;
+  uint64_t index_mask;
+
+  /* the past requests, a ring of lookahead_range requests */
+  obj_id_t *past_obj_ids;
+  int32_t *past_obj_sizes;
+  int32_t past_request_pointer;
+  int32_t n_past_request;
+
+  /* the successors to prefetch, reused by every request */
+  PG_successor_t *prefetch_list;
+  request_t *prefetch_req;
+
+  int64_t num_of_prefetch;
+  int64_t num_of_node_eviction;
 } PG_params_t;
 
 typedef struct {
-  GHashTable* graph;  // key -> pq_node_t
-  pqueue_t* pq;
-  uint64_t total_count;
-} graphNode_t;
-
-typedef struct {
-  uint8_t lookahead_range;
-  uint block_size;
+  int32_t lookahead_range;
+  int32_t n_successor;
+  uint32_t block_size;
   double max_metadata_size;
   double prefetch_threshold;
 } PG_init_params_t;
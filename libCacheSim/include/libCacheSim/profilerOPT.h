@@ -0,0 +1,66 @@
+//
+// the miss ratio curve of the optimal (Belady) cache computed in one pass
+//
+// with unit object size, Belady is a stack algorithm (Mattson et al. 1970),
+// the objects are kept in a stack ordered by OPT priority and the miss ratio
+// at every cache size comes from the stack distance of each request
+//
+// with variable object sizes, finding OPT is NP-hard, we compute an upper
+// bound of the hit ratio (a lower bound of the miss ratio) with the
+// interval relaxation of PFOO-L (Berger et al., SIGMETRICS 2018): a hit needs
+// obj_size * reuse_time of cache space-time, and a cache of size C has
+// C * n_req space-time, so the hits are bounded by taking the cheapest
+// reuse intervals until the space-time runs out
+//
+// both require the next access vtime of each request (oracle traces)
+//
+// profilerOPT.h
+// libCacheSim
+//
+
+#ifndef profilerOPT_h
+#define profilerOPT_h
+
+#include <glib.h>
+#include <stdint.h>
+
+#include "reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief the object miss ratio of OPT with unit object size
+ * for cache sizes 0 ~ size (number of objects), computed in one pass
+ *
+ * @param reader the trace must have next access vtime
+ * @param size the largest cache size
+ * @return an array of size + 1 miss ratios, free with g_free
+ */
+double *get_opt_obj_miss_ratio(reader_t *reader, gint64 size);
+
+/**
+ * @brief the lower bound of the object and byte miss ratio of OPT with
+ * variable object sizes at the given cache sizes (bytes), the trace is split
+ * into n_thread segments that are scanned in parallel
+ *
+ * @param reader the trace must have next access vtime
+ * @param cache_sizes the cache sizes in bytes
+ * @param n_size the number of cache sizes
+ * @param obj_miss_ratio output, n_size object miss ratio bounds
+ * @param byte_miss_ratio output, n_size byte miss ratio bounds
+ * @param n_thread the number of threads
+ */
+void get_opt_miss_ratio_bound(reader_t *reader, const uint64_t *cache_sizes,
+                              int n_size, double *obj_miss_ratio,
+                              double *byte_miss_ratio, int n_thread);
+
+/* internal use, the OPT miss count for cache sizes 0 ~ size */
+guint64 *_get_opt_miss_cnt(reader_t *reader, gint64 size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* profilerOPT_h */
@@ -33,6 +33,14 @@
 extern "C" {
 #endif
 
+/* how the requests of a MULTI_TRACE are tagged with the index of the trace
+ * they come from */
+typedef enum {
+  MULTI_TRACE_TAG_NONE,
+  MULTI_TRACE_TAG_TENANT,
+  MULTI_TRACE_TAG_NS,
+} multi_trace_tag_e;
+
 /* this provides the info about each field or col in csv and binary trace
  * the field index start with 1 */
 typedef struct {
@@ -64,6 +72,19 @@ typedef struct {
 
   // sample some requests in the trace
   sampler_t *sampler;
+
+  // load the sidecar index (trace_path.idx) if it exists, otherwise build it
+  // on the first pass that counts the requests, see reader_build_index
+  bool use_index;
+
+  // multi-trace reader, the type of each trace, the other params apply to
+  // each trace except sampler and cap_at_n_req, which apply to all requests
+  trace_type_e multi_trace_type;
+  // merge the traces by clock_time, otherwise concatenate them in order
+  bool multi_trace_merge;
+  multi_trace_tag_e multi_trace_tag;
+  // read each trace ahead in a background thread
+  bool multi_trace_readahead;
 } reader_init_param_t;
 
 enum read_direction {
@@ -72,6 +93,7 @@ enum read_direction {
 };
 
 struct zstd_reader;
+struct reader_index;
 typedef struct reader {
   /************* common fields *************/
   uint64_t n_read_req;
@@ -103,6 +125,13 @@ typedef struct reader {
   bool is_zstd_file;
   /* the size of one request in binary trace */
   size_t item_size;
+  /* the offsets of the little-endian obj_id (8 bytes, or 4 bytes that are
+   * sign-extended as read_data does) and obj_size (4 bytes) in a record,
+   * they are used to skip the requests that are not sampled without
+   * decoding them, -1 if the trace does not support it */
+  int raw_obj_id_offset;
+  int raw_obj_id_width;
+  int raw_obj_size_offset;
 
   /************* used by txt trace *************/
   FILE *file;
@@ -126,6 +155,9 @@ typedef struct reader {
   /* used for trace sampling */
   sampler_t *sampler;
   enum read_direction read_direction;
+
+  /* a sparse index from request number to file position, NULL if not used */
+  struct reader_index *index;
 } reader_t;
 
 static inline void set_default_reader_init_params(reader_init_param_t *params) {
@@ -152,6 +184,11 @@ static inline void set_default_reader_init_params(reader_init_param_t *params) {
   params->binary_fmt_str = NULL;
 
   params->sampler = NULL;
+
+  params->multi_trace_type = UNKNOWN_TRACE;
+  params->multi_trace_merge = false;
+  params->multi_trace_tag = MULTI_TRACE_TAG_NONE;
+  params->multi_trace_readahead = false;
 }
 
 static inline reader_init_param_t default_reader_init_params(void) {
@@ -265,6 +302,30 @@ int go_back_one_req(reader_t *reader);
 
 void reader_set_read_pos(reader_t *reader, double pos);
 
+/**
+ * read the whole trace once and build a sparse index of
+ * (request number, file position, timestamp), the index is saved to
+ * trace_path.idx and loaded by readers opened with use_index,
+ * it makes get_num_of_req O(1) and seeking cheap for txt, csv and zstd traces
+ * @param reader
+ * @return true if the index is built
+ */
+bool reader_build_index(reader_t *reader);
+
+/**
+ * seek so that the next read_one_req returns the req_idx-th request
+ * (start from 0) of the trace, sampling is ignored when seeking
+ * @return 0 on success, 1 if the trace has fewer requests
+ */
+int reader_seek_to_req(reader_t *reader, int64_t req_idx);
+
+/**
+ * seek to the first request whose clock_time >= clock_time,
+ * assuming the timestamps are non-decreasing
+ * @return 0 on success, 1 if no request is at or after clock_time
+ */
+int reader_seek_to_time(reader_t *reader, int64_t clock_time);
+
 static inline void print_reader(reader_t *reader) {
   printf(
       "trace_type: %s, trace_path: %s, trace_start_offset: %d, mmap_offset: "
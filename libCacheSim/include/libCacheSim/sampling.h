@@ -11,6 +11,12 @@ struct request;
 
 typedef bool (*trace_sampling_func)(struct sampler *sampler, request_t *req);
 
+/* return the number of leading requests in obj_ids that are not sampled
+ * (n if none is sampled), the state of the sampler is advanced over these
+ * requests only, so the next sampled request still goes through sample */
+typedef int (*trace_batch_sampling_func)(struct sampler *sampler,
+                                         const obj_id_t *obj_ids, int n);
+
 typedef struct sampler *(*clone_sampler_func)(const struct sampler *sampler);
 
 typedef void (*free_sampler_func)(struct sampler *sampler);
@@ -24,10 +30,18 @@ enum sampler_type {
 
 static const char *sampling_type_str[] = {"spatial", "temporal", "invalid"};
 
+/* a sampling ratio that is not 1 / integer is used as
+ * sampling_boundary / SAMPLING_RATIO_SCALE */
+#define SAMPLING_RATIO_SCALE 1000000
+
 typedef struct sampler {
   trace_sampling_func sample;
+  /* optional, used by the reader to skip records without decoding them */
+  trace_batch_sampling_func sample_batch;
+  /* 1 / sampling_ratio if it is an integer, otherwise 0 */
   int sampling_ratio_inv;
   double sampling_ratio;
+  uint64_t sampling_boundary;
   void *other_params;
   clone_sampler_func clone;
   free_sampler_func free;
@@ -0,0 +1,66 @@
+//
+// record what the cache does for each request of a simulation so that later
+// analyses can join it with the trace instead of re-running the cache
+//
+// two files are written, both are indexed by the request number in the trace
+// (starting from 0, including the warmup requests)
+// <path>.hit: a bitmap, bit i (byte i / 8, the least significant bit first)
+//   is 1 if request i hits, the last byte is padded with 0
+// <path>.event: a sequence of events, each starts with the varint
+//   (req_delta << 2) | type, where req_delta is the number of requests since
+//   the previous event, type is cache_event_e (admit, bypass or evict),
+//   an evict event is followed by the varint obj_id and obj_size of the victim,
+//   the object of an admit or bypass event is the request itself
+//
+// varints are unsigned LEB128 (7 bits per byte, the lowest bits first), when
+// zstd is available, the files are written as <path>.hit.zst and
+// <path>.event.zst, and can be decompressed with `zstd -d`
+//
+// the buffers are compressed and written by a background thread
+//
+// simOutput.h
+// libCacheSim
+//
+
+#pragma once
+
+#include "cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sim_output sim_output_t;
+
+/**
+ * @brief create the output files and register the event hook of the cache,
+ * the events are only reported by the algorithms that use cache_get_base,
+ * the victims are the objects removed with cache_remove_obj_base during the
+ * eviction and not in the cache afterwards
+ *
+ * @param path the path prefix of the output files
+ * @param cache
+ * @return the output, NULL if the files cannot be created
+ */
+sim_output_t *open_sim_output(const char *path, cache_t *cache);
+
+/**
+ * @brief record the result of a request, call it after each cache->get
+ * and before the next one
+ *
+ * @param output
+ * @param hit the return value of cache->get
+ */
+void sim_output_record(sim_output_t *output, bool hit);
+
+/**
+ * @brief flush the output, wait for the background writer and unregister
+ * the event hook
+ *
+ * @return true if all data are written
+ */
+bool close_sim_output(sim_output_t *output);
+
+#ifdef __cplusplus
+}
+#endif
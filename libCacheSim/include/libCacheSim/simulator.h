@@ -89,6 +89,159 @@ cache_stat_t *simulate_with_multi_caches(reader_t *reader, cache_t *caches[],
                                          int num_of_threads, 
                                          bool free_cache_when_finish);
 
+/* how the trace is split into shards in simulate_sharded */
+typedef enum {
+  /* each shard has the same number of requests */
+  SHARD_BY_REQ,
+  /* each shard covers the same length of trace time */
+  SHARD_BY_TIME,
+
+  SHARD_MODE_INVALID,
+} shard_mode_e;
+
+typedef struct {
+  int n_shard;
+  shard_mode_e mode;
+  /* a shard starting from an empty cache first replays the warmup_n_req
+   * requests before the shard without counting them */
+  int64_t warmup_n_req;
+  /* round 0 runs all shards in parallel from (warmed) empty caches,
+   * round r restarts shard i with the cache that shard i-1 ends with in
+   * round r-1, so after n_round rounds the first n_round shards are exact,
+   * and the later ones start from a state closer to the exact one */
+  int n_round;
+  /* if larger than 0, the objects sampled (spatially) with this ratio are
+   * also simulated with a scaled cache, both sharded and in one serial pass,
+   * and the difference estimates the error introduced by sharding */
+  double verify_sample_ratio;
+  int num_of_threads;
+} sharded_sim_params_t;
+
+typedef struct {
+  /* the sum of all shards */
+  cache_stat_t stat;
+  int n_shard;
+  /* the first request of each shard and the end of the trace, n_shard + 1 */
+  int64_t *shard_start;
+  cache_stat_t *shard_stat;
+
+  /* the miss ratio of the sampled objects, -1 if not verified */
+  double sampled_sharded_miss_ratio;
+  double sampled_exact_miss_ratio;
+  /* the largest absolute miss ratio error of one shard on the sampled objects */
+  double max_shard_miss_ratio_error;
+} sharded_sim_result_t;
+
+static inline sharded_sim_params_t default_sharded_sim_params(void) {
+  sharded_sim_params_t params;
+  params.n_shard = 8;
+  params.mode = SHARD_BY_REQ;
+  params.warmup_n_req = 1000000;
+  params.n_round = 1;
+  params.verify_sample_ratio = 0.01;
+  params.num_of_threads = 8;
+  return params;
+}
+
+/**
+ * simulate one cache on a trace by splitting the trace into shards and
+ * simulating the shards in parallel, each shard seeks to its start using
+ * reader_seek_to_req, so the trace should be an uncompressed binary trace
+ * or be opened with use_index, otherwise each shard reads the trace from
+ * the beginning
+ *
+ * the result is approximate because a shard does not start from the cache
+ * state at the end of the previous shard, see sharded_sim_params_t for
+ * how to reduce and estimate the error
+ *
+ * sampling in the reader is not supported
+ *
+ * @param reader
+ * @param cache the cache used as a template, it is not modified
+ * @param params see default_sharded_sim_params
+ * @return the result, which should be freed with free_sharded_sim_result
+ */
+sharded_sim_result_t *simulate_sharded(reader_t *reader, const cache_t *cache,
+                                       const sharded_sim_params_t *params);
+
+void free_sharded_sim_result(sharded_sim_result_t *result);
+
+/* how the L1 and L2 caches in a cache hierarchy share objects */
+typedef enum {
+  /* L2 is filled with L1 misses, L1 evictions are not propagated */
+  HIERARCHY_NON_INCLUSIVE,
+  /* L2 is filled with L1 misses, an L2 eviction of an object that is in L1
+   * requires a back invalidation, because the L1 caches are shared by all L2
+   * sizes, back invalidations are counted but not applied to L1 */
+  HIERARCHY_INCLUSIVE,
+  /* L2 only holds L1 victims, an L2 hit moves the object to L1 */
+  HIERARCHY_EXCLUSIVE,
+
+  HIERARCHY_INVALID,
+} hierarchy_policy_e;
+
+/* the names of hierarchy_policy_e, defined in hierarchy.c */
+extern const char *const hierarchy_policy_str[HIERARCHY_INVALID + 1];
+
+typedef struct {
+  hierarchy_policy_e policy;
+  /* if true, L1 tracks dirty objects (written by set/write/update ops) and
+   * writes them back to L2 on eviction */
+  bool track_writeback;
+  /* the number of messages buffered between one L1 and one L2 */
+  int64_t queue_size;
+} cache_hierarchy_params_t;
+
+typedef struct {
+  /* n_req and n_miss count the L1 misses looked up in L2 */
+  cache_stat_t stat;
+  /* dirty L1 evictions written back to L2 */
+  int64_t n_writeback;
+  int64_t n_writeback_byte;
+  /* L1 victims inserted into L2 (exclusive hierarchy) */
+  int64_t n_victim_insert;
+  /* L2 evictions of objects still cached in L1 (inclusive hierarchy) */
+  int64_t n_back_invalidation;
+} cache_hierarchy_stat_t;
+
+static inline cache_hierarchy_params_t default_cache_hierarchy_params(void) {
+  cache_hierarchy_params_t params;
+  params.policy = HIERARCHY_NON_INCLUSIVE;
+  params.track_writeback = false;
+  params.queue_size = 1 << 16;
+  return params;
+}
+
+/**
+ * simulate a two-level cache hierarchy in one pass without materializing the
+ * L1 misses, each L1 cache reads its own trace in a separate thread and
+ * streams its misses (and evictions if needed) through lock-free queues to
+ * num_of_l2_sizes L2 caches, each running in its own thread, every L2 cache
+ * merges the streams from all L1 caches by timestamp
+ *
+ * inclusive and exclusive hierarchies and writeback tracking learn the L1
+ * evictions (and the L2 evictions for inclusive hierarchy) from the event hook
+ * of the caches, so the algorithms need to use cache_get_base and the L1
+ * caches must not have an event hook
+ *
+ * @param l1_readers one reader per L1 cache, the readers are consumed
+ * @param l1_caches the L1 caches, they are not freed
+ * @param num_of_l1 number of L1 caches
+ * @param l2_cache the L2 cache used as a template
+ * @param num_of_l2_sizes number of L2 cache sizes
+ * @param l2_cache_sizes the L2 cache sizes
+ * @param params hierarchy params, see default_cache_hierarchy_params
+ * @param l1_stat if not NULL, an array of num_of_l1 cache_stat_t that is
+ * filled with the L1 results
+ * @return an array of num_of_l2_sizes cache_hierarchy_stat_t, the returned
+ * array should be freed by the user
+ */
+cache_hierarchy_stat_t *simulate_cache_hierarchy(
+    reader_t *l1_readers[], cache_t *l1_caches[], int num_of_l1,
+    const cache_t *l2_cache, int num_of_l2_sizes,
+    const uint64_t *l2_cache_sizes, const cache_hierarchy_params_t *params,
+    cache_stat_t *l1_stat);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,355 @@
+//
+//  hit ratio heatmap of start time x end time, see heatmap.h
+//
+//  each row of the heatmap is the cumulative hit count of a cache starting
+//  at the row's pixel divided by the number of requests, for LRU the hits of
+//  all rows come from one pass of stack distances, for other caches each row
+//  is one simulation from its start pixel, and the rows run in parallel
+//
+//  heatmap.c
+//  libCacheSim
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../include/libCacheSim/heatmap.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <math.h>
+
+#include "../dataStructure/splay.h"
+#include "../utils/include/mymath.h"
+
+#define HEATMAP_MAGIC 0x50414d4853434cULL /* "LCSHMAP" */
+#define HEATMAP_VERSION 1
+
+static const char *heatmap_time_mode_str[HEATMAP_TIME_MODE_INVALID + 1] = {
+    "vtime", "rtime", "invalid"};
+
+/* 64 bytes so that the pixel_start and matrix after it are aligned */
+typedef struct {
+  uint64_t magic;
+  int32_t version;
+  int32_t time_mode;
+  int64_t n_pixel;
+  int64_t time_interval;
+  int64_t n_req;
+  int64_t reserved[3];
+} heatmap_header_t;
+
+int64_t get_stack_dist_add_req(const request_t *req, sTree **splay_tree,
+                               GHashTable *hash_table, const int64_t curr_ts,
+                               int64_t *last_access_ts);
+
+typedef struct {
+  reader_t *reader;
+  const cache_t *cache;
+  heatmap_t *heatmap;
+  int64_t start_ts;
+  GMutex mtx;
+} hr_heatmap_sim_t;
+
+static int64_t get_start_ts(reader_t *reader) {
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  reset_reader(cloned_reader);
+  read_one_req(cloned_reader, req);
+  int64_t start_ts = req->clock_time;
+  free_request(req);
+  close_reader(cloned_reader);
+  return start_ts;
+}
+
+static void compute_pixel_start(reader_t *reader, heatmap_t *heatmap,
+                                const heatmap_params_t *params,
+                                int64_t n_req) {
+  int64_t interval = params->time_interval;
+
+  if (params->time_mode == HEATMAP_VIRTUAL_TIME) {
+    if (interval == 0) {
+      interval = (n_req + params->n_pixel - 1) / params->n_pixel;
+    }
+    interval = MAX(interval, 1);
+    heatmap->n_pixel = (int)((n_req + interval - 1) / interval);
+    heatmap->time_interval = interval;
+    heatmap->pixel_start = my_malloc_n(int64_t, heatmap->n_pixel + 1);
+    for (int i = 0; i < heatmap->n_pixel; i++) {
+      heatmap->pixel_start[i] = interval * i;
+    }
+    heatmap->pixel_start[heatmap->n_pixel] = n_req;
+    return;
+  }
+
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  reset_reader(cloned_reader);
+  read_one_req(cloned_reader, req);
+  int64_t start_ts = req->clock_time;
+  reader_seek_to_req(cloned_reader, n_req - 1);
+  read_one_req(cloned_reader, req);
+  int64_t end_ts = req->clock_time;
+
+  if (interval == 0) interval = (end_ts - start_ts) / params->n_pixel + 1;
+  interval = MAX(interval, 1);
+  heatmap->n_pixel = (int)((end_ts - start_ts) / interval + 1);
+  heatmap->time_interval = interval;
+  heatmap->pixel_start = my_malloc_n(int64_t, heatmap->n_pixel + 1);
+  heatmap->pixel_start[0] = 0;
+  heatmap->pixel_start[heatmap->n_pixel] = n_req;
+  for (int i = 1; i < heatmap->n_pixel; i++) {
+    if (reader_seek_to_time(cloned_reader, start_ts + interval * i) == 0) {
+      heatmap->pixel_start[i] = (int64_t)cloned_reader->n_read_req;
+    } else {
+      heatmap->pixel_start[i] = n_req;
+    }
+    heatmap->pixel_start[i] =
+        MAX(heatmap->pixel_start[i], heatmap->pixel_start[i - 1]);
+  }
+
+  free_request(req);
+  close_reader(cloned_reader);
+}
+
+static heatmap_t *new_heatmap(reader_t *reader,
+                              const heatmap_params_t *params) {
+  if (params->time_mode >= HEATMAP_TIME_MODE_INVALID ||
+      params->time_interval < 0 ||
+      (params->time_interval == 0 && params->n_pixel <= 0)) {
+    ERROR("invalid heatmap params, time interval %ld, n_pixel %d\n",
+          (long)params->time_interval, params->n_pixel);
+    return NULL;
+  }
+  if (reader->sampler != NULL) {
+    ERROR("heatmap does not support trace sampling\n");
+    return NULL;
+  }
+
+  int64_t n_req = (int64_t)get_num_of_req(reader);
+  if (n_req == 0) {
+    ERROR("heatmap of an empty trace\n");
+    return NULL;
+  }
+
+  heatmap_t *heatmap = my_malloc(heatmap_t);
+  memset(heatmap, 0, sizeof(heatmap_t));
+  heatmap->time_mode = params->time_mode;
+  compute_pixel_start(reader, heatmap, params, n_req);
+
+  int64_t n_pixel = heatmap->n_pixel;
+  heatmap->matrix = my_malloc_n(double, n_pixel * n_pixel);
+
+  return heatmap;
+}
+
+/* hit_cnt[j] is the number of hits from the start of pixel i to the end of
+ * pixel j */
+static void fill_row(heatmap_t *heatmap, int i, const int64_t *hit_cnt) {
+  int n_pixel = heatmap->n_pixel;
+  double *row = heatmap->matrix + (int64_t)i * n_pixel;
+  for (int j = 0; j < i; j++) {
+    row[j] = NAN;
+  }
+  for (int j = i; j < n_pixel; j++) {
+    int64_t n_req = heatmap->pixel_start[j + 1] - heatmap->pixel_start[i];
+    row[j] = n_req > 0 ? (double)hit_cnt[j] / (double)n_req : NAN;
+  }
+}
+
+/* the last pixel starting at or before ts */
+static int find_pixel(const heatmap_t *heatmap, int64_t ts) {
+  int lo = 0, hi = heatmap->n_pixel - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (heatmap->pixel_start[mid] <= ts) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+heatmap_t *get_lru_obj_hr_heatmap(reader_t *reader, int64_t cache_size,
+                                  const heatmap_params_t *params) {
+  heatmap_t *heatmap = new_heatmap(reader, params);
+  if (heatmap == NULL) return NULL;
+
+  int n_pixel = heatmap->n_pixel;
+  INFO("%s starts computation, cache size %ld, %d pixels of %ld %s\n",
+       __func__, (long)cache_size, n_pixel, (long)heatmap->time_interval,
+       heatmap_time_mode_str[heatmap->time_mode]);
+
+  /* hit_cnt[a * n_pixel + b] is the number of LRU hits in pixel b whose last
+   * access is in pixel a, they are hits for all start pixels up to a */
+  int64_t *hit_cnt = my_malloc_n(int64_t, (int64_t)n_pixel * n_pixel);
+  memset(hit_cnt, 0, sizeof(int64_t) * n_pixel * n_pixel);
+
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  GHashTable *hash_table =
+      g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+  sTree *splay_tree = NULL;
+  reset_reader(cloned_reader);
+
+  int64_t ts = 0, last_access_ts;
+  int pixel = 0;
+  while (read_one_req(cloned_reader, req) == 0) {
+    while (pixel < n_pixel - 1 && ts >= heatmap->pixel_start[pixel + 1]) {
+      pixel++;
+    }
+    int64_t stack_dist = get_stack_dist_add_req(req, &splay_tree, hash_table,
+                                                ts, &last_access_ts);
+    if (stack_dist != -1 && stack_dist < cache_size) {
+      int last_pixel = find_pixel(heatmap, last_access_ts);
+      hit_cnt[(int64_t)last_pixel * n_pixel + pixel] += 1;
+    }
+    ts++;
+  }
+
+  /* going up from the last row, start_hit_cnt[j] sums the hits in pixel j
+   * whose last access is in pixel i or later */
+  int64_t *start_hit_cnt = my_malloc_n(int64_t, n_pixel);
+  int64_t *row_hit_cnt = my_malloc_n(int64_t, n_pixel);
+  memset(start_hit_cnt, 0, sizeof(int64_t) * n_pixel);
+  for (int i = n_pixel - 1; i >= 0; i--) {
+    int64_t n_hit = 0;
+    for (int j = i; j < n_pixel; j++) {
+      start_hit_cnt[j] += hit_cnt[(int64_t)i * n_pixel + j];
+      n_hit += start_hit_cnt[j];
+      row_hit_cnt[j] = n_hit;
+    }
+    fill_row(heatmap, i, row_hit_cnt);
+  }
+
+  my_free(sizeof(int64_t) * n_pixel, start_hit_cnt);
+  my_free(sizeof(int64_t) * n_pixel, row_hit_cnt);
+  my_free(sizeof(int64_t) * n_pixel * n_pixel, hit_cnt);
+  g_hash_table_destroy(hash_table);
+  free_sTree(splay_tree);
+  free_request(req);
+  close_reader(cloned_reader);
+
+  return heatmap;
+}
+
+static void _hr_heatmap_task(gpointer data, gpointer user_data) {
+  hr_heatmap_sim_t *sim = (hr_heatmap_sim_t *)user_data;
+  heatmap_t *heatmap = sim->heatmap;
+  int n_pixel = heatmap->n_pixel;
+  int i = GPOINTER_TO_UINT(data) - 1;
+  set_rand_seed(0);
+
+  /* cache creation is not thread safe for all algorithms */
+  g_mutex_lock(&sim->mtx);
+  cache_t *cache =
+      create_cache_with_new_size(sim->cache, sim->cache->cache_size);
+  g_mutex_unlock(&sim->mtx);
+
+  reader_t *reader = clone_reader(sim->reader);
+  request_t *req = new_request();
+  int64_t *hit_cnt = my_malloc_n(int64_t, n_pixel);
+  if (reader_seek_to_req(reader, heatmap->pixel_start[i]) != 0) {
+    WARN("heatmap row %d cannot seek to request %ld\n", i,
+         (long)heatmap->pixel_start[i]);
+  }
+
+  int64_t n_hit = 0;
+  int pixel = i;
+  int64_t end = heatmap->pixel_start[n_pixel];
+  for (int64_t ts = heatmap->pixel_start[i]; ts < end; ts++) {
+    if (read_one_req(reader, req) != 0) break;
+    while (pixel < n_pixel - 1 && ts >= heatmap->pixel_start[pixel + 1]) {
+      hit_cnt[pixel++] = n_hit;
+    }
+    req->clock_time -= sim->start_ts;
+    if (cache->get(cache, req)) n_hit += 1;
+  }
+  for (; pixel < n_pixel; pixel++) {
+    hit_cnt[pixel] = n_hit;
+  }
+
+  fill_row(heatmap, i, hit_cnt);
+
+  my_free(sizeof(int64_t) * n_pixel, hit_cnt);
+  free_request(req);
+  close_reader(reader);
+  cache->cache_free(cache);
+}
+
+heatmap_t *get_hr_heatmap(reader_t *reader, const cache_t *cache,
+                          const heatmap_params_t *params) {
+  heatmap_t *heatmap = new_heatmap(reader, params);
+  if (heatmap == NULL) return NULL;
+
+  int n_pixel = heatmap->n_pixel;
+  INFO("%s starts computation %s, %d pixels of %ld %s, %d threads\n",
+       __func__, cache->cache_name, n_pixel, (long)heatmap->time_interval,
+       heatmap_time_mode_str[heatmap->time_mode], params->num_of_threads);
+
+  hr_heatmap_sim_t sim;
+  memset(&sim, 0, sizeof(sim));
+  sim.reader = reader;
+  sim.cache = cache;
+  sim.heatmap = heatmap;
+  sim.start_ts = get_start_ts(reader);
+  g_mutex_init(&sim.mtx);
+
+  GThreadPool *gthread_pool =
+      g_thread_pool_new((GFunc)_hr_heatmap_task, (gpointer)&sim,
+                        params->num_of_threads, TRUE, NULL);
+  ASSERT_NOT_NULL(gthread_pool, "cannot create thread pool in heatmap\n");
+
+  /* the rows starting earlier are longer, start them first */
+  for (int i = 0; i < n_pixel; i++) {
+    ASSERT_TRUE(g_thread_pool_push(gthread_pool, GSIZE_TO_POINTER(i + 1), NULL),
+                "cannot push data into thread_pool in get_hr_heatmap\n");
+  }
+  g_thread_pool_free(gthread_pool, FALSE, TRUE);
+  g_mutex_clear(&sim.mtx);
+
+  return heatmap;
+}
+
+bool save_heatmap(const heatmap_t *heatmap, const char *path) {
+  FILE *ofile = fopen(path, "wb");
+  if (ofile == NULL) {
+    WARN("cannot open %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  int64_t n_pixel = heatmap->n_pixel;
+  heatmap_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = HEATMAP_MAGIC;
+  header.version = HEATMAP_VERSION;
+  header.time_mode = heatmap->time_mode;
+  header.n_pixel = n_pixel;
+  header.time_interval = heatmap->time_interval;
+  header.n_req = heatmap->pixel_start[n_pixel];
+
+  bool ok = fwrite(&header, sizeof(header), 1, ofile) == 1 &&
+            fwrite(heatmap->pixel_start, sizeof(int64_t), n_pixel + 1,
+                   ofile) == (size_t)(n_pixel + 1) &&
+            fwrite(heatmap->matrix, sizeof(double), n_pixel * n_pixel,
+                   ofile) == (size_t)(n_pixel * n_pixel);
+  ok = (fclose(ofile) == 0) && ok;
+  if (!ok) {
+    WARN("failed to write heatmap %s\n", path);
+  }
+
+  return ok;
+}
+
+void free_heatmap(heatmap_t *heatmap) {
+  my_free(sizeof(int64_t) * (heatmap->n_pixel + 1), heatmap->pixel_start);
+  my_free(sizeof(double) * heatmap->n_pixel * heatmap->n_pixel,
+          heatmap->matrix);
+  my_free(sizeof(heatmap_t), heatmap);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,480 @@
+//
+//  simulate a two-level cache hierarchy in one pass,
+//  the L1 caches stream their misses and evictions to the L2 caches through
+//  lock-free queues, so we do not need to write the L1 miss traces to disk
+//  and read them back for each L2 size
+//
+//  hierarchy.c
+//  libCacheSim
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <glib.h>
+
+#include "../dataStructure/spscRing.h"
+#include "../include/libCacheSim/simulator.h"
+
+const char *const hierarchy_policy_str[HIERARCHY_INVALID + 1] = {
+    "non-inclusive", "inclusive", "exclusive", "invalid"};
+
+typedef enum {
+  HIER_MSG_MISS,   /* an L1 miss, looked up in L2 */
+  HIER_MSG_EVICT,  /* an L1 eviction */
+  HIER_MSG_END,    /* the L1 trace has finished */
+} hier_msg_type_e;
+
+typedef struct {
+  int64_t clock_time;
+  obj_id_t obj_id;
+  int64_t obj_size;
+  int8_t type;
+  /* the evicted object was written in L1 */
+  bool dirty;
+  /* the missed object was inserted into L1 */
+  bool admitted;
+} hier_msg_t;
+
+typedef struct {
+  obj_id_t obj_id;
+  int64_t obj_size;
+} evicted_obj_t;
+
+typedef struct {
+  reader_t *reader;
+  cache_t *cache;
+  /* one ring per L2 cache */
+  spsc_ring_t **rings;
+  int n_l2;
+  const cache_hierarchy_params_t *params;
+  cache_stat_t *stat;
+
+  /* the objects that have been written since they are inserted */
+  GHashTable *dirty_objs;
+  /* the objects evicted when serving the current request */
+  evicted_obj_t *evicted;
+  int n_evicted;
+  int evicted_array_size;
+  /* whether the current request is inserted into L1 */
+  bool admitted;
+} l1_worker_t;
+
+typedef struct {
+  cache_t *cache;
+  /* one ring per L1 cache */
+  spsc_ring_t **rings;
+  int n_l1;
+  const cache_hierarchy_params_t *params;
+  cache_hierarchy_stat_t *stat;
+
+  /* inclusive hierarchy: obj_id -> the number of L1 caches holding it */
+  GHashTable *l1_resident_objs;
+} l2_worker_t;
+
+static inline bool _is_write_op(req_op_e op) {
+  switch (op) {
+    case OP_SET:
+    case OP_ADD:
+    case OP_CAS:
+    case OP_REPLACE:
+    case OP_APPEND:
+    case OP_PREPEND:
+    case OP_INCR:
+    case OP_DECR:
+    case OP_WRITE:
+    case OP_UPDATE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/************************** L1 **************************/
+/* the event hook of the L1 cache, records the victims and admission of the
+ * current request */
+static void _l1_handle_event(const cache_t *cache, cache_event_e event,
+                             const request_t *req, const cache_obj_t *obj,
+                             void *user_data) {
+  l1_worker_t *worker = (l1_worker_t *)user_data;
+  if (event == CACHE_EVENT_ADMIT) {
+    worker->admitted = true;
+    return;
+  } else if (event != CACHE_EVENT_EVICT) {
+    return;
+  }
+
+  if (worker->n_evicted == worker->evicted_array_size) {
+    worker->evicted_array_size *= 2;
+    worker->evicted = realloc(worker->evicted, sizeof(evicted_obj_t) *
+                                                   worker->evicted_array_size);
+    ASSERT_NOT_NULL(worker->evicted, "cannot grow evicted obj array\n");
+  }
+  worker->evicted[worker->n_evicted].obj_id = obj->obj_id;
+  worker->evicted[worker->n_evicted].obj_size = obj->obj_size;
+  worker->n_evicted += 1;
+}
+
+static inline void _l1_send(l1_worker_t *worker, const hier_msg_t *msg) {
+  for (int i = 0; i < worker->n_l2; i++) {
+    spsc_ring_push(worker->rings[i], msg);
+  }
+}
+
+static gpointer _l1_worker(gpointer data) {
+  l1_worker_t *worker = (l1_worker_t *)data;
+  cache_t *cache = worker->cache;
+  const cache_hierarchy_params_t *params = worker->params;
+  bool track_eviction =
+      params->policy != HIERARCHY_NON_INCLUSIVE || params->track_writeback;
+
+  request_t *req = new_request();
+  hier_msg_t msg;
+  memset(&msg, 0, sizeof(msg));
+
+  if (track_eviction) {
+    if (cache->event_hook != NULL) {
+      ERROR("L1 cache %s already has an event hook\n", cache->cache_name);
+    }
+    cache->event_hook = _l1_handle_event;
+    cache->event_hook_data = worker;
+  }
+
+  read_one_req(worker->reader, req);
+  while (req->valid) {
+    worker->stat->n_req += 1;
+    worker->stat->n_req_byte += req->obj_size;
+
+    worker->n_evicted = 0;
+    worker->admitted = false;
+    bool hit = cache->get(cache, req);
+    bool admitted = worker->admitted;
+
+    if (!hit) {
+      worker->stat->n_miss += 1;
+      worker->stat->n_miss_byte += req->obj_size;
+
+      msg.type = HIER_MSG_MISS;
+      msg.clock_time = req->clock_time;
+      msg.obj_id = req->obj_id;
+      msg.obj_size = req->obj_size;
+      msg.dirty = false;
+      msg.admitted = admitted;
+      _l1_send(worker, &msg);
+    }
+
+    for (int i = 0; i < worker->n_evicted; i++) {
+      gpointer key = GSIZE_TO_POINTER(worker->evicted[i].obj_id);
+      bool dirty = false;
+      if (params->track_writeback) {
+        dirty = g_hash_table_remove(worker->dirty_objs, key);
+      }
+      if (params->policy == HIERARCHY_NON_INCLUSIVE && !dirty) {
+        continue;
+      }
+
+      msg.type = HIER_MSG_EVICT;
+      msg.clock_time = req->clock_time;
+      msg.obj_id = worker->evicted[i].obj_id;
+      msg.obj_size = worker->evicted[i].obj_size;
+      msg.dirty = dirty;
+      msg.admitted = false;
+      _l1_send(worker, &msg);
+    }
+
+    if (params->track_writeback && _is_write_op(req->op) &&
+        (hit || admitted)) {
+      g_hash_table_add(worker->dirty_objs, GSIZE_TO_POINTER(req->obj_id));
+    }
+
+    read_one_req(worker->reader, req);
+  }
+
+  msg.type = HIER_MSG_END;
+  msg.clock_time = INT64_MAX;
+  _l1_send(worker, &msg);
+
+  if (track_eviction) {
+    cache->event_hook = NULL;
+    cache->event_hook_data = NULL;
+  }
+
+  worker->stat->n_obj = cache->get_n_obj(cache);
+  worker->stat->occupied_byte = cache->get_occupied_byte(cache);
+  worker->stat->cache_size = cache->cache_size;
+  strncpy(worker->stat->cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+
+  INFO("L1 cache %s (size %" PRIu64 ") finishes %" PRId64
+       " requests, miss ratio %.4lf\n",
+       cache->cache_name, cache->cache_size, worker->stat->n_req,
+       (double)worker->stat->n_miss / (double)worker->stat->n_req);
+
+  free_request(req);
+  return NULL;
+}
+
+/************************** L2 **************************/
+/* the event hook of the L2 cache in an inclusive hierarchy, counts the
+ * victims that are still in an L1 cache */
+static void _l2_check_back_invalidation(const cache_t *cache,
+                                        cache_event_e event,
+                                        const request_t *req,
+                                        const cache_obj_t *obj,
+                                        void *user_data) {
+  l2_worker_t *worker = (l2_worker_t *)user_data;
+  if (event != CACHE_EVENT_EVICT) return;
+
+  if (g_hash_table_contains(worker->l1_resident_objs,
+                            GSIZE_TO_POINTER(obj->obj_id))) {
+    worker->stat->n_back_invalidation += 1;
+  }
+}
+
+static void _l2_update_l1_residency(l2_worker_t *worker, obj_id_t obj_id,
+                                    int delta) {
+  gpointer key = GSIZE_TO_POINTER(obj_id);
+  gint cnt = GPOINTER_TO_INT(g_hash_table_lookup(worker->l1_resident_objs, key));
+  cnt += delta;
+  if (cnt <= 0) {
+    g_hash_table_remove(worker->l1_resident_objs, key);
+  } else {
+    g_hash_table_replace(worker->l1_resident_objs, key, GINT_TO_POINTER(cnt));
+  }
+}
+
+static void _l2_handle_miss(l2_worker_t *worker, const hier_msg_t *msg,
+                            request_t *req) {
+  cache_t *cache = worker->cache;
+  cache_stat_t *stat = &worker->stat->stat;
+  bool hit;
+
+  stat->n_req += 1;
+  stat->n_req_byte += msg->obj_size;
+
+  switch (worker->params->policy) {
+    case HIERARCHY_EXCLUSIVE:
+      /* the object moves up to L1 on an L2 hit,
+       * and it is not inserted into L2 on an L2 miss */
+      cache->n_req += 1;
+      hit = cache->find(cache, req, true) != NULL;
+      if (hit) {
+        cache->remove(cache, req->obj_id);
+      }
+      break;
+    case HIERARCHY_INCLUSIVE:
+      hit = cache->get(cache, req);
+      if (msg->admitted) {
+        _l2_update_l1_residency(worker, msg->obj_id, 1);
+      }
+      break;
+    default:
+      hit = cache->get(cache, req);
+      break;
+  }
+
+  if (!hit) {
+    stat->n_miss += 1;
+    stat->n_miss_byte += msg->obj_size;
+  }
+}
+
+static void _l2_handle_evict(l2_worker_t *worker, const hier_msg_t *msg,
+                             request_t *req) {
+  cache_t *cache = worker->cache;
+
+  if (msg->dirty) {
+    worker->stat->n_writeback += 1;
+    worker->stat->n_writeback_byte += msg->obj_size;
+  }
+
+  switch (worker->params->policy) {
+    case HIERARCHY_EXCLUSIVE:
+      worker->stat->n_victim_insert += 1;
+      cache->get(cache, req);
+      break;
+    case HIERARCHY_INCLUSIVE:
+      _l2_update_l1_residency(worker, msg->obj_id, -1);
+      if (msg->dirty) {
+        cache->get(cache, req);
+      }
+      break;
+    default:
+      /* write-allocate the dirty object in L2 */
+      if (msg->dirty) {
+        cache->get(cache, req);
+      }
+      break;
+  }
+}
+
+static gpointer _l2_worker(gpointer data) {
+  l2_worker_t *worker = (l2_worker_t *)data;
+  int n_l1 = worker->n_l1;
+  int n_finished = 0;
+  hier_msg_t **heads = my_malloc_n(hier_msg_t *, n_l1);
+  bool *finished = my_malloc_n(bool, n_l1);
+  memset(heads, 0, sizeof(hier_msg_t *) * n_l1);
+  memset(finished, 0, sizeof(bool) * n_l1);
+  request_t *req = new_request();
+
+  while (n_finished < n_l1) {
+    /* merge the L1 streams by time, we wait for every unfinished stream to
+     * have a message so that the merged order is deterministic */
+    int min_idx = -1;
+    for (int i = 0; i < n_l1; i++) {
+      if (finished[i]) continue;
+      if (heads[i] == NULL) {
+        heads[i] = (hier_msg_t *)spsc_ring_wait_peek(worker->rings[i]);
+      }
+      if (heads[i]->type == HIER_MSG_END) {
+        finished[i] = true;
+        n_finished += 1;
+        heads[i] = NULL;
+        spsc_ring_pop(worker->rings[i]);
+        continue;
+      }
+      if (min_idx == -1 || heads[i]->clock_time < heads[min_idx]->clock_time) {
+        min_idx = i;
+      }
+    }
+    if (min_idx == -1) break;
+
+    hier_msg_t *msg = heads[min_idx];
+    req->clock_time = msg->clock_time;
+    req->obj_id = msg->obj_id;
+    req->obj_size = msg->obj_size;
+    req->valid = true;
+    if (msg->type == HIER_MSG_MISS) {
+      _l2_handle_miss(worker, msg, req);
+    } else {
+      _l2_handle_evict(worker, msg, req);
+    }
+    worker->stat->stat.curr_rtime = msg->clock_time;
+
+    heads[min_idx] = NULL;
+    spsc_ring_pop(worker->rings[min_idx]);
+  }
+
+  cache_t *cache = worker->cache;
+  worker->stat->stat.n_obj = cache->get_n_obj(cache);
+  worker->stat->stat.occupied_byte = cache->get_occupied_byte(cache);
+  worker->stat->stat.cache_size = cache->cache_size;
+  strncpy(worker->stat->stat.cache_name, cache->cache_name,
+          CACHE_NAME_ARRAY_LEN);
+
+  free_request(req);
+  my_free(sizeof(hier_msg_t *) * n_l1, heads);
+  my_free(sizeof(bool) * n_l1, finished);
+  return NULL;
+}
+
+/**
+ * @brief simulate a two-level cache hierarchy, see simulator.h
+ */
+cache_hierarchy_stat_t *simulate_cache_hierarchy(
+    reader_t *l1_readers[], cache_t *l1_caches[], int num_of_l1,
+    const cache_t *l2_cache, int num_of_l2_sizes,
+    const uint64_t *l2_cache_sizes, const cache_hierarchy_params_t *params,
+    cache_stat_t *l1_stat) {
+  assert(num_of_l1 > 0);
+  assert(num_of_l2_sizes > 0);
+
+  cache_hierarchy_params_t default_params = default_cache_hierarchy_params();
+  if (params == NULL) params = &default_params;
+  if (params->policy >= HIERARCHY_INVALID) {
+    ERROR("unknown cache hierarchy policy %d\n", (int)params->policy);
+  }
+
+  cache_hierarchy_stat_t *result =
+      my_malloc_n(cache_hierarchy_stat_t, num_of_l2_sizes);
+  memset(result, 0, sizeof(cache_hierarchy_stat_t) * num_of_l2_sizes);
+  cache_stat_t *l1_result = my_malloc_n(cache_stat_t, num_of_l1);
+  memset(l1_result, 0, sizeof(cache_stat_t) * num_of_l1);
+
+  /* rings[i * num_of_l2_sizes + j] connects L1 i and L2 j */
+  spsc_ring_t **rings = my_malloc_n(spsc_ring_t *, num_of_l1 * num_of_l2_sizes);
+  for (int i = 0; i < num_of_l1 * num_of_l2_sizes; i++) {
+    rings[i] = create_spsc_ring(sizeof(hier_msg_t), params->queue_size);
+  }
+
+  l2_worker_t *l2_workers = my_malloc_n(l2_worker_t, num_of_l2_sizes);
+  GThread **l2_threads = my_malloc_n(GThread *, num_of_l2_sizes);
+  for (int j = 0; j < num_of_l2_sizes; j++) {
+    l2_worker_t *worker = &l2_workers[j];
+    worker->cache = create_cache_with_new_size(l2_cache, l2_cache_sizes[j]);
+    worker->n_l1 = num_of_l1;
+    worker->rings = my_malloc_n(spsc_ring_t *, num_of_l1);
+    for (int i = 0; i < num_of_l1; i++) {
+      worker->rings[i] = rings[i * num_of_l2_sizes + j];
+    }
+    worker->params = params;
+    worker->stat = &result[j];
+    worker->l1_resident_objs = NULL;
+    if (params->policy == HIERARCHY_INCLUSIVE) {
+      worker->l1_resident_objs =
+          g_hash_table_new(g_direct_hash, g_direct_equal);
+      worker->cache->event_hook = _l2_check_back_invalidation;
+      worker->cache->event_hook_data = worker;
+    }
+    l2_threads[j] = g_thread_new("l2_cache", _l2_worker, worker);
+  }
+
+  l1_worker_t *l1_workers = my_malloc_n(l1_worker_t, num_of_l1);
+  GThread **l1_threads = my_malloc_n(GThread *, num_of_l1);
+  for (int i = 0; i < num_of_l1; i++) {
+    l1_worker_t *worker = &l1_workers[i];
+    worker->reader = l1_readers[i];
+    worker->cache = l1_caches[i];
+    worker->n_l2 = num_of_l2_sizes;
+    worker->rings = &rings[i * num_of_l2_sizes];
+    worker->params = params;
+    worker->stat = &l1_result[i];
+    worker->dirty_objs = g_hash_table_new(g_direct_hash, g_direct_equal);
+    worker->evicted_array_size = 8;
+    worker->n_evicted = 0;
+    worker->evicted = my_malloc_n(evicted_obj_t, worker->evicted_array_size);
+    l1_threads[i] = g_thread_new("l1_cache", _l1_worker, worker);
+  }
+
+  INFO("%s starts %d L1 caches and %d L2 caches (%s, %s), %s hierarchy\n",
+       __func__, num_of_l1, num_of_l2_sizes, l1_caches[0]->cache_name,
+       l2_cache->cache_name, hierarchy_policy_str[params->policy]);
+
+  for (int i = 0; i < num_of_l1; i++) {
+    g_thread_join(l1_threads[i]);
+    g_hash_table_destroy(l1_workers[i].dirty_objs);
+    free(l1_workers[i].evicted);
+  }
+
+  for (int j = 0; j < num_of_l2_sizes; j++) {
+    g_thread_join(l2_threads[j]);
+    l2_workers[j].cache->cache_free(l2_workers[j].cache);
+    if (l2_workers[j].l1_resident_objs != NULL) {
+      g_hash_table_destroy(l2_workers[j].l1_resident_objs);
+    }
+    my_free(sizeof(spsc_ring_t *) * num_of_l1, l2_workers[j].rings);
+  }
+
+  for (int i = 0; i < num_of_l1 * num_of_l2_sizes; i++) {
+    free_spsc_ring(rings[i]);
+  }
+
+  if (l1_stat != NULL) {
+    memcpy(l1_stat, l1_result, sizeof(cache_stat_t) * num_of_l1);
+  }
+
+  my_free(sizeof(spsc_ring_t *) * num_of_l1 * num_of_l2_sizes, rings);
+  my_free(sizeof(l1_worker_t) * num_of_l1, l1_workers);
+  my_free(sizeof(GThread *) * num_of_l1, l1_threads);
+  my_free(sizeof(l2_worker_t) * num_of_l2_sizes, l2_workers);
+  my_free(sizeof(GThread *) * num_of_l2_sizes, l2_threads);
+  my_free(sizeof(cache_stat_t) * num_of_l1, l1_result);
+
+  // user is responsible for free-ing the result
+  return result;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,83 @@
+//
+// per-operation cpu cost of the cache, see perfStat.h
+//
+// perfStat.c
+// libCacheSim
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../include/libCacheSim/perfStat.h"
+
+static const char *const perf_op_str[N_PERF_OP] = {"find", "admit", "evict",
+                                                   "insert", "prefetch"};
+
+uint64_t perf_hist_percentile(const perf_hist_t *hist, double percentile) {
+  if (hist->n == 0) return 0;
+
+  int64_t target = (int64_t)(percentile * (double)hist->n);
+  if (target >= hist->n) target = hist->n - 1;
+  int64_t cnt = 0;
+  for (int i = 0; i < PERF_HIST_N_BUCKET; i++) {
+    cnt += hist->buckets[i];
+    if (cnt > target) return perf_hist_bucket_value(i);
+  }
+
+  return (uint64_t)hist->max;
+}
+
+static void _perf_hist_merge(perf_hist_t *dst, const perf_hist_t *src) {
+  dst->n += src->n;
+  dst->sum += src->sum;
+  if (src->max > dst->max) dst->max = src->max;
+  for (int i = 0; i < PERF_HIST_N_BUCKET; i++) {
+    dst->buckets[i] += src->buckets[i];
+  }
+}
+
+void perf_stat_merge(perf_stat_t *dst, const perf_stat_t *src) {
+  for (int op = 0; op < N_PERF_OP; op++) {
+    _perf_hist_merge(&dst->op_cycles[op], &src->op_cycles[op]);
+  }
+  _perf_hist_merge(&dst->chain_len, &src->chain_len);
+  dst->n_hashtable_expand += src->n_hashtable_expand;
+}
+
+void print_perf_stat(FILE *ofile, const char *cache_name,
+                     const perf_stat_t *perf_stat) {
+  int64_t total_cycles = 0;
+  for (int op = 0; op < N_PERF_OP; op++) {
+    total_cycles += perf_stat->op_cycles[op].sum;
+  }
+
+  fprintf(ofile, "%s cycles per operation\n", cache_name);
+  fprintf(ofile, "%16s %12s %10s %10s %10s %12s %8s\n", "operation", "count",
+          "mean", "p50", "p99", "max", "share");
+  for (int op = 0; op < N_PERF_OP; op++) {
+    const perf_hist_t *hist = &perf_stat->op_cycles[op];
+    if (hist->n == 0) continue;
+
+    fprintf(ofile, "%16s %12" PRId64 " %10.1lf %10" PRIu64 " %10" PRIu64
+                   " %12" PRId64 " %8.4lf\n",
+            perf_op_str[op], hist->n, (double)hist->sum / (double)hist->n,
+            perf_hist_percentile(hist, 0.5), perf_hist_percentile(hist, 0.99),
+            hist->max, (double)hist->sum / (double)total_cycles);
+  }
+
+  const perf_hist_t *chain_len = &perf_stat->chain_len;
+  if (chain_len->n > 0) {
+    fprintf(ofile,
+            "%s hashtable: %" PRId64 " lookups, chain length mean %.2lf, "
+            "p99 %" PRIu64 ", max %" PRId64 ", %" PRId64 " expansions\n",
+            cache_name, chain_len->n,
+            (double)chain_len->sum / (double)chain_len->n,
+            perf_hist_percentile(chain_len, 0.99), chain_len->max,
+            perf_stat->n_hashtable_expand);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
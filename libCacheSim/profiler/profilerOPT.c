@@ -0,0 +1,515 @@
+//
+// the miss ratio curve of the optimal cache, see profilerOPT.h
+//
+// profilerOPT.c
+// libCacheSim
+//
+
+#include "../include/libCacheSim/profilerOPT.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/mem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  one-pass OPT with unit size                  ****
+// ****                                                               ****
+// ***********************************************************************
+
+/**
+ * Mattson's update of the OPT stack: when the object at stack distance d is
+ * requested, it moves to the top, and the object carried down from the top is
+ * compared with each level above d, the one accessed sooner stays and the
+ * other is carried, so only the prefix maxima of the next access vtime move,
+ * each moves to the position of the next prefix maximum and the last one
+ * moves to d. prefix maxima at consecutive positions form runs, a run shifts
+ * down by one and its last object moves to the start of the next run.
+ * a run can be thousands of objects long, but there are few runs per request,
+ * so the stack is an implicit treap and a run is moved with split and merge
+ */
+typedef struct {
+  int64_t left;
+  int64_t right;
+  int64_t parent;
+  int64_t size;
+  /* the next access vtime */
+  int64_t val;
+  /* the max, first and last val in the subtree */
+  int64_t max_val;
+  int64_t first_val;
+  int64_t last_val;
+  uint32_t prio;
+  /* whether val is strictly increasing in the subtree */
+  bool increasing;
+  bool in_stack;
+} opt_node_t;
+
+#define OPT_NIL (-1)
+
+typedef struct {
+  /* one node per object, indexed by the dense object index */
+  opt_node_t *nodes;
+  int64_t n_obj;
+  int64_t obj_capacity;
+
+  int64_t root;
+  int64_t max_depth;
+  uint64_t rand_state;
+} opt_stack_t;
+
+static inline int64_t _size(const opt_stack_t *stack, int64_t n) {
+  return n == OPT_NIL ? 0 : stack->nodes[n].size;
+}
+
+static void _pull(opt_stack_t *stack, int64_t n) {
+  opt_node_t *node = &stack->nodes[n];
+  node->size = 1;
+  node->max_val = node->val;
+  node->first_val = node->val;
+  node->last_val = node->val;
+  node->increasing = true;
+  node->parent = OPT_NIL;
+
+  if (node->left != OPT_NIL) {
+    opt_node_t *l = &stack->nodes[node->left];
+    l->parent = n;
+    node->size += l->size;
+    node->max_val = MAX(node->max_val, l->max_val);
+    node->first_val = l->first_val;
+    node->increasing = l->increasing && l->last_val < node->val;
+  }
+  if (node->right != OPT_NIL) {
+    opt_node_t *r = &stack->nodes[node->right];
+    r->parent = n;
+    node->size += r->size;
+    node->max_val = MAX(node->max_val, r->max_val);
+    node->last_val = r->last_val;
+    node->increasing =
+        node->increasing && r->increasing && node->val < r->first_val;
+  }
+}
+
+/* split the first k objects of t into *l and the rest into *r */
+static void _split(opt_stack_t *stack, int64_t t, int64_t k, int64_t *l,
+                   int64_t *r) {
+  if (t == OPT_NIL) {
+    *l = *r = OPT_NIL;
+    return;
+  }
+
+  opt_node_t *node = &stack->nodes[t];
+  if (_size(stack, node->left) < k) {
+    _split(stack, node->right, k - _size(stack, node->left) - 1, &node->right,
+           r);
+    *l = t;
+  } else {
+    _split(stack, node->left, k, l, &node->left);
+    *r = t;
+  }
+  _pull(stack, t);
+  if (*l != OPT_NIL) stack->nodes[*l].parent = OPT_NIL;
+  if (*r != OPT_NIL) stack->nodes[*r].parent = OPT_NIL;
+}
+
+static int64_t _merge(opt_stack_t *stack, int64_t l, int64_t r) {
+  if (l == OPT_NIL) return r;
+  if (r == OPT_NIL) return l;
+
+  if (stack->nodes[l].prio > stack->nodes[r].prio) {
+    stack->nodes[l].right = _merge(stack, stack->nodes[l].right, r);
+    _pull(stack, l);
+    return l;
+  } else {
+    stack->nodes[r].left = _merge(stack, l, stack->nodes[r].left);
+    _pull(stack, r);
+    return r;
+  }
+}
+
+/* the 0-based position of the node in the stack */
+static int64_t _position(const opt_stack_t *stack, int64_t n) {
+  int64_t pos = _size(stack, stack->nodes[n].left);
+  while (stack->nodes[n].parent != OPT_NIL) {
+    int64_t p = stack->nodes[n].parent;
+    if (stack->nodes[p].right == n) {
+      pos += _size(stack, stack->nodes[p].left) + 1;
+    }
+    n = p;
+  }
+  return pos;
+}
+
+/* the position of the first object in t whose val is larger than v, or -1 */
+static int64_t _find_larger(const opt_stack_t *stack, int64_t t, int64_t v) {
+  int64_t pos = 0;
+  while (t != OPT_NIL && stack->nodes[t].max_val > v) {
+    const opt_node_t *node = &stack->nodes[t];
+    if (node->left != OPT_NIL && stack->nodes[node->left].max_val > v) {
+      t = node->left;
+    } else if (node->val > v) {
+      return pos + _size(stack, node->left);
+    } else {
+      pos += _size(stack, node->left) + 1;
+      t = node->right;
+    }
+  }
+  return -1;
+}
+
+/* the length of the strictly increasing prefix of t,
+ * prev is the val before t */
+static int64_t _increasing_prefix_len(const opt_stack_t *stack, int64_t t,
+                                      int64_t prev) {
+  if (t == OPT_NIL) return 0;
+
+  const opt_node_t *node = &stack->nodes[t];
+  if (node->increasing && prev < node->first_val) return node->size;
+
+  int64_t left_len = _increasing_prefix_len(stack, node->left, prev);
+  if (left_len < _size(stack, node->left)) return left_len;
+
+  int64_t before =
+      node->left == OPT_NIL ? prev : stack->nodes[node->left].last_val;
+  if (node->val <= before) return left_len;
+
+  return left_len + 1 +
+         _increasing_prefix_len(stack, node->right, node->val);
+}
+
+static void _opt_stack_init(opt_stack_t *stack, int64_t max_depth) {
+  memset(stack, 0, sizeof(opt_stack_t));
+  stack->root = OPT_NIL;
+  stack->max_depth = max_depth;
+  stack->rand_state = 0x9E3779B97F4A7C15ULL;
+  stack->obj_capacity = 1024;
+  stack->nodes = g_new(opt_node_t, stack->obj_capacity);
+}
+
+static void _opt_stack_free(opt_stack_t *stack) { g_free(stack->nodes); }
+
+/**
+ * @brief move the prefix maxima of t as in Mattson's update
+ *
+ * @param t the objects above the requested one
+ * @param carry the object that leaves t, which is the last prefix maximum
+ * @return t without the carried object
+ */
+static int64_t _opt_stack_push_down(opt_stack_t *stack, int64_t t,
+                                    int64_t *carry) {
+  int64_t out = OPT_NIL;
+  int64_t max_val = INT64_MIN;
+  *carry = OPT_NIL;
+  while (t != OPT_NIL) {
+    int64_t run_start = _find_larger(stack, t, max_val);
+    if (run_start == -1) break;
+
+    int64_t gap, run;
+    _split(stack, t, run_start, &gap, &t);
+    out = _merge(stack, out, gap);
+    /* the carried object moves to the start of the run */
+    if (*carry != OPT_NIL) out = _merge(stack, out, *carry);
+
+    int64_t run_len = _increasing_prefix_len(stack, t, max_val);
+    _split(stack, t, run_len, &run, &t);
+    int64_t run_body;
+    _split(stack, run, run_len - 1, &run_body, carry);
+    out = _merge(stack, out, run_body);
+    max_val = stack->nodes[*carry].val;
+  }
+
+  return _merge(stack, out, t);
+}
+
+/**
+ * @brief access an object and update the stack
+ * @return the stack distance of the object, 0 if it is not in the stack
+ */
+static int64_t _opt_stack_access(opt_stack_t *stack, int64_t obj,
+                                 int64_t next_access_vtime) {
+  opt_node_t *node = &stack->nodes[obj];
+  int64_t dist = 0;
+  int64_t above, below = OPT_NIL;
+  if (node->in_stack) {
+    dist = _position(stack, obj) + 1;
+    int64_t rest;
+    _split(stack, stack->root, dist - 1, &above, &rest);
+    _split(stack, rest, 1, &rest, &below);
+  } else {
+    above = stack->root;
+  }
+
+  int64_t carry = OPT_NIL;
+  above = _opt_stack_push_down(stack, above, &carry);
+  if (carry != OPT_NIL) {
+    if (dist == 0 && _size(stack, above) + 1 > stack->max_depth - 1) {
+      /* the carried object falls out of the largest cache */
+      stack->nodes[carry].in_stack = false;
+    } else {
+      above = _merge(stack, above, carry);
+    }
+  }
+
+  node = &stack->nodes[obj];
+  node->val = next_access_vtime;
+  node->left = node->right = OPT_NIL;
+  node->in_stack = true;
+  _pull(stack, obj);
+  stack->root = _merge(stack, _merge(stack, obj, above), below);
+  return dist;
+}
+
+static int64_t _get_dense_obj_idx(opt_stack_t *stack, GHashTable *obj_idx,
+                                  obj_id_t obj_id) {
+  gpointer v = g_hash_table_lookup(obj_idx, GSIZE_TO_POINTER(obj_id));
+  if (v != NULL) return (int64_t)GPOINTER_TO_SIZE(v) - 1;
+
+  int64_t idx = stack->n_obj++;
+  if (idx == stack->obj_capacity) {
+    stack->obj_capacity *= 2;
+    stack->nodes = g_renew(opt_node_t, stack->nodes, stack->obj_capacity);
+  }
+  opt_node_t *node = &stack->nodes[idx];
+  memset(node, 0, sizeof(opt_node_t));
+  node->left = node->right = node->parent = OPT_NIL;
+  /* xorshift64 */
+  stack->rand_state ^= stack->rand_state << 13;
+  stack->rand_state ^= stack->rand_state >> 7;
+  stack->rand_state ^= stack->rand_state << 17;
+  node->prio = (uint32_t)stack->rand_state;
+
+  g_hash_table_insert(obj_idx, GSIZE_TO_POINTER(obj_id),
+                      GSIZE_TO_POINTER(idx + 1));
+  return idx;
+}
+
+guint64 *_get_opt_miss_cnt(reader_t *reader, gint64 size) {
+  guint64 *hit_cnt = g_new0(guint64, size + 1);
+  guint64 n_req = 0;
+
+  opt_stack_t stack;
+  _opt_stack_init(&stack, MAX(size, 1));
+  GHashTable *obj_idx =
+      g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, NULL);
+
+  request_t *req = new_request();
+  read_one_req(reader, req);
+  while (req->valid) {
+    if (n_req == 0 && req->next_access_vtime == -2) {
+      ERROR("OPT profiler requires the next access vtime of each request\n");
+    }
+    int64_t next_access_vtime =
+        req->next_access_vtime == -1 ? INT64_MAX : req->next_access_vtime;
+
+    int64_t obj = _get_dense_obj_idx(&stack, obj_idx, req->obj_id);
+    int64_t dist = _opt_stack_access(&stack, obj, next_access_vtime);
+    if (dist > 0 && dist <= size) hit_cnt[dist] += 1;
+
+    n_req += 1;
+    read_one_req(reader, req);
+  }
+
+  /* hit_cnt[x] becomes the hit count of cache size x,
+   * and then the miss count */
+  for (gint64 i = 1; i < size + 1; i++) {
+    hit_cnt[i] += hit_cnt[i - 1];
+  }
+  for (gint64 i = 0; i < size + 1; i++) {
+    hit_cnt[i] = n_req - hit_cnt[i];
+  }
+
+  free_request(req);
+  g_hash_table_destroy(obj_idx);
+  _opt_stack_free(&stack);
+  reset_reader(reader);
+  return hit_cnt;
+}
+
+double *get_opt_obj_miss_ratio(reader_t *reader, gint64 size) {
+  double n_req = (double)get_num_of_req(reader);
+  double *miss_ratio = g_new(double, size + 1);
+
+  guint64 *miss_cnt = _get_opt_miss_cnt(reader, size);
+  for (gint64 i = 0; i < size + 1; i++) {
+    miss_ratio[i] = (double)miss_cnt[i] / n_req;
+  }
+  g_free(miss_cnt);
+  return miss_ratio;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****             miss ratio bound with variable size               ****
+// ****                                                               ****
+// ***********************************************************************
+
+/* each power of two is split into 8 buckets, so the cost of an interval
+ * is under-estimated by at most 12.5% when a bucket is partially used */
+#define BOUND_SUB_BITS 3
+#define BOUND_N_SUB (1 << BOUND_SUB_BITS)
+#define BOUND_N_BUCKET (128 * BOUND_N_SUB)
+
+typedef struct {
+  int64_t n_interval;
+  double cost;
+  double bytes;
+} bound_bucket_t;
+
+typedef struct {
+  /* bucketed by obj_size * reuse_time, for the object miss ratio */
+  bound_bucket_t obj_buckets[BOUND_N_BUCKET];
+  /* bucketed by reuse_time, the cost per byte, for the byte miss ratio */
+  bound_bucket_t byte_buckets[BOUND_N_BUCKET];
+  int64_t n_req;
+  double n_byte;
+} bound_hist_t;
+
+typedef struct {
+  reader_t *reader;
+  int64_t n_req_per_seg;
+  bound_hist_t *hists;
+} bound_params_t;
+
+static inline int _bound_bucket_idx(double value) {
+  if (value < 1) return 0;
+
+  int exp;
+  double mantissa = frexp(value, &exp);
+  int sub = (int)((mantissa * 2 - 1) * BOUND_N_SUB);
+  return MIN(exp * BOUND_N_SUB + sub, BOUND_N_BUCKET - 1);
+}
+
+/* the smallest value in the bucket */
+static inline double _bound_bucket_value(int idx) {
+  if (idx < BOUND_N_SUB) return 0;
+
+  int exp = idx / BOUND_N_SUB;
+  int sub = idx % BOUND_N_SUB;
+  return ldexp(1.0 + (double)sub / BOUND_N_SUB, exp - 1);
+}
+
+static inline void _bound_bucket_add(bound_bucket_t *bucket, double cost,
+                                     double bytes) {
+  bucket->n_interval += 1;
+  bucket->cost += cost;
+  bucket->bytes += bytes;
+}
+
+static void _scan_segment(gpointer data, gpointer user_data) {
+  int seg_idx = GPOINTER_TO_INT(data) - 1;
+  bound_params_t *params = (bound_params_t *)user_data;
+  bound_hist_t *hist = &params->hists[seg_idx];
+
+  reader_t *reader = clone_reader(params->reader);
+  int64_t start = params->n_req_per_seg * seg_idx;
+  for (int64_t n_skip = start; n_skip > 0; n_skip -= INT32_MAX) {
+    skip_n_req(reader, (int)MIN(n_skip, INT32_MAX));
+  }
+
+  request_t *req = new_request();
+  /* the vtime of the first request is 1 */
+  int64_t vtime = start + 1;
+  while (hist->n_req < params->n_req_per_seg && read_one_req(reader, req) == 0) {
+    hist->n_req += 1;
+    hist->n_byte += (double)req->obj_size;
+
+    if (req->next_access_vtime != -1 && req->next_access_vtime != INT64_MAX) {
+      double reuse_time = (double)MAX(req->next_access_vtime - vtime, 1);
+      double cost = (double)req->obj_size * reuse_time;
+      _bound_bucket_add(&hist->obj_buckets[_bound_bucket_idx(cost)], cost,
+                        (double)req->obj_size);
+      _bound_bucket_add(&hist->byte_buckets[_bound_bucket_idx(reuse_time)],
+                        cost, (double)req->obj_size);
+    }
+    vtime += 1;
+  }
+
+  free_request(req);
+  close_reader(reader);
+}
+
+void get_opt_miss_ratio_bound(reader_t *reader, const uint64_t *cache_sizes,
+                              int n_size, double *obj_miss_ratio,
+                              double *byte_miss_ratio, int n_thread) {
+  int64_t n_req = get_num_of_req(reader);
+  /* compressed traces cannot skip to the start of a segment */
+  int n_seg = reader->is_zstd_file ? 1 : MAX(n_thread, 1);
+
+  bound_params_t params = {.reader = reader,
+                           .n_req_per_seg = (n_req + n_seg - 1) / n_seg,
+                           .hists = g_new0(bound_hist_t, n_seg)};
+
+  GThreadPool *gthread_pool = g_thread_pool_new(
+      (GFunc)_scan_segment, (gpointer)&params, n_seg, TRUE, NULL);
+  ASSERT_NOT_NULL(gthread_pool, "cannot create thread pool in OPT bound\n");
+  for (int i = 0; i < n_seg; i++) {
+    ASSERT_TRUE(g_thread_pool_push(gthread_pool, GINT_TO_POINTER(i + 1), NULL),
+                "cannot push data into thread_pool in OPT bound\n");
+  }
+  g_thread_pool_free(gthread_pool, FALSE, TRUE);
+
+  bound_hist_t *hist = &params.hists[0];
+  for (int s = 1; s < n_seg; s++) {
+    bound_hist_t *seg_hist = &params.hists[s];
+    for (int i = 0; i < BOUND_N_BUCKET; i++) {
+      hist->obj_buckets[i].n_interval += seg_hist->obj_buckets[i].n_interval;
+      hist->obj_buckets[i].cost += seg_hist->obj_buckets[i].cost;
+      hist->obj_buckets[i].bytes += seg_hist->obj_buckets[i].bytes;
+      hist->byte_buckets[i].n_interval += seg_hist->byte_buckets[i].n_interval;
+      hist->byte_buckets[i].cost += seg_hist->byte_buckets[i].cost;
+      hist->byte_buckets[i].bytes += seg_hist->byte_buckets[i].bytes;
+    }
+    hist->n_req += seg_hist->n_req;
+    hist->n_byte += seg_hist->n_byte;
+  }
+
+  for (int s = 0; s < n_size; s++) {
+    /* the space-time of the cache, the cheapest intervals are taken first,
+     * and the last bucket is taken at its smallest cost */
+    double budget = (double)cache_sizes[s] * (double)hist->n_req;
+    double n_hit = 0;
+    for (int i = 0; i < BOUND_N_BUCKET && budget > 0; i++) {
+      bound_bucket_t *bucket = &hist->obj_buckets[i];
+      if (bucket->cost <= budget) {
+        n_hit += (double)bucket->n_interval;
+        budget -= bucket->cost;
+      } else {
+        double lo = _bound_bucket_value(i);
+        n_hit += lo > 0 ? MIN(budget / lo, (double)bucket->n_interval)
+                        : (double)bucket->n_interval;
+        budget = 0;
+      }
+    }
+
+    budget = (double)cache_sizes[s] * (double)hist->n_req;
+    double n_hit_byte = 0;
+    for (int i = 0; i < BOUND_N_BUCKET && budget > 0; i++) {
+      bound_bucket_t *bucket = &hist->byte_buckets[i];
+      if (bucket->cost <= budget) {
+        n_hit_byte += bucket->bytes;
+        budget -= bucket->cost;
+      } else {
+        double lo = _bound_bucket_value(i);
+        n_hit_byte +=
+            lo > 0 ? MIN(budget / lo, bucket->bytes) : bucket->bytes;
+        budget = 0;
+      }
+    }
+
+    obj_miss_ratio[s] = 1.0 - n_hit / (double)hist->n_req;
+    byte_miss_ratio[s] = 1.0 - n_hit_byte / hist->n_byte;
+  }
+
+  g_free(params.hists);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,375 @@
+//
+//  simulate one cache on a long trace using all cores,
+//  the trace is split into shards by request or by time, and the shards are
+//  simulated in parallel, a shard starts from a cache warmed up by replaying
+//  the requests before it, later rounds hand off the cache that the previous
+//  shard ends with, and the error is estimated on a spatially sampled subset
+//  of objects that is also simulated serially
+//
+//  shardedSim.c
+//  libCacheSim
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <glib.h>
+#include <math.h>
+
+#include "../dataStructure/hash/hash.h"
+#include "../include/libCacheSim/simulator.h"
+#include "../utils/include/mymath.h"
+
+static const char *shard_mode_str[SHARD_MODE_INVALID + 1] = {"req", "time",
+                                                              "invalid"};
+
+typedef struct {
+  reader_t *reader;
+  const cache_t *cache;
+  const sharded_sim_params_t *params;
+  int64_t *shard_start;
+  int64_t start_ts;
+  /* 1 / verify_sample_ratio, 0 if not verifying */
+  uint64_t sampling_ratio_inv;
+
+  /* the cache each shard starts with, and after the shard finishes,
+   * the cache it ends with */
+  cache_t **caches;
+  cache_t **sampled_caches;
+  /* whether the cache of the shard is empty and needs to be warmed up */
+  bool *empty_cache;
+  cache_t *exact_sampled_cache;
+
+  cache_stat_t *shard_stat;
+  cache_stat_t *sampled_shard_stat;
+  cache_stat_t *exact_sampled_shard_stat;
+} sharded_sim_t;
+
+static inline bool is_sampled(const sharded_sim_t *sim, request_t *req) {
+  if (sim->sampling_ratio_inv == 0) return false;
+  if (req->hv == 0) req->hv = get_hash_value_int_64(&req->obj_id);
+  return req->hv % sim->sampling_ratio_inv == 0;
+}
+
+static inline void update_stat(cache_stat_t *stat, const request_t *req,
+                               bool hit) {
+  stat->n_req += 1;
+  stat->n_req_byte += req->obj_size;
+  if (!hit) {
+    stat->n_miss += 1;
+    stat->n_miss_byte += req->obj_size;
+  }
+}
+
+static cache_t *create_sampled_cache(const sharded_sim_t *sim) {
+  uint64_t cache_size = (uint64_t)((double)sim->cache->cache_size /
+                                   (double)sim->sampling_ratio_inv);
+  return create_cache_with_new_size(sim->cache, MAX(cache_size, 1));
+}
+
+static void free_shard_cache(sharded_sim_t *sim, int idx) {
+  if (sim->caches[idx] != NULL) {
+    sim->caches[idx]->cache_free(sim->caches[idx]);
+    sim->caches[idx] = NULL;
+  }
+  if (sim->sampled_caches[idx] != NULL) {
+    sim->sampled_caches[idx]->cache_free(sim->sampled_caches[idx]);
+    sim->sampled_caches[idx] = NULL;
+  }
+}
+
+static void _simulate_shard(sharded_sim_t *sim, int idx) {
+  reader_t *reader = clone_reader(sim->reader);
+  request_t *req = new_request();
+  int64_t start = sim->shard_start[idx], end = sim->shard_start[idx + 1];
+
+  cache_t *cache = sim->caches[idx];
+  cache_t *sampled_cache = sim->sampled_caches[idx];
+
+  cache_stat_t *stat = &sim->shard_stat[idx];
+  cache_stat_t *sampled_stat = &sim->sampled_shard_stat[idx];
+  memset(stat, 0, sizeof(cache_stat_t));
+  memset(sampled_stat, 0, sizeof(cache_stat_t));
+
+  int64_t n_warmup = 0;
+  if (sim->empty_cache[idx]) {
+    n_warmup = MIN(start, sim->params->warmup_n_req);
+  }
+  if (reader_seek_to_req(reader, start - n_warmup) != 0) {
+    WARN("shard %d cannot seek to request %ld\n", idx,
+         (long)(start - n_warmup));
+  }
+
+  for (int64_t i = start - n_warmup; i < end; i++) {
+    if (read_one_req(reader, req) != 0) break;
+    req->clock_time -= sim->start_ts;
+    bool hit = cache->get(cache, req);
+    bool sampled = is_sampled(sim, req);
+    bool sampled_hit = sampled ? sampled_cache->get(sampled_cache, req) : true;
+
+    if (i < start) {
+      stat->n_warmup_req += 1;
+      continue;
+    }
+    update_stat(stat, req, hit);
+    if (sampled) {
+      update_stat(sampled_stat, req, sampled_hit);
+    }
+  }
+
+  stat->curr_rtime = req->clock_time;
+  stat->n_obj = cache->get_n_obj(cache);
+  stat->occupied_byte = cache->get_occupied_byte(cache);
+  stat->cache_size = cache->cache_size;
+  strncpy(stat->cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+
+  free_request(req);
+  close_reader(reader);
+}
+
+/* simulate the sampled objects serially over the whole trace */
+static void _simulate_sampled_exact(sharded_sim_t *sim) {
+  reader_t *reader = clone_reader(sim->reader);
+  request_t *req = new_request();
+  cache_t *cache = sim->exact_sampled_cache;
+  int n_shard = sim->params->n_shard;
+
+  reset_reader(reader);
+  int shard = 0;
+  for (int64_t i = 0; i < sim->shard_start[n_shard]; i++) {
+    if (read_one_req(reader, req) != 0) break;
+    while (i >= sim->shard_start[shard + 1]) shard++;
+    if (!is_sampled(sim, req)) continue;
+    req->clock_time -= sim->start_ts;
+    update_stat(&sim->exact_sampled_shard_stat[shard], req,
+                cache->get(cache, req));
+  }
+
+  free_request(req);
+  close_reader(reader);
+}
+
+static void _simulate_sharded_task(gpointer data, gpointer user_data) {
+  sharded_sim_t *sim = (sharded_sim_t *)user_data;
+  int idx = GPOINTER_TO_UINT(data) - 1;
+  set_rand_seed(0);
+
+  if (idx == sim->params->n_shard) {
+    _simulate_sampled_exact(sim);
+  } else {
+    _simulate_shard(sim, idx);
+  }
+}
+
+static void compute_shard_start(reader_t *reader,
+                                const sharded_sim_params_t *params,
+                                int64_t n_req, int64_t *shard_start) {
+  int n_shard = params->n_shard;
+  shard_start[0] = 0;
+  shard_start[n_shard] = n_req;
+
+  if (params->mode == SHARD_BY_REQ) {
+    for (int i = 1; i < n_shard; i++) {
+      shard_start[i] = n_req * i / n_shard;
+    }
+    return;
+  }
+
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  reset_reader(cloned_reader);
+  read_one_req(cloned_reader, req);
+  int64_t start_ts = req->clock_time;
+  reader_seek_to_req(cloned_reader, n_req - 1);
+  read_one_req(cloned_reader, req);
+  int64_t end_ts = req->clock_time;
+
+  for (int i = 1; i < n_shard; i++) {
+    int64_t ts = start_ts + (end_ts - start_ts) * i / n_shard;
+    if (reader_seek_to_time(cloned_reader, ts) == 0) {
+      shard_start[i] = (int64_t)cloned_reader->n_read_req;
+    } else {
+      shard_start[i] = n_req;
+    }
+    shard_start[i] = MAX(shard_start[i], shard_start[i - 1]);
+  }
+
+  free_request(req);
+  close_reader(cloned_reader);
+}
+
+sharded_sim_result_t *simulate_sharded(reader_t *reader, const cache_t *cache,
+                                       const sharded_sim_params_t *params) {
+  int n_shard = params->n_shard;
+  if (n_shard <= 0 || params->n_round <= 0 ||
+      params->mode >= SHARD_MODE_INVALID) {
+    ERROR("invalid sharded simulation params, n_shard %d, n_round %d\n",
+          n_shard, params->n_round);
+    return NULL;
+  }
+  if (reader->sampler != NULL) {
+    ERROR("sharded simulation does not support trace sampling\n");
+    return NULL;
+  }
+
+  sharded_sim_result_t *result = my_malloc(sharded_sim_result_t);
+  memset(result, 0, sizeof(sharded_sim_result_t));
+  result->n_shard = n_shard;
+  result->shard_start = my_malloc_n(int64_t, n_shard + 1);
+  result->shard_stat = my_malloc_n(cache_stat_t, n_shard);
+  memset(result->shard_stat, 0, sizeof(cache_stat_t) * n_shard);
+
+  int64_t n_req = (int64_t)get_num_of_req(reader);
+  compute_shard_start(reader, params, n_req, result->shard_start);
+
+  sharded_sim_t sim;
+  memset(&sim, 0, sizeof(sim));
+  sim.reader = reader;
+  sim.cache = cache;
+  sim.params = params;
+  sim.shard_start = result->shard_start;
+  sim.shard_stat = result->shard_stat;
+  sim.caches = my_malloc_n(cache_t *, n_shard);
+  sim.sampled_caches = my_malloc_n(cache_t *, n_shard);
+  sim.empty_cache = my_malloc_n(bool, n_shard);
+  memset(sim.caches, 0, sizeof(cache_t *) * n_shard);
+  memset(sim.sampled_caches, 0, sizeof(cache_t *) * n_shard);
+  sim.sampled_shard_stat = my_malloc_n(cache_stat_t, n_shard);
+  sim.exact_sampled_shard_stat = my_malloc_n(cache_stat_t, n_shard);
+  memset(sim.exact_sampled_shard_stat, 0, sizeof(cache_stat_t) * n_shard);
+  if (params->verify_sample_ratio > 0 && params->verify_sample_ratio < 1) {
+    sim.sampling_ratio_inv =
+        (uint64_t)(1.0 / params->verify_sample_ratio + 0.5);
+  }
+
+  request_t *req = new_request();
+  reader_t *cloned_reader = clone_reader(reader);
+  reset_reader(cloned_reader);
+  read_one_req(cloned_reader, req);
+  sim.start_ts = req->clock_time;
+  close_reader(cloned_reader);
+  free_request(req);
+
+  INFO(
+      "%s starts computation %s, %ld requests, %d shards by %s, warmup %ld "
+      "requests, %d rounds, %d threads\n",
+      __func__, cache->cache_name, (long)n_req, n_shard,
+      shard_mode_str[params->mode], (long)params->warmup_n_req,
+      params->n_round, params->num_of_threads);
+
+  for (int round = 0; round < params->n_round && round < n_shard; round++) {
+    /* the caches are created here because cache creation is not thread
+     * safe for all algorithms */
+    for (int i = round; i < n_shard; i++) {
+      sim.empty_cache[i] = sim.caches[i] == NULL;
+      if (sim.caches[i] == NULL) {
+        sim.caches[i] = create_cache_with_new_size(cache, cache->cache_size);
+      }
+      if (sim.sampled_caches[i] == NULL && sim.sampling_ratio_inv > 0) {
+        sim.sampled_caches[i] = create_sampled_cache(&sim);
+      }
+    }
+    if (round == 0 && sim.sampling_ratio_inv > 0) {
+      sim.exact_sampled_cache = create_sampled_cache(&sim);
+    }
+
+    GThreadPool *gthread_pool =
+        g_thread_pool_new((GFunc)_simulate_sharded_task, (gpointer)&sim,
+                          params->num_of_threads, TRUE, NULL);
+    ASSERT_NOT_NULL(gthread_pool, "cannot create thread pool in simulator\n");
+
+    if (round == 0 && sim.sampling_ratio_inv > 0) {
+      /* the longest task, start it first */
+      ASSERT_TRUE(g_thread_pool_push(gthread_pool,
+                                     GSIZE_TO_POINTER(n_shard + 1), NULL),
+                  "cannot push data into thread_pool in simulate_sharded\n");
+    }
+    /* the shards before round are exact since the last round */
+    for (int i = round; i < n_shard; i++) {
+      ASSERT_TRUE(
+          g_thread_pool_push(gthread_pool, GSIZE_TO_POINTER(i + 1), NULL),
+          "cannot push data into thread_pool in simulate_sharded\n");
+    }
+    g_thread_pool_free(gthread_pool, FALSE, TRUE);
+
+    /* shard i starts the next round with the cache shard i-1 ends with */
+    free_shard_cache(&sim, n_shard - 1);
+    for (int i = n_shard - 1; i > round; i--) {
+      sim.caches[i] = sim.caches[i - 1];
+      sim.sampled_caches[i] = sim.sampled_caches[i - 1];
+    }
+    sim.caches[round] = NULL;
+    sim.sampled_caches[round] = NULL;
+
+    INFO("%s round %d finishes\n", __func__, round);
+  }
+
+  for (int i = 0; i < n_shard; i++) {
+    free_shard_cache(&sim, i);
+  }
+  if (sim.exact_sampled_cache != NULL) {
+    sim.exact_sampled_cache->cache_free(sim.exact_sampled_cache);
+  }
+
+  /* merge the shards */
+  cache_stat_t *stat = &result->stat;
+  cache_stat_t sampled_stat, exact_sampled_stat;
+  memset(&sampled_stat, 0, sizeof(cache_stat_t));
+  memset(&exact_sampled_stat, 0, sizeof(cache_stat_t));
+  result->max_shard_miss_ratio_error = -1;
+  for (int i = 0; i < n_shard; i++) {
+    const cache_stat_t *s = &result->shard_stat[i];
+    stat->n_warmup_req += s->n_warmup_req;
+    stat->n_req += s->n_req;
+    stat->n_req_byte += s->n_req_byte;
+    stat->n_miss += s->n_miss;
+    stat->n_miss_byte += s->n_miss_byte;
+
+    const cache_stat_t *ss = &sim.sampled_shard_stat[i];
+    const cache_stat_t *es = &sim.exact_sampled_shard_stat[i];
+    sampled_stat.n_req += ss->n_req;
+    sampled_stat.n_miss += ss->n_miss;
+    exact_sampled_stat.n_req += es->n_req;
+    exact_sampled_stat.n_miss += es->n_miss;
+    if (ss->n_req > 0 && es->n_req > 0) {
+      double err = fabs((double)ss->n_miss / (double)ss->n_req -
+                        (double)es->n_miss / (double)es->n_req);
+      result->max_shard_miss_ratio_error =
+          MAX(result->max_shard_miss_ratio_error, err);
+    }
+  }
+  const cache_stat_t *last = &result->shard_stat[n_shard - 1];
+  stat->n_obj = last->n_obj;
+  stat->occupied_byte = last->occupied_byte;
+  stat->curr_rtime = last->curr_rtime;
+  stat->cache_size = cache->cache_size;
+  strncpy(stat->cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+
+  result->sampled_sharded_miss_ratio = -1;
+  result->sampled_exact_miss_ratio = -1;
+  if (sampled_stat.n_req > 0 && exact_sampled_stat.n_req > 0) {
+    result->sampled_sharded_miss_ratio =
+        (double)sampled_stat.n_miss / (double)sampled_stat.n_req;
+    result->sampled_exact_miss_ratio =
+        (double)exact_sampled_stat.n_miss / (double)exact_sampled_stat.n_req;
+  }
+
+  my_free(sizeof(cache_t *) * n_shard, sim.caches);
+  my_free(sizeof(cache_t *) * n_shard, sim.sampled_caches);
+  my_free(sizeof(bool) * n_shard, sim.empty_cache);
+  my_free(sizeof(cache_stat_t) * n_shard, sim.sampled_shard_stat);
+  my_free(sizeof(cache_stat_t) * n_shard, sim.exact_sampled_shard_stat);
+
+  return result;
+}
+
+void free_sharded_sim_result(sharded_sim_result_t *result) {
+  my_free(sizeof(int64_t) * (result->n_shard + 1), result->shard_start);
+  my_free(sizeof(cache_stat_t) * result->n_shard, result->shard_stat);
+  my_free(sizeof(sharded_sim_result_t), result);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,276 @@
+//
+//  write the per-request hit bitmap and the admission and eviction events of a
+//  simulation, see simOutput.h
+//
+//  the simulation fills fixed-size buffers and hands the full ones to a
+//  writer thread through a lock-free ring, the writer compresses and writes
+//  them and returns the buffers through another ring, so the simulation only
+//  waits when all buffers are waiting to be written
+//
+//  simOutput.c
+//  libCacheSim
+//
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../include/libCacheSim/simOutput.h"
+
+#include <errno.h>
+#include <glib.h>
+#include <limits.h>
+
+#include "../dataStructure/spscRing.h"
+
+#ifdef SUPPORT_ZSTD_TRACE
+#include <zstd.h>
+#endif
+
+#define SIM_OUTPUT_BUF_SIZE (1 * MiB)
+#define SIM_OUTPUT_N_BUF 8
+/* an evict event has three varints of at most 10 bytes */
+#define SIM_OUTPUT_MAX_EVENT_SIZE 30
+#define SIM_OUTPUT_ZSTD_LEVEL 3
+
+typedef enum {
+  SIM_OUTPUT_HIT,
+  SIM_OUTPUT_EVENT,
+
+  SIM_OUTPUT_N_STREAM,
+} sim_output_stream_e;
+
+static const char *sim_output_suffix[SIM_OUTPUT_N_STREAM] = {"hit", "event"};
+
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  /* the stream the buffer belongs to, -1 tells the writer to stop */
+  int stream;
+} sim_output_buf_t;
+
+struct sim_output {
+  cache_t *cache;
+  FILE *ofiles[SIM_OUTPUT_N_STREAM];
+  sim_output_buf_t *curr_buf[SIM_OUTPUT_N_STREAM];
+  sim_output_buf_t bufs[SIM_OUTPUT_N_BUF];
+  /* full buffers to the writer, and empty buffers back */
+  spsc_ring_t *full_bufs;
+  spsc_ring_t *free_bufs;
+  GThread *writer;
+  /* set by the writer, read after it finishes */
+  bool write_failed;
+
+  /* the number of recorded requests */
+  int64_t n_req;
+  /* the request of the last event */
+  int64_t last_event_req;
+  /* the hit bits that are not in the buffer yet */
+  uint64_t hit_bits;
+  int n_hit_bits;
+
+#ifdef SUPPORT_ZSTD_TRACE
+  ZSTD_CCtx *cctx;
+  void *zbuf;
+  size_t zbuf_size;
+#endif
+};
+
+static bool _write_buf(sim_output_t *output, const sim_output_buf_t *buf) {
+  FILE *ofile = output->ofiles[buf->stream];
+#ifdef SUPPORT_ZSTD_TRACE
+  /* each buffer is a zstd frame, and the frames can be decompressed as one
+   * stream */
+  size_t zsize = ZSTD_compressCCtx(output->cctx, output->zbuf,
+                                   output->zbuf_size, buf->data, buf->len,
+                                   SIM_OUTPUT_ZSTD_LEVEL);
+  if (ZSTD_isError(zsize)) {
+    WARN("zstd compression failed: %s\n", ZSTD_getErrorName(zsize));
+    return false;
+  }
+  return fwrite(output->zbuf, 1, zsize, ofile) == zsize;
+#else
+  return fwrite(buf->data, 1, buf->len, ofile) == buf->len;
+#endif
+}
+
+static gpointer _sim_output_writer(gpointer data) {
+  sim_output_t *output = (sim_output_t *)data;
+
+  while (true) {
+    sim_output_buf_t *buf =
+        *(sim_output_buf_t **)spsc_ring_wait_peek(output->full_bufs);
+    spsc_ring_pop(output->full_bufs);
+    if (buf->stream < 0) break;
+
+    if (!output->write_failed && !_write_buf(output, buf)) {
+      WARN("failed to write simulation output %s\n",
+           sim_output_suffix[buf->stream]);
+      output->write_failed = true;
+    }
+    buf->len = 0;
+    spsc_ring_push(output->free_bufs, &buf);
+  }
+
+  return NULL;
+}
+
+static sim_output_buf_t *_get_free_buf(sim_output_t *output, int stream) {
+  sim_output_buf_t *buf =
+      *(sim_output_buf_t **)spsc_ring_wait_peek(output->free_bufs);
+  spsc_ring_pop(output->free_bufs);
+  buf->stream = stream;
+  return buf;
+}
+
+static void _submit_buf(sim_output_t *output, int stream) {
+  spsc_ring_push(output->full_bufs, &output->curr_buf[stream]);
+  output->curr_buf[stream] = _get_free_buf(output, stream);
+}
+
+static inline void _write_varint(sim_output_buf_t *buf, uint64_t v) {
+  while (v >= 0x80) {
+    buf->data[buf->len++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  buf->data[buf->len++] = (uint8_t)v;
+}
+
+static void _record_event(const cache_t *cache, cache_event_e event,
+                          const request_t *req, const cache_obj_t *obj,
+                          void *user_data) {
+  sim_output_t *output = (sim_output_t *)user_data;
+  sim_output_buf_t *buf = output->curr_buf[SIM_OUTPUT_EVENT];
+  if (buf->len + SIM_OUTPUT_MAX_EVENT_SIZE > SIM_OUTPUT_BUF_SIZE) {
+    _submit_buf(output, SIM_OUTPUT_EVENT);
+    buf = output->curr_buf[SIM_OUTPUT_EVENT];
+  }
+
+  uint64_t req_delta = (uint64_t)(output->n_req - output->last_event_req);
+  _write_varint(buf, (req_delta << 2) | (uint64_t)event);
+  output->last_event_req = output->n_req;
+  if (event == CACHE_EVENT_EVICT) {
+    _write_varint(buf, obj->obj_id);
+    _write_varint(buf, (uint64_t)obj->obj_size);
+  }
+}
+
+/* move the hit bits into the buffer in little-endian order */
+static void _flush_hit_bits(sim_output_t *output) {
+  sim_output_buf_t *buf = output->curr_buf[SIM_OUTPUT_HIT];
+  int n_byte = (output->n_hit_bits + 7) / 8;
+  for (int i = 0; i < n_byte; i++) {
+    buf->data[buf->len++] = (uint8_t)(output->hit_bits >> (i * 8));
+  }
+  output->hit_bits = 0;
+  output->n_hit_bits = 0;
+
+  if (buf->len + sizeof(uint64_t) > SIM_OUTPUT_BUF_SIZE) {
+    _submit_buf(output, SIM_OUTPUT_HIT);
+  }
+}
+
+void sim_output_record(sim_output_t *output, bool hit) {
+  output->hit_bits |= (uint64_t)hit << output->n_hit_bits;
+  output->n_req += 1;
+  if (++output->n_hit_bits == 64) {
+    _flush_hit_bits(output);
+  }
+}
+
+sim_output_t *open_sim_output(const char *path, cache_t *cache) {
+  if (cache->event_hook != NULL) {
+    WARN("%s already has an event hook\n", cache->cache_name);
+    return NULL;
+  }
+
+  sim_output_t *output = my_malloc(sim_output_t);
+  memset(output, 0, sizeof(sim_output_t));
+  output->cache = cache;
+
+  char ofile_path[PATH_MAX];
+  for (int i = 0; i < SIM_OUTPUT_N_STREAM; i++) {
+#ifdef SUPPORT_ZSTD_TRACE
+    snprintf(ofile_path, PATH_MAX, "%s.%s.zst", path, sim_output_suffix[i]);
+#else
+    snprintf(ofile_path, PATH_MAX, "%s.%s", path, sim_output_suffix[i]);
+#endif
+    output->ofiles[i] = fopen(ofile_path, "wb");
+    if (output->ofiles[i] == NULL) {
+      WARN("cannot open %s: %s\n", ofile_path, strerror(errno));
+      for (int j = 0; j < i; j++) fclose(output->ofiles[j]);
+      my_free(sizeof(sim_output_t), output);
+      return NULL;
+    }
+  }
+
+#ifdef SUPPORT_ZSTD_TRACE
+  output->cctx = ZSTD_createCCtx();
+  output->zbuf_size = ZSTD_compressBound(SIM_OUTPUT_BUF_SIZE);
+  output->zbuf = malloc(output->zbuf_size);
+  ASSERT_NOT_NULL(output->zbuf, "cannot allocate compression buffer\n");
+#endif
+
+  output->full_bufs =
+      create_spsc_ring(sizeof(sim_output_buf_t *), SIM_OUTPUT_N_BUF + 1);
+  output->free_bufs =
+      create_spsc_ring(sizeof(sim_output_buf_t *), SIM_OUTPUT_N_BUF);
+  for (int i = 0; i < SIM_OUTPUT_N_BUF; i++) {
+    sim_output_buf_t *buf = &output->bufs[i];
+    buf->data = (uint8_t *)malloc(SIM_OUTPUT_BUF_SIZE);
+    ASSERT_NOT_NULL(buf->data, "cannot allocate simulation output buffer\n");
+    buf->len = 0;
+    spsc_ring_push(output->free_bufs, &buf);
+  }
+  for (int i = 0; i < SIM_OUTPUT_N_STREAM; i++) {
+    output->curr_buf[i] = _get_free_buf(output, i);
+  }
+
+  output->writer = g_thread_new("sim_output", _sim_output_writer, output);
+
+  cache->event_hook = _record_event;
+  cache->event_hook_data = output;
+
+  return output;
+}
+
+bool close_sim_output(sim_output_t *output) {
+  output->cache->event_hook = NULL;
+  output->cache->event_hook_data = NULL;
+
+  _flush_hit_bits(output);
+  for (int i = 0; i < SIM_OUTPUT_N_STREAM; i++) {
+    if (output->curr_buf[i]->len > 0) {
+      spsc_ring_push(output->full_bufs, &output->curr_buf[i]);
+    }
+  }
+  sim_output_buf_t stop = {.data = NULL, .len = 0, .stream = -1};
+  sim_output_buf_t *stop_ptr = &stop;
+  spsc_ring_push(output->full_bufs, &stop_ptr);
+  g_thread_join(output->writer);
+
+  bool ok = !output->write_failed;
+  for (int i = 0; i < SIM_OUTPUT_N_STREAM; i++) {
+    ok = (fclose(output->ofiles[i]) == 0) && ok;
+  }
+  if (ok) {
+    INFO("simulation output of %ld requests written\n", (long)output->n_req);
+  }
+
+  for (int i = 0; i < SIM_OUTPUT_N_BUF; i++) {
+    free(output->bufs[i].data);
+  }
+  free_spsc_ring(output->full_bufs);
+  free_spsc_ring(output->free_bufs);
+#ifdef SUPPORT_ZSTD_TRACE
+  ZSTD_freeCCtx(output->cctx);
+  free(output->zbuf);
+#endif
+  my_free(sizeof(sim_output_t), output);
+
+  return ok;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -96,25 +96,15 @@ static void _simulate(gpointer data, gpointer user_data) {
     read_one_req(cloned_reader, req);
   }
 
-/* disabled due to ARC and LeCaR use ghost entries in the hash table */
-#if defined(SUPPORT_TTL) && defined(ENABLE_SCAN)
-  /* get expiration information */
-  if (local_cache->hashtable->n_obj != 0) {
-    cache_stat_t temp_stat;
-    memset(&temp_stat, 0, sizeof(cache_stat_t));
-    temp_stat.curr_rtime = req->clock_time;
-    get_cache_state(local_cache, &temp_stat);
-
-    if (local_cache->occupied_size != temp_stat.occupied_size) {
-      WARN(
-          "occupied_size not match, %ld vs %ld, maybe the "
-          "cache uses a ghost list, in which case, the expired "
-          "object count may not be accurate",
-          local_cache->occupied_size, temp_stat.occupied_size);
-    }
-    result[idx].expired_obj_cnt = temp_stat.expired_obj_cnt;
-    result[idx].expired_bytes = temp_stat.expired_bytes;
-  }
+#ifdef SUPPORT_TTL
+  /* counted by the cache when objects expire, so ghost entries in the hash
+   * table are not counted */
+  result[idx].expired_obj_cnt = local_cache->n_expired_obj;
+  result[idx].expired_bytes = local_cache->n_expired_byte;
+#endif
+
+#ifdef ENABLE_PERF_STAT
+  cache_get_perf_stat(local_cache, &result[idx].perf_stat);
 #endif
 
   result[idx].curr_rtime = req->clock_time;
@@ -24,6 +24,9 @@ static inline int oracleGeneralBin_setup(reader_t *reader) {
   reader->item_size = 24;
   reader->n_total_req = (uint64_t)reader->file_size / (reader->item_size);
   reader->obj_id_is_num = true;
+  reader->raw_obj_id_offset = 4;
+  reader->raw_obj_id_width = 8;
+  reader->raw_obj_size_offset = 12;
   return 0;
 }
 
@@ -57,6 +60,9 @@ static inline int oracleGeneralOpNS_setup(reader_t *reader) {
   reader->item_size = 27;
   reader->n_total_req = (uint64_t)reader->file_size / (reader->item_size);
   reader->obj_id_is_num = true;
+  reader->raw_obj_id_offset = 4;
+  reader->raw_obj_id_width = 8;
+  reader->raw_obj_size_offset = 12;
   return 0;
 }
 
@@ -132,6 +132,17 @@ int binaryReader_setup(reader_t *const reader) {
 
   reader->n_total_req = (uint64_t)data_region_size / (reader->item_size);
 
+  /* binary_read_one_req does not skip size zero requests, so only the obj_id
+   * is needed to skip the requests that are not sampled */
+  if (params->obj_id_format == 'Q' || params->obj_id_format == 'q') {
+    reader->raw_obj_id_offset = params->obj_id_offset;
+    reader->raw_obj_id_width = 8;
+  } else if (format_to_size(params->obj_id_format) == 4 &&
+             params->obj_id_format != 'f') {
+    reader->raw_obj_id_offset = params->obj_id_offset;
+    reader->raw_obj_id_width = 4;
+  }
+
   char output[1024];
   int n = snprintf(
       output, 1024,
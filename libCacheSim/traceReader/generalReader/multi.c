@@ -0,0 +1,428 @@
+//
+// a reader that reads multiple traces of the same type as one trace, the
+// trace path is a comma-separated list of paths or glob patterns, e.g.,
+// "/data/host1.oracleGeneral.bin,/data/host2.*.oracleGeneral.bin",
+// the matches of a pattern are sorted by path
+//
+// the traces are either concatenated in order or merged by clock_time with a
+// loser tree, a tie is broken by the order of the traces, so the result is
+// deterministic, each trace has its own reader, which can read ahead in a
+// background thread that fills batches of requests and passes them through
+// lock-free rings
+//
+// the type of the traces is multi_trace_type in reader_init_param_t, the
+// other params are used to set up each trace, except the sampler and
+// cap_at_n_req, which are applied to the requests of the multi-trace reader
+//
+// multi.c
+// libCacheSim
+//
+
+#include <glib.h>
+#include <glob.h>
+#include <string.h>
+
+#include "../../dataStructure/spscRing.h"
+#include "readerInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MULTI_READAHEAD_BATCH_SIZE 256
+#define MULTI_READAHEAD_N_BATCH 4
+
+typedef struct {
+  request_t *reqs;
+  int n_req;
+} multi_batch_t;
+
+typedef struct {
+  reader_t *reader;
+  /* the next request of the trace, valid if !eof */
+  request_t *head;
+  bool eof;
+
+  /* used when not reading ahead */
+  request_t *req;
+
+  /* used when reading ahead, the reader thread owns the reader while it
+   * runs, batches go to the reader thread through free_batches and come
+   * back filled through full_batches */
+  multi_batch_t batches[MULTI_READAHEAD_N_BATCH];
+  spsc_ring_t *full_batches;
+  spsc_ring_t *free_batches;
+  multi_batch_t *curr_batch;
+  int curr_batch_pos;
+  GThread *thread;
+  bool stop;
+} multi_source_t;
+
+typedef struct {
+  int n_source;
+  multi_source_t *sources;
+  bool merge;
+  multi_trace_tag_e tag;
+  bool readahead;
+
+  /* the trace being read when concatenating */
+  int curr_source;
+  /* the loser tree used when merging, tree[0] is the winner, and
+   * tree[1 .. n_source - 1] are the losers of the internal nodes */
+  int *tree;
+} multi_params_t;
+
+/**************** read ahead ****************/
+static gpointer _multi_readahead(gpointer data) {
+  multi_source_t *src = (multi_source_t *)data;
+
+  while (true) {
+    /* wait for a free batch, the consumer may be busy with other traces for
+     * a long time, so back off to sleeping */
+    void *item;
+    int n_wait = 0;
+    while ((item = spsc_ring_peek(src->free_batches)) == NULL) {
+      if (__atomic_load_n(&src->stop, __ATOMIC_ACQUIRE)) return NULL;
+      if (++n_wait < 64) {
+        sched_yield();
+      } else {
+        g_usleep(100);
+      }
+    }
+    multi_batch_t *batch = *(multi_batch_t **)item;
+    spsc_ring_pop(src->free_batches);
+
+    batch->n_req = 0;
+    while (batch->n_req < MULTI_READAHEAD_BATCH_SIZE &&
+           read_one_req(src->reader, &batch->reqs[batch->n_req]) == 0) {
+      batch->n_req += 1;
+    }
+    /* the full ring can hold all batches, so this does not block */
+    spsc_ring_push(src->full_batches, &batch);
+
+    /* a batch that is not full marks the end of the trace */
+    if (batch->n_req < MULTI_READAHEAD_BATCH_SIZE) return NULL;
+  }
+}
+
+static void start_readahead(multi_source_t *src) {
+  src->full_batches =
+      create_spsc_ring(sizeof(multi_batch_t *), MULTI_READAHEAD_N_BATCH + 1);
+  src->free_batches =
+      create_spsc_ring(sizeof(multi_batch_t *), MULTI_READAHEAD_N_BATCH);
+  for (int i = 0; i < MULTI_READAHEAD_N_BATCH; i++) {
+    multi_batch_t *batch = &src->batches[i];
+    spsc_ring_push(src->free_batches, &batch);
+  }
+  src->curr_batch = NULL;
+  src->curr_batch_pos = 0;
+  src->stop = false;
+  src->thread = g_thread_new("multi_readahead", _multi_readahead, src);
+}
+
+static void stop_readahead(multi_source_t *src) {
+  if (src->thread == NULL) return;
+
+  /* the reader thread only waits for free batches, where it checks stop */
+  __atomic_store_n(&src->stop, true, __ATOMIC_RELEASE);
+  g_thread_join(src->thread);
+  src->thread = NULL;
+
+  free_spsc_ring(src->full_batches);
+  free_spsc_ring(src->free_batches);
+  src->full_batches = NULL;
+  src->free_batches = NULL;
+  src->curr_batch = NULL;
+}
+
+/**************** sources ****************/
+/* move the head of the trace to its next request */
+static void source_next(const multi_params_t *params, multi_source_t *src) {
+  if (src->eof) return;
+
+  if (!params->readahead) {
+    if (read_one_req(src->reader, src->req) != 0) {
+      src->eof = true;
+    }
+    src->head = src->req;
+    return;
+  }
+
+  if (src->thread == NULL && src->curr_batch == NULL) {
+    start_readahead(src);
+  }
+
+  multi_batch_t *batch = src->curr_batch;
+  if (batch != NULL) {
+    if (++src->curr_batch_pos < batch->n_req) {
+      src->head = &batch->reqs[src->curr_batch_pos];
+      return;
+    }
+    bool last_batch = batch->n_req < MULTI_READAHEAD_BATCH_SIZE;
+    src->curr_batch = NULL;
+    spsc_ring_push(src->free_batches, &batch);
+    if (last_batch) {
+      src->eof = true;
+      return;
+    }
+  }
+
+  batch = *(multi_batch_t **)spsc_ring_wait_peek(src->full_batches);
+  spsc_ring_pop(src->full_batches);
+  if (batch->n_req == 0) {
+    spsc_ring_push(src->free_batches, &batch);
+    src->eof = true;
+    return;
+  }
+  src->curr_batch = batch;
+  src->curr_batch_pos = 0;
+  src->head = &batch->reqs[0];
+}
+
+/**************** loser tree ****************/
+/* whether the head of trace a comes before the head of trace b, the traces
+ * that reach the end come after all others */
+static inline bool source_before(const multi_params_t *params, int a, int b) {
+  const multi_source_t *src_a = &params->sources[a];
+  const multi_source_t *src_b = &params->sources[b];
+  if (src_a->eof != src_b->eof) return src_b->eof;
+  if (src_a->eof) return a < b;
+
+  int64_t time_a = src_a->head->clock_time;
+  int64_t time_b = src_b->head->clock_time;
+  return time_a < time_b || (time_a == time_b && a < b);
+}
+
+/* node i has children 2i and 2i + 1, trace j is the leaf n_source + j,
+ * return the winner of the subtree and record the losers */
+static int build_loser_tree(multi_params_t *params, int node) {
+  if (node >= params->n_source) return node - params->n_source;
+
+  int left = build_loser_tree(params, node * 2);
+  int right = build_loser_tree(params, node * 2 + 1);
+  if (source_before(params, left, right)) {
+    params->tree[node] = right;
+    return left;
+  }
+  params->tree[node] = left;
+  return right;
+}
+
+/* replay the matches from the leaf of the winner after its head changes */
+static void update_loser_tree(multi_params_t *params) {
+  int winner = params->tree[0];
+  for (int node = (winner + params->n_source) / 2; node > 0; node /= 2) {
+    if (source_before(params, params->tree[node], winner)) {
+      int loser = winner;
+      winner = params->tree[node];
+      params->tree[node] = loser;
+    }
+  }
+  params->tree[0] = winner;
+}
+
+/**************** reader interface ****************/
+static void multi_start(multi_params_t *params) {
+  params->curr_source = 0;
+  for (int i = 0; i < params->n_source; i++) {
+    params->sources[i].eof = false;
+    params->sources[i].head = NULL;
+  }
+
+  if (params->merge) {
+    for (int i = 0; i < params->n_source; i++) {
+      source_next(params, &params->sources[i]);
+    }
+    params->tree[0] = build_loser_tree(params, 1);
+  } else if (params->readahead) {
+    /* read ahead the first two traces, later traces are started when the
+     * previous one is being read */
+    for (int i = 0; i < MIN(2, params->n_source); i++) {
+      start_readahead(&params->sources[i]);
+    }
+  }
+}
+
+int multiReader_setup(reader_t *const reader) {
+  reader->trace_format = MULTI_TRACE_FORMAT;
+  reader->trace_type = MULTI_TRACE;
+
+  reader_init_param_t *init_params = &reader->init_params;
+  trace_type_e trace_type = init_params->multi_trace_type;
+  if (trace_type == MULTI_TRACE || trace_type >= UNKNOWN_TRACE) {
+    ERROR("multi-trace reader needs the type of the traces\n");
+    abort();
+  }
+
+  glob_t glob_result;
+  memset(&glob_result, 0, sizeof(glob_result));
+  char *paths = strdup(reader->trace_path);
+  char *rest = paths;
+  char *pattern;
+  int glob_flags = 0;
+  while ((pattern = strsep(&rest, ",")) != NULL) {
+    while (*pattern == ' ') pattern++;
+    if (*pattern == '\0') continue;
+    int ret = glob(pattern, glob_flags, NULL, &glob_result);
+    if (ret == GLOB_NOMATCH) {
+      ERROR("no trace matches %s\n", pattern);
+      abort();
+    } else if (ret != 0) {
+      ERROR("cannot expand %s\n", pattern);
+      abort();
+    }
+    glob_flags = GLOB_APPEND;
+  }
+  free(paths);
+  if (glob_result.gl_pathc == 0) {
+    ERROR("multi-trace reader has no trace: %s\n", reader->trace_path);
+    abort();
+  }
+
+  /* reader_params is freed by close_reader */
+  multi_params_t *params = calloc(1, sizeof(multi_params_t));
+  reader->reader_params = params;
+  params->n_source = (int)glob_result.gl_pathc;
+  params->merge = init_params->multi_trace_merge;
+  params->tag = init_params->multi_trace_tag;
+  params->readahead = init_params->multi_trace_readahead;
+  params->sources = calloc(params->n_source, sizeof(multi_source_t));
+  params->tree = calloc(params->n_source, sizeof(int));
+
+  /* each trace is read without sampling or cap, they apply to the merged
+   * requests */
+  reader_init_param_t source_init_params = *init_params;
+  source_init_params.sampler = NULL;
+  source_init_params.cap_at_n_req = -1;
+
+  bool n_total_req_known = true;
+  reader->n_total_req = 0;
+  reader->file_size = 0;
+  for (int i = 0; i < params->n_source; i++) {
+    multi_source_t *src = &params->sources[i];
+    src->reader = setup_reader(glob_result.gl_pathv[i], trace_type,
+                               &source_init_params);
+    src->req = new_request();
+    if (params->readahead) {
+      for (int j = 0; j < MULTI_READAHEAD_N_BATCH; j++) {
+        src->batches[j].reqs =
+            malloc(sizeof(request_t) * MULTI_READAHEAD_BATCH_SIZE);
+        for (int k = 0; k < MULTI_READAHEAD_BATCH_SIZE; k++) {
+          copy_request(&src->batches[j].reqs[k], src->req);
+        }
+      }
+    }
+
+    reader->file_size += src->reader->file_size;
+    reader->n_total_req += src->reader->n_total_req;
+    if (src->reader->n_total_req == 0) n_total_req_known = false;
+  }
+  if (!n_total_req_known) reader->n_total_req = 0;
+  reader->obj_id_is_num = params->sources[0].reader->obj_id_is_num;
+
+  INFO("multi-trace reader: %d %s traces, %s%s\n", params->n_source,
+       g_trace_type_name[trace_type],
+       params->merge ? "merged by time" : "concatenated",
+       params->readahead ? ", read ahead" : "");
+  globfree(&glob_result);
+
+  multi_start(params);
+
+  return 0;
+}
+
+int multi_read_one_req(reader_t *const reader, request_t *const req) {
+  multi_params_t *params = (multi_params_t *)reader->reader_params;
+
+  int src_idx;
+  multi_source_t *src;
+  if (params->merge) {
+    src_idx = params->tree[0];
+    src = &params->sources[src_idx];
+    if (src->eof) {
+      req->valid = false;
+      return 1;
+    }
+  } else {
+    while (true) {
+      if (params->curr_source >= params->n_source) {
+        req->valid = false;
+        return 1;
+      }
+      src = &params->sources[params->curr_source];
+      source_next(params, src);
+      if (!src->eof) break;
+
+      stop_readahead(src);
+      params->curr_source += 1;
+      if (params->readahead && params->curr_source + 1 < params->n_source) {
+        start_readahead(&params->sources[params->curr_source + 1]);
+      }
+    }
+    src_idx = params->curr_source;
+  }
+
+  copy_request(req, src->head);
+  if (params->tag == MULTI_TRACE_TAG_TENANT) {
+    req->tenant_id = src_idx;
+  } else if (params->tag == MULTI_TRACE_TAG_NS) {
+    req->ns = src_idx;
+  }
+
+  if (params->merge) {
+    source_next(params, src);
+    update_loser_tree(params);
+  }
+
+  return 0;
+}
+
+void multi_reset_reader(reader_t *const reader) {
+  multi_params_t *params = (multi_params_t *)reader->reader_params;
+
+  for (int i = 0; i < params->n_source; i++) {
+    multi_source_t *src = &params->sources[i];
+    stop_readahead(src);
+    reset_reader(src->reader);
+  }
+
+  multi_start(params);
+}
+
+int multi_skip_n_req(reader_t *const reader, const int n) {
+  request_t *req = new_request();
+  int i = 0;
+  for (; i < n; i++) {
+    if (multi_read_one_req(reader, req) != 0) break;
+  }
+  free_request(req);
+
+  return i;
+}
+
+void multi_close_reader(reader_t *const reader) {
+  multi_params_t *params = (multi_params_t *)reader->reader_params;
+
+  for (int i = 0; i < params->n_source; i++) {
+    multi_source_t *src = &params->sources[i];
+    stop_readahead(src);
+    close_reader(src->reader);
+    free_request(src->req);
+    if (params->readahead) {
+      for (int j = 0; j < MULTI_READAHEAD_N_BATCH; j++) {
+        free(src->batches[j].reqs);
+      }
+    }
+  }
+  free(params->sources);
+  free(params->tree);
+
+  if (reader->init_params.binary_fmt_str != NULL) {
+    free(reader->init_params.binary_fmt_str);
+    reader->init_params.binary_fmt_str = NULL;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -113,6 +113,69 @@ int binaryReader_setup(reader_t *const reader);
 
 int binary_read_one_req(reader_t *reader, request_t *req);
 
+/**************** index ****************/
+#define READER_INDEX_MAGIC 0x6c63736964780001ULL
+#define READER_INDEX_VERSION 1
+/* the number of requests between two index entries */
+#define READER_INDEX_INTERVAL 65536
+
+/* a position in the trace where reading can restart */
+typedef struct {
+  int64_t req_idx;
+  int64_t clock_time;
+  /* file offset for txt traces, mmap offset for binary traces,
+   * and decompressed offset for zstd traces */
+  uint64_t offset;
+  /* the zstd frame to restart decompression from */
+  uint64_t frame_in_offset;
+  uint64_t frame_out_offset;
+} reader_index_entry_t;
+
+/* the header of the sidecar index file, followed by the entries */
+typedef struct {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t interval;
+  /* the index is stale if the trace size or modification time changes */
+  uint64_t trace_size;
+  int64_t trace_mtime;
+  int64_t n_req;
+  int64_t n_entry;
+} reader_index_header_t;
+
+typedef struct reader_index {
+  int64_t n_req;
+  int64_t n_entry;
+  reader_index_entry_t *entries;
+} reader_index_t;
+
+/* load trace_path.idx if it matches the trace, return NULL otherwise */
+reader_index_t *load_reader_index(const char *trace_path);
+
+reader_index_t *clone_reader_index(const reader_index_t *index);
+
+void free_reader_index(reader_index_t *index);
+
+/**************** synthetic ****************/
+int syntheticReader_setup(reader_t *const reader);
+
+int synthetic_read_one_req(reader_t *const reader, request_t *const req);
+
+void synthetic_reset_reader(reader_t *const reader);
+
+int synthetic_skip_n_req(reader_t *const reader, const int n);
+
+/**************** multi ****************/
+int multiReader_setup(reader_t *const reader);
+
+int multi_read_one_req(reader_t *const reader, request_t *const req);
+
+void multi_reset_reader(reader_t *const reader);
+
+int multi_skip_n_req(reader_t *const reader, const int n);
+
+void multi_close_reader(reader_t *const reader);
+
 #ifdef __cplusplus
 }
 #endif
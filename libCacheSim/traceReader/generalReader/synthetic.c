@@ -0,0 +1,483 @@
+//
+// a reader that generates requests in memory instead of reading a trace,
+// the trace path is the workload spec, e.g.,
+// "n-req=10000000,n-obj=1000000,alpha=0.8,scan-ratio=0.1,seed=42"
+//
+// the popular objects follow a Zipf distribution sampled with
+// rejection-inversion (Hormann and Derflinger, 1996), which needs O(1) time
+// and no memory per object, the workload can mix in sequential scans of
+// new objects, loops over a fixed set of objects, popularity shifts over time
+// and multiple tenants, object sizes are derived from the object id so that
+// an object always has the same size
+//
+// the same spec always generates the same requests, so a cloned reader or a
+// reset reader replays the same stream
+//
+// synthetic.c
+// libCacheSim
+//
+
+#include <math.h>
+#include <string.h>
+#include <strings.h>
+
+#include "readerInternal.h"
+
+#define SYNTHETIC_MAX_N_TENANT 256
+/* object sizes of a distribution are looked up from its quantiles */
+#define SIZE_N_QUANTILE_POW 12
+#define SIZE_N_QUANTILE (1 << SIZE_N_QUANTILE_POW)
+
+typedef enum {
+  SIZE_DIST_FIXED,
+  SIZE_DIST_UNIFORM,
+  SIZE_DIST_LOGNORMAL,
+  SIZE_DIST_PARETO,
+} size_dist_e;
+
+typedef struct {
+  /* workload spec */
+  int64_t n_req;
+  int64_t n_obj;
+  double alpha;
+  uint64_t seed;
+  size_dist_e size_dist;
+  int64_t obj_size;
+  int64_t size_min;
+  int64_t size_max;
+  double size_sigma;
+  double size_shape;
+  double scan_ratio;
+  int64_t scan_len;
+  double loop_ratio;
+  int64_t loop_len;
+  int64_t shift_interval;
+  double shift_frac;
+  int n_tenant;
+  double tenant_alpha;
+  int64_t req_rate;
+
+  /* precomputed rejection-inversion constants */
+  double h_integral_x1;
+  double h_integral_n;
+  double zipf_s;
+  double one_minus_alpha_inv;
+  int64_t shift_step;
+  double size_quantiles[SIZE_N_QUANTILE + 1];
+  double tenant_cdf[SYNTHETIC_MAX_N_TENANT];
+  obj_id_t loop_id_start;
+  obj_id_t scan_id_start;
+
+  /* generator state, restored by reset */
+  uint64_t rng;
+  int64_t n_gen;
+  int64_t run_left;
+  bool run_is_scan;
+  int run_tenant;
+  int64_t loop_pos;
+  obj_id_t next_scan_id;
+  /* the clock time and the popularity shift are advanced with counters to
+   * avoid divisions on every request */
+  int64_t clock_time;
+  int64_t n_req_in_sec;
+  int64_t n_req_in_shift;
+  int64_t shift_offset;
+} synthetic_params_t;
+
+static inline uint64_t splitmix64(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/* a uniform double in (0, 1) */
+static inline double to_unit(uint64_t v) {
+  return ((double)(v >> 11) + 0.5) / (double)(1ULL << 53);
+}
+
+/* log1p(x) / x */
+static inline double helper1(double x) {
+  if (fabs(x) > 1e-8) return log1p(x) / x;
+  return 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+}
+
+/* expm1(x) / x */
+static inline double helper2(double x) {
+  if (fabs(x) > 1e-8) return expm1(x) / x;
+  return 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+}
+
+static inline double zipf_h(double alpha, double x) {
+  return exp(-alpha * log(x));
+}
+
+static inline double zipf_h_integral(double alpha, double x) {
+  double log_x = log(x);
+  return helper2((1 - alpha) * log_x) * log_x;
+}
+
+static inline double zipf_h_integral_inv(double alpha, double x) {
+  double t = x * (1 - alpha);
+  if (t < -1) t = -1;
+  return exp(helper1(t) * x);
+}
+
+/* zipf_h_integral_inv with a single pow when alpha is not close to 1,
+ * exp(log1p(t) / t * x) = (1 + t) ^ (1 / (1 - alpha)) */
+static inline double zipf_h_integral_inv_fast(const synthetic_params_t *params,
+                                              double x) {
+  if (params->one_minus_alpha_inv == 0) {
+    return zipf_h_integral_inv(params->alpha, x);
+  }
+  double t = x * (1 - params->alpha);
+  if (t < -1) t = -1;
+  return pow(1 + t, params->one_minus_alpha_inv);
+}
+
+/* the rank of the sampled object in [0, n_obj) */
+static inline int64_t sample_rank(synthetic_params_t *params) {
+  if (params->alpha <= 0) {
+    return (int64_t)(((__uint128_t)splitmix64(&params->rng) *
+                      (uint64_t)params->n_obj) >>
+                     64);
+  }
+
+  while (true) {
+    double u = params->h_integral_n +
+               to_unit(splitmix64(&params->rng)) *
+                   (params->h_integral_x1 - params->h_integral_n);
+    double x = zipf_h_integral_inv_fast(params, u);
+    int64_t k = (int64_t)(x + 0.5);
+    if (k < 1) {
+      k = 1;
+    } else if (k > params->n_obj) {
+      k = params->n_obj;
+    }
+    if (k - x <= params->zipf_s ||
+        u >= zipf_h_integral(params->alpha, k + 0.5) -
+                 zipf_h(params->alpha, (double)k)) {
+      return k - 1;
+    }
+  }
+}
+
+/* the size of an object only depends on the object id and the seed */
+static inline int64_t gen_obj_size(const synthetic_params_t *params,
+                                   obj_id_t obj_id) {
+  if (params->size_dist == SIZE_DIST_FIXED) return params->obj_size;
+
+  uint64_t state = obj_id ^ params->seed;
+  uint64_t v = splitmix64(&state);
+  /* the high bits select the quantile, the low bits interpolate */
+  uint64_t idx = v >> (64 - SIZE_N_QUANTILE_POW);
+  double frac = (double)(v & 0xffffffffULL) / 4294967296.0;
+  double lo = params->size_quantiles[idx];
+  double hi = params->size_quantiles[idx + 1];
+  return (int64_t)(lo + (hi - lo) * frac);
+}
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/* the quantiles of the size distribution, capped to [size_min, size_max] */
+static void init_size_quantiles(synthetic_params_t *params) {
+  double *q = params->size_quantiles;
+  if (params->size_dist == SIZE_DIST_UNIFORM) {
+    for (int i = 0; i <= SIZE_N_QUANTILE; i++) {
+      q[i] = params->size_min + (double)i / SIZE_N_QUANTILE *
+                                    (params->size_max - params->size_min);
+    }
+  } else if (params->size_dist == SIZE_DIST_PARETO) {
+    for (int i = 0; i <= SIZE_N_QUANTILE; i++) {
+      double p = (i + 0.5) / (SIZE_N_QUANTILE + 1);
+      q[i] = params->size_min / pow(1 - p, 1.0 / params->size_shape);
+    }
+  } else if (params->size_dist == SIZE_DIST_LOGNORMAL) {
+    /* the median is obj_size, the quantiles are taken from sorted samples */
+    int n_sample = SIZE_N_QUANTILE * 16;
+    double *samples = malloc(sizeof(double) * n_sample);
+    uint64_t state = params->seed;
+    for (int i = 0; i < n_sample; i++) {
+      double u1 = to_unit(splitmix64(&state));
+      double u2 = to_unit(splitmix64(&state));
+      double z = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+      samples[i] = exp(log((double)params->obj_size) + params->size_sigma * z);
+    }
+    qsort(samples, n_sample, sizeof(double), cmp_double);
+    for (int i = 0; i <= SIZE_N_QUANTILE; i++) {
+      int64_t pos = (int64_t)i * (n_sample - 1) / SIZE_N_QUANTILE;
+      q[i] = samples[pos];
+    }
+    free(samples);
+  }
+
+  for (int i = 0; i <= SIZE_N_QUANTILE; i++) {
+    if (q[i] < params->size_min) q[i] = params->size_min;
+    if (q[i] > params->size_max) q[i] = params->size_max;
+  }
+}
+
+static void synthetic_reset_state(synthetic_params_t *params) {
+  params->rng = params->seed;
+  params->n_gen = 0;
+  params->run_left = 0;
+  params->run_is_scan = false;
+  params->run_tenant = 0;
+  params->loop_pos = 0;
+  params->next_scan_id = params->scan_id_start;
+  params->clock_time = 0;
+  params->n_req_in_sec = 0;
+  params->n_req_in_shift = 0;
+  params->shift_offset = 0;
+}
+
+static void synthetic_parse_params(synthetic_params_t *params,
+                                   const char *spec) {
+  char *params_str = strdup(spec);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    char *key = strsep(&params_str, "=");
+    char *value = strsep(&params_str, ",");
+    while (params_str != NULL && (*params_str == ' ' || *params_str == ',')) {
+      params_str++;
+    }
+    if (value == NULL) {
+      ERROR("synthetic trace parameter %s has no value\n", key);
+    }
+    for (char *p = key; *p != '\0'; p++) {
+      if (*p == '_') *p = '-';
+    }
+
+    if (strcasecmp(key, "n-req") == 0) {
+      params->n_req = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "n-obj") == 0) {
+      params->n_obj = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "alpha") == 0) {
+      params->alpha = strtod(value, &end);
+    } else if (strcasecmp(key, "seed") == 0) {
+      params->seed = strtoull(value, &end, 0);
+    } else if (strcasecmp(key, "size-dist") == 0) {
+      end = "";
+      if (strcasecmp(value, "fixed") == 0) {
+        params->size_dist = SIZE_DIST_FIXED;
+      } else if (strcasecmp(value, "uniform") == 0) {
+        params->size_dist = SIZE_DIST_UNIFORM;
+      } else if (strcasecmp(value, "lognormal") == 0) {
+        params->size_dist = SIZE_DIST_LOGNORMAL;
+      } else if (strcasecmp(value, "pareto") == 0) {
+        params->size_dist = SIZE_DIST_PARETO;
+      } else {
+        ERROR("unknown size distribution %s\n", value);
+      }
+    } else if (strcasecmp(key, "obj-size") == 0) {
+      params->obj_size = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "size-min") == 0) {
+      params->size_min = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "size-max") == 0) {
+      params->size_max = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "size-sigma") == 0) {
+      params->size_sigma = strtod(value, &end);
+    } else if (strcasecmp(key, "size-shape") == 0) {
+      params->size_shape = strtod(value, &end);
+    } else if (strcasecmp(key, "scan-ratio") == 0) {
+      params->scan_ratio = strtod(value, &end);
+    } else if (strcasecmp(key, "scan-len") == 0) {
+      params->scan_len = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "loop-ratio") == 0) {
+      params->loop_ratio = strtod(value, &end);
+    } else if (strcasecmp(key, "loop-len") == 0) {
+      params->loop_len = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "shift-interval") == 0) {
+      params->shift_interval = strtoll(value, &end, 0);
+    } else if (strcasecmp(key, "shift-frac") == 0) {
+      params->shift_frac = strtod(value, &end);
+    } else if (strcasecmp(key, "n-tenant") == 0) {
+      params->n_tenant = (int)strtol(value, &end, 0);
+    } else if (strcasecmp(key, "tenant-alpha") == 0) {
+      params->tenant_alpha = strtod(value, &end);
+    } else if (strcasecmp(key, "req-rate") == 0) {
+      params->req_rate = strtoll(value, &end, 0);
+    } else {
+      ERROR("synthetic trace does not have parameter %s\n", key);
+    }
+
+    if (strlen(end) > 0) {
+      ERROR("param parsing error, find string \"%s\" after number\n", end);
+    }
+  }
+
+  free(old_params_str);
+}
+
+int syntheticReader_setup(reader_t *const reader) {
+  synthetic_params_t *params = malloc(sizeof(synthetic_params_t));
+  memset(params, 0, sizeof(synthetic_params_t));
+  params->n_req = 10000000;
+  params->n_obj = 1000000;
+  params->alpha = 1.0;
+  params->seed = 42;
+  params->size_dist = SIZE_DIST_FIXED;
+  params->obj_size = 4096;
+  params->size_min = 64;
+  params->size_max = 4 * MiB;
+  params->size_sigma = 1.5;
+  params->size_shape = 1.2;
+  params->scan_len = 1000;
+  params->loop_len = 10000;
+  params->shift_frac = 0.1;
+  params->n_tenant = 1;
+  params->req_rate = 1000;
+
+  synthetic_parse_params(params, reader->trace_path);
+
+  if (params->n_req <= 0 || params->n_obj <= 0) {
+    ERROR("synthetic trace n-req and n-obj must be positive\n");
+  }
+  if (params->n_tenant < 1 || params->n_tenant > SYNTHETIC_MAX_N_TENANT) {
+    ERROR("synthetic trace n-tenant must be in [1, %d]\n",
+          SYNTHETIC_MAX_N_TENANT);
+  }
+  if (params->scan_ratio < 0 || params->loop_ratio < 0 ||
+      params->scan_ratio + params->loop_ratio >= 1) {
+    ERROR("synthetic trace scan-ratio + loop-ratio must be in [0, 1)\n");
+  }
+  if (params->scan_len <= 0 || params->loop_len <= 0 ||
+      params->req_rate <= 0) {
+    ERROR("synthetic trace scan-len, loop-len and req-rate must be positive\n");
+  }
+
+  if (params->alpha > 0) {
+    params->h_integral_x1 = zipf_h_integral(params->alpha, 1.5) - 1;
+    params->h_integral_n =
+        zipf_h_integral(params->alpha, (double)params->n_obj + 0.5);
+    params->zipf_s =
+        2 - zipf_h_integral_inv(params->alpha,
+                                zipf_h_integral(params->alpha, 2.5) -
+                                    zipf_h(params->alpha, 2));
+    if (fabs(1 - params->alpha) > 1e-6) {
+      params->one_minus_alpha_inv = 1 / (1 - params->alpha);
+    }
+  }
+  params->shift_step = (int64_t)(params->shift_frac * params->n_obj);
+  if (params->shift_step < 0 || params->shift_step > params->n_obj) {
+    ERROR("synthetic trace shift-frac must be in [0, 1]\n");
+  }
+  init_size_quantiles(params);
+
+  double sum = 0;
+  for (int i = 0; i < params->n_tenant; i++) {
+    sum += 1.0 / pow(i + 1, params->tenant_alpha);
+    params->tenant_cdf[i] = sum;
+  }
+  for (int i = 0; i < params->n_tenant; i++) {
+    params->tenant_cdf[i] /= sum;
+  }
+
+  /* the popular objects of tenant t use ids [t * n_obj + 1, (t+1) * n_obj],
+   * followed by the loop objects and the scan objects */
+  params->loop_id_start = (obj_id_t)params->n_tenant * params->n_obj + 1;
+  params->scan_id_start = params->loop_id_start + params->loop_len;
+  synthetic_reset_state(params);
+
+  reader->trace_format = SYNTHETIC_TRACE_FORMAT;
+  reader->reader_params = params;
+  reader->n_total_req = params->n_req;
+  reader->obj_id_is_num = true;
+
+  return 0;
+}
+
+int synthetic_read_one_req(reader_t *const reader, request_t *const req) {
+  synthetic_params_t *params = reader->reader_params;
+  if (params->n_gen >= params->n_req) {
+    req->valid = false;
+    return 1;
+  }
+
+  params->n_gen += 1;
+  int tenant = 0;
+  obj_id_t obj_id;
+
+  if (params->run_left > 0) {
+    params->run_left -= 1;
+    tenant = params->run_tenant;
+    if (params->run_is_scan) {
+      obj_id = params->next_scan_id++;
+    } else {
+      obj_id = params->loop_id_start + params->loop_pos;
+      params->loop_pos = (params->loop_pos + 1) % params->loop_len;
+    }
+  } else {
+    if (params->n_tenant > 1) {
+      double u = to_unit(splitmix64(&params->rng));
+      while (tenant < params->n_tenant - 1 && params->tenant_cdf[tenant] < u) {
+        tenant++;
+      }
+    }
+
+    /* a run starts with probability ratio / len per request, so that about
+     * ratio of the requests are in scans or loops */
+    double u = 1;
+    if (params->scan_ratio > 0 || params->loop_ratio > 0) {
+      u = to_unit(splitmix64(&params->rng));
+    }
+    if (u < params->scan_ratio / params->scan_len) {
+      params->run_is_scan = true;
+      params->run_left = params->scan_len - 1;
+      params->run_tenant = tenant;
+      obj_id = params->next_scan_id++;
+    } else if (u < params->scan_ratio / params->scan_len +
+                       params->loop_ratio / params->loop_len) {
+      params->run_is_scan = false;
+      params->run_left = params->loop_len - 1;
+      params->run_tenant = tenant;
+      obj_id = params->loop_id_start + params->loop_pos;
+      params->loop_pos = (params->loop_pos + 1) % params->loop_len;
+    } else {
+      /* every shift interval, the popularity ranks move to other objects */
+      int64_t idx = sample_rank(params) + params->shift_offset;
+      if (idx >= params->n_obj) idx -= params->n_obj;
+      obj_id = (obj_id_t)tenant * params->n_obj + idx + 1;
+    }
+  }
+
+  req->obj_id = obj_id;
+  req->obj_size = gen_obj_size(params, obj_id);
+  req->clock_time = params->clock_time;
+  req->tenant_id = tenant;
+  req->op = OP_GET;
+  req->next_access_vtime = -2;
+
+  if (++params->n_req_in_sec == params->req_rate) {
+    params->n_req_in_sec = 0;
+    params->clock_time += 1;
+  }
+  if (params->shift_interval > 0 &&
+      ++params->n_req_in_shift == params->shift_interval) {
+    params->n_req_in_shift = 0;
+    params->shift_offset += params->shift_step;
+    if (params->shift_offset >= params->n_obj) {
+      params->shift_offset -= params->n_obj;
+    }
+  }
+
+  return 0;
+}
+
+void synthetic_reset_reader(reader_t *const reader) {
+  synthetic_reset_state(reader->reader_params);
+}
+
+/* generate and drop the next n requests, the generator cannot seek */
+int synthetic_skip_n_req(reader_t *const reader, const int n) {
+  request_t req;
+  for (int i = 0; i < n; i++) {
+    if (synthetic_read_one_req(reader, &req) != 0) return i;
+  }
+  return n;
+}
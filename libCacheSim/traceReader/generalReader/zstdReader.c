@@ -39,6 +39,12 @@ zstd_reader *create_zstd_reader(const char *trace_path) {
   reader->buff_out_read_pos = 0;
   reader->status = 0;
 
+  reader->buff_in_file_offset = 0;
+  reader->buff_out_offset = 0;
+  reader->frame_in_offsets[0] = 0;
+  reader->frame_out_offsets[0] = 0;
+  reader->n_frame = 1;
+
   reader->zds = ZSTD_createDStream();
 
   return reader;
@@ -53,6 +59,7 @@ void free_zstd_reader(zstd_reader *reader) {
 
 size_t _read_from_file(zstd_reader *reader) {
   size_t read_sz;
+  reader->buff_in_file_offset = (uint64_t)ftello(reader->ifile);
   read_sz = fread(reader->buff_in, 1, reader->buff_in_sz, reader->ifile);
   if (read_sz < reader->buff_in_sz) {
     if (feof(reader->ifile)) {
@@ -76,6 +83,7 @@ rstatus _decompress_from_buff(zstd_reader *reader) {
   void *buff_start = reader->buff_out + reader->buff_out_read_pos;
   size_t buff_left_sz = reader->output.pos - reader->buff_out_read_pos;
   memmove(reader->buff_out, buff_start, buff_left_sz);
+  reader->buff_out_offset += reader->buff_out_read_pos;
   reader->output.pos = buff_left_sz;
   reader->buff_out_read_pos = 0;
   size_t old_pos = buff_left_sz;
@@ -99,6 +107,13 @@ rstatus _decompress_from_buff(zstd_reader *reader) {
       printf("%zu\n", ret);
       WARN("zstd decompression error: %s\n", ZSTD_getErrorName(ret));
     }
+  } else {
+    /* a frame is fully decoded, the next frame starts here */
+    int idx = reader->n_frame % ZSTD_READER_N_FRAME;
+    reader->frame_in_offsets[idx] =
+        reader->buff_in_file_offset + reader->input.pos;
+    reader->frame_out_offsets[idx] = reader->buff_out_offset + reader->output.pos;
+    reader->n_frame += 1;
   }
   //  DEBUG("decompress %zu - %zu bytes\n", reader->output.pos, old_pos);
 
@@ -199,4 +214,57 @@ size_t zstd_reader_read_bytes(zstd_reader *reader, size_t n_byte,
 
     return sz;
   }
-}
\ No newline at end of file
+}
+
+void zstd_reader_tell(const zstd_reader *reader, uint64_t *out_offset,
+                      uint64_t *frame_in_offset, uint64_t *frame_out_offset) {
+  *out_offset = reader->buff_out_offset + reader->buff_out_read_pos;
+
+  /* the start of the file is always a frame start */
+  *frame_in_offset = 0;
+  *frame_out_offset = 0;
+  int n = reader->n_frame < ZSTD_READER_N_FRAME ? reader->n_frame
+                                                : ZSTD_READER_N_FRAME;
+  for (int i = 1; i <= n; i++) {
+    int idx = (reader->n_frame - i) % ZSTD_READER_N_FRAME;
+    if (reader->frame_out_offsets[idx] <= *out_offset) {
+      *frame_in_offset = reader->frame_in_offsets[idx];
+      *frame_out_offset = reader->frame_out_offsets[idx];
+      break;
+    }
+  }
+}
+
+bool zstd_reader_seek(zstd_reader *reader, uint64_t frame_in_offset,
+                      uint64_t frame_out_offset, uint64_t out_offset) {
+  ZSTD_DCtx_reset(reader->zds, ZSTD_reset_session_only);
+  if (fseeko(reader->ifile, (off_t)frame_in_offset, SEEK_SET) != 0) {
+    WARN("cannot seek zstd trace to %lu\n", (unsigned long)frame_in_offset);
+    return false;
+  }
+
+  reader->input.size = 0;
+  reader->input.pos = 0;
+  reader->output.pos = 0;
+  reader->buff_out_read_pos = 0;
+  reader->status = OK;
+  reader->buff_in_file_offset = frame_in_offset;
+  reader->buff_out_offset = frame_out_offset;
+  reader->frame_in_offsets[0] = frame_in_offset;
+  reader->frame_out_offsets[0] = frame_out_offset;
+  reader->n_frame = 1;
+
+  /* decompress and drop the bytes before out_offset */
+  uint64_t n_skip = out_offset - frame_out_offset;
+  while (n_skip > 0) {
+    size_t n_byte = reader->buff_out_sz / 4;
+    if (n_byte > n_skip) n_byte = n_skip;
+    char *data_start;
+    if (zstd_reader_read_bytes(reader, n_byte, &data_start) != n_byte) {
+      return false;
+    }
+    n_skip -= n_byte;
+  }
+
+  return true;
+}
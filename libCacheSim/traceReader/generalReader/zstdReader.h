@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <zstd.h>
 
@@ -9,6 +11,9 @@
 extern "C" {
 #endif
 
+/* the number of recent frame starts remembered for seeking */
+#define ZSTD_READER_N_FRAME 16
+
 typedef struct zstd_reader {
   FILE *ifile;
   ZSTD_DStream *zds;
@@ -24,6 +29,15 @@ typedef struct zstd_reader {
   ZSTD_outBuffer output;
 
   rstatus status;
+
+  /* the file offset of buff_in and the decompressed offset of buff_out */
+  uint64_t buff_in_file_offset;
+  uint64_t buff_out_offset;
+  /* a ring of recent frame starts (compressed offset, decompressed offset),
+   * a frame start is a point where decompression can restart */
+  uint64_t frame_in_offsets[ZSTD_READER_N_FRAME];
+  uint64_t frame_out_offsets[ZSTD_READER_N_FRAME];
+  int n_frame;
 } zstd_reader;
 
 zstd_reader *create_zstd_reader(const char *trace_path);
@@ -38,6 +52,17 @@ size_t zstd_reader_read_line(zstd_reader *reader, char **line_start,
 size_t zstd_reader_read_bytes(zstd_reader *reader, size_t n_byte,
                               char **data_start);
 
+/* the decompressed offset of the next unread byte, and the start of the
+ * latest frame before it, seeking to the frame and skipping
+ * (out_offset - frame_out_offset) bytes returns to the current position */
+void zstd_reader_tell(const zstd_reader *reader, uint64_t *out_offset,
+                      uint64_t *frame_in_offset, uint64_t *frame_out_offset);
+
+/* restart decompression at a frame start and skip to out_offset,
+ * seeking to (0, 0, 0) rewinds the reader, return false on failure */
+bool zstd_reader_seek(zstd_reader *reader, uint64_t frame_in_offset,
+                      uint64_t frame_out_offset, uint64_t out_offset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -54,8 +54,9 @@ reader_t *setup_reader(const char *const trace_path,
   reader->zstd_reader_p = NULL;
 #ifdef SUPPORT_ZSTD_TRACE
   size_t slen = strlen(trace_path);
-  if (strncmp(trace_path + (slen - 4), ".zst", 4) == 0 ||
-      strncmp(trace_path + (slen - 7), ".zst.22", 7) == 0) {
+  if (trace_type != SYNTHETIC_TRACE && trace_type != MULTI_TRACE &&
+      ((slen >= 4 && strncmp(trace_path + (slen - 4), ".zst", 4) == 0) ||
+       (slen >= 7 && strncmp(trace_path + (slen - 7), ".zst.22", 7) == 0))) {
     reader->is_zstd_file = true;
     reader->zstd_reader_p = create_zstd_reader(trace_path);
     if (!_info_printed) {
@@ -72,6 +73,9 @@ reader_t *setup_reader(const char *const trace_path,
   reader->ignore_obj_size = false;
   reader->cloned = false;
   reader->item_size = 0;
+  reader->raw_obj_id_offset = -1;
+  reader->raw_obj_id_width = 0;
+  reader->raw_obj_size_offset = -1;
   reader->obj_id_is_num = false;
   reader->mapped_file = NULL;
   reader->mmap_offset = 0;
@@ -80,6 +84,7 @@ reader_t *setup_reader(const char *const trace_path,
   reader->read_direction = READ_FORWARD;
   reader->n_req_left = 0;
   reader->last_req_clock_time = -1;
+  reader->index = NULL;
 
   if (init_params != NULL) {
     memcpy(&reader->init_params, init_params, sizeof(reader_init_param_t));
@@ -101,6 +106,22 @@ reader_t *setup_reader(const char *const trace_path,
   assert(trace_path != NULL);
   reader->trace_path = strdup(trace_path);
 
+  if (trace_type == SYNTHETIC_TRACE) {
+    /* there is no file, the trace path is the workload spec */
+    reader->file_size = 0;
+    reader->file = NULL;
+    syntheticReader_setup(reader);
+    return reader;
+  }
+
+  if (trace_type == MULTI_TRACE) {
+    /* each trace in the path list has its own reader */
+    reader->file_size = 0;
+    reader->file = NULL;
+    multiReader_setup(reader);
+    return reader;
+  }
+
   if ((fd = open(trace_path, O_RDONLY)) < 0) {
     ERROR("Unable to open '%s', %s\n", trace_path, strerror(errno));
     exit(1);
@@ -260,10 +281,69 @@ reader_t *setup_reader(const char *const trace_path,
     reader->n_total_req = 0;
   }
 
+  if (reader->init_params.use_index) {
+    reader->index = load_reader_index(trace_path);
+  }
+
   close(fd);
   return reader;
 }
 
+#define SAMPLE_BATCH_SIZE 64
+
+/**
+ * @brief move mmap_offset over the records that the sampler does not sample
+ * without decoding them, the object ids are gathered from a block of raw
+ * records and passed to sample_batch, the record that stops the batch is
+ * decoded and sampled as usual
+ *
+ * the skipped requests are counted in n_read_req, and size zero requests are
+ * skipped without being counted, which is the same as reading one at a time
+ */
+static void skip_unsampled_req(reader_t *const reader) {
+  sampler_t *sampler = reader->sampler;
+  obj_id_t obj_ids[SAMPLE_BATCH_SIZE];
+  int record_idx[SAMPLE_BATCH_SIZE];
+  bool skip_size_zero =
+      reader->ignore_size_zero_req && reader->raw_obj_size_offset >= 0;
+
+  while (reader->mmap_offset + reader->item_size <= reader->file_size) {
+    int64_t n_record =
+        (int64_t)((reader->file_size - reader->mmap_offset) / reader->item_size);
+    if (n_record > SAMPLE_BATCH_SIZE) n_record = SAMPLE_BATCH_SIZE;
+    if (reader->cap_at_n_req > 1) {
+      int64_t n_left = reader->cap_at_n_req - reader->n_read_req;
+      if (n_left <= 0) return;
+      if (n_record > n_left) n_record = n_left;
+    }
+
+    const char *record = reader->mapped_file + reader->mmap_offset;
+    int n = 0;
+    for (int i = 0; i < n_record; i++, record += reader->item_size) {
+      if (skip_size_zero &&
+          *(const uint32_t *)(record + reader->raw_obj_size_offset) == 0) {
+        continue;
+      }
+      if (reader->raw_obj_id_width == 8) {
+        obj_ids[n] = *(const uint64_t *)(record + reader->raw_obj_id_offset);
+      } else {
+        obj_ids[n] = (obj_id_t)(int64_t)(
+            *(const int32_t *)(record + reader->raw_obj_id_offset));
+      }
+      record_idx[n++] = i;
+    }
+
+    int n_skip = sampler->sample_batch(sampler, obj_ids, n);
+    if (n_skip < n) {
+      reader->mmap_offset += (size_t)record_idx[n_skip] * reader->item_size;
+      reader->n_read_req += n_skip;
+      return;
+    }
+    reader->mmap_offset += (size_t)n_record * reader->item_size;
+    reader->n_read_req += n;
+  }
+}
+
 /**
  * @brief read one request from trace file
  *
@@ -272,7 +352,15 @@ reader_t *setup_reader(const char *const trace_path,
  * @return 0 if success, 1 if end of file
  */
 int read_one_req(reader_t *const reader, request_t *const req) {
-  if (reader->mmap_offset >= reader->file_size) {
+  if (reader->sampler != NULL && reader->sampler->sample_batch != NULL &&
+      reader->raw_obj_id_offset >= 0 && !reader->is_zstd_file &&
+      reader->read_direction == READ_FORWARD && reader->n_req_left == 0) {
+    skip_unsampled_req(reader);
+  }
+
+  if (reader->trace_format != SYNTHETIC_TRACE_FORMAT &&
+      reader->trace_format != MULTI_TRACE_FORMAT &&
+      reader->mmap_offset >= reader->file_size) {
     DEBUG("read_one_req: end of file, current mmap_offset %zu, file size %zu\n",
           reader->mmap_offset, reader->file_size);
     req->valid = false;
@@ -377,6 +465,12 @@ int read_one_req(reader_t *const reader, request_t *const req) {
       case VALPIN_TRACE:
         status = valpin_read_one_req(reader, req);
         break;
+      case SYNTHETIC_TRACE:
+        status = synthetic_read_one_req(reader, req);
+        break;
+      case MULTI_TRACE:
+        status = multi_read_one_req(reader, req);
+        break;
       default:
         ERROR(
             "cannot recognize reader obj_id_type, given reader obj_id_type: "
@@ -478,6 +572,12 @@ int go_back_one_req(reader_t *const reader) {
       } else {
         return 1;
       }
+    case SYNTHETIC_TRACE_FORMAT:
+      ERROR("synthetic trace does not support reading backward\n");
+      exit(1);
+    case MULTI_TRACE_FORMAT:
+      ERROR("multi-trace reader does not support reading backward\n");
+      exit(1);
     default:
       ERROR("cannot recognize reader trace format: %d\n", reader->trace_format);
       exit(1);
@@ -547,6 +647,10 @@ int skip_n_req(reader_t *reader, const int N) {
       reader->mmap_offset = reader->file_size;
       WARN("try to skip %d requests, but only %d requests left\n", N, count);
     }
+  } else if (reader->trace_format == SYNTHETIC_TRACE_FORMAT) {
+    count = synthetic_skip_n_req(reader, N);
+  } else if (reader->trace_format == MULTI_TRACE_FORMAT) {
+    count = multi_skip_n_req(reader, N);
   } else {
     ERROR("unknown trace format %d\n", reader->trace_format);
     abort();
@@ -560,12 +664,17 @@ int skip_n_req(reader_t *reader, const int N) {
 void reset_reader(reader_t *const reader) {
   /* rewind the reader back to beginning */
   long curr_offset = 0;
+  reader->n_read_req = 0;
   if (reader->trace_type == PLAIN_TXT_TRACE) {
     fseek(reader->file, 0, SEEK_SET);
     curr_offset = ftell(reader->file);
   } else if (reader->trace_type == CSV_TRACE) {
     csv_reset_reader(reader);
     curr_offset = ftell(reader->file);
+  } else if (reader->trace_type == SYNTHETIC_TRACE) {
+    synthetic_reset_reader(reader);
+  } else if (reader->trace_type == MULTI_TRACE) {
+    multi_reset_reader(reader);
   } else {
     reader->mmap_offset = reader->trace_start_offset;
     curr_offset = reader->mmap_offset;
@@ -573,7 +682,8 @@ void reset_reader(reader_t *const reader) {
 
 #ifdef SUPPORT_ZSTD_TRACE
   if (reader->is_zstd_file) {
-    fseek(reader->zstd_reader_p->ifile, 0, SEEK_SET);
+    /* the header of the trace is also compressed, skip it */
+    zstd_reader_seek(reader->zstd_reader_p, 0, 0, reader->trace_start_offset);
   }
 #endif
 
@@ -585,13 +695,31 @@ uint64_t get_num_of_req(reader_t *const reader) {
 
   uint64_t n_req = 0;
 
-  if (reader->trace_format == TXT_TRACE_FORMAT || reader->is_zstd_file) {
+  /* the index counts the requests before sampling */
+  if (reader->sampler == NULL && reader->init_params.use_index) {
+    if (reader->index == NULL) {
+      reader_build_index(reader);
+    }
+    if (reader->index != NULL) {
+      n_req = reader->index->n_req;
+      if (reader->cap_at_n_req > 1 && n_req > (uint64_t)reader->cap_at_n_req) {
+        n_req = reader->cap_at_n_req;
+      }
+      reader->n_total_req = n_req;
+      return n_req;
+    }
+  }
+
+  if (reader->trace_format == TXT_TRACE_FORMAT ||
+      reader->trace_format == MULTI_TRACE_FORMAT || reader->is_zstd_file) {
     reader_t *reader_copy = clone_reader(reader);
     reader_copy->mmap_offset = 0;
     request_t *req = new_request();
     while (read_one_req(reader_copy, req) == 0) {
       n_req++;
     }
+    free_request(req);
+    close_reader(reader_copy);
   } else {
     ERROR("should not reach here\n");
     abort();
@@ -605,10 +733,13 @@ reader_t *clone_reader(const reader_t *const reader_in) {
                                   &reader_in->init_params);
   reader->n_total_req = reader_in->n_total_req;
 
-  if (reader->trace_format != TXT_TRACE_FORMAT) {
+  if (reader->trace_format == BINARY_TRACE_FORMAT) {
     munmap(reader->mapped_file, reader->file_size);
     reader->mapped_file = reader_in->mapped_file;
   }
+  if (reader->index == NULL && reader_in->index != NULL) {
+    reader->index = clone_reader_index(reader_in->index);
+  }
   reader->cloned = true;
   return reader;
 }
@@ -638,6 +769,8 @@ int close_reader(reader_t *const reader) {
     if (reader->init_params.binary_fmt_str != NULL) {
       free(reader->init_params.binary_fmt_str);
     }
+  } else if (reader->trace_type == MULTI_TRACE) {
+    multi_close_reader(reader);
   }
 
 #ifdef SUPPORT_ZSTD_TRACE
@@ -663,6 +796,7 @@ int close_reader(reader_t *const reader) {
     free(reader->sampler);
   }
 
+  free_reader_index(reader->index);
   free(reader->trace_path);
   free(reader);
 
@@ -679,6 +813,28 @@ void reader_set_read_pos(reader_t *const reader, double pos) {
    */
   if (pos > 1) pos = 1;
 
+  if (reader->trace_format == SYNTHETIC_TRACE_FORMAT) {
+    /* the generator cannot seek, so regenerate up to the position */
+    synthetic_reset_reader(reader);
+    synthetic_skip_n_req(reader, (int)((double)reader->n_total_req * pos));
+    return;
+  }
+
+  if (reader->trace_format == MULTI_TRACE_FORMAT) {
+    multi_reset_reader(reader);
+    multi_skip_n_req(reader, (int)((double)get_num_of_req(reader) * pos));
+    return;
+  }
+
+  if (reader->index != NULL || reader->is_zstd_file) {
+    /* seek by request number, the file offset of a compressed trace
+     * does not map to a position in the decompressed data */
+    int64_t n_req = reader->index != NULL ? reader->index->n_req
+                                          : (int64_t)get_num_of_req(reader);
+    reader_seek_to_req(reader, (int64_t)((double)n_req * pos));
+    return;
+  }
+
   size_t offset = (double)reader->file_size * pos;
   if (reader->trace_format == TXT_TRACE_FORMAT) {
     fseek(reader->file, offset, SEEK_SET);
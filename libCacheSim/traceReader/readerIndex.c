@@ -0,0 +1,405 @@
+//
+// a sparse index of a trace, every READER_INDEX_INTERVAL requests it records
+// the request number, the timestamp and the position to restart reading,
+// the index is built in one pass and saved next to the trace (trace.idx),
+// so that later runs get the number of requests in O(1) and can seek to a
+// request or a timestamp without parsing the trace from the beginning
+//
+// txt and csv traces restart at a file offset, zstd traces restart at the
+// latest frame start and decompress up to the decompressed offset,
+// a trace compressed as a single frame still needs to be decompressed from
+// the beginning, but it is not parsed
+//
+// readerIndex.c
+// libCacheSim
+//
+
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "generalReader/readerInternal.h"
+
+#ifdef SUPPORT_ZSTD_TRACE
+#include "generalReader/zstdReader.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static char *get_index_path(const char *trace_path) {
+  size_t len = strlen(trace_path) + 5;
+  char *path = malloc(len);
+  snprintf(path, len, "%s.idx", trace_path);
+  return path;
+}
+
+static bool get_trace_stat(const char *trace_path, uint64_t *size,
+                           int64_t *mtime) {
+  struct stat st;
+  if (stat(trace_path, &st) != 0) return false;
+  *size = (uint64_t)st.st_size;
+  *mtime = (int64_t)st.st_mtime;
+  return true;
+}
+
+reader_index_t *load_reader_index(const char *trace_path) {
+  char *path = get_index_path(trace_path);
+  FILE *ifile = fopen(path, "rb");
+  free(path);
+  if (ifile == NULL) return NULL;
+
+  reader_index_header_t header;
+  uint64_t trace_size;
+  int64_t trace_mtime;
+  if (fread(&header, sizeof(header), 1, ifile) != 1 ||
+      header.magic != READER_INDEX_MAGIC ||
+      header.version != READER_INDEX_VERSION || header.n_entry < 0) {
+    WARN("ignore invalid index of %s\n", trace_path);
+    fclose(ifile);
+    return NULL;
+  }
+  if (!get_trace_stat(trace_path, &trace_size, &trace_mtime) ||
+      trace_size != header.trace_size || trace_mtime != header.trace_mtime) {
+    WARN("ignore stale index of %s\n", trace_path);
+    fclose(ifile);
+    return NULL;
+  }
+
+  reader_index_t *index = malloc(sizeof(reader_index_t));
+  index->n_req = header.n_req;
+  index->n_entry = header.n_entry;
+  index->entries = malloc(sizeof(reader_index_entry_t) * (header.n_entry + 1));
+  if (fread(index->entries, sizeof(reader_index_entry_t), header.n_entry,
+            ifile) != (size_t)header.n_entry) {
+    WARN("ignore truncated index of %s\n", trace_path);
+    free_reader_index(index);
+    index = NULL;
+  }
+  fclose(ifile);
+
+  return index;
+}
+
+/* write to a temporary file and rename it, so that concurrent readers never
+ * see a partial index */
+static void save_reader_index(const char *trace_path,
+                              const reader_index_t *index) {
+  reader_index_header_t header;
+  memset(&header, 0, sizeof(header));
+  header.magic = READER_INDEX_MAGIC;
+  header.version = READER_INDEX_VERSION;
+  header.interval = READER_INDEX_INTERVAL;
+  header.n_req = index->n_req;
+  header.n_entry = index->n_entry;
+  if (!get_trace_stat(trace_path, &header.trace_size, &header.trace_mtime)) {
+    return;
+  }
+
+  char *path = get_index_path(trace_path);
+  size_t len = strlen(path) + 32;
+  char *tmp_path = malloc(len);
+  snprintf(tmp_path, len, "%s.%ld.tmp", path, (long)getpid());
+
+  FILE *ofile = fopen(tmp_path, "wb");
+  bool ok = ofile != NULL;
+  if (ok) {
+    ok = fwrite(&header, sizeof(header), 1, ofile) == 1 &&
+         fwrite(index->entries, sizeof(reader_index_entry_t), index->n_entry,
+                ofile) == (size_t)index->n_entry;
+    ok = fclose(ofile) == 0 && ok;
+  }
+  if (ok) {
+    ok = rename(tmp_path, path) == 0;
+  }
+  if (!ok) {
+    WARN("cannot save trace index to %s, %s\n", path, strerror(errno));
+    unlink(tmp_path);
+  }
+
+  free(tmp_path);
+  free(path);
+}
+
+reader_index_t *clone_reader_index(const reader_index_t *index) {
+  reader_index_t *new_index = malloc(sizeof(reader_index_t));
+  new_index->n_req = index->n_req;
+  new_index->n_entry = index->n_entry;
+  new_index->entries =
+      malloc(sizeof(reader_index_entry_t) * (index->n_entry + 1));
+  memcpy(new_index->entries, index->entries,
+         sizeof(reader_index_entry_t) * index->n_entry);
+  return new_index;
+}
+
+void free_reader_index(reader_index_t *index) {
+  if (index == NULL) return;
+  free(index->entries);
+  free(index);
+}
+
+/* the position where the next read starts */
+static void reader_tell(reader_t *reader, reader_index_entry_t *pos) {
+  pos->frame_in_offset = 0;
+  pos->frame_out_offset = 0;
+#ifdef SUPPORT_ZSTD_TRACE
+  if (reader->is_zstd_file) {
+    zstd_reader_tell(reader->zstd_reader_p, &pos->offset, &pos->frame_in_offset,
+                     &pos->frame_out_offset);
+    return;
+  }
+#endif
+  if (reader->trace_format == TXT_TRACE_FORMAT) {
+    pos->offset = (uint64_t)ftello(reader->file);
+  } else {
+    pos->offset = reader->mmap_offset;
+  }
+}
+
+static bool reader_seek_to_pos(reader_t *reader,
+                               const reader_index_entry_t *pos) {
+  reader->n_req_left = 0;
+  reader->n_read_req = pos->req_idx;
+#ifdef SUPPORT_ZSTD_TRACE
+  if (reader->is_zstd_file) {
+    return zstd_reader_seek(reader->zstd_reader_p, pos->frame_in_offset,
+                            pos->frame_out_offset, pos->offset);
+  }
+#endif
+  if (reader->trace_format == TXT_TRACE_FORMAT) {
+    return fseeko(reader->file, (off_t)pos->offset, SEEK_SET) == 0;
+  }
+  reader->mmap_offset = pos->offset;
+  return true;
+}
+
+bool reader_build_index(reader_t *reader) {
+  if (reader->trace_format == SYNTHETIC_TRACE_FORMAT ||
+      reader->trace_format == MULTI_TRACE_FORMAT)
+    return false;
+
+  /* scan the trace with a fresh reader so that the position of the given
+   * reader does not change, sampling is not applied to the index */
+  reader_init_param_t init_params = reader->init_params;
+  init_params.sampler = NULL;
+  init_params.cap_at_n_req = -1;
+  init_params.use_index = false;
+  if (reader->trace_type == LCS_TRACE) {
+    /* the LCS reader sets the offset after reading the header */
+    init_params.trace_start_offset = 0;
+  }
+  reader_t *scan_reader =
+      setup_reader(reader->trace_path, reader->trace_type, &init_params);
+
+  reader_index_t *index = malloc(sizeof(reader_index_t));
+  int64_t entry_cap = 1024;
+  index->entries = malloc(sizeof(reader_index_entry_t) * entry_cap);
+  index->n_entry = 0;
+
+  request_t *req = new_request();
+  reader_index_entry_t pos;
+  int64_t n_req = 0;
+  while (true) {
+    /* an entry can only be recorded between two lines of the trace, not
+     * between the requests expanded from one line with a count field */
+    bool record = scan_reader->n_req_left == 0 &&
+                  n_req >= index->n_entry * READER_INDEX_INTERVAL;
+    if (record) reader_tell(scan_reader, &pos);
+
+    if (read_one_req(scan_reader, req) != 0) break;
+
+    if (record) {
+      if (index->n_entry == entry_cap) {
+        entry_cap *= 2;
+        index->entries = realloc(index->entries,
+                                 sizeof(reader_index_entry_t) * entry_cap);
+      }
+      pos.req_idx = n_req;
+      pos.clock_time = req->clock_time;
+      index->entries[index->n_entry++] = pos;
+    }
+    n_req += 1;
+  }
+  index->n_req = n_req;
+
+  free_request(req);
+  close_reader(scan_reader);
+
+  INFO("built index of %s, %ld requests, %ld entries\n", reader->trace_path,
+       (long)index->n_req, (long)index->n_entry);
+  save_reader_index(reader->trace_path, index);
+
+  free_reader_index(reader->index);
+  reader->index = index;
+
+  return true;
+}
+
+/* read and drop n requests without sampling, return the number dropped */
+static int64_t skip_raw_req(reader_t *reader, int64_t n) {
+  sampler_t *sampler = reader->sampler;
+  reader->sampler = NULL;
+  request_t *req = new_request();
+  int64_t i = 0;
+  for (; i < n; i++) {
+    if (read_one_req(reader, req) != 0) break;
+  }
+  free_request(req);
+  reader->sampler = sampler;
+  return i;
+}
+
+/* the last index entry at or before req_idx */
+static const reader_index_entry_t *find_entry_by_req(
+    const reader_index_t *index, int64_t req_idx) {
+  if (index->n_entry == 0) return NULL;
+  int64_t lo = 0, hi = index->n_entry - 1;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo + 1) / 2;
+    if (index->entries[mid].req_idx <= req_idx) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return &index->entries[lo];
+}
+
+/* the last index entry before any request at or after clock_time */
+static const reader_index_entry_t *find_entry_by_time(
+    const reader_index_t *index, int64_t clock_time) {
+  if (index->n_entry == 0) return NULL;
+  int64_t lo = 0, hi = index->n_entry - 1;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo + 1) / 2;
+    if (index->entries[mid].clock_time < clock_time) {
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return &index->entries[lo];
+}
+
+int reader_seek_to_req(reader_t *reader, int64_t req_idx) {
+  if (req_idx < 0) return 1;
+
+  if (reader->trace_format == SYNTHETIC_TRACE_FORMAT) {
+    synthetic_reset_reader(reader);
+    return skip_raw_req(reader, req_idx) == req_idx ? 0 : 1;
+  }
+
+  if (reader->trace_format == BINARY_TRACE_FORMAT && !reader->is_zstd_file) {
+    uint64_t offset = reader->trace_start_offset + req_idx * reader->item_size;
+    if (offset >= reader->file_size) return 1;
+    reader->mmap_offset = offset;
+    reader->n_req_left = 0;
+    reader->n_read_req = req_idx;
+    return 0;
+  }
+
+  int64_t curr_req_idx = 0;
+  const reader_index_entry_t *entry =
+      reader->index != NULL ? find_entry_by_req(reader->index, req_idx) : NULL;
+  if (entry != NULL) {
+    if (!reader_seek_to_pos(reader, entry)) return 1;
+    curr_req_idx = entry->req_idx;
+  } else {
+    reset_reader(reader);
+    reader->n_req_left = 0;
+    reader->n_read_req = 0;
+  }
+
+  int64_t n_skip = req_idx - curr_req_idx;
+  return skip_raw_req(reader, n_skip) == n_skip ? 0 : 1;
+}
+
+int reader_seek_to_time(reader_t *reader, int64_t clock_time) {
+  if (reader->trace_format == SYNTHETIC_TRACE_FORMAT ||
+      reader->trace_format == MULTI_TRACE_FORMAT) {
+    /* these readers cannot go back to a position, so count the requests
+     * before clock_time and seek by request number */
+    reset_reader(reader);
+    sampler_t *sampler = reader->sampler;
+    reader->sampler = NULL;
+    request_t *req = new_request();
+    int64_t req_idx = 0;
+    bool found = false;
+    while (read_one_req(reader, req) == 0) {
+      if (req->clock_time >= clock_time) {
+        found = true;
+        break;
+      }
+      req_idx += 1;
+    }
+    free_request(req);
+    reader->sampler = sampler;
+    return found ? reader_seek_to_req(reader, req_idx) : 1;
+  }
+
+  int64_t curr_req_idx = 0;
+  const reader_index_entry_t *entry =
+      reader->index != NULL ? find_entry_by_time(reader->index, clock_time)
+                            : NULL;
+
+  if (entry != NULL) {
+    if (reader_seek_to_pos(reader, entry) == false) return 1;
+    curr_req_idx = entry->req_idx;
+  } else if (reader->trace_format == BINARY_TRACE_FORMAT &&
+             !reader->is_zstd_file && reader->n_total_req > 0) {
+    /* binary search the requests */
+    sampler_t *sampler = reader->sampler;
+    reader->sampler = NULL;
+    request_t *req = new_request();
+    int64_t lo = 0, hi = (int64_t)reader->n_total_req;
+    while (lo < hi) {
+      int64_t mid = lo + (hi - lo) / 2;
+      reader_seek_to_req(reader, mid);
+      if (read_one_req(reader, req) == 0 && req->clock_time < clock_time) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    free_request(req);
+    reader->sampler = sampler;
+    return reader_seek_to_req(reader, lo);
+  } else {
+    reset_reader(reader);
+    reader->n_req_left = 0;
+    reader->n_read_req = 0;
+  }
+
+  /* scan forward to the first request at or after clock_time */
+  sampler_t *sampler = reader->sampler;
+  reader->sampler = NULL;
+  request_t *req = new_request();
+  reader_index_entry_t pos;
+  int status = 1;
+  while (true) {
+    reader_tell(reader, &pos);
+    pos.req_idx = curr_req_idx;
+    bool at_line_start = reader->n_req_left == 0;
+    if (read_one_req(reader, req) != 0) break;
+    if (req->clock_time >= clock_time) {
+      if (at_line_start) {
+        status = reader_seek_to_pos(reader, &pos) ? 0 : 1;
+      } else {
+        /* the rest of the line are at the same time */
+        reader->n_req_left += 1;
+        status = 0;
+      }
+      break;
+    }
+    curr_req_idx += 1;
+  }
+  free_request(req);
+  reader->sampler = sampler;
+
+  return status;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,7 +2,10 @@
  * a spatial sampler that samples sampling_ratio of objects from the trace
  **/
 
+#include <math.h>
+
 #include "../../include/libCacheSim/logging.h"
+#include "../../include/libCacheSim/macro.h"
 #include "../../include/libCacheSim/sampling.h"
 #include "../../dataStructure/hash/hash.h"
 
@@ -10,6 +13,16 @@
 extern "C" {
 #endif
 
+/* when 1 / sampling_ratio is an integer, an object is sampled if its hash
+ * is a multiple of it, which keeps the same objects as shardedSim */
+static inline bool spatial_sample_hash(const sampler_t *sampler,
+                                       uint64_t hash_value) {
+  if (sampler->sampling_ratio_inv > 0) {
+    return hash_value % sampler->sampling_ratio_inv == 0;
+  }
+  return hash_value % SAMPLING_RATIO_SCALE < sampler->sampling_boundary;
+}
+
 bool spatial_sample(sampler_t *sampler, request_t *req) {
   uint64_t hash_value = req->hv;
   if (hash_value == 0) {
@@ -17,7 +30,26 @@ bool spatial_sample(sampler_t *sampler, request_t *req) {
     req->hv = hash_value;
   }
 
-  return hash_value % sampler->sampling_ratio_inv == 0;
+  return spatial_sample_hash(sampler, hash_value);
+}
+
+#define SPATIAL_SAMPLE_BLOCK 16
+
+/* the objects are hashed a block at a time before they are checked so that
+ * the hash loop has no branch on the result */
+int spatial_sample_batch(sampler_t *sampler, const obj_id_t *obj_ids, int n) {
+  uint64_t hash_values[SPATIAL_SAMPLE_BLOCK];
+  for (int start = 0; start < n; start += SPATIAL_SAMPLE_BLOCK) {
+    int end = MIN(start + SPATIAL_SAMPLE_BLOCK, n);
+    for (int i = start; i < end; i++) {
+      hash_values[i - start] = get_hash_value_int_64(&obj_ids[i]);
+    }
+    for (int i = start; i < end; i++) {
+      if (spatial_sample_hash(sampler, hash_values[i - start])) return i;
+    }
+  }
+
+  return n;
 }
 
 sampler_t *clone_spatial_sampler(const sampler_t *sampler) {
@@ -34,8 +66,6 @@ sampler_t *create_spatial_sampler(double sampling_ratio) {
   if (sampling_ratio > 1 || sampling_ratio <= 0) {
     ERROR("sampling ratio range error get %lf (should be 0-1)\n",
           sampling_ratio);
-  } else if (sampling_ratio > 0.5) {
-    ERROR("currently we only support sampling ratio no more than 0.5\n");
   } else if (sampling_ratio == 1) {
     WARN("spatial sampler ratio 1 means no sampling\n");
     return NULL;
@@ -44,12 +74,19 @@ sampler_t *create_spatial_sampler(double sampling_ratio) {
   sampler_t *s = my_malloc(sampler_t);
   memset(s, 0, sizeof(sampler_t));
   s->sampling_ratio = sampling_ratio;
-  s->sampling_ratio_inv = (int)(1.0 / sampling_ratio);
+  int ratio_inv = (int)lround(1.0 / sampling_ratio);
+  if (fabs(1.0 / ratio_inv - sampling_ratio) < 1e-9 * sampling_ratio) {
+    s->sampling_ratio_inv = ratio_inv;
+  } else {
+    s->sampling_ratio_inv = 0;
+  }
+  s->sampling_boundary =
+      (uint64_t)llround(sampling_ratio * SAMPLING_RATIO_SCALE);
   s->sample = spatial_sample;
+  s->sample_batch = spatial_sample_batch;
   s->clone = clone_spatial_sampler;
   s->free = free_spatial_sampler;
   s->type = SPATIAL_SAMPLER;
-  // s->sampling_boundary = (uint64_t)(ratio * UINT64_MAX);
 
   print_sampler(s);
 
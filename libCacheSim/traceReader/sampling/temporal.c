@@ -1,5 +1,9 @@
-/* a temporal sampler that samples every 1 / sampling_ratio requests */
+/* a temporal sampler that samples every 1 / sampling_ratio requests,
+ * if 1 / sampling_ratio is not an integer, each request adds
+ * sampling_boundary to a credit and a request is sampled when the credit
+ * reaches SAMPLING_RATIO_SCALE */
 
+#include <math.h>
 #include <stdbool.h>
 
 #include "../../include/libCacheSim/logging.h"
@@ -11,24 +15,59 @@ extern "C" {
 
 typedef struct temporal_sampler_params {
   int n_samples;
+  uint64_t credit;
 } temporal_sampler_params_t;
 
 bool temporal_sample(sampler_t *sampler, request_t *req) {
   temporal_sampler_params_t *params = sampler->other_params;
 
-  if (++params->n_samples == sampler->sampling_ratio_inv) {
-    params->n_samples = 0;
+  if (sampler->sampling_ratio_inv > 0) {
+    if (++params->n_samples == sampler->sampling_ratio_inv) {
+      params->n_samples = 0;
+      return true;
+    }
+    return false;
+  }
+
+  params->credit += sampler->sampling_boundary;
+  if (params->credit >= SAMPLING_RATIO_SCALE) {
+    params->credit -= SAMPLING_RATIO_SCALE;
     return true;
   }
 
   return false;
 }
 
+/* the requests are not needed, only the number of requests to skip */
+int temporal_sample_batch(sampler_t *sampler, const obj_id_t *obj_ids, int n) {
+  temporal_sampler_params_t *params = sampler->other_params;
+
+  int64_t n_skip;
+  if (sampler->sampling_ratio_inv > 0) {
+    n_skip = sampler->sampling_ratio_inv - 1 - params->n_samples;
+  } else {
+    /* the number of requests before the credit reaches the scale */
+    n_skip = (int64_t)((SAMPLING_RATIO_SCALE - params->credit +
+                        sampler->sampling_boundary - 1) /
+                       sampler->sampling_boundary) -
+             1;
+  }
+  if (n_skip > n) n_skip = n;
+
+  if (sampler->sampling_ratio_inv > 0) {
+    params->n_samples += (int)n_skip;
+  } else {
+    params->credit += (uint64_t)n_skip * sampler->sampling_boundary;
+  }
+
+  return (int)n_skip;
+}
+
 sampler_t *clone_temporal_sampler(const sampler_t *sampler) {
   sampler_t *cloned_sampler = my_malloc(sampler_t);
   memcpy(cloned_sampler, sampler, sizeof(sampler_t));
   cloned_sampler->other_params = my_malloc(temporal_sampler_params_t);
-  ((temporal_sampler_params_t *)cloned_sampler->other_params)->n_samples = 0;
+  memset(cloned_sampler->other_params, 0, sizeof(temporal_sampler_params_t));
 
   return cloned_sampler;
 }
@@ -42,8 +81,6 @@ sampler_t *create_temporal_sampler(double sampling_ratio) {
   if (sampling_ratio > 1 || sampling_ratio <= 0) {
     ERROR("sampling ratio range error get %lf (should be 0-1)\n",
           sampling_ratio);
-  } else if (sampling_ratio > 0.5) {
-    ERROR("currently we only support sampling ratio no more than 0.5\n");
   } else if (sampling_ratio == 1) {
     WARN("temporal sampler ratio 1 means no sampling\n");
     return NULL;
@@ -52,14 +89,23 @@ sampler_t *create_temporal_sampler(double sampling_ratio) {
   sampler_t *s = my_malloc(sampler_t);
   memset(s, 0, sizeof(sampler_t));
   s->sampling_ratio = sampling_ratio;
-  s->sampling_ratio_inv = (int)(1.0 / sampling_ratio);
+  int ratio_inv = (int)lround(1.0 / sampling_ratio);
+  if (fabs(1.0 / ratio_inv - sampling_ratio) < 1e-9 * sampling_ratio) {
+    s->sampling_ratio_inv = ratio_inv;
+  } else {
+    s->sampling_ratio_inv = 0;
+  }
+  s->sampling_boundary =
+      (uint64_t)llround(sampling_ratio * SAMPLING_RATIO_SCALE);
+  if (s->sampling_boundary == 0) s->sampling_boundary = 1;
   s->sample = temporal_sample;
+  s->sample_batch = temporal_sample_batch;
   s->clone = clone_temporal_sampler;
   s->free = free_temporal_sampler;
   s->type = TEMPORAL_SAMPLER;
 
   s->other_params = my_malloc(temporal_sampler_params_t);
-  ((temporal_sampler_params_t *)s->other_params)->n_samples = 0;
+  memset(s->other_params, 0, sizeof(temporal_sampler_params_t));
 
   return s;
 }
@@ -0,0 +1,62 @@
+//
+// a background task that runs one function at a time, see bgTask.h
+//
+
+#include "include/bgTask.h"
+
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+static void *_bg_task_worker(void *arg) {
+  bg_task_t *task = (bg_task_t *)arg;
+  task->func(task->arg);
+  __atomic_store_n(&task->finished, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+void bg_task_init(bg_task_t *task, bool run_inline) {
+  memset(task, 0, sizeof(bg_task_t));
+  task->run_inline = run_inline;
+}
+
+void bg_task_submit(bg_task_t *task, bg_task_func_t func, void *arg) {
+  DEBUG_ASSERT(!task->pending);
+
+  task->func = func;
+  task->arg = arg;
+  task->pending = true;
+  task->has_thread = false;
+  task->finished = 0;
+
+  if (!task->run_inline) {
+    if (pthread_create(&task->thread, NULL, _bg_task_worker, task) == 0) {
+      task->has_thread = true;
+      return;
+    }
+    WARN("cannot create background thread, run the task inline\n");
+  }
+
+  func(arg);
+  task->finished = 1;
+}
+
+bool bg_task_try_collect(bg_task_t *task) {
+  if (!task->pending) return false;
+  if (!__atomic_load_n(&task->finished, __ATOMIC_ACQUIRE)) return false;
+
+  return bg_task_wait(task);
+}
+
+bool bg_task_wait(bg_task_t *task) {
+  if (!task->pending) return false;
+
+  if (task->has_thread) {
+    pthread_join(task->thread, NULL);
+    task->has_thread = false;
+  }
+  task->pending = false;
+
+  return true;
+}
@@ -0,0 +1,62 @@
+//
+// a background task that runs one function at a time on its own thread,
+// used to train the models of learned caches off the request path
+//
+// the owner submits a task, keeps serving requests, and polls
+// bg_task_try_collect to install the result once the task finishes,
+// in inline mode, the task runs in bg_task_submit so that the result is
+// installed at the same request every run
+//
+
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*bg_task_func_t)(void *arg);
+
+typedef struct bg_task {
+  pthread_t thread;
+  bg_task_func_t func;
+  void *arg;
+  bool run_inline;
+  /* a task is submitted and not collected */
+  bool pending;
+  bool has_thread;
+  /* set by the worker when func returns */
+  int finished;
+} bg_task_t;
+
+void bg_task_init(bg_task_t *task, bool run_inline);
+
+/**
+ * @brief run func(arg) on a new thread, or before returning in inline mode,
+ * the previous task must have been collected
+ */
+void bg_task_submit(bg_task_t *task, bg_task_func_t func, void *arg);
+
+/**
+ * @brief collect the task if it has finished, does not block
+ *
+ * @return true if a task is collected and its result can be used
+ */
+bool bg_task_try_collect(bg_task_t *task);
+
+/**
+ * @brief block until the pending task finishes and collect it
+ *
+ * @return true if a task is collected, false if no task is pending
+ */
+bool bg_task_wait(bg_task_t *task);
+
+static inline bool bg_task_is_pending(const bg_task_t *task) {
+  return task->pending;
+}
+
+#ifdef __cplusplus
+}
+#endif
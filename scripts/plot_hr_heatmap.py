@@ -0,0 +1,141 @@
+"""
+plot hit ratio heatmap (start time x end time)
+
+
+usage:
+1. compute the heatmap using get_hr_heatmap or get_lru_obj_hr_heatmap
+and write it with save_heatmap, see doc/advanced_lib.md
+2. plot the heatmap using this script:
+`python3 plot_hr_heatmap.py trace.hrHeatmap`
+
+"""
+
+import os, sys
+import copy
+import numpy as np
+import matplotlib.pyplot as plt
+from matplotlib.ticker import FuncFormatter
+
+from typing import Tuple
+import logging
+
+sys.path.append(os.path.dirname(os.path.abspath(__file__)))
+from utils.trace_utils import extract_dataname
+from utils.plot_utils import FIG_DIR, FIG_TYPE
+
+logger = logging.getLogger("plot_hr_heatmap")
+
+HEATMAP_MAGIC = 0x50414D4853434C
+HEATMAP_VERSION = 1
+
+# the 64-byte header written by save_heatmap in profiler/heatmap.c
+HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "<u8"),
+        ("version", "<i4"),
+        ("time_mode", "<i4"),
+        ("n_pixel", "<i8"),
+        ("time_interval", "<i8"),
+        ("n_req", "<i8"),
+        ("reserved", "<i8", (3,)),
+    ]
+)
+
+
+def load_hr_heatmap(datapath: str) -> Tuple[np.ndarray, np.ndarray, str, int]:
+    """load the heatmap written by save_heatmap, the matrix is mapped from the
+    file without parsing
+
+    Args:
+        datapath (str): the path of the heatmap file
+
+    Returns:
+        Tuple[np.ndarray, np.ndarray, str, int]: matrix (start pixel x end pixel),
+            pixel_start, time_mode ("vtime" or "rtime"), time_interval
+
+    """
+
+    header = np.fromfile(datapath, dtype=HEADER_DTYPE, count=1)[0]
+    assert (
+        header["magic"] == HEATMAP_MAGIC and header["version"] == HEATMAP_VERSION
+    ), "{} is not a hit ratio heatmap file".format(datapath)
+
+    n_pixel = int(header["n_pixel"])
+    pixel_start = np.memmap(
+        datapath,
+        dtype="<i8",
+        mode="r",
+        offset=HEADER_DTYPE.itemsize,
+        shape=(n_pixel + 1,),
+    )
+    matrix = np.memmap(
+        datapath,
+        dtype="<f8",
+        mode="r",
+        offset=HEADER_DTYPE.itemsize + 8 * (n_pixel + 1),
+        shape=(n_pixel, n_pixel),
+    )
+    time_mode = "vtime" if header["time_mode"] == 0 else "rtime"
+
+    return matrix, pixel_start, time_mode, int(header["time_interval"])
+
+
+def plot_hr_heatmap(datapath: str, figname_prefix: str = "") -> None:
+    """
+    plot hit ratio heatmap, x is the end time and y is the start time
+
+    Args:
+        datapath (str): the path of the heatmap file
+
+    Returns:
+        None
+
+    """
+
+    if len(figname_prefix) == 0:
+        figname_prefix = extract_dataname(datapath)
+
+    matrix, pixel_start, time_mode, time_interval = load_hr_heatmap(datapath)
+
+    cmap = copy.copy(plt.cm.jet)
+    cmap.set_bad(color="white", alpha=1.0)
+    img = plt.imshow(
+        np.ma.masked_invalid(matrix), origin="lower", cmap=cmap, aspect="auto"
+    )
+    cb = plt.colorbar(img)
+    cb.set_label("Hit ratio")
+
+    if time_mode == "rtime":
+        formatter = FuncFormatter(
+            lambda x, pos: "{:.0f}".format(x * time_interval / 3600)
+        )
+        unit = "hour"
+    else:
+        formatter = FuncFormatter(
+            lambda x, pos: "{:.1f}".format(x * time_interval / 1e6)
+        )
+        unit = "M request"
+    plt.gca().xaxis.set_major_formatter(formatter)
+    plt.gca().yaxis.set_major_formatter(formatter)
+    plt.xlabel("End time ({})".format(unit))
+    plt.ylabel("Start time ({})".format(unit))
+
+    figname = "{}/{}_hr_heatmap_{}.{}".format(
+        FIG_DIR, figname_prefix, time_mode, FIG_TYPE
+    )
+    plt.savefig(figname, bbox_inches="tight")
+    plt.clf()
+    logger.info("plot saved to {}".format(figname))
+
+
+if __name__ == "__main__":
+    import argparse
+
+    ap = argparse.ArgumentParser()
+    ap.add_argument("datapath", type=str, help="data path")
+    ap.add_argument(
+        "--figname-prefix", type=str, default="", help="the prefix of figname"
+    )
+    p = ap.parse_args()
+
+    plot_hr_heatmap(p.datapath, p.figname_prefix)
@@ -0,0 +1,73 @@
+"""
+load the per-request output written by cachesim --sim-output (simOutput.h)
+
+"""
+
+import numpy as np
+from typing import Iterator, Tuple
+
+# cache_event_e in cache.h
+EVENT_ADMIT, EVENT_BYPASS, EVENT_EVICT = 0, 1, 2
+
+
+def _read_file(datapath: str) -> bytes:
+    if datapath.endswith(".zst"):
+        import zstandard
+
+        with open(datapath, "rb") as ifile:
+            return zstandard.ZstdDecompressor().decompressobj().decompress(ifile.read())
+    with open(datapath, "rb") as ifile:
+        return ifile.read()
+
+
+def load_hit_bitmap(datapath: str, n_req: int = -1) -> np.ndarray:
+    """load the hit bitmap
+
+    Args:
+        datapath (str): the path of the .hit or .hit.zst file
+        n_req (int): the number of requests, -1 to keep the padding bits
+
+    Returns:
+        np.ndarray: a bool array, element i is whether request i hits
+    """
+
+    data = np.frombuffer(_read_file(datapath), dtype=np.uint8)
+    hit = np.unpackbits(data, bitorder="little").astype(bool)
+    return hit if n_req < 0 else hit[:n_req]
+
+
+def iter_events(datapath: str) -> Iterator[Tuple[int, int, int, int]]:
+    """iterate the admission and eviction events
+
+    Args:
+        datapath (str): the path of the .event or .event.zst file
+
+    Returns:
+        Iterator[Tuple[int, int, int, int]]: (request number, event type,
+            victim obj_id, victim obj_size), the victim is -1 except for evictions
+    """
+
+    data = _read_file(datapath)
+    pos, req = 0, 0
+
+    def read_varint():
+        nonlocal pos
+        v, shift = 0, 0
+        while True:
+            b = data[pos]
+            pos += 1
+            v |= (b & 0x7F) << shift
+            if b < 0x80:
+                return v
+            shift += 7
+
+    while pos < len(data):
+        v = read_varint()
+        req += v >> 2
+        event = v & 3
+        if event == EVENT_EVICT:
+            obj_id = read_varint()
+            obj_size = read_varint()
+            yield req, event, obj_id, obj_size
+        else:
+            yield req, event, -1, -1
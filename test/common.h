@@ -224,11 +224,13 @@ static cache_t *create_test_cache(const char *alg_name,
     } else if (strcasecmp(alg_name, "GLCache-LearnedTrueY") == 0) {
       init_params =
           "type=learned, "
-          "train-source-y=oracle, rank-intvl=0.05, retrain-intvl=172800";
+          "train-source-y=oracle, rank-intvl=0.05, retrain-intvl=172800, "
+          "train-mode=inline";
     } else if (strcasecmp(alg_name, "GLCache-LearnedOnline") == 0) {
       init_params =
           "type=learned, "
-          "train-source-y=online, rank-intvl=0.05, retrain-intvl=172800";
+          "train-source-y=online, rank-intvl=0.05, retrain-intvl=172800, "
+          "train-mode=inline";
     }
     cache = GLCache_init(cc_params, init_params);
 #endif
@@ -254,6 +256,8 @@ static cache_t *create_test_cache(const char *alg_name,
     cache = S3FIFO_init(cc_params, "move-to-main-threshold=2");
   } else if (strcasecmp(alg_name, "Sieve") == 0) {
     cache = Sieve_init(cc_params, NULL);
+  } else if (strcasecmp(alg_name, "WTinyLFU") == 0) {
+    cache = WTinyLFU_init(cc_params, NULL);
   } else if (strcasecmp(alg_name, "Mithril") == 0) {
     cache = LRU_init(cc_params, NULL);
     cache->prefetcher =
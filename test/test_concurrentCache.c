@@ -0,0 +1,151 @@
+//
+// test the concurrent caches
+//
+// test_concurrentCache.c
+// libCacheSim
+//
+
+#include <pthread.h>
+
+#include "common.h"
+
+static const uint64_t g_req_cnt_true = 113872;
+
+/* with one thread, the concurrent FIFO and Clock make the same decisions as
+ * the single-threaded implementations */
+static void _test_concurrent_cache_same_as_sequential(reader_t *reader,
+                                                      const char *alg_name) {
+  for (uint64_t cache_size = STEP_SIZE; cache_size <= CACHE_SIZE;
+       cache_size += STEP_SIZE * 3) {
+    common_cache_params_t cc_params = {
+        .cache_size = cache_size, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+    cache_t *cache = create_test_cache(alg_name, cc_params, reader, NULL);
+    concurrent_cache_t *ccache =
+        create_concurrent_cache(alg_name, cc_params, NULL);
+    g_assert_true(ccache != NULL);
+
+    reset_reader(reader);
+    request_t *req = new_request();
+    uint64_t n_req = 0, n_miss = 0, n_miss_concurrent = 0;
+    while (read_one_req(reader, req) == 0) {
+      n_req += 1;
+      n_miss += cache->get(cache, req) ? 0 : 1;
+      n_miss_concurrent += ccache->get(ccache, req) ? 0 : 1;
+    }
+
+    g_assert_cmpuint(n_req, ==, g_req_cnt_true);
+    g_assert_cmpuint(n_miss_concurrent, ==, n_miss);
+    g_assert_cmpint(concurrent_cache_get_occupied_byte(ccache), ==,
+                    cache->get_occupied_byte(cache));
+    g_assert_cmpint(concurrent_cache_get_n_obj(ccache), ==,
+                    cache->get_n_obj(cache));
+
+    free_request(req);
+    cache->cache_free(cache);
+    ccache->cache_free(ccache);
+  }
+}
+
+static void test_concurrent_FIFO(gconstpointer user_data) {
+  _test_concurrent_cache_same_as_sequential((reader_t *)user_data, "FIFO");
+}
+
+static void test_concurrent_Clock(gconstpointer user_data) {
+  _test_concurrent_cache_same_as_sequential((reader_t *)user_data, "Clock");
+}
+
+#define N_TEST_THREAD 4
+
+typedef struct {
+  concurrent_cache_t *cache;
+  request_t *reqs;
+  int64_t n_req;
+  int64_t n_miss;
+} test_thread_params_t;
+
+static void *_replay(void *arg) {
+  test_thread_params_t *params = (test_thread_params_t *)arg;
+  for (int64_t i = 0; i < params->n_req; i++) {
+    if (!params->cache->get(params->cache, &params->reqs[i])) {
+      params->n_miss += 1;
+    }
+  }
+  return NULL;
+}
+
+/* replay the trace partitioned by object on multiple threads sharing one
+ * cache, the cache must never exceed its size and every request must be
+ * counted once */
+static void test_concurrent_multi_thread(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const char *alg_names[] = {"FIFO", "Clock", "S3FIFO"};
+
+  test_thread_params_t params[N_TEST_THREAD];
+  memset(params, 0, sizeof(params));
+  for (int t = 0; t < N_TEST_THREAD; t++) {
+    params[t].reqs = my_malloc_n(request_t, g_req_cnt_true);
+  }
+
+  reset_reader(reader);
+  request_t *req = new_request();
+  GHashTable *uniq_objs = g_hash_table_new(g_int64_hash, g_int64_equal);
+  while (read_one_req(reader, req) == 0) {
+    test_thread_params_t *p = &params[req->obj_id % N_TEST_THREAD];
+    p->reqs[p->n_req++] = *req;
+    g_hash_table_add(uniq_objs, &p->reqs[p->n_req - 1].obj_id);
+  }
+  free_request(req);
+  uint64_t n_uniq_obj = g_hash_table_size(uniq_objs);
+  g_hash_table_destroy(uniq_objs);
+
+  for (int i = 0; i < 3; i++) {
+    common_cache_params_t cc_params = {
+        .cache_size = STEP_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+    concurrent_cache_t *cache =
+        create_concurrent_cache(alg_names[i], cc_params, NULL);
+    g_assert_true(cache != NULL);
+
+    pthread_t threads[N_TEST_THREAD];
+    for (int t = 0; t < N_TEST_THREAD; t++) {
+      params[t].cache = cache;
+      params[t].n_miss = 0;
+      pthread_create(&threads[t], NULL, _replay, &params[t]);
+    }
+
+    uint64_t n_req = 0, n_miss = 0;
+    for (int t = 0; t < N_TEST_THREAD; t++) {
+      pthread_join(threads[t], NULL);
+      n_req += params[t].n_req;
+      n_miss += params[t].n_miss;
+    }
+
+    g_assert_cmpuint(n_req, ==, g_req_cnt_true);
+    g_assert_cmpuint(n_miss, >=, n_uniq_obj);
+    g_assert_cmpuint(n_miss, <=, n_req);
+    g_assert_cmpint(concurrent_cache_get_occupied_byte(cache), <=,
+                    cache->cache_size);
+    g_assert_cmpint(concurrent_cache_get_n_obj(cache), <=, cache->max_n_obj);
+
+    cache->cache_free(cache);
+  }
+
+  for (int t = 0; t < N_TEST_THREAD; t++) {
+    my_free(sizeof(request_t) * g_req_cnt_true, params[t].reqs);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+  reader_t *reader;
+
+  // object sizes do not change in the oracleGeneral trace
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func("/libCacheSim/concurrent_FIFO", reader,
+                       test_concurrent_FIFO);
+  g_test_add_data_func("/libCacheSim/concurrent_Clock", reader,
+                       test_concurrent_Clock);
+  g_test_add_data_func_full("/libCacheSim/concurrent_multi_thread", reader,
+                            test_concurrent_multi_thread, test_teardown);
+
+  return g_test_run();
+}
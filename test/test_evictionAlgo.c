@@ -515,7 +515,24 @@ static void test_Sieve(gconstpointer user_data) {
 }
 
 static void test_WTinyLFU(gconstpointer user_data) {
-  // TODO: to be implemented
+  uint64_t miss_cnt_true[] = {90525, 84533, 79047, 74753,
+                              72761, 65551, 61367, 53647};
+  uint64_t miss_byte_true[] = {4085580288, 3743911424, 3424789504, 3156033024,
+                               2974754304, 2622712832, 2536180736, 2275356672};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("WTinyLFU", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
 }
 
 static void test_LIRS(gconstpointer user_data) {
@@ -539,6 +556,271 @@ static void test_LIRS(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+/* AdaptSize admission with a short reconfiguration interval */
+static void test_LRU_adaptsize(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {88964, 86385, 83036, 81450,
+                              76531, 76285, 76166, 75818};
+  uint64_t miss_byte_true[] = {4103746048, 3963164160, 3762220032, 3649888256,
+                               3362744832, 3349567488, 3347370496, 3333344256};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("LRU", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  /* reconfigure several times in the trace */
+  cache->admissioner = create_admissioner("adaptsize", "reconf-interval=20000");
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+}
+
+static void test_LRU_tinylfu(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {94422, 89039, 87166, 85876,
+                              81888, 81335, 76682, 75362};
+  uint64_t miss_byte_true[] = {4188422144, 3933666304, 3816784896, 3745110528,
+                               3499240448, 3465011712, 3245257216, 3197024256};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache("LRU", cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  /* a small sketch so that it is halved in the trace */
+  cache->admissioner =
+      create_admissioner("tinylfu", "n-entry=8192,min-freq=2");
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  print_results(cache, res);
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+}
+
+/* objects with only the metadata of their own algorithm
+ * must not change the results */
+static void test_compact_obj(gconstpointer user_data) {
+  const char *alg_names[] = {"FIFO", "LRU", "Clock", "Sieve"};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  for (int i = 0; i < 4; i++) {
+    cache_t *cache = create_test_cache(alg_names[i], cc_params, reader, NULL);
+    cache_t *compact_cache =
+        create_test_cache(alg_names[i], cc_params, reader, NULL);
+    g_assert_cmpint(compact_cache->algo_obj_md_size, >=, 0);
+    cache_use_compact_obj(compact_cache);
+
+    cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+        reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+    cache_stat_t *compact_res = simulate_at_multi_sizes_with_step_size(
+        reader, compact_cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+    for (uint64_t j = 0; j < CACHE_SIZE / STEP_SIZE; j++) {
+      g_assert_cmpuint(compact_res[j].n_req, ==, g_req_cnt_true);
+      g_assert_cmpuint(compact_res[j].n_miss, ==, res[j].n_miss);
+      g_assert_cmpuint(compact_res[j].n_miss_byte, ==, res[j].n_miss_byte);
+    }
+
+    cache->cache_free(cache);
+    compact_cache->cache_free(compact_cache);
+    my_free(sizeof(cache_stat_t), res);
+    my_free(sizeof(cache_stat_t), compact_res);
+  }
+}
+
+/* a cache restored from a checkpoint in the middle of the trace
+ * must have the same misses as the cache that was not interrupted */
+static void test_checkpoint(gconstpointer user_data) {
+  const char *alg_names[] = {"FIFO", "LRU", "Clock", "Sieve", "S3-FIFO", "ARC"};
+  const char *ckpt_path = "test_checkpoint.ckpt";
+  const int64_t n_warmup_req = g_req_cnt_true / 2;
+
+  reader_t *reader = (reader_t *)user_data;
+  request_t *req = new_request();
+  common_cache_params_t cc_params = {.cache_size = STEP_SIZE * 2,
+                                     .hashpower = 20,
+                                     .default_ttl = DEFAULT_TTL};
+  for (int i = 0; i < 6; i++) {
+    cache_t *cache = create_test_cache(alg_names[i], cc_params, reader, NULL);
+    int64_t n_req = 0, n_miss = 0;
+    reset_reader(reader);
+    while (read_one_req(reader, req) == 0) {
+      bool hit = cache->get(cache, req);
+      if (++n_req == n_warmup_req) {
+        g_assert_true(cache_checkpoint(cache, reader, ckpt_path));
+      } else if (n_req > n_warmup_req && !hit) {
+        n_miss += 1;
+      }
+    }
+
+    cache_t *restored = create_test_cache(alg_names[i], cc_params, reader, NULL);
+    reset_reader(reader);
+    g_assert_true(cache_restore(restored, ckpt_path, reader));
+    g_assert_cmpint(restored->get_n_obj(restored), >, 0);
+    int64_t n_restored_req = 0, n_restored_miss = 0;
+    while (read_one_req(reader, req) == 0) {
+      n_restored_req += 1;
+      if (!restored->get(restored, req)) n_restored_miss += 1;
+    }
+
+    g_assert_cmpint(n_restored_req, ==, n_req - n_warmup_req);
+    g_assert_cmpint(n_restored_miss, ==, n_miss);
+    g_assert_cmpint(restored->n_req, ==, cache->n_req);
+    g_assert_cmpint(restored->get_n_obj(restored), ==, cache->get_n_obj(cache));
+    g_assert_cmpint(restored->get_occupied_byte(restored), ==,
+                    cache->get_occupied_byte(cache));
+
+    cache->cache_free(cache);
+    restored->cache_free(restored);
+  }
+
+  remove(ckpt_path);
+  free_request(req);
+  reset_reader(reader);
+}
+
+/* a cache with one partition must behave the same as its sub-cache, and the
+ * partitions must share the capacity and account all requests */
+static void test_Partition(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {93374, 89783, 83572, 81722,
+                              72494, 72104, 71972, 71704};
+  uint64_t miss_byte_true[] = {4214303232, 4061242368, 3778040320, 3660569600,
+                               3100927488, 3078128640, 3075403776, 3061662720};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache =
+      Partition_init(cc_params, "sub-cache=LRU,partition-by=obj,n-partition=1");
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+  _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                           miss_cnt_true, g_req_byte_true, miss_byte_true);
+  cache->cache_free(cache);
+  my_free(sizeof(cache_stat_t), res);
+
+  const char *policies[] = {
+      "policy=static,shares=1:2:3:4",
+      "policy=proportional,interval=5000",
+      "policy=dynamic,interval=5000,shadow-sample-ratio=0.1",
+  };
+  request_t *req = new_request();
+  cc_params.cache_size = STEP_SIZE * 2;
+  for (int i = 0; i < 3; i++) {
+    char params[256];
+    snprintf(params, sizeof(params), "partition-by=obj,n-partition=4,%s",
+             policies[i]);
+    cache = Partition_init(cc_params, params);
+    g_assert_true(is_partition_cache(cache));
+    g_assert_cmpint(Partition_get_n_partition(cache), ==, 4);
+
+    int64_t n_req = 0, n_miss = 0;
+    reset_reader(reader);
+    while (read_one_req(reader, req) == 0) {
+      n_req += 1;
+      if (!cache->get(cache, req)) n_miss += 1;
+    }
+
+    int64_t part_n_req = 0, part_n_miss = 0, part_size = 0;
+    for (int j = 0; j < 4; j++) {
+      cache_stat_t stat;
+      Partition_get_stat(cache, j, &stat);
+      g_assert_cmpint(stat.occupied_byte, <=, stat.cache_size);
+      part_n_req += stat.n_req;
+      part_n_miss += stat.n_miss;
+      part_size += stat.cache_size;
+    }
+    g_assert_cmpint(part_n_req, ==, n_req);
+    g_assert_cmpint(part_n_miss, ==, n_miss);
+    g_assert_cmpint(part_size, ==, cache->cache_size);
+    g_assert_cmpint(cache->get_occupied_byte(cache), <=, cache->cache_size);
+
+    int64_t curve_sizes[16];
+    double curve[16];
+    int n_point = Partition_get_miss_ratio_curve(cache, 0, curve_sizes, curve);
+    if (i == 2) {
+      g_assert_cmpint(n_point, ==, 9);
+      g_assert_cmpint(curve_sizes[n_point - 1], ==, cache->cache_size);
+      g_assert_cmpfloat(curve[n_point - 1], <, curve[0]);
+    } else {
+      g_assert_cmpint(n_point, ==, 0);
+    }
+
+    cache->cache_free(cache);
+  }
+
+  free_request(req);
+  reset_reader(reader);
+}
+
+static void test_mini_sim(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {93374, 89783, 83572, 81722,
+                              72494, 72104, 71972, 71704};
+  uint64_t miss_byte_true[] = {4214303232, 4061242368, 3778040320, 3660569600,
+                               3100927488, 3078128640, 3075403776, 3061662720};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  request_t *req = new_request();
+  int n_size = CACHE_SIZE / STEP_SIZE;
+  int64_t cache_sizes[CACHE_SIZE / STEP_SIZE];
+  double miss_ratios[CACHE_SIZE / STEP_SIZE];
+  double byte_miss_ratios[CACHE_SIZE / STEP_SIZE];
+
+  /* the mini sim of all requests is the same as the simulation at each size,
+   * and the sampled one is close */
+  double sampling_ratios[] = {1.0, 0.1};
+  for (int i = 0; i < 2; i++) {
+    cache_t *cache = LRU_init(cc_params, NULL);
+    mini_sim_params_t params = default_mini_sim_params();
+    params.n_size = n_size;
+    params.max_size = CACHE_SIZE;
+    params.sampling_ratio = sampling_ratios[i];
+    cache_enable_mini_sim(cache, &params);
+
+    uint64_t n_miss = 0;
+    reset_reader(reader);
+    while (read_one_req(reader, req) == 0) {
+      if (!cache->get(cache, req)) n_miss += 1;
+    }
+    g_assert_cmpuint(n_miss, ==, miss_cnt_true[n_size - 1]);
+
+    g_assert_cmpint(mini_sim_get_mrc(cache->mini_sim, cache_sizes, miss_ratios,
+                                     byte_miss_ratios),
+                    ==, n_size);
+    for (int j = 0; j < n_size; j++) {
+      g_assert_cmpint(cache_sizes[j], ==, STEP_SIZE * (j + 1));
+      double miss_ratio = (double)miss_cnt_true[j] / g_req_cnt_true;
+      double byte_miss_ratio = (double)miss_byte_true[j] / g_req_byte_true;
+      if (i == 0) {
+        g_assert_cmpfloat(fabs(miss_ratios[j] - miss_ratio), <, 1e-9);
+        g_assert_cmpfloat(fabs(byte_miss_ratios[j] - byte_miss_ratio), <,
+                          1e-9);
+      } else {
+        g_assert_cmpfloat(fabs(miss_ratios[j] - miss_ratio), <, 0.15);
+      }
+    }
+    g_assert_cmpfloat(mini_sim_get_miss_ratio(cache->mini_sim, 0), ==, 1.0);
+    g_assert_cmpfloat(mini_sim_get_miss_ratio(cache->mini_sim, CACHE_SIZE * 2),
+                      ==, miss_ratios[n_size - 1]);
+
+    cache->cache_free(cache);
+  }
+
+  free_request(req);
+  reset_reader(reader);
+}
+
 static void empty_test(gconstpointer user_data) { ; }
 
 int main(int argc, char *argv[]) {
@@ -581,6 +863,20 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/cacheAlgo_LFUCpp", reader, test_LFUCpp);
   g_test_add_data_func("/libCacheSim/cacheAlgo_GDSF", reader, test_GDSF);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LHD", reader, test_LHD);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_LRU_adaptsize", reader,
+                       test_LRU_adaptsize);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_LRU_tinylfu", reader,
+                       test_LRU_tinylfu);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_WTinyLFU", reader,
+                       test_WTinyLFU);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_compact_obj", reader,
+                       test_compact_obj);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_Partition", reader,
+                       test_Partition);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_mini_sim", reader,
+                       test_mini_sim);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_checkpoint", reader,
+                       test_checkpoint);
 
   /* Belady requires reader that has next access information and can only use
    * oracleGeneral trace */
@@ -0,0 +1,154 @@
+//
+// unit tests of the 4-bit frequency sketch used by TinyLFU
+//
+// test_freqSketch.c
+// libCacheSim
+//
+
+#include "../libCacheSim/dataStructure/freqSketch.h"
+#include "common.h"
+
+#define N_OBJ 20000
+
+/* the count of object i is i % 8 + 1 */
+static int _true_count(int i) { return i % 8 + 1; }
+
+/* a count-min sketch never under-estimates before halving */
+static void test_freqSketch_no_underestimate(gconstpointer user_data) {
+  /* a large sample size so that the counters are not halved */
+  freq_sketch_t *sketch = create_freq_sketch(N_OBJ / 4, INT64_MAX);
+
+  for (int round = 0; round < 8; round++) {
+    for (int i = 0; i < N_OBJ; i++) {
+      if (round < _true_count(i)) freq_sketch_add(sketch, (obj_id_t)i);
+    }
+  }
+  g_assert_cmpint(sketch->n_halving, ==, 0);
+
+  int n_exact = 0;
+  for (int i = 0; i < N_OBJ; i++) {
+    int est = freq_sketch_estimate(sketch, (obj_id_t)i);
+    g_assert_cmpint(est, >=, _true_count(i));
+    g_assert_cmpint(est, <=, FREQ_SKETCH_MAX_COUNT);
+    n_exact += est == _true_count(i);
+  }
+  /* the sketch has 4 counters per object, most estimates are exact */
+  g_assert_cmpint(n_exact, >, N_OBJ / 2);
+
+  free_freq_sketch(sketch);
+}
+
+static void test_freqSketch_saturation(gconstpointer user_data) {
+  freq_sketch_t *sketch = create_freq_sketch(1024, INT64_MAX);
+
+  for (int i = 1; i <= 100; i++) {
+    int est = freq_sketch_add(sketch, 42);
+    g_assert_cmpint(est, ==, MIN(i, FREQ_SKETCH_MAX_COUNT));
+  }
+  g_assert_cmpint(freq_sketch_estimate(sketch, 42), ==,
+                  FREQ_SKETCH_MAX_COUNT);
+
+  /* a saturated counter does not overflow into its neighbors */
+  for (int64_t i = 0; i < sketch->n_word; i++) {
+    for (int shift = 0; shift < 64; shift += 4) {
+      uint64_t count = (sketch->table[i] >> shift) & 0xf;
+      g_assert_true(count == 0 || count == FREQ_SKETCH_MAX_COUNT);
+    }
+  }
+
+  free_freq_sketch(sketch);
+}
+
+static void test_freqSketch_halving(gconstpointer user_data) {
+  freq_sketch_t *sketch = create_freq_sketch(1024, INT64_MAX);
+
+  /* one object, so its counters are exact */
+  for (int i = 0; i < 13; i++) freq_sketch_add(sketch, 7);
+  g_assert_cmpint(freq_sketch_estimate(sketch, 7), ==, 13);
+  freq_sketch_halve(sketch);
+  g_assert_cmpint(freq_sketch_estimate(sketch, 7), ==, 6);
+  freq_sketch_halve(sketch);
+  g_assert_cmpint(freq_sketch_estimate(sketch, 7), ==, 3);
+  g_assert_cmpint(sketch->n_halving, ==, 2);
+
+  freq_sketch_reset(sketch);
+  g_assert_cmpint(freq_sketch_estimate(sketch, 7), ==, 0);
+  free_freq_sketch(sketch);
+
+  /* the counters are halved automatically every sample_size adds */
+  int64_t sample_size = 1000;
+  sketch = create_freq_sketch(N_OBJ, sample_size);
+  for (int i = 0; i < N_OBJ; i++) {
+    for (int j = 0; j < _true_count(i); j++) {
+      freq_sketch_add(sketch, (obj_id_t)i);
+    }
+  }
+  g_assert_cmpint(sketch->n_halving, >, 0);
+  g_assert_cmpint(sketch->n_add, <, sample_size);
+  /* the estimate after halving is at least half of the count */
+  freq_sketch_halve(sketch);
+  for (int i = 0; i < N_OBJ; i++) {
+    g_assert_cmpint(freq_sketch_estimate(sketch, (obj_id_t)i), <=,
+                    FREQ_SKETCH_MAX_COUNT / 2);
+  }
+  free_freq_sketch(sketch);
+
+  sketch = create_freq_sketch(N_OBJ, INT64_MAX);
+  for (int i = 0; i < N_OBJ; i++) {
+    for (int j = 0; j < _true_count(i); j++) {
+      freq_sketch_add(sketch, (obj_id_t)i);
+    }
+  }
+  freq_sketch_halve(sketch);
+  for (int i = 0; i < N_OBJ; i++) {
+    g_assert_cmpint(freq_sketch_estimate(sketch, (obj_id_t)i), >=,
+                    _true_count(i) / 2);
+  }
+  free_freq_sketch(sketch);
+}
+
+/* an add only changes the counters of one cache-line aligned block */
+static void test_freqSketch_block_locality(gconstpointer user_data) {
+  freq_sketch_t *sketch = create_freq_sketch(N_OBJ, INT64_MAX);
+  g_assert_cmpuint((uintptr_t)sketch->table % 64, ==, 0);
+  g_assert_cmpint(sketch->n_word % FREQ_SKETCH_BLOCK_N_WORD, ==, 0);
+
+  uint64_t *old_table = g_new(uint64_t, sketch->n_word);
+  for (int i = 0; i < 1000; i++) {
+    memcpy(old_table, sketch->table, sizeof(uint64_t) * sketch->n_word);
+    freq_sketch_add(sketch, (obj_id_t)i);
+
+    int64_t block = -1;
+    int n_changed_counter = 0;
+    for (int64_t w = 0; w < sketch->n_word; w++) {
+      if (old_table[w] == sketch->table[w]) continue;
+      if (block == -1) block = w / FREQ_SKETCH_BLOCK_N_WORD;
+      g_assert_cmpint(w / FREQ_SKETCH_BLOCK_N_WORD, ==, block);
+      for (int shift = 0; shift < 64; shift += 4) {
+        n_changed_counter += ((old_table[w] >> shift) & 0xf) !=
+                             ((sketch->table[w] >> shift) & 0xf);
+      }
+    }
+    g_assert_cmpint(block, !=, -1);
+    g_assert_cmpint(n_changed_counter, >=, 1);
+    g_assert_cmpint(n_changed_counter, <=, FREQ_SKETCH_DEPTH);
+  }
+
+  g_free(old_table);
+  free_freq_sketch(sketch);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_data_func("/libCacheSim/freqSketch_no_underestimate", NULL,
+                       test_freqSketch_no_underestimate);
+  g_test_add_data_func("/libCacheSim/freqSketch_saturation", NULL,
+                       test_freqSketch_saturation);
+  g_test_add_data_func("/libCacheSim/freqSketch_halving", NULL,
+                       test_freqSketch_halving);
+  g_test_add_data_func("/libCacheSim/freqSketch_block_locality", NULL,
+                       test_freqSketch_block_locality);
+
+  return g_test_run();
+}
@@ -65,6 +65,34 @@ static void test_Mithril(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+/* the mining runs in the background, but the associations are only merged
+ * when the next mining starts, so the result must be deterministic */
+static void test_Mithril_epoch(gconstpointer user_data) {
+  uint64_t miss_cnt_true[] = {80130, 79032, 76145, 75267,
+                              72339, 72063, 71936, 71667};
+  uint64_t miss_byte_true[] = {3491591680, 3433147904, 3285124608, 3245293056,
+                               3092902400, 3077805568, 3075234816, 3061489664};
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+
+  for (int i = 0; i < 2; i++) {
+    cache_t *cache = LRU_init(cc_params, NULL);
+    cache->prefetcher = create_prefetcher("Mithril", "mining-mode=epoch",
+                                          cc_params.cache_size);
+    g_assert_true(cache->prefetcher != NULL);
+    cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+        reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+    print_results(cache, res);
+    _verify_profiler_results(res, CACHE_SIZE / STEP_SIZE, g_req_cnt_true,
+                             miss_cnt_true, g_req_byte_true, miss_byte_true);
+    cache->cache_free(cache);
+    my_free(sizeof(cache_stat_t), res);
+  }
+}
+
 static void test_OBL(gconstpointer user_data) {
   uint64_t miss_cnt_true[] = {92139, 88548, 82337, 80487, 71259, 70869, 70737, 70469};
   uint64_t miss_byte_true[] = {4213140480, 4060079616, 3776877568, 3659406848,
@@ -83,9 +111,9 @@ static void test_OBL(gconstpointer user_data) {
 }
 
 static void test_PG(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {92786, 89494, 83403, 81564, 72360, 71973, 71842, 71574};
-  uint64_t miss_byte_true[] = {4195964416, 4054977024, 3776220672, 3659069952,
-                               3100251136, 3077595648, 3074874880, 3061133824};
+  uint64_t miss_cnt_true[] = {93099, 89548, 83397, 81558, 72355, 71969, 71839, 71571};
+  uint64_t miss_byte_true[] = {4211371520, 4058679296, 3776067072, 3658916352,
+                               3100101632, 3077450240, 3074733568, 3060992512};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
@@ -114,6 +142,8 @@ int main(int argc, char *argv[]) {
   reader = setup_oracleGeneralBin_reader();
   // reader = setup_vscsi_reader_with_ignored_obj_size();
   g_test_add_data_func("/libCacheSim/cacheAlgo_Mithril", reader, test_Mithril);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_Mithril_epoch", reader,
+                       test_Mithril_epoch);
   g_test_add_data_func("/libCacheSim/cacheAlgo_OBL", reader, test_OBL);
   g_test_add_data_func("/libCacheSim/cacheAlgo_PG", reader, test_PG);
 
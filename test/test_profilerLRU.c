@@ -29,6 +29,40 @@ void test_profilerLRU_basic(gconstpointer user_data) {
   g_free(mr);
 }
 
+void test_profilerLRU_heatmap(gconstpointer user_data) {
+  // the simulation uses object size 1 of the plain text trace
+  reader_t *reader = (reader_t *)user_data;
+  heatmap_params_t params = default_heatmap_params();
+  params.n_pixel = 8;
+
+  heatmap_t *lru_heatmap = get_lru_obj_hr_heatmap(reader, 20, &params);
+  int n_pixel = lru_heatmap->n_pixel;
+  // starting at the first pixel and ending at the last one is the whole trace
+  g_assert_cmpfloat(fabs(lru_heatmap->matrix[n_pixel - 1] - 0.072985), <=,
+                    0.0001);
+
+  common_cache_params_t cc_params = {
+      .cache_size = 20, .hashpower = 16, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = LRU_init(cc_params, NULL);
+  heatmap_t *heatmap = get_hr_heatmap(reader, cache, &params);
+  g_assert_cmpint(heatmap->n_pixel, ==, n_pixel);
+  for (int i = 0; i < n_pixel; i++) {
+    for (int j = 0; j < n_pixel; j++) {
+      double hr = heatmap->matrix[i * n_pixel + j];
+      double lru_hr = lru_heatmap->matrix[i * n_pixel + j];
+      if (j < i) {
+        g_assert_true(isnan(hr) && isnan(lru_hr));
+      } else {
+        g_assert_cmpfloat(fabs(hr - lru_hr), <=, 1e-9);
+      }
+    }
+  }
+
+  free_heatmap(lru_heatmap);
+  free_heatmap(heatmap);
+  cache->cache_free(cache);
+}
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
@@ -36,6 +70,8 @@ int main(int argc, char *argv[]) {
   reader = setup_plaintxt_reader_num();
   g_test_add_data_func("/libCacheSim/test_profilerLRU_basic_plain_num", reader,
                        test_profilerLRU_basic);
+  g_test_add_data_func("/libCacheSim/test_profilerLRU_heatmap_plain_num",
+                       reader, test_profilerLRU_heatmap);
 
   reader = setup_plaintxt_reader_str();
   g_test_add_data_func("/libCacheSim/test_profilerLRU_basic_plain_str", reader,
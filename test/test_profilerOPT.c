@@ -0,0 +1,66 @@
+//
+// test the one-pass OPT profiler
+//
+// test_profilerOPT.c
+// libCacheSim
+//
+
+#include "common.h"
+
+/* the one-pass curve is the same as simulating Belady with unit size */
+static void test_profilerOPT_obj_miss_ratio(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  gint64 sizes[] = {1, 10, 100, 1000, 5000, 20000};
+  guint64 miss_cnt_true[] = {111187, 102486, 94010, 87025, 71311, 51843};
+
+  guint64 *miss_cnt = _get_opt_miss_cnt(reader, 20000);
+  g_assert_cmpuint(miss_cnt[0], ==, 113872);
+  for (int i = 0; i < 6; i++) {
+    g_assert_cmpuint(miss_cnt[sizes[i]], ==, miss_cnt_true[i]);
+  }
+  g_free(miss_cnt);
+
+  /* a smaller maximal size does not change the curve */
+  double *mr = get_opt_obj_miss_ratio(reader, 1000);
+  g_assert_cmpfloat(fabs(mr[1000] - 87025.0 / 113872), <=, 1e-9);
+  g_free(mr);
+}
+
+/* the bound is not larger than the miss ratio of Belady */
+static void test_profilerOPT_bound(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  uint64_t belady_miss_cnt[] = {79256, 70724, 65481, 61594,
+                                59645, 57599, 50873, 48974};
+  uint64_t belady_miss_byte[] = {3472532480, 2995165696, 2726689792,
+                                 2537648128, 2403427840, 2269212672,
+                                 2134992896, 2029769728};
+  uint64_t cache_sizes[8];
+  double obj_mr[8], byte_mr[8], obj_mr_parallel[8], byte_mr_parallel[8];
+  for (int i = 0; i < 8; i++) cache_sizes[i] = STEP_SIZE * (i + 1);
+
+  get_opt_miss_ratio_bound(reader, cache_sizes, 8, obj_mr, byte_mr, 1);
+  get_opt_miss_ratio_bound(reader, cache_sizes, 8, obj_mr_parallel,
+                           byte_mr_parallel, 4);
+  for (int i = 0; i < 8; i++) {
+    g_assert_cmpfloat(obj_mr[i], <=, (double)belady_miss_cnt[i] / 113872);
+    g_assert_cmpfloat(byte_mr[i], <=, (double)belady_miss_byte[i] / 4368040448);
+    g_assert_cmpfloat(fabs(obj_mr[i] - obj_mr_parallel[i]), <=, 1e-9);
+    g_assert_cmpfloat(fabs(byte_mr[i] - byte_mr_parallel[i]), <=, 1e-9);
+    if (i > 0) g_assert_cmpfloat(obj_mr[i], <=, obj_mr[i - 1]);
+  }
+  /* every object misses at least once */
+  g_assert_cmpfloat(obj_mr[7], >=, 48974.0 / 113872 - 1e-9);
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+  reader_t *reader;
+
+  reader = setup_oracleGeneralBin_reader();
+  g_test_add_data_func("/libCacheSim/test_profilerOPT_obj_miss_ratio", reader,
+                       test_profilerOPT_obj_miss_ratio);
+  g_test_add_data_func_full("/libCacheSim/test_profilerOPT_bound", reader,
+                            test_profilerOPT_bound, test_teardown);
+
+  return g_test_run();
+}
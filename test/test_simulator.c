@@ -4,6 +4,12 @@
 
 #include "common.h"
 
+#ifdef SUPPORT_ZSTD_TRACE
+#include <zstd.h>
+#endif
+
+#include "../libCacheSim/utils/include/mymath.h"
+
 /**
  * this one for testing with the plain trace reader, which does not have obj
  * size information
@@ -221,6 +227,286 @@ static void test_simulator_with_ttl(gconstpointer user_data) {
   cache->cache_free(cache);
 }
 
+/* expired objects are removed when the trace time passes their expiration
+ * time instead of when they are requested again */
+static void test_simulator_with_ttl_wheel(gconstpointer user_data) {
+  uint64_t req_cnt_true = 113872;
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE,
+                                     .default_ttl = 2400};
+  cache_t *cache = LRU_init(cc_params, NULL);
+  g_assert_true(cache != NULL);
+  cache_enable_ttl_wheel(cache);
+
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(
+      reader, cache, STEP_SIZE, NULL, 0, 0, _n_cores());
+
+  for (uint64_t i = 0; i < CACHE_SIZE / STEP_SIZE; i++) {
+    g_assert_cmpuint(res[i].n_req, ==, req_cnt_true);
+    g_assert_cmpint(res[i].expired_obj_cnt, >, 0);
+    g_assert_cmpint(res[i].expired_bytes, >=, res[i].expired_obj_cnt);
+    g_assert_cmpint(res[i].occupied_byte, <=, res[i].cache_size);
+  }
+  g_free(res);
+
+  cache->cache_free(cache);
+}
+
+static void test_simulator_sharded(gconstpointer user_data) {
+  uint64_t req_cnt_true = 113872, req_byte_true = 4205978112;
+  uint64_t miss_cnt_true = 87793;
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = STEP_SIZE * 2,
+                                     .default_ttl = 0};
+  cache_t *cache = LRU_init(cc_params, NULL);
+  g_assert_true(cache != NULL);
+
+  sharded_sim_params_t params = default_sharded_sim_params();
+  params.n_shard = 4;
+  params.warmup_n_req = 0;
+  params.verify_sample_ratio = 0.1;
+  params.num_of_threads = _n_cores();
+
+  for (int mode = 0; mode < SHARD_MODE_INVALID; mode++) {
+    params.mode = (shard_mode_e)mode;
+
+    /* shards start from empty caches, so there are more misses */
+    params.n_round = 1;
+    sharded_sim_result_t *res = simulate_sharded(reader, cache, &params);
+    g_assert_cmpuint(res->stat.n_req, ==, req_cnt_true);
+    g_assert_cmpuint(res->stat.n_req_byte, ==, req_byte_true);
+    g_assert_cmpuint(res->stat.n_miss, >, miss_cnt_true);
+    g_assert_cmpfloat(res->sampled_sharded_miss_ratio, >,
+                      res->sampled_exact_miss_ratio);
+    g_assert_cmpfloat(res->max_shard_miss_ratio_error, >, 0);
+    free_sharded_sim_result(res);
+
+    /* one round per shard hands off the exact cache state to every shard */
+    params.n_round = params.n_shard;
+    res = simulate_sharded(reader, cache, &params);
+    g_assert_cmpuint(res->stat.n_req, ==, req_cnt_true);
+    g_assert_cmpuint(res->stat.n_miss, ==, miss_cnt_true);
+    g_assert_cmpfloat(res->max_shard_miss_ratio_error, ==, 0);
+    free_sharded_sim_result(res);
+  }
+
+  cache->cache_free(cache);
+}
+
+static void test_simulator_hierarchy(gconstpointer user_data) {
+  uint64_t l2_sizes[] = {STEP_SIZE, STEP_SIZE * 2, STEP_SIZE * 4};
+  int n_l2_sizes = 3;
+  /* S3-FIFO moves objects between its queues, which must not be reported as
+   * L1 evictions */
+  const char *l1_algos[] = {"LRU", "S3-FIFO"};
+
+  reader_t *reader = clone_reader((reader_t *)user_data);
+  request_t *req = new_request();
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE,
+                                     .default_ttl = 0};
+  cache_t *l2_cache = LRU_init(cc_params, NULL);
+  cc_params.cache_size = STEP_SIZE / 2;
+
+  for (int a = 0; a < (int)(sizeof(l1_algos) / sizeof(l1_algos[0])); a++) {
+    cache_t *l1_cache = create_test_cache(l1_algos[a], cc_params, reader, NULL);
+
+    /* the L1 caches in the hierarchy must behave the same as a plain run */
+    uint64_t l1_miss_true = 0;
+    cache_t *l1 = clone_cache(l1_cache);
+    reset_reader(reader);
+    while (read_one_req(reader, req) == 0) {
+      if (!l1->get(l1, req)) l1_miss_true += 1;
+    }
+    l1->cache_free(l1);
+
+    for (int policy = 0; policy < HIERARCHY_INVALID; policy++) {
+      cache_hierarchy_params_t params = default_cache_hierarchy_params();
+      params.policy = (hierarchy_policy_e)policy;
+      cache_stat_t l1_stat;
+      l1 = clone_cache(l1_cache);
+      reset_reader(reader);
+
+      cache_hierarchy_stat_t *res = simulate_cache_hierarchy(
+          &reader, &l1, 1, l2_cache, n_l2_sizes, l2_sizes, &params, &l1_stat);
+
+      g_assert_cmpuint(l1_stat.n_req, ==, 113872);
+      g_assert_cmpuint(l1_stat.n_miss, ==, l1_miss_true);
+      g_assert_null(l1->event_hook);
+      for (int i = 0; i < n_l2_sizes; i++) {
+        /* every L1 miss is looked up in L2 */
+        g_assert_cmpuint(res[i].stat.n_req, ==, l1_stat.n_miss);
+        g_assert_cmpuint(res[i].stat.n_req_byte, ==, l1_stat.n_miss_byte);
+        g_assert_cmpuint(res[i].stat.n_miss, <=, res[i].stat.n_req);
+        g_assert_cmpuint(res[i].stat.cache_size, ==, l2_sizes[i]);
+        if (policy == HIERARCHY_EXCLUSIVE) {
+          /* every L1 victim is inserted into L2 */
+          g_assert_cmpuint(res[i].n_victim_insert, >, 0);
+          g_assert_cmpuint(res[i].n_victim_insert, <=, l1_stat.n_miss);
+        } else {
+          g_assert_cmpuint(res[i].n_victim_insert, ==, 0);
+        }
+      }
+      g_free(res);
+      l1->cache_free(l1);
+    }
+    l1_cache->cache_free(l1_cache);
+  }
+
+  l2_cache->cache_free(l2_cache);
+  free_request(req);
+  close_reader(reader);
+}
+
+/* read <path>.<suffix>(.zst) into memory */
+static uint8_t *_read_sim_output(const char *path, const char *suffix,
+                                 size_t *len) {
+  gchar *file_path;
+#ifdef SUPPORT_ZSTD_TRACE
+  file_path = g_strdup_printf("%s.%s.zst", path, suffix);
+#else
+  file_path = g_strdup_printf("%s.%s", path, suffix);
+#endif
+  gchar *content;
+  gsize content_len;
+  g_assert_true(g_file_get_contents(file_path, &content, &content_len, NULL));
+  remove(file_path);
+  g_free(file_path);
+
+#ifdef SUPPORT_ZSTD_TRACE
+  unsigned long long n =
+      ZSTD_findDecompressedSize(content, content_len);
+  g_assert_true(n != ZSTD_CONTENTSIZE_ERROR &&
+                n != ZSTD_CONTENTSIZE_UNKNOWN);
+  uint8_t *data = g_malloc(n + 1);
+  size_t ret = ZSTD_decompress(data, n, content, content_len);
+  g_assert_false(ZSTD_isError(ret));
+  g_assert_cmpuint(ret, ==, n);
+  g_free(content);
+  *len = n;
+  return data;
+#else
+  *len = content_len;
+  return (uint8_t *)content;
+#endif
+}
+
+static uint64_t _read_varint(const uint8_t *data, size_t len, size_t *pos) {
+  uint64_t v = 0;
+  int shift = 0;
+  while (true) {
+    g_assert_cmpuint(*pos, <, len);
+    uint8_t b = data[(*pos)++];
+    v |= (uint64_t)(b & 0x7f) << shift;
+    if (b < 0x80) return v;
+    shift += 7;
+  }
+}
+
+/**
+ * run the cache with and without the simulation output, the hits must be the
+ * same, and replaying the event log must reproduce the cache content, i.e.,
+ * a request hits iff its object has been admitted and not evicted
+ */
+static void test_sim_output(gconstpointer user_data) {
+  const char *algos[] = {"LRU", "S3-FIFO", "Random"};
+  const char *path = "test_sim_output";
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {
+      .cache_size = STEP_SIZE, .hashpower = 20, .default_ttl = 0};
+  int64_t n_req = get_num_of_req(reader);
+  request_t *req = new_request();
+  bool *hits = g_new0(bool, n_req);
+
+  for (int a = 0; a < (int)(sizeof(algos) / sizeof(algos[0])); a++) {
+    set_rand_seed(0);
+    reset_reader(reader);
+    cache_t *cache = create_test_cache(algos[a], cc_params, reader, NULL);
+    for (int64_t i = 0; read_one_req(reader, req) == 0; i++) {
+      hits[i] = cache->get(cache, req);
+    }
+    cache->cache_free(cache);
+
+    set_rand_seed(0);
+    reset_reader(reader);
+    cache = create_test_cache(algos[a], cc_params, reader, NULL);
+    sim_output_t *output = open_sim_output(path, cache);
+    g_assert_nonnull(output);
+    for (int64_t i = 0; read_one_req(reader, req) == 0; i++) {
+      bool hit = cache->get(cache, req);
+      sim_output_record(output, hit);
+      g_assert_cmpint(hit, ==, hits[i]);
+    }
+    g_assert_true(close_sim_output(output));
+    cache->cache_free(cache);
+
+    size_t hit_len, event_len, pos = 0;
+    uint8_t *hit_bits = _read_sim_output(path, "hit", &hit_len);
+    uint8_t *events = _read_sim_output(path, "event", &event_len);
+    g_assert_cmpuint(hit_len, ==, (n_req + 7) / 8);
+
+    /* obj_id -> obj_size of the objects in the cache */
+    GHashTable *cached_objs = g_hash_table_new(g_direct_hash, g_direct_equal);
+    int64_t occupied_byte = 0, event_req = -1, n_evict = 0;
+    uint64_t head = 0;
+    if (event_len > 0) {
+      head = _read_varint(events, event_len, &pos);
+      event_req = (int64_t)(head >> 2);
+    }
+
+    reset_reader(reader);
+    for (int64_t i = 0; read_one_req(reader, req) == 0; i++) {
+      gpointer key = GSIZE_TO_POINTER(req->obj_id);
+      bool hit = (hit_bits[i / 8] >> (i % 8)) & 1;
+      g_assert_cmpint(hit, ==, hits[i]);
+      g_assert_cmpint(g_hash_table_contains(cached_objs, key), ==, hit);
+
+      while (event_req == i) {
+        cache_event_e event = (cache_event_e)(head & 3);
+        if (event == CACHE_EVENT_EVICT) {
+          obj_id_t obj_id = _read_varint(events, event_len, &pos);
+          int64_t obj_size = (int64_t)_read_varint(events, event_len, &pos);
+          gpointer victim = GSIZE_TO_POINTER(obj_id);
+          g_assert_true(g_hash_table_contains(cached_objs, victim));
+          g_assert_cmpint(GPOINTER_TO_SIZE(
+                              g_hash_table_lookup(cached_objs, victim)),
+                          ==, obj_size);
+          g_hash_table_remove(cached_objs, victim);
+          occupied_byte -= obj_size;
+          n_evict += 1;
+        } else if (event == CACHE_EVENT_ADMIT) {
+          g_assert_false(hit);
+          g_hash_table_insert(cached_objs, key,
+                              GSIZE_TO_POINTER(req->obj_size));
+          occupied_byte += req->obj_size;
+        } else {
+          g_assert_false(hit);
+        }
+
+        if (pos == event_len) {
+          event_req = -1;
+        } else {
+          head = _read_varint(events, event_len, &pos);
+          event_req += (int64_t)(head >> 2);
+        }
+      }
+      g_assert_cmpint(occupied_byte, <=, (int64_t)cc_params.cache_size);
+    }
+    g_assert_cmpuint(pos, ==, event_len);
+    g_assert_cmpint(event_req, ==, -1);
+    g_assert_cmpint(n_evict, >, 0);
+
+    g_hash_table_destroy(cached_objs);
+    g_free(hit_bits);
+    g_free(events);
+  }
+
+  g_free(hits);
+  free_request(req);
+}
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
@@ -249,6 +535,18 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func_full("/libCacheSim/simulator_vscsi", reader,
                             test_simulator, test_teardown);
 
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_sharded", reader,
+                            test_simulator_sharded, test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_hierarchy", reader,
+                            test_simulator_hierarchy, test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_sim_output", reader,
+                            test_sim_output, test_teardown);
+
   reader = setup_vscsi_reader();
   g_test_add_data_func_full("/libCacheSim/simulator_warmup1", reader,
                             test_simulator_with_warmup1, test_teardown);
@@ -259,8 +557,10 @@ int main(int argc, char *argv[]) {
 
 #ifdef SUPPORT_TTL
   reader = setup_vscsi_reader();
-  g_test_add_data_func_full("/libCacheSim/simulator_with_ttl", reader,
-                            test_simulator_with_ttl, test_teardown);
+  g_test_add_data_func("/libCacheSim/simulator_with_ttl", reader,
+                       test_simulator_with_ttl);
+  g_test_add_data_func_full("/libCacheSim/simulator_with_ttl_wheel", reader,
+                            test_simulator_with_ttl_wheel, test_teardown);
 #endif
 
   return g_test_run();
@@ -134,6 +134,251 @@ void test_reader_more2(gconstpointer user_data) {
   close_reader(cloned_reader);
 }
 
+void test_reader_synthetic(gconstpointer user_data) {
+  const char *spec =
+      "n-req=200000,n-obj=10000,alpha=0.9,scan-ratio=0.1,loop-ratio=0.1,"
+      "loop-len=100,shift-interval=50000,n-tenant=4,size-dist=lognormal,"
+      "seed=7";
+  reader_t *reader = setup_reader(spec, SYNTHETIC_TRACE, NULL);
+  reader_t *cloned_reader = clone_reader(reader);
+  request_t *req = new_request();
+  request_t *cloned_req = new_request();
+  GHashTable *obj_size_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+  g_assert_true(get_num_of_req(reader) == 200000);
+
+  // the cloned reader generates the same requests
+  uint64_t n_req = 0;
+  while (read_one_req(reader, req) == 0) {
+    g_assert_true(read_one_req(cloned_reader, cloned_req) == 0);
+    g_assert_true(req->obj_id == cloned_req->obj_id);
+    g_assert_true(req->obj_size == cloned_req->obj_size);
+    g_assert_true(req->tenant_id == cloned_req->tenant_id);
+
+    // an object always has the same size
+    gpointer size = g_hash_table_lookup(obj_size_table,
+                                        GSIZE_TO_POINTER(req->obj_id));
+    if (size == NULL) {
+      g_hash_table_insert(obj_size_table, GSIZE_TO_POINTER(req->obj_id),
+                          GSIZE_TO_POINTER(req->obj_size));
+    } else {
+      g_assert_cmpuint(GPOINTER_TO_SIZE(size), ==, req->obj_size);
+    }
+    n_req++;
+  }
+  g_assert_true(n_req == 200000);
+  g_assert_true(read_one_req(cloned_reader, cloned_req) != 0);
+
+  // reset replays the stream
+  reset_reader(reader);
+  reset_reader(cloned_reader);
+  g_assert_true(skip_n_req(reader, 10) == 10);
+  for (int i = 0; i < 10; i++) read_one_req(cloned_reader, cloned_req);
+  for (int i = 0; i < N_TEST_REQ; i++) {
+    read_one_req(reader, req);
+    read_one_req(cloned_reader, cloned_req);
+    g_assert_true(req->obj_id == cloned_req->obj_id);
+  }
+
+  g_hash_table_destroy(obj_size_table);
+  free_request(cloned_req);
+  free_request(req);
+  close_reader(cloned_reader);
+  close_reader(reader);
+}
+
+void test_reader_multi(gconstpointer user_data) {
+  char data_path[1024], multi_path[2100];
+  _detect_data_path(data_path, "cloudPhysicsIO.oracleGeneral.bin");
+  snprintf(multi_path, sizeof(multi_path), "%s,%s", data_path, data_path);
+
+  reader_init_param_t init_params = default_reader_init_params();
+  init_params.multi_trace_type = ORACLE_GENERAL_TRACE;
+  request_t *req = new_request();
+  request_t *multi_req = new_request();
+
+  // concatenation reads the trace twice
+  reader_t *reader = setup_reader(data_path, ORACLE_GENERAL_TRACE, NULL);
+  init_params.multi_trace_tag = MULTI_TRACE_TAG_NS;
+  reader_t *multi_reader = setup_reader(multi_path, MULTI_TRACE, &init_params);
+  g_assert_true(get_num_of_req(multi_reader) == trace_length * 2);
+  for (int i = 0; i < 2; i++) {
+    reset_reader(reader);
+    while (read_one_req(reader, req) == 0) {
+      g_assert_true(read_one_req(multi_reader, multi_req) == 0);
+      g_assert_true(multi_req->obj_id == req->obj_id);
+      g_assert_true(multi_req->ns == i);
+    }
+  }
+  g_assert_true(read_one_req(multi_reader, multi_req) != 0);
+  close_reader(multi_reader);
+
+  // merging by time keeps the order of the requests of each trace
+  init_params.multi_trace_merge = true;
+  init_params.multi_trace_readahead = true;
+  init_params.multi_trace_tag = MULTI_TRACE_TAG_TENANT;
+  multi_reader = setup_reader(multi_path, MULTI_TRACE, &init_params);
+  reader_t *cloned_reader = clone_reader(multi_reader);
+  reader_t *readers[2] = {reader, clone_reader(reader)};
+  reset_reader(reader);
+  int64_t last_clock_time = 0;
+  uint64_t n_req = 0;
+  while (read_one_req(cloned_reader, multi_req) == 0) {
+    g_assert_true(multi_req->tenant_id == 0 || multi_req->tenant_id == 1);
+    g_assert_true(read_one_req(readers[multi_req->tenant_id], req) == 0);
+    g_assert_true(multi_req->obj_id == req->obj_id);
+    g_assert_true(multi_req->clock_time >= last_clock_time);
+    last_clock_time = multi_req->clock_time;
+    n_req++;
+  }
+  g_assert_true(n_req == trace_length * 2);
+
+  free_request(multi_req);
+  free_request(req);
+  close_reader(readers[1]);
+  close_reader(cloned_reader);
+  close_reader(multi_reader);
+  close_reader(reader);
+}
+
+void test_reader_index(gconstpointer user_data) {
+  char data_path[1024], index_path[1100];
+  _detect_data_path(data_path, "cloudPhysicsIO.csv");
+  snprintf(index_path, sizeof(index_path), "%s.idx", data_path);
+  remove(index_path);
+
+  reader_init_param_t init_params = default_reader_init_params();
+  init_params.time_field = 2;
+  init_params.obj_id_field = 5;
+  init_params.obj_size_field = 4;
+  init_params.has_header = true;
+  init_params.has_header_set = true;
+  init_params.use_index = true;
+
+  // the first pass builds and saves the index
+  reader_t *reader = setup_reader(data_path, CSV_TRACE, &init_params);
+  g_assert_null(reader->index);
+  g_assert_true(get_num_of_req(reader) == trace_length);
+  g_assert_nonnull(reader->index);
+
+  int64_t req_idx[] = {0, 5, 65535, 65536, 100000, trace_length - 1};
+  int n_idx = sizeof(req_idx) / sizeof(req_idx[0]);
+  obj_id_t obj_ids[sizeof(req_idx) / sizeof(req_idx[0])];
+  int64_t clock_times[sizeof(req_idx) / sizeof(req_idx[0])];
+  request_t *req = new_request();
+  int64_t n = 0;
+  for (int i = 0; i < n_idx; i++) {
+    while (n <= req_idx[i]) {
+      g_assert_true(read_one_req(reader, req) == 0);
+      n++;
+    }
+    obj_ids[i] = req->obj_id;
+    clock_times[i] = req->clock_time;
+  }
+  close_reader(reader);
+
+  // the second reader loads the index
+  reader = setup_reader(data_path, CSV_TRACE, &init_params);
+  g_assert_nonnull(reader->index);
+  g_assert_true(get_num_of_req(reader) == trace_length);
+  for (int i = n_idx - 1; i >= 0; i--) {
+    g_assert_true(reader_seek_to_req(reader, req_idx[i]) == 0);
+    g_assert_true(read_one_req(reader, req) == 0);
+    g_assert_true(req->obj_id == obj_ids[i]);
+  }
+  g_assert_true(reader_seek_to_req(reader, trace_length) == 0);
+  g_assert_true(read_one_req(reader, req) != 0);
+
+  for (int i = 0; i < n_idx; i++) {
+    g_assert_true(reader_seek_to_time(reader, clock_times[i]) == 0);
+    g_assert_true(read_one_req(reader, req) == 0);
+    g_assert_true(req->clock_time == clock_times[i]);
+  }
+
+  free_request(req);
+  close_reader(reader);
+  remove(index_path);
+}
+
+static sampler_t *_create_sampler(enum sampler_type type, double ratio) {
+  return type == SPATIAL_SAMPLER ? create_spatial_sampler(ratio)
+                                 : create_temporal_sampler(ratio);
+}
+
+/* read the trace with a sampler, with and without skipping the unsampled
+ * records in blocks, the sampled requests must be the same */
+static void _check_sampling_batch(const char *data_path, trace_type_e type,
+                                  reader_init_param_t *init_params,
+                                  enum sampler_type sampler_type,
+                                  double ratio) {
+  /* the reader frees the sampler in init_params when it is closed */
+  init_params->sampler = _create_sampler(sampler_type, ratio);
+  reader_t *reader = setup_reader(data_path, type, init_params);
+  init_params->sampler = _create_sampler(sampler_type, ratio);
+  reader_t *reader_no_batch = setup_reader(data_path, type, init_params);
+  init_params->sampler = NULL;
+  g_assert_nonnull(reader->sampler->sample_batch);
+  g_assert_true(reader->raw_obj_id_offset >= 0);
+  reader_no_batch->sampler->sample_batch = NULL;
+
+  request_t *req = new_request();
+  request_t *req_no_batch = new_request();
+  int64_t n_sampled = 0;
+  while (read_one_req(reader, req) == 0) {
+    g_assert_true(read_one_req(reader_no_batch, req_no_batch) == 0);
+    g_assert_true(req->obj_id == req_no_batch->obj_id);
+    g_assert_true(req->obj_size == req_no_batch->obj_size);
+    g_assert_true(req->clock_time == req_no_batch->clock_time);
+    n_sampled++;
+  }
+  g_assert_true(read_one_req(reader_no_batch, req_no_batch) != 0);
+  g_assert_cmpint(reader->n_read_req, ==, reader_no_batch->n_read_req);
+  g_assert_cmpint(n_sampled, >, 0);
+
+  /* temporal sampling keeps the given fraction of the requests,
+   * 0.3 must not be truncated to 1 / 3 */
+  if (sampler_type == TEMPORAL_SAMPLER) {
+    double sampled_ratio = (double)n_sampled / (double)reader->n_read_req;
+    g_assert_cmpfloat(fabs(sampled_ratio - ratio), <, 0.01);
+  }
+
+  free_request(req);
+  free_request(req_no_batch);
+  close_reader(reader);
+  close_reader(reader_no_batch);
+}
+
+void test_reader_sampling_batch(gconstpointer user_data) {
+  char oracle_path[1024], vscsi_path[1024];
+  _detect_data_path(oracle_path, "cloudPhysicsIO.oracleGeneral.bin");
+  _detect_data_path(vscsi_path, "cloudPhysicsIO.vscsi");
+  double ratios[] = {0.5, 0.1, 0.01, 0.3, 0.75};
+  int64_t caps[] = {-1, 20000};
+
+  for (int r = 0; r < (int)(sizeof(ratios) / sizeof(ratios[0])); r++) {
+    for (int t = SPATIAL_SAMPLER; t <= TEMPORAL_SAMPLER; t++) {
+      for (int c = 0; c < (int)(sizeof(caps) / sizeof(caps[0])); c++) {
+        for (int ignore_size_zero = 0; ignore_size_zero <= 1;
+             ignore_size_zero++) {
+          reader_init_param_t init_params = default_reader_init_params();
+          init_params.cap_at_n_req = caps[c];
+          init_params.ignore_size_zero_req = ignore_size_zero;
+          _check_sampling_batch(oracle_path, ORACLE_GENERAL_TRACE,
+                                &init_params, t, ratios[r]);
+
+          init_params.binary_fmt_str = "<IIIHHQQ";
+          init_params.obj_size_field = 2;
+          init_params.obj_id_field = 6;
+          init_params.time_field = 7;
+          init_params.obj_id_is_num = true;
+          _check_sampling_batch(vscsi_path, BIN_TRACE, &init_params, t,
+                                ratios[r]);
+        }
+      }
+    }
+  }
+}
+
 void test_twr(gconstpointer user_data) {
   reader_t *reader = setup_reader("/Users/junchengy/twr.sbin", TWR_TRACE, NULL);
   gint64 n_req = get_num_of_req(reader);
@@ -210,6 +455,14 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func_full("/libCacheSim/reader_more2_oracleGeneral", reader,
                             test_reader_more2, test_teardown);
 
+  g_test_add_data_func("/libCacheSim/reader_synthetic", NULL,
+                       test_reader_synthetic);
+
+  g_test_add_data_func("/libCacheSim/reader_multi", NULL, test_reader_multi);
+  g_test_add_data_func("/libCacheSim/reader_index", NULL, test_reader_index);
+  g_test_add_data_func("/libCacheSim/reader_sampling_batch", NULL,
+                       test_reader_sampling_batch);
+
   // g_test_add_data_func("/libCacheSim/test_twr", NULL, test_twr);
   return g_test_run();
 }
\ No newline at end of file